@@ -0,0 +1,114 @@
+#include "archive_output.h"
+
+#include <iomanip>
+#include <sstream>
+#include "logger.h"
+#include "mapped_file.h"
+#include "normalizer.h"
+
+namespace fs = std::filesystem;
+
+// 已经压缩过的格式, 再压缩基本没有收益, 压缩模式下同样直接存储
+static constexpr std::string_view COMPRESSED_EXTENSIONS[] = {".jar", ".zip", ".mrpack", ".gz", ".xz", ".7z",
+                                                             ".png", ".jpg", ".jpeg", ".ogg"};
+
+ArchiveOutput::ArchiveOutput(const fs::path& directory, ArchiveCompression compression)
+    : outputDirectory(directory), mode(compression) {
+    if (mode == ArchiveCompression::Deflate) pool = std::make_unique<ThreadPool>(defaultThreadCount());
+}
+
+std::string ArchiveOutput::archiveName(ModType type) {
+    return ModInfo::modTypeToDirectory(type) + ".zip";
+}
+
+bool ArchiveOutput::contains(ModType type, std::string_view name) const {
+    auto it = writers.find(type);
+    return it != writers.end() && it->second->contains(name);
+}
+
+ZipWriter* ArchiveOutput::writerFor(ModType type, std::string& error) {
+    auto it = writers.find(type);
+    if (it != writers.end()) return it->second.get();
+    auto writer = std::make_unique<ZipWriter>();
+    if (!writer->open(outputDirectory / archiveName(type))) {
+        error = "无法创建归档 " + archiveName(type);
+        return nullptr;
+    }
+    return writers.emplace(type, std::move(writer)).first->second.get();
+}
+
+bool ArchiveOutput::shouldDeflate(std::string_view name) const {
+    if (mode != ArchiveCompression::Deflate) return false;
+    std::string fileName = fs::path(name).filename().string();
+    for (std::string_view compressed : COMPRESSED_EXTENSIONS) {
+        if (hasExtension(fileName, compressed)) return false;
+    }
+    return true;
+}
+
+bool ArchiveOutput::addFile(ModType type, const std::string& name, const fs::path& source, std::string& error) {
+    ZipWriter* writer = writerFor(type, error);
+    if (writer == nullptr) return false;
+
+    std::error_code ec;
+    uintmax_t size = fs::file_size(source, ec);
+    if (ec) {
+        error = ec.message();
+        return false;
+    }
+    bool written;
+    if (size == 0) {
+        // 空文件无法映射
+        written = writer->addStored(name, nullptr, 0);
+    } else {
+        MappedFile file;
+        if (!file.open(source)) {
+            error = "无法读取文件";
+            return false;
+        }
+        written = shouldDeflate(name) ? writer->addDeflated(name, file.data(), file.size(), *pool)
+                                      : writer->addStored(name, file.data(), file.size());
+    }
+    if (!written) error = "无法写入归档 " + archiveName(type);
+    return written;
+}
+
+bool ArchiveOutput::addEntry(ModType type, const std::string& name, const ZipEntry& entry, const unsigned char* raw,
+                             std::string& error) {
+    if (raw == nullptr || entry.isEncrypted() || (entry.method != 0 && entry.method != 8)) {
+        error = "条目已损坏、加密或使用了不支持的压缩方法";
+        return false;
+    }
+    ZipWriter* writer = writerFor(type, error);
+    if (writer == nullptr) return false;
+
+    bool written;
+    if (entry.method == 0 && shouldDeflate(name)) {
+        if (entry.compressedSize != entry.uncompressedSize) {
+            error = "条目已损坏";
+            return false;
+        }
+        written = writer->addDeflated(name, raw, static_cast<size_t>(entry.uncompressedSize), *pool);
+    } else {
+        // 原样复制压缩数据, 不解压也不重新计算 CRC
+        written = writer->addRaw(name, entry.method, entry.crc32, raw, entry.compressedSize, entry.uncompressedSize);
+    }
+    if (!written) error = "无法写入归档 " + archiveName(type);
+    return written;
+}
+
+bool ArchiveOutput::finish() {
+    bool ok = true;
+    for (auto& [type, writer] : writers) {
+        size_t entries = writer->entryCount();
+        if (!writer->finish()) {
+            ok = false;
+            continue;
+        }
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2) << "已写出归档 " << archiveName(type) << ": " << entries << " 个文件, "
+           << static_cast<double>(writer->bytesWritten()) / (1024.0 * 1024.0) << " MiB";
+        logMessage(ss.str());
+    }
+    return ok;
+}
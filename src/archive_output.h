@@ -0,0 +1,55 @@
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "mod_info.h"
+#include "thread_pool.h"
+#include "zip_reader.h"
+#include "zip_writer.h"
+
+// --- 按类型写出的 zip 归档 ---
+// 分类时直接把每种类型的 Mod 写入输出目录下的 ClientOnly.zip、ServerOnly.zip 等, 不再先复制到子目录
+// 再手动打包。jar 本身已经压缩, 默认原样存储: 目录中的文件映射后计算 CRC 直接写入,
+// 整合包中的条目连同原有的压缩数据和 CRC 原样复制, 每个输入只读一遍。
+// 压缩模式下其它文件 (配置等) 在线程池中并行 DEFLATE 压缩。归档在第一次写入时创建, 没有 Mod 的类型不生成归档。
+
+enum class ArchiveCompression {
+    Store,  // 全部原样存储
+    Deflate // jar 等已压缩的格式存储, 其它文件压缩
+};
+
+class ArchiveOutput {
+public:
+    ArchiveOutput(const std::filesystem::path& directory, ArchiveCompression compression);
+
+    ArchiveOutput(const ArchiveOutput&) = delete;
+    ArchiveOutput& operator=(const ArchiveOutput&) = delete;
+
+    // 归档的文件名, 例如 "ClientOnly.zip"
+    static std::string archiveName(ModType type);
+
+    // 这个类型的归档中是否已有同名文件
+    bool contains(ModType type, std::string_view name) const;
+
+    // 写入目录中的文件, 失败时返回 false 并给出原因
+    bool addFile(ModType type, const std::string& name, const std::filesystem::path& source, std::string& error);
+
+    // 写入另一个 zip 中的条目, raw 为条目的压缩数据 (ZipReader::rawData)
+    bool addEntry(ModType type, const std::string& name, const ZipEntry& entry, const unsigned char* raw,
+                  std::string& error);
+
+    // 写出所有归档的中央目录, 全部成功时返回 true
+    bool finish();
+
+private:
+    ZipWriter* writerFor(ModType type, std::string& error);
+    bool shouldDeflate(std::string_view name) const;
+
+    std::filesystem::path outputDirectory;
+    ArchiveCompression mode;
+    std::unique_ptr<ThreadPool> pool; // 只在压缩模式下创建
+    std::map<ModType, std::unique_ptr<ZipWriter>> writers;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// --- 辅助函数：小端序整数的读写 ---
+// 缓存、索引、ZIP 和服务协议都按小端序存储, 逐字节拼接, 不依赖主机字节序和对齐
+inline uint16_t readLe16(const unsigned char* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t readLe32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint64_t readLe64(const unsigned char* p) {
+    return static_cast<uint64_t>(readLe32(p)) | (static_cast<uint64_t>(readLe32(p + 4)) << 32);
+}
+
+inline uint16_t readLe16(const char* p) { return readLe16(reinterpret_cast<const unsigned char*>(p)); }
+inline uint32_t readLe32(const char* p) { return readLe32(reinterpret_cast<const unsigned char*>(p)); }
+inline uint64_t readLe64(const char* p) { return readLe64(reinterpret_cast<const unsigned char*>(p)); }
+
+inline void appendLe16(std::string& out, uint16_t value) {
+    out.push_back(static_cast<char>(value & 0xFF));
+    out.push_back(static_cast<char>(value >> 8));
+}
+
+inline void appendLe32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+inline void appendLe64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+inline void writeLe32(std::ostream& out, uint32_t value) {
+    char bytes[4];
+    for (int i = 0; i < 4; ++i) bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    out.write(bytes, 4);
+}
+
+inline void writeLe64(std::ostream& out, uint64_t value) {
+    char bytes[8];
+    for (int i = 0; i < 8; ++i) bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    out.write(bytes, 8);
+}
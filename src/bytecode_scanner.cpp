@@ -0,0 +1,340 @@
+#include "bytecode_scanner.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <sstream>
+#include "logger.h"
+#include "nested_jar.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MODCLASSIFIER_SSE2 1
+#endif
+
+namespace fs = std::filesystem;
+using namespace std::string_view_literals;
+
+namespace {
+
+// 超过这个大小的类文件视为异常, 不解压
+constexpr uint64_t MAX_CLASS_SIZE = 4 * 1024 * 1024;
+// 并行扫描时每个任务处理的类文件数
+constexpr size_t CLASSES_PER_CHUNK = 64;
+
+// 常量池中的字符串是 CONSTANT_Utf8 项: 标签 1, 两字节长度, 内容。
+// 包名和类型描述符直接按子串查找; 注解参数等短常量连同标签和长度一起匹配, 避免匹配到更长的名称
+constexpr std::string_view GAME_PACKAGE = "net/minecraft/";
+constexpr std::string_view CLIENT_PACKAGES[] = {"net/minecraft/client/", "com/mojang/blaze3d/", "org/lwjgl/"};
+constexpr std::string_view SERVER_PACKAGES[] = {"net/minecraft/server/dedicated/", "net/minecraft/server/gui/"};
+// Forge 1.7.10-1.12 的 @SideOnly, 1.13 之后 Forge / NeoForge 的 @OnlyIn, Fabric 的 @Environment
+constexpr std::string_view SIDE_ANNOTATIONS[] = {"/relauncher/SideOnly;", "/api/distmarker/OnlyIn;",
+                                                 "Lnet/fabricmc/api/Environment;"};
+constexpr std::string_view CLIENT_CONSTANT = "\x01\x00\x06" "CLIENT"sv;
+constexpr std::string_view SERVER_CONSTANTS[] = {"\x01\x00\x06" "SERVER"sv, "\x01\x00\x10" "DEDICATED_SERVER"sv};
+// 1.7.10-1.12 的 @Mod 注解 (cpw/mods/fml/common/Mod 和 net/minecraftforge/fml/common/Mod)
+constexpr std::string_view MOD_ANNOTATION = "/fml/common/Mod;";
+constexpr std::string_view CLIENT_SIDE_ONLY = "\x01\x00\x0E" "clientSideOnly"sv;
+
+// --- 辅助函数：子串查找 ---
+// SSE2 下同时比较候选位置的首字节和末字节, 两者都相同时再逐字节确认;
+// 常量池中大部分字节在第一步就被排除。没有 SSE2 时使用标准库查找
+bool containsBytes(std::string_view haystack, std::string_view needle) {
+    size_t n = needle.size();
+    if (n == 0) return true;
+    if (haystack.size() < n) return false;
+#ifdef MODCLASSIFIER_SSE2
+    if (n >= 2) {
+        const __m128i first = _mm_set1_epi8(needle[0]);
+        const __m128i last = _mm_set1_epi8(needle[n - 1]);
+        const char* h = haystack.data();
+        size_t i = 0;
+        for (; i + n - 1 + 16 <= haystack.size(); i += 16) {
+            __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i));
+            __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i + n - 1));
+            auto mask = static_cast<unsigned>(
+                    _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast))));
+            while (mask != 0) {
+                unsigned bit = static_cast<unsigned>(std::countr_zero(mask));
+                if (std::memcmp(h + i + bit + 1, needle.data() + 1, n - 2) == 0) return true;
+                mask &= mask - 1;
+            }
+        }
+        return haystack.substr(i).find(needle) != std::string_view::npos;
+    }
+#endif
+    return haystack.find(needle) != std::string_view::npos;
+}
+
+template <size_t N>
+bool containsAny(std::string_view haystack, const std::string_view (&needles)[N]) {
+    return std::any_of(std::begin(needles), std::end(needles),
+                       [&](std::string_view needle) { return containsBytes(haystack, needle); });
+}
+
+uint16_t readBe16(const unsigned char* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+// --- 辅助函数：逐项跳过常量池 ---
+// 可以对不断变长的同一段前缀反复调用 advance(), 从上次停下的项继续;
+// 常量池读完或发现不是类文件时返回 true, 用于在解压时提前停止
+class ConstantPoolWalker {
+public:
+    bool advance(std::string_view data) {
+        if (state != State::Walking) return true;
+        auto bytes = reinterpret_cast<const unsigned char*>(data.data());
+        if (pos == 0) {
+            if (data.size() < 10) return false;
+            // 魔数 0xCAFEBABE, 之后是版本号和常量池项数 (下标从 1 开始)
+            if (bytes[0] != 0xCA || bytes[1] != 0xFE || bytes[2] != 0xBA || bytes[3] != 0xBE) return fail();
+            count = readBe16(bytes + 8);
+            if (count == 0) return fail();
+            pos = 10;
+        }
+        while (index < count) {
+            if (pos >= data.size()) return false;
+            size_t length;
+            size_t slots = 1;
+            switch (bytes[pos]) {
+                case 1: // Utf8
+                    if (pos + 3 > data.size()) return false;
+                    length = 3 + readBe16(bytes + pos + 1);
+                    break;
+                case 7: case 8: case 16: case 19: case 20: // Class, String, MethodType, Module, Package
+                    length = 3;
+                    break;
+                case 15: // MethodHandle
+                    length = 4;
+                    break;
+                case 3: case 4: case 9: case 10: case 11: case 12: case 17: case 18:
+                    length = 5;
+                    break;
+                case 5: case 6: // Long, Double 占两个下标
+                    length = 9;
+                    slots = 2;
+                    break;
+                default:
+                    return fail();
+            }
+            if (pos + length > data.size()) return false;
+            pos += length;
+            index += slots;
+        }
+        state = State::Complete;
+        return true;
+    }
+
+    bool complete() const { return state == State::Complete; }
+    // 常量池的范围 (不含文件头), 只在 complete() 时有效
+    std::string_view pool(std::string_view data) const { return data.substr(10, pos - 10); }
+    size_t end() const { return pos; }
+
+private:
+    enum class State { Walking, Complete, Invalid };
+
+    bool fail() {
+        state = State::Invalid;
+        return true;
+    }
+
+    State state = State::Walking;
+    size_t pos = 0;
+    size_t count = 0;
+    size_t index = 1;
+};
+
+// --- 辅助函数：在常量池中查找各类引用 ---
+void matchReferences(std::string_view pool, ClassReferences& refs) {
+    refs = ClassReferences{};
+    refs.client = containsAny(pool, CLIENT_PACKAGES);
+    refs.game = refs.client || containsBytes(pool, GAME_PACKAGE);
+    if (refs.game) refs.server = containsAny(pool, SERVER_PACKAGES);
+    if (containsAny(pool, SIDE_ANNOTATIONS)) {
+        refs.clientAnnotation = containsBytes(pool, CLIENT_CONSTANT);
+        refs.serverAnnotation = containsAny(pool, SERVER_CONSTANTS);
+    }
+    refs.clientSideOnly = containsBytes(pool, CLIENT_SIDE_ONLY) && containsBytes(pool, MOD_ANNOTATION);
+}
+
+// 只扫描真正会被加载的类; META-INF/versions/ 下是多版本 jar 的重复类
+bool isClassEntry(const ZipEntry& entry) {
+    return !entry.isDirectory() && !entry.isEncrypted() && entry.name.size() > 6 &&
+           entry.name.substr(entry.name.size() - 6) == ".class" && entry.name.substr(0, 9) != "META-INF/";
+}
+
+// 一个顶层 jar 或内嵌 jar 中的类
+struct ClassSource {
+    const ZipReader* jar;
+    std::vector<ZipEntry> classes;
+};
+
+struct OpenedJar {
+    ZipReader jar;
+    NestedJarSet nested;
+    std::vector<ClassSource> sources;
+};
+
+struct ClassChunk {
+    size_t jar;
+    size_t source;
+    size_t begin;
+    size_t end;
+};
+
+void collectClasses(const ZipReader& jar, std::vector<ClassSource>& sources) {
+    ClassSource source{&jar, {}};
+    jar.forEachEntry([&](const ZipEntry& entry) {
+        if (isClassEntry(entry)) source.classes.push_back(entry);
+        return true;
+    });
+    if (!source.classes.empty()) sources.push_back(std::move(source));
+}
+
+} // namespace
+
+void BytecodeSummary::add(const ClassReferences& refs) {
+    ++classes;
+    if (refs.game || refs.clientAnnotation || refs.serverAnnotation) ++gameClasses;
+    if (refs.client || refs.clientAnnotation) ++clientClasses;
+    if (refs.server || refs.serverAnnotation) ++serverClasses;
+    clientSideOnly = clientSideOnly || refs.clientSideOnly;
+}
+
+void BytecodeSummary::merge(const BytecodeSummary& other) {
+    classes += other.classes;
+    unreadable += other.unreadable;
+    gameClasses += other.gameClasses;
+    nestedJars += other.nestedJars;
+    clientClasses += other.clientClasses;
+    serverClasses += other.serverClasses;
+    clientSideOnly = clientSideOnly || other.clientSideOnly;
+}
+
+size_t scanClassBytes(std::string_view classBytes, ClassReferences& refs) {
+    ConstantPoolWalker walker;
+    walker.advance(classBytes);
+    if (!walker.complete()) return 0;
+    matchReferences(walker.pool(classBytes), refs);
+    return walker.end();
+}
+
+bool scanClassFile(const ZipReader& jar, const ZipEntry& entry, ClassReferences& refs) {
+    ConstantPoolWalker walker;
+    std::string_view data;
+    bool ok = jar.extractToWindow(entry, MAX_CLASS_SIZE, data, [&](std::string_view prefix) {
+        return walker.advance(prefix);
+    });
+    if (!ok) return false;
+    walker.advance(data); // 存储的条目和提前停止之前已经解压完的条目
+    if (!walker.complete()) return false;
+    matchReferences(walker.pool(data), refs);
+    return true;
+}
+
+BytecodeVerdict inferBytecodeType(const BytecodeSummary& summary) {
+    BytecodeVerdict verdict;
+    std::stringstream ss;
+    ss << "客户端类 " << summary.clientClasses << "/" << summary.gameClasses << ", 服务端类 " << summary.serverClasses;
+    if (summary.nestedJars > 0) ss << ", 含 " << summary.nestedJars << " 个内嵌 jar";
+    verdict.evidence = ss.str();
+
+    if (summary.clientSideOnly) {
+        verdict.type = ModType::ClientOnly;
+        verdict.confidence = 0.95;
+        verdict.evidence = "@Mod(clientSideOnly), " + verdict.evidence;
+        return verdict;
+    }
+    if (summary.gameClasses == 0) {
+        verdict.evidence = "没有引用游戏代码";
+        return verdict;
+    }
+
+    // 引用游戏代码的类越多, 比例越可信; 只有几个类时置信度明显降低
+    auto game = static_cast<double>(summary.gameClasses);
+    double weight = game / (game + 5.0);
+    double clientRatio = static_cast<double>(summary.clientClasses) / game;
+    if (summary.serverClasses > 0 && summary.clientClasses == 0) {
+        verdict.type = ModType::ServerOnly;
+        verdict.confidence = weight * std::min(1.0, 0.6 + 0.1 * static_cast<double>(summary.serverClasses));
+    } else if (summary.serverClasses == 0 && clientRatio >= 0.8) {
+        verdict.type = ModType::ClientOnly;
+        verdict.confidence = weight * clientRatio;
+    } else {
+        // 旧版本的通用类里也常有 @SideOnly(CLIENT) 的方法, 客户端类占一半以下才比较确定是双端 Mod
+        verdict.type = ModType::ClientAndServerRequired;
+        verdict.confidence = weight * std::min(1.0, 2.0 * (1.0 - clientRatio));
+    }
+    return verdict;
+}
+
+BytecodeSummary scanJarBytecode(const ZipReader& jar, const std::string& jarName) {
+    std::vector<ClassSource> sources;
+    collectClasses(jar, sources);
+    NestedJarSet nested;
+    nested.open(jar);
+    if (nested.limitReached()) {
+        logMessage("jar " + jarName + " 的内嵌 jar 超出深度或大小限制, 只扫描了前 " + std::to_string(nested.size()) +
+                   " 个", true);
+    }
+    for (size_t k = 0; k < nested.size(); ++k) collectClasses(nested[k].reader, sources);
+
+    BytecodeSummary summary;
+    summary.nestedJars = nested.size();
+    for (const ClassSource& source : sources) {
+        for (const ZipEntry& entry : source.classes) {
+            ClassReferences refs;
+            if (scanClassFile(*source.jar, entry, refs)) {
+                summary.add(refs);
+            } else {
+                ++summary.unreadable;
+            }
+        }
+    }
+    return summary;
+}
+
+std::vector<BytecodeSummary> scanJarsBytecode(const std::vector<fs::path>& jars, ThreadPool& pool) {
+    // 先并行打开所有 jar (连同内嵌 jar) 并列出类文件, 再把所有类按固定大小切块, 大 jar 也能分到多个线程
+    std::vector<OpenedJar> opened(jars.size());
+    parallelFor(pool, jars.size(), [&](size_t i) {
+        OpenedJar& target = opened[i];
+        if (!target.jar.open(jars[i])) return;
+        collectClasses(target.jar, target.sources);
+        target.nested.open(target.jar);
+        if (target.nested.limitReached()) {
+            logMessage("jar " + jars[i].filename().string() + " 的内嵌 jar 超出深度或大小限制, 只扫描了前 " +
+                       std::to_string(target.nested.size()) + " 个", true);
+        }
+        for (size_t k = 0; k < target.nested.size(); ++k) collectClasses(target.nested[k].reader, target.sources);
+    });
+
+    std::vector<ClassChunk> chunks;
+    for (size_t i = 0; i < opened.size(); ++i) {
+        for (size_t s = 0; s < opened[i].sources.size(); ++s) {
+            size_t count = opened[i].sources[s].classes.size();
+            for (size_t begin = 0; begin < count; begin += CLASSES_PER_CHUNK) {
+                chunks.push_back({i, s, begin, std::min(begin + CLASSES_PER_CHUNK, count)});
+            }
+        }
+    }
+
+    std::vector<BytecodeSummary> partial(chunks.size());
+    parallelFor(pool, chunks.size(), [&](size_t c) {
+        const ClassChunk& chunk = chunks[c];
+        const ClassSource& source = opened[chunk.jar].sources[chunk.source];
+        for (size_t k = chunk.begin; k < chunk.end; ++k) {
+            ClassReferences refs;
+            if (scanClassFile(*source.jar, source.classes[k], refs)) {
+                partial[c].add(refs);
+            } else {
+                ++partial[c].unreadable;
+            }
+        }
+    });
+
+    std::vector<BytecodeSummary> summaries(jars.size());
+    for (size_t i = 0; i < jars.size(); ++i) summaries[i].nestedJars = opened[i].nested.size();
+    for (size_t c = 0; c < chunks.size(); ++c) summaries[chunks[c].jar].merge(partial[c]);
+    return summaries;
+}
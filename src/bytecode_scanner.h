@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mod_info.h"
+#include "thread_pool.h"
+#include "zip_reader.h"
+
+// --- 字节码扫描 ---
+// 很多 1.7.10 / 1.12 的旧 jar 既不在数据库中, 也没有可靠的描述文件。
+// 这里只解压每个 .class 文件开头的常量池 (读完常量池立即停止解压), 统计其中对
+// 客户端代码 (net/minecraft/client/, com/mojang/blaze3d/, org/lwjgl/) 和专用服务端代码的引用,
+// 以及 @SideOnly / @OnlyIn / @Environment 和 @Mod(clientSideOnly = true) 注解, 推断 Mod 的运行端。
+
+// 单个类的常量池中出现的引用
+struct ClassReferences {
+    bool game = false;             // 引用了任何游戏代码 (net/minecraft/ 等)
+    bool client = false;           // 引用了客户端代码
+    bool server = false;           // 引用了专用服务端代码
+    bool clientAnnotation = false; // 带有 CLIENT 参数的运行端注解
+    bool serverAnnotation = false; // 带有 SERVER / DEDICATED_SERVER 参数的运行端注解
+    bool clientSideOnly = false;   // @Mod(clientSideOnly = ...)
+};
+
+// 一个 jar 中所有类的统计
+struct BytecodeSummary {
+    size_t classes = 0;        // 成功读取常量池的类
+    size_t unreadable = 0;     // 损坏或过大而跳过的类
+    size_t gameClasses = 0;    // 引用了游戏代码的类
+    size_t clientClasses = 0;  // 引用客户端代码或标注为仅客户端的类
+    size_t serverClasses = 0;  // 引用专用服务端代码或标注为仅服务端的类
+    size_t nestedJars = 0;     // 一并扫描的内嵌 jar
+    bool clientSideOnly = false;
+
+    void add(const ClassReferences& refs);
+    void merge(const BytecodeSummary& other);
+};
+
+// 推断结果; 没有引用游戏代码 (例如纯 Java 库) 时 type 为空
+struct BytecodeVerdict {
+    std::optional<ModType> type;
+    double confidence = 0; // 0 - 1, 类越多、比例越悬殊越高
+    std::string evidence;  // 用于日志, 例如 "客户端类 45/50, 服务端类 0"
+};
+
+// 读取一个 .class 条目的常量池, 文件损坏或不是类文件时返回 false
+bool scanClassFile(const ZipReader& jar, const ZipEntry& entry, ClassReferences& refs);
+
+// 在已解压的类文件 (至少包含完整常量池) 中统计引用, 返回常量池的结束位置, 不是有效类文件时返回 0
+size_t scanClassBytes(std::string_view classBytes, ClassReferences& refs);
+
+// 根据统计推断 Mod 类型
+BytecodeVerdict inferBytecodeType(const BytecodeSummary& summary);
+
+// 在当前线程中扫描一个已打开的 jar (连同内嵌 jar), 用于整合包中已解压到内存的 jar; jarName 只用于日志
+BytecodeSummary scanJarBytecode(const ZipReader& jar, const std::string& jarName);
+
+// 并行扫描多个 jar (同时在 jar 之间和 jar 内的类之间并行), 结果与 jars 一一对应;
+// 内嵌 jar (见 nested_jar.h) 中的类计入所属的顶层 jar
+std::vector<BytecodeSummary> scanJarsBytecode(const std::vector<std::filesystem::path>& jars, ThreadPool& pool);
@@ -0,0 +1,817 @@
+#include "classifier.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include "archive_output.h"
+#include "bytecode_scanner.h"
+#include "dependency_graph.h"
+#include "fingerprint.h"
+#include "jar_metadata.h"
+#include "logger.h"
+#include "mod_version.h"
+#include "modpack.h"
+#include "normalizer.h"
+#include "profile_output.h"
+#include "thread_pool.h"
+
+namespace fs = std::filesystem;
+
+ModIndex::ModIndex(const std::vector<ModInfo>& mods) {
+    typeByName.reserve(mods.size());
+    for (const auto& mod : mods) {
+        if (!mod.name.empty()) typeByName[mod.name] = mod.type;
+        for (const auto& alias : mod.aliases) typeByName[alias] = mod.type;
+        if (!mod.modId.empty()) typeByModId[mod.modId] = mod.type;
+    }
+}
+
+ModIndex::ModIndex(std::vector<std::pair<std::string, ModType>> names,
+                   std::vector<std::pair<std::string, ModType>> modIds) {
+    typeByName.reserve(names.size());
+    for (auto& [name, type] : names) typeByName.emplace(std::move(name), type);
+    typeByModId.reserve(modIds.size());
+    for (auto& [modId, type] : modIds) typeByModId.emplace(std::move(modId), type);
+}
+
+std::optional<ModType> ModIndex::find(const std::string& cleanName) const {
+    auto it = typeByName.find(cleanName);
+    if (it == typeByName.end()) return std::nullopt;
+    return it->second;
+}
+
+std::optional<ModType> ModIndex::findModId(std::string_view modId) const {
+    if (typeByModId.empty()) return std::nullopt;
+    std::string key;
+    key.reserve(modId.size());
+    for (char c : modId) key.push_back(toLowerAscii(c));
+    auto it = typeByModId.find(key);
+    if (it == typeByModId.end()) return std::nullopt;
+    return it->second;
+}
+
+std::vector<std::pair<std::string_view, ModType>> ModIndex::sortedEntries() const {
+    // 按名称排序编号, 分数或距离相同的结果按字典序给出
+    std::vector<std::pair<std::string_view, ModType>> entries;
+    entries.reserve(typeByName.size());
+    for (const auto& [name, type] : typeByName) entries.emplace_back(name, type);
+    std::sort(entries.begin(), entries.end());
+    return entries;
+}
+
+void ModIndex::buildSuggestionIndex() {
+    std::vector<std::pair<std::string_view, ModType>> entries = sortedEntries();
+    auto index = std::make_shared<SuggestionIndex>();
+    std::vector<std::string_view> names;
+    names.reserve(entries.size());
+    index->types.reserve(entries.size());
+    for (const auto& [name, type] : entries) {
+        names.push_back(name);
+        index->types.push_back(type);
+    }
+    index->trigrams.build(names);
+    suggestions = std::move(index);
+}
+
+std::vector<ModIndex::Suggestion> ModIndex::suggest(std::string_view cleanName, size_t limit) const {
+    std::vector<Suggestion> result;
+    if (!suggestions) return result;
+    for (const TrigramMatch& match : suggestions->trigrams.search(cleanName, limit)) {
+        result.push_back({suggestions->trigrams.name(match.entry), suggestions->types[match.entry], match.score});
+    }
+    return result;
+}
+
+void ModIndex::buildFuzzyIndex(int maxDistance) {
+    std::vector<std::pair<std::string_view, ModType>> entries = sortedEntries();
+    auto index = std::make_shared<FuzzyIndex>();
+    std::vector<std::string_view> names;
+    names.reserve(entries.size());
+    index->types.reserve(entries.size());
+    for (const auto& [name, type] : entries) {
+        names.push_back(name);
+        index->types.push_back(type);
+    }
+    index->names.build(names);
+    index->maxDistance = maxDistance;
+    fuzzy = std::move(index);
+}
+
+std::vector<ModIndex::FuzzyCandidate> ModIndex::findFuzzy(std::string_view cleanName, size_t limit) const {
+    std::vector<FuzzyCandidate> result;
+    if (!fuzzy) return result;
+    for (const FuzzyMatch& match : fuzzy->names.search(cleanName, fuzzy->maxDistance, limit)) {
+        result.push_back({fuzzy->names.name(match.entry), fuzzy->types[match.entry], match.distance});
+    }
+    return result;
+}
+
+ClassifyResult classifyFileName(const ModIndex& index, const std::string& fullFileName, NormalizeCache* nameCache) {
+    ClassifyResult result;
+    result.cleanName = nameCache ? nameCache->getCleanName(fullFileName) : getCleanModName(fullFileName);
+    if (const OverrideRule* rule = index.matchOverride(result.cleanName)) {
+        result.type = rule->type;
+        result.overrideRule = rule->pattern;
+        return result;
+    }
+    result.type = index.find(result.cleanName);
+    return result;
+}
+
+// 字节码推断的置信度低于这个值时不采纳, 文件留在原处等待人工确认
+constexpr double MIN_BYTECODE_CONFIDENCE = 0.6;
+
+// 找不到分类信息时最多给出的近似名称数
+constexpr size_t SUGGESTION_LIMIT = 3;
+
+// --- 辅助函数：按 mod ID 查找数据库 ---
+// 先查按 mod ID 登记的条目; 旧条目只有干净文件名, 而 mod ID 通常就是去掉版本后的文件名, 再按 "<modid>.jar" 查找
+static std::optional<ModType> findByModId(const ModIndex& index, const std::string& modId) {
+    if (auto type = index.findModId(modId)) return type;
+    std::string key;
+    key.reserve(modId.size() + 4);
+    for (char c : modId) key.push_back(toLowerAscii(c));
+    key += ".jar";
+    return index.find(key);
+}
+
+// --- 辅助函数：并行读取需要的 jar 元数据 ---
+// 每个 jar 只映射一次并解压一个小条目, 耗时主要在文件系统, 适合并行
+static void readMetadataInParallel(const std::vector<fs::path>& files, const std::vector<size_t>& wanted,
+                                   std::vector<std::optional<JarMetadata>>& metadata, bool withDependencies) {
+    if (wanted.empty()) return;
+    auto start = std::chrono::steady_clock::now();
+    ThreadPool pool(std::min(defaultThreadCount(), wanted.size()));
+    parallelFor(pool, wanted.size(), [&](size_t i) {
+        size_t fileIndex = wanted[i];
+        JarMetadata result;
+        if (readJarMetadata(files[fileIndex], result, withDependencies)) metadata[fileIndex] = std::move(result);
+    });
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    size_t found = 0;
+    for (size_t fileIndex : wanted) found += metadata[fileIndex].has_value();
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2) << "已读取 " << wanted.size() << " 个 jar 的元数据, 其中 " << found
+       << " 个包含描述文件, 耗时 " << elapsed << " 毫秒";
+    logMessage(ss.str());
+}
+
+// --- 辅助函数：并行计算指纹并查找哈希索引 ---
+// 只计算索引中有条目的指纹种类; 每个 jar 需要完整读取一遍, 耗时与 jar 的总大小成正比
+static void lookupHashesInParallel(const HashIndex& hashIndex, const std::vector<fs::path>& files,
+                                   const std::vector<size_t>& wanted, std::vector<std::optional<ModType>>& types) {
+    if (wanted.empty()) return;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<fs::path> jars;
+    jars.reserve(wanted.size());
+    for (size_t fileIndex : wanted) jars.push_back(files[fileIndex]);
+
+    ThreadPool pool(std::min(defaultThreadCount(), wanted.size()));
+    std::vector<std::optional<Fingerprint>> fingerprints = fingerprintFiles(jars, pool, hashIndex.fingerprintKinds());
+    size_t found = 0;
+    for (size_t i = 0; i < wanted.size(); ++i) {
+        if (!fingerprints[i]) continue;
+        types[wanted[i]] = hashIndex.find(*fingerprints[i]);
+        found += types[wanted[i]].has_value();
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2) << "已计算 " << wanted.size() << " 个 jar 的指纹, 其中 " << found
+       << " 个在哈希索引中, 耗时 " << elapsed << " 毫秒";
+    logMessage(ss.str());
+}
+
+// --- 辅助函数：按模式依次尝试文件名、mod ID 和描述文件 ---
+// fallback 为 文件名 -> mod ID -> 描述文件; primary 为 按 mod ID 登记的条目 -> 描述文件 -> 文件名 -> mod ID。
+// origin 记录依据, 用于日志
+static std::optional<ModType> resolveType(const ModIndex& index, const ClassifyResult& result,
+                                          const std::optional<JarMetadata>& declared, MetadataMode metadataMode,
+                                          std::string& origin) {
+    std::optional<ModType> type;
+    bool preferDeclared = metadataMode == MetadataMode::Primary;
+    if (declared && preferDeclared) {
+        // 数据库中按 mod ID 登记的条目是人工确认过的, 比描述文件中声明的运行环境更准确
+        if (!declared->modId.empty()) type = index.findModId(declared->modId);
+        if (type) {
+            origin = " (依据 mod ID: " + declared->modId + ")";
+        } else if (declared->type) {
+            type = declared->type;
+            origin = std::string(" (依据 ") + metadataSourceName(declared->source) + ", " + declared->evidence + ")";
+        }
+    }
+    if (!type) type = result.type;
+    if (!type && declared && !declared->modId.empty()) {
+        type = findByModId(index, declared->modId);
+        if (type) origin = " (依据 mod ID: " + declared->modId + ")";
+    }
+    if (!type && declared && declared->type) {
+        type = declared->type;
+        origin = std::string(" (依据 ") + metadataSourceName(declared->source) + ", " + declared->evidence + ")";
+    }
+    return type;
+}
+
+// --- 辅助函数：并行扫描剩余 jar 的字节码 ---
+static void scanBytecodeInParallel(const std::vector<fs::path>& files, const std::vector<size_t>& wanted,
+                                   std::vector<std::optional<BytecodeVerdict>>& verdicts) {
+    if (wanted.empty()) return;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<fs::path> jars;
+    jars.reserve(wanted.size());
+    for (size_t fileIndex : wanted) jars.push_back(files[fileIndex]);
+
+    ThreadPool pool(defaultThreadCount());
+    std::vector<BytecodeSummary> summaries = scanJarsBytecode(jars, pool);
+    BytecodeSummary total;
+    for (size_t i = 0; i < wanted.size(); ++i) {
+        verdicts[wanted[i]] = inferBytecodeType(summaries[i]);
+        total.merge(summaries[i]);
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2) << "已扫描 " << wanted.size() << " 个 jar 的字节码, 共 " << total.classes
+       << " 个类 (" << total.unreadable << " 个无法读取), 耗时 " << elapsed << " 毫秒";
+    logMessage(ss.str());
+}
+
+// 最终类型的来源, 用于统计
+enum class TypeOrigin {
+    FileName,  // 文件名或别名
+    HashIndex, // 哈希索引
+    Metadata,  // jar 内描述文件 (包括按 mod ID 查到的数据库条目)
+    Modpack,   // 整合包声明的运行端
+    Dependency, // 由依赖它的 Mod 推出
+    Fuzzy,      // 编辑距离足够小的唯一一个数据库名称
+    Override    // 覆盖规则
+};
+
+// 一个待写出的文件及其分类依据
+struct PendingMod {
+    std::string fileName;
+    ClassifyResult result;
+    std::optional<ModType> type;
+    std::string origin; // 依据, 附加在日志末尾
+    TypeOrigin typeOrigin = TypeOrigin::FileName;
+    std::optional<BytecodeVerdict> bytecode;
+    bool downloadOnly = false; // 只在整合包清单中列出, 没有文件可以写出
+    std::string fuzzyNote; // 编辑距离以内有多个名称而没有采纳时列出这些名称, 附加在找不到的日志中
+};
+
+// --- 辅助函数：采用覆盖规则给出的类型 ---
+// 覆盖规则是使用者针对自己环境的明确要求, 优先于其它所有依据
+static bool applyOverrideRule(PendingMod& mod) {
+    if (mod.result.overrideRule.empty()) return false;
+    mod.type = mod.result.type;
+    mod.origin = " (依据覆盖规则: " + mod.result.overrideRule + ")";
+    mod.typeOrigin = TypeOrigin::Override;
+    return true;
+}
+
+// --- 辅助函数：按编辑距离匹配数据库名称 ---
+// 只有距离以内恰好一个名称时才采纳, 多个时无法判断是哪一个, 只记录下来
+static void matchFuzzyName(const ModIndex& index, PendingMod& mod) {
+    if (mod.type || !index.hasFuzzyIndex()) return;
+    std::vector<ModIndex::FuzzyCandidate> candidates = index.findFuzzy(mod.result.cleanName, SUGGESTION_LIMIT);
+    if (candidates.size() == 1) {
+        mod.type = candidates[0].type;
+        mod.origin = " (依据近似名称: " + std::string(candidates[0].name) + ", 编辑距离 " +
+                     std::to_string(candidates[0].distance) + ")";
+        mod.typeOrigin = TypeOrigin::Fuzzy;
+    } else if (candidates.size() > 1) {
+        mod.fuzzyNote = ", 编辑距离 " + std::to_string(index.fuzzyDistance()) + " 以内有多个名称: ";
+        for (size_t k = 0; k < candidates.size(); ++k) {
+            if (k > 0) mod.fuzzyNote += ", ";
+            mod.fuzzyNote += std::string(candidates[k].name) + " (" + std::to_string(candidates[k].distance) + ")";
+        }
+    }
+}
+
+// --- 辅助函数：并行按编辑距离匹配仍然没有类型的文件 ---
+static void matchFuzzyNamesInParallel(const ModIndex& index, std::vector<PendingMod>& mods) {
+    if (!index.hasFuzzyIndex()) return;
+    std::vector<size_t> wanted;
+    for (size_t i = 0; i < mods.size(); ++i) {
+        if (!mods[i].type) wanted.push_back(i);
+    }
+    if (wanted.empty()) return;
+    auto start = std::chrono::steady_clock::now();
+    ThreadPool pool(std::min(defaultThreadCount(), wanted.size()));
+    parallelFor(pool, wanted.size(), [&](size_t w) { matchFuzzyName(index, mods[wanted[w]]); });
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    size_t matched = 0;
+    for (size_t i : wanted) matched += mods[i].typeOrigin == TypeOrigin::Fuzzy;
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2) << "已按编辑距离 (不超过 " << index.fuzzyDistance() << ") 检查 "
+       << wanted.size() << " 个未找到的 Mod, 其中 " << matched << " 个只有一个近似名称, 耗时 " << elapsed << " 毫秒";
+    logMessage(ss.str());
+}
+
+// 把第 i 个文件写到 destination 或归档输出中 type 对应的归档, 失败时返回 false 并给出原因
+using WriteModFile = std::function<bool(size_t i, ModType type, const fs::path& destination, std::string& error)>;
+
+// --- 辅助函数：确保输出目录和所有可能的子目录都存在 ---
+// 写入归档时只需要输出目录本身
+static void createOutputDirectories(const std::string& outputDir, bool archives) {
+    fs::create_directories(outputDir);
+    if (archives) return;
+    fs::create_directories(fs::path(outputDir) / "ClientOnly");
+    fs::create_directories(fs::path(outputDir) / "ServerOnly");
+    fs::create_directories(fs::path(outputDir) / "ClientRequiredServerOptional");
+    fs::create_directories(fs::path(outputDir) / "ClientOptionalServerRequired");
+    fs::create_directories(fs::path(outputDir) / "ClientAndServerRequired");
+    fs::create_directories(fs::path(outputDir) / "ClientOptionalServerOptional");
+    fs::create_directories(fs::path(outputDir) / "Unknown"); // 为在JSON中指定的Unknown类型创建目录
+}
+
+// --- 辅助函数：按确定的类型写出文件 ---
+// 按原顺序处理, 保持日志顺序稳定
+static void placeClassifiedMods(const ModIndex& index, const std::vector<PendingMod>& mods,
+                                const std::string& outputDir, const ArchiveOutput* archiveOutput,
+                                ProfileOutput* profileOutput, const WriteModFile& write, ClassifyStats& stats) {
+    size_t suggestionQueries = 0;
+    std::chrono::steady_clock::duration suggestionTime{};
+    for (size_t i = 0; i < mods.size(); ++i) {
+        const PendingMod& mod = mods[i];
+        const std::string& fullFileName = mod.fileName;
+        std::optional<ModType> type = mod.type;
+        std::string origin = mod.origin;
+
+        // 字节码推断只采纳置信度足够高的结果
+        const std::optional<BytecodeVerdict>& inferred = mod.bytecode;
+        bool inferredAccepted = !type && inferred && inferred->type && inferred->confidence >= MIN_BYTECODE_CONFIDENCE;
+        if (inferredAccepted) {
+            type = inferred->type;
+            std::stringstream ss;
+            ss << std::fixed << std::setprecision(2) << " (依据字节码, " << inferred->evidence << ", 置信度 "
+               << inferred->confidence << ")";
+            origin = ss.str();
+        }
+
+        if (type && mod.downloadOnly) {
+            // 清单中的文件由启动器下载, 这里只给出分类
+            logMessage("整合包清单中的 Mod: " + fullFileName + " 属于 " + ModInfo::modTypeToDirectory(*type) + origin +
+                       ", 文件需要下载, 未写出");
+            ++stats.downloadOnly;
+        } else if (type) {
+            // 找到了匹配项, 进行分类
+            std::string targetSubDir = ModInfo::modTypeToDirectory(*type);
+            fs::path destinationPath = fs::path(outputDir) / targetSubDir / fullFileName;
+
+            // 检查目标文件是否已存在
+            if (archiveOutput != nullptr && archiveOutput->contains(*type, fullFileName)) {
+                logMessage("已跳过 Mod: " + fullFileName + ", 因为它已存在于归档: " + ArchiveOutput::archiveName(*type));
+                ++stats.skipped;
+                continue;
+            }
+            if (archiveOutput == nullptr && fs::exists(destinationPath) && fs::is_regular_file(destinationPath)) {
+                logMessage("已跳过 Mod: " + fullFileName + ", 因为它已存在于目标目录: " + targetSubDir);
+                ++stats.skipped;
+                if (profileOutput != nullptr) profileOutput->add(*type, destinationPath);
+                continue;
+            }
+
+            std::string error;
+            if (write(i, *type, destinationPath, error)) {
+                std::string target = archiveOutput != nullptr ? ArchiveOutput::archiveName(*type) : targetSubDir;
+                logMessage("已分类 Mod: " + fullFileName + " 到 " + target + origin);
+                ++stats.classified;
+                if (profileOutput != nullptr) profileOutput->add(*type, destinationPath);
+                if (inferredAccepted) {
+                    ++stats.fromBytecode;
+                } else if (mod.typeOrigin == TypeOrigin::HashIndex) {
+                    ++stats.fromHashIndex;
+                } else if (mod.typeOrigin == TypeOrigin::Modpack) {
+                    ++stats.fromModpack;
+                } else if (mod.typeOrigin == TypeOrigin::Metadata) {
+                    ++stats.fromMetadata;
+                } else if (mod.typeOrigin == TypeOrigin::Dependency) {
+                    ++stats.fromDependency;
+                } else if (mod.typeOrigin == TypeOrigin::Fuzzy) {
+                    ++stats.fromFuzzy;
+                } else if (mod.typeOrigin == TypeOrigin::Override) {
+                    ++stats.fromOverride;
+                }
+            } else {
+                logMessage("无法分类 Mod " + fullFileName + ": " + error, true);
+                ++stats.failed;
+            }
+        } else {
+            // 未找到匹配项, 记录错误, 不移动文件
+            std::string detail;
+            if (inferred) {
+                std::stringstream ss;
+                ss << std::fixed << std::setprecision(2) << ", 字节码: " << inferred->evidence;
+                if (inferred->type) {
+                    ss << ", 推断为 " << ModInfo::modTypeToDirectory(*inferred->type) << " 但置信度只有 "
+                       << inferred->confidence;
+                }
+                detail = ss.str();
+            }
+            detail += mod.fuzzyNote;
+            if (index.hasSuggestionIndex()) {
+                auto start = std::chrono::steady_clock::now();
+                std::vector<ModIndex::Suggestion> suggestions = index.suggest(mod.result.cleanName, SUGGESTION_LIMIT);
+                suggestionTime += std::chrono::steady_clock::now() - start;
+                ++suggestionQueries;
+                if (!suggestions.empty()) {
+                    std::stringstream ss;
+                    ss << std::fixed << std::setprecision(2) << ", 可能是: ";
+                    for (size_t k = 0; k < suggestions.size(); ++k) {
+                        if (k > 0) ss << ", ";
+                        ss << suggestions[k].name << " (" << ModInfo::modTypeToDirectory(suggestions[k].type) << ", "
+                           << suggestions[k].score << ")";
+                    }
+                    detail += ss.str();
+                }
+            }
+            logMessage("未在 mods_data.json 中找到 Mod 的分类信息: " + fullFileName + " (干净名称: " +
+                       mod.result.cleanName + detail + ")", true);
+            ++stats.notFound;
+        }
+    }
+
+    if (suggestionQueries > 0) {
+        double micros = std::chrono::duration<double, std::micro>(suggestionTime).count();
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(1) << "已为 " << suggestionQueries << " 个未找到的 Mod 查找近似名称, 平均每个 "
+           << micros / static_cast<double>(suggestionQueries) << " 微秒";
+        logMessage(ss.str());
+    }
+}
+
+// --- 辅助函数：按声明的依赖调整类型并报告缺少的依赖 ---
+// 被依赖的库在依赖者需要的每一端都必须安装, 类型按依赖图推出的需求升级 (没有类型的库也会因此得到类型);
+// 随后按每个目标的闭包检查是否有依赖没有任何文件提供
+static void resolveDependencies(std::vector<PendingMod>& mods, const std::vector<std::optional<JarMetadata>>& metadata,
+                                const std::vector<OutputProfile>& profiles, ClassifyStats& stats) {
+    auto start = std::chrono::steady_clock::now();
+    // mod ID 按小写比较, 与数据库的 modid 一致
+    auto lower = [](std::string text) {
+        for (char& c : text) c = toLowerAscii(c);
+        return text;
+    };
+    std::vector<DependencyNode> nodes(mods.size());
+    for (size_t i = 0; i < mods.size(); ++i) {
+        const PendingMod& mod = mods[i];
+        DependencyNode& node = nodes[i];
+        node.fileName = mod.fileName;
+        node.type = mod.type;
+        // 字节码推断的结果在写出时才采纳, 这里按同样的条件提前计入
+        if (!node.type && mod.bytecode && mod.bytecode->type && mod.bytecode->confidence >= MIN_BYTECODE_CONFIDENCE) {
+            node.type = mod.bytecode->type;
+        }
+        if (!metadata[i]) continue;
+        if (!metadata[i]->modId.empty()) node.ids.push_back(lower(metadata[i]->modId));
+        else node.ids.emplace_back(); // 保持 "第一个为自身 modId" 的约定
+        for (const std::string& id : metadata[i]->providedIds) node.ids.push_back(lower(id));
+        node.dependencies = metadata[i]->dependencies;
+        for (DeclaredDependency& dependency : node.dependencies) dependency.modId = lower(dependency.modId);
+    }
+
+    DependencyGraph graph(std::move(nodes));
+    std::vector<DependencyPromotion> promotions = graph.promote();
+    for (const DependencyPromotion& promotion : promotions) {
+        PendingMod& mod = mods[promotion.node];
+        std::string from = promotion.from ? ModInfo::modTypeToDirectory(*promotion.from) : "未分类";
+        mod.type = promotion.to;
+        mod.origin = " (依据依赖: 原为 " + from + ", " + graph.node(promotion.requiredBy).fileName + " 需要它)";
+        mod.typeOrigin = TypeOrigin::Dependency;
+    }
+    std::vector<MissingDependency> missing = graph.missingDependencies(profiles);
+    std::vector<ProfileClosure> closures;
+    closures.reserve(profiles.size());
+    for (const OutputProfile& profile : profiles) closures.push_back(graph.closure(profile));
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3) << "依赖图: " << graph.size() << " 个文件, " << graph.edgeCount()
+       << " 条依赖, " << promotions.size() << " 个 Mod 按依赖调整类型, 缺少 " << missing.size() << " 个依赖, 耗时 "
+       << elapsed << " 毫秒";
+    logMessage(ss.str());
+    // 升级后闭包通常与目标一致; 自定义目标只接受部分需求时, 依赖可能仍然不在目标中
+    for (size_t p = 0; p < profiles.size(); ++p) {
+        if (closures[p].extra.empty()) continue;
+        std::string names;
+        for (size_t node : closures[p].extra) {
+            if (!names.empty()) names += ", ";
+            names += graph.node(node).fileName;
+        }
+        logMessage("目标 " + profiles[p].name + " 中的 Mod 还依赖 " + std::to_string(closures[p].extra.size()) +
+                   " 个不属于这个目标的 Mod: " + names, true);
+    }
+    for (const MissingDependency& dependency : missing) {
+        std::string requiredBy;
+        for (size_t node : dependency.requiredBy) {
+            if (!requiredBy.empty()) requiredBy += ", ";
+            requiredBy += graph.node(node).fileName;
+        }
+        std::string affected;
+        for (const std::string& name : dependency.profiles) {
+            if (!affected.empty()) affected += ", ";
+            affected += name;
+        }
+        logMessage("缺少依赖 " + dependency.modId + ": " + requiredBy + " 需要它 (影响目标: " + affected + ")", true);
+    }
+    stats.missingDependencies = missing.size();
+}
+
+// --- 辅助函数：同一个 Mod 的多个版本只保留最新的 ---
+// 按干净名称分组, 只对有多个文件的组提取版本号; 与最新版本无法分出先后的文件一并保留
+static void dropOlderVersions(std::vector<fs::path>& files, std::vector<ClassifyResult>& results,
+                              ClassifyStats& stats) {
+    std::unordered_map<std::string_view, std::vector<size_t>> groups;
+    for (size_t i = 0; i < files.size(); ++i) groups[results[i].cleanName].push_back(i);
+
+    std::vector<bool> dropped(files.size(), false);
+    for (const auto& [cleanName, members] : groups) {
+        if (members.size() < 2) continue;
+        std::vector<std::string> versions;
+        versions.reserve(members.size());
+        for (size_t i : members) versions.push_back(extractModVersion(files[i].filename().string()));
+        size_t newest = 0;
+        for (size_t k = 1; k < members.size(); ++k) {
+            if (compareModVersions(versions[k], versions[newest]) > 0) newest = k;
+        }
+        for (size_t k = 0; k < members.size(); ++k) {
+            if (k == newest || compareModVersions(versions[k], versions[newest]) == 0) continue;
+            dropped[members[k]] = true;
+            logMessage("已跳过旧版本 Mod: " + files[members[k]].filename().string() + ", 保留 " +
+                       files[members[newest]].filename().string());
+            ++stats.olderVersions;
+        }
+    }
+    if (stats.olderVersions == 0) return;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (dropped[i]) continue;
+        if (kept != i) {
+            files[kept] = std::move(files[i]);
+            results[kept] = std::move(results[i]);
+        }
+        ++kept;
+    }
+    files.resize(kept);
+    results.resize(kept);
+}
+
+// --- 3. Mod 分类逻辑 & 4. 文件操作 ---
+ClassifyStats classifyMods(const ModIndex& index, const std::string& inputDir, const std::string& outputDir,
+                           NormalizeCache* nameCache, MetadataMode metadataMode, bool scanBytecode,
+                           const HashIndex* hashIndex, ArchiveOutput* archiveOutput, ProfileOutput* profileOutput,
+                           bool withDependencies, bool dedupeVersions) {
+    ClassifyStats stats;
+    createOutputDirectories(outputDir, archiveOutput != nullptr);
+    withDependencies = withDependencies && metadataMode != MetadataMode::Off;
+
+    // 先按文件名匹配 Input 目录中的所有文件
+    std::vector<fs::path> files;
+    std::vector<ClassifyResult> results;
+    for (const auto& entry : fs::directory_iterator(inputDir)) {
+        if (entry.is_regular_file()) {
+            files.push_back(entry.path());
+            results.push_back(classifyFileName(index, entry.path().filename().string(), nameCache));
+        }
+    }
+    stats.total = files.size();
+    if (dedupeVersions) dropOlderVersions(files, results, stats);
+
+    // 有哈希索引时按指纹查找, 同一个文件的哈希比文件名和描述文件都可靠
+    std::vector<std::optional<ModType>> hashTypes(files.size());
+    if (hashIndex != nullptr && !hashIndex->empty()) {
+        std::vector<size_t> wanted;
+        for (size_t i = 0; i < files.size(); ++i) {
+            if (results[i].overrideRule.empty() && hasExtension(files[i].filename().string(), ".jar")) {
+                wanted.push_back(i);
+            }
+        }
+        lookupHashesInParallel(*hashIndex, files, wanted, hashTypes);
+    }
+
+    // 再并行读取需要的 jar 元数据; 检查依赖时需要所有 jar 的描述文件
+    std::vector<std::optional<JarMetadata>> metadata(files.size());
+    if (metadataMode != MetadataMode::Off) {
+        std::vector<size_t> wanted;
+        for (size_t i = 0; i < files.size(); ++i) {
+            bool needed = withDependencies || (!hashTypes[i] && results[i].overrideRule.empty() &&
+                                               (metadataMode == MetadataMode::Primary || !results[i].type));
+            if (needed && hasExtension(files[i].filename().string(), ".jar")) wanted.push_back(i);
+        }
+        readMetadataInParallel(files, wanted, metadata, withDependencies);
+    }
+
+    std::vector<PendingMod> mods(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        PendingMod& mod = mods[i];
+        mod.fileName = files[i].filename().string();
+        mod.result = std::move(results[i]);
+        if (applyOverrideRule(mod)) continue;
+        if (hashTypes[i]) {
+            mod.type = hashTypes[i];
+            mod.origin = " (依据文件哈希)";
+            mod.typeOrigin = TypeOrigin::HashIndex;
+        } else {
+            mod.type = resolveType(index, mod.result, metadata[i], metadataMode, mod.origin);
+            if (!mod.origin.empty()) mod.typeOrigin = TypeOrigin::Metadata;
+        }
+    }
+
+    // 数据库中人工确认的名称比字节码推断可靠, 先按编辑距离匹配
+    matchFuzzyNamesInParallel(index, mods);
+
+    // 仍然确定不了类型的 jar 扫描字节码
+    if (scanBytecode && metadataMode != MetadataMode::Off) {
+        std::vector<size_t> wanted;
+        for (size_t i = 0; i < files.size(); ++i) {
+            if (!mods[i].type && hasExtension(files[i].filename().string(), ".jar")) wanted.push_back(i);
+        }
+        std::vector<std::optional<BytecodeVerdict>> bytecode(files.size());
+        scanBytecodeInParallel(files, wanted, bytecode);
+        for (size_t i : wanted) mods[i].bytecode = std::move(bytecode[i]);
+    }
+
+    if (withDependencies) {
+        std::vector<OutputProfile> profiles =
+            profileOutput != nullptr ? profileOutput->profiles() : defaultOutputProfiles();
+        resolveDependencies(mods, metadata, profiles, stats);
+    }
+
+    // 最后按原顺序复制
+    placeClassifiedMods(index, mods, outputDir, archiveOutput, profileOutput,
+                        [&](size_t i, ModType type, const fs::path& destination, std::string& error) {
+        if (archiveOutput != nullptr) return archiveOutput->addFile(type, mods[i].fileName, files[i], error);
+        try {
+            fs::copy(files[i], destination, fs::copy_options::overwrite_existing);
+            return true;
+        } catch (const fs::filesystem_error& e) {
+            error = e.what();
+            return false;
+        }
+    }, stats);
+    return stats;
+}
+
+// --- 辅助函数：按整合包清单给出的哈希查找哈希索引 ---
+static std::optional<ModType> findListedHash(const HashIndex& hashIndex, const ModpackEntry& entry) {
+    std::optional<ModType> type;
+    if (entry.sha1Key) type = hashIndex.find(HashKind::Sha1, *entry.sha1Key);
+    if (!type && entry.sha512Key) type = hashIndex.find(HashKind::Sha512, *entry.sha512Key);
+    return type;
+}
+
+ClassifyStats classifyModpack(const ModIndex& index, const Modpack& modpack, const std::string& outputDir,
+                              NormalizeCache* nameCache, MetadataMode metadataMode, bool scanBytecode,
+                              const HashIndex* hashIndex, ArchiveOutput* archiveOutput, ProfileOutput* profileOutput,
+                              bool withDependencies) {
+    ClassifyStats stats;
+    createOutputDirectories(outputDir, archiveOutput != nullptr);
+    withDependencies = withDependencies && metadataMode != MetadataMode::Off;
+
+    const std::vector<ModpackEntry>& entries = modpack.entries();
+    stats.total = entries.size();
+    bool useHashIndex = hashIndex != nullptr && !hashIndex->empty();
+
+    // 整合包声明的运行端和清单中的哈希都不需要读取文件
+    std::vector<PendingMod> mods(entries.size());
+    std::vector<size_t> wanted;
+    // 不必读取文件就已确定类型的条目; 检查依赖时这些 jar 也要取出, 但只读取描述文件
+    std::vector<bool> settled(entries.size(), false);
+    size_t downloadOnly = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const ModpackEntry& entry = entries[i];
+        PendingMod& mod = mods[i];
+        mod.fileName = entry.fileName;
+        mod.result = classifyFileName(index, entry.fileName, nameCache);
+        mod.downloadOnly = !entry.entry.has_value();
+        if (mod.downloadOnly) ++downloadOnly;
+        bool isJar = entry.entry && hasExtension(entry.fileName, ".jar");
+        if (applyOverrideRule(mod)) {
+            settled[i] = true;
+        } else if (entry.declared) {
+            mod.type = entry.declared;
+            mod.origin = " (依据整合包, " + entry.declaredEvidence + ")";
+            mod.typeOrigin = TypeOrigin::Modpack;
+            settled[i] = true;
+        } else if (useHashIndex && (mod.type = findListedHash(*hashIndex, entry))) {
+            mod.origin = " (依据清单中的哈希)";
+            mod.typeOrigin = TypeOrigin::HashIndex;
+            settled[i] = true;
+        } else {
+            bool needMetadata = metadataMode != MetadataMode::Off &&
+                                (metadataMode == MetadataMode::Primary || !mod.result.type);
+            if (!isJar || (!useHashIndex && !needMetadata && !withDependencies)) {
+                mod.type = mod.result.type;
+                matchFuzzyName(index, mod);
+                settled[i] = true;
+            }
+        }
+        if (isJar && (!settled[i] || withDependencies)) wanted.push_back(i);
+    }
+
+    // 其余 jar 各取出一次, 在内存中依次计算指纹、读取描述文件、扫描字节码
+    std::vector<std::optional<JarMetadata>> metadata(entries.size());
+    if (!wanted.empty()) {
+        auto start = std::chrono::steady_clock::now();
+        std::atomic<size_t> unreadable{0};
+        std::atomic<size_t> hashHits{0};
+        std::atomic<uint64_t> inflatedBytes{0};
+        ThreadPool pool(std::min(defaultThreadCount(), wanted.size()));
+        parallelFor(pool, wanted.size(), [&](size_t w) {
+            size_t i = wanted[w];
+            PendingMod& mod = mods[i];
+            std::string storage;
+            std::string_view bytes;
+            bool known = settled[i];
+            if (!modpack.load(entries[i], storage, bytes)) {
+                ++unreadable;
+                if (!known) {
+                    mod.type = mod.result.type;
+                    matchFuzzyName(index, mod);
+                }
+                return;
+            }
+            inflatedBytes += storage.size();
+
+            if (!known && useHashIndex) {
+                Fingerprint fingerprint = fingerprintBytes(reinterpret_cast<const unsigned char*>(bytes.data()),
+                                                           bytes.size(), hashIndex->fingerprintKinds());
+                mod.type = hashIndex->find(fingerprint);
+                if (mod.type) {
+                    ++hashHits;
+                    mod.origin = " (依据文件哈希)";
+                    mod.typeOrigin = TypeOrigin::HashIndex;
+                    if (!withDependencies) return;
+                    known = true;
+                }
+            }
+
+            ZipReader jar;
+            bool opened = jar.openMemory(reinterpret_cast<const unsigned char*>(bytes.data()), bytes.size());
+            std::optional<JarMetadata> declared;
+            bool needMetadata = withDependencies || metadataMode == MetadataMode::Primary ||
+                                (metadataMode == MetadataMode::Fallback && !mod.result.type);
+            if (opened && needMetadata) {
+                JarMetadata result;
+                if (readJarOrBundledMetadata(jar, mod.fileName, result, withDependencies)) declared = std::move(result);
+            }
+            if (known) {
+                metadata[i] = std::move(declared);
+                return;
+            }
+            mod.type = resolveType(index, mod.result, declared, metadataMode, mod.origin);
+            if (!mod.origin.empty()) mod.typeOrigin = TypeOrigin::Metadata;
+            matchFuzzyName(index, mod);
+            if (withDependencies) metadata[i] = std::move(declared);
+
+            if (!mod.type && opened && scanBytecode && metadataMode != MetadataMode::Off) {
+                mod.bytecode = inferBytecodeType(scanJarBytecode(jar, mod.fileName));
+            }
+        });
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2) << "已检查整合包中的 " << wanted.size() << " 个 jar (解压 "
+           << static_cast<double>(inflatedBytes.load()) / (1024.0 * 1024.0) << " MiB";
+        if (useHashIndex) ss << ", " << hashHits.load() << " 个在哈希索引中";
+        ss << "), 耗时 " << elapsed << " 毫秒";
+        logMessage(ss.str());
+        if (unreadable > 0) {
+            logMessage("整合包中有 " + std::to_string(unreadable.load()) + " 个 jar 无法读取, 只按文件名匹配", true);
+        }
+    }
+
+    if (withDependencies) {
+        // 清单中需要下载的文件没有内容可读, 只由它们提供的依赖会被报告为缺少
+        if (downloadOnly > 0) {
+            logMessage("整合包清单中有 " + std::to_string(downloadOnly) +
+                       " 个文件需要下载, 读不到它们的描述文件, 依赖图中只包含整合包内的 jar", true);
+        }
+        std::vector<OutputProfile> profiles =
+            profileOutput != nullptr ? profileOutput->profiles() : defaultOutputProfiles();
+        resolveDependencies(mods, metadata, profiles, stats);
+    }
+
+    // 写出到目录时存储的条目直接从归档复制, 压缩的条目此时才解压; 写入归档时原样复制压缩数据
+    placeClassifiedMods(index, mods, outputDir, archiveOutput, profileOutput,
+                        [&](size_t i, ModType type, const fs::path& destination, std::string& error) {
+        if (archiveOutput != nullptr) {
+            return archiveOutput->addEntry(type, mods[i].fileName, *entries[i].entry, modpack.rawData(entries[i]),
+                                           error);
+        }
+        return modpack.write(entries[i], destination, error);
+    }, stats);
+
+    if (modpack.unnamedDownloads() > 0) {
+        logMessage("CurseForge 清单中另有 " + std::to_string(modpack.unnamedDownloads()) +
+                   " 个文件只有项目 ID, 需要下载后放入 Input 再分类", true);
+    }
+    return stats;
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "edit_distance.h"
+#include "hash_index.h"
+#include "mod_info.h"
+#include "normalize_cache.h"
+#include "override_rules.h"
+#include "trigram_index.h"
+
+class ArchiveOutput;
+class Modpack;
+class ProfileOutput;
+
+// --- Mod 类型的查找索引 ---
+// 两级: 干净文件名 (含别名) 和 mod ID 各一个哈希表, 按文件名查找时不会多查 mod ID 表。
+// 加载一次后只读, 可以在多个线程中同时查询
+class ModIndex {
+public:
+    ModIndex() = default;
+    // 名称或 mod ID 重复时以后出现的条目为准 (与旧版 std::map 赋值的行为一致)
+    explicit ModIndex(const std::vector<ModInfo>& mods);
+    // 已经合并好的条目 (见 mod_layers.h), 键没有重复
+    ModIndex(std::vector<std::pair<std::string, ModType>> names, std::vector<std::pair<std::string, ModType>> modIds);
+
+    // 按干净文件名查找, 别名同样匹配
+    std::optional<ModType> find(const std::string& cleanName) const;
+    // 按 jar 描述文件中的 mod ID 精确查找 (不区分大小写)
+    std::optional<ModType> findModId(std::string_view modId) const;
+
+    size_t size() const { return typeByName.size(); }
+    size_t modIdCount() const { return typeByModId.size(); }
+
+    // 为找不到的名称建立近似匹配的三元组索引 (见 trigram_index.h), 没有建立时 suggest 返回空
+    void buildSuggestionIndex();
+    bool hasSuggestionIndex() const { return suggestions != nullptr; }
+
+    struct Suggestion {
+        std::string_view name; // 数据库中的干净名称或别名, 指向索引内部
+        ModType type;
+        float score;
+    };
+    // 与 cleanName 最相近的至多 limit 个名称, 按相似度从高到低
+    std::vector<Suggestion> suggest(std::string_view cleanName, size_t limit) const;
+
+    // 为找不到的名称建立按编辑距离查找的索引 (见 edit_distance.h), 没有建立时 findFuzzy 返回空
+    void buildFuzzyIndex(int maxDistance);
+    bool hasFuzzyIndex() const { return fuzzy != nullptr; }
+    int fuzzyDistance() const { return fuzzy ? fuzzy->maxDistance : 0; }
+
+    struct FuzzyCandidate {
+        std::string_view name; // 数据库中的干净名称或别名, 指向索引内部
+        ModType type;
+        int distance;
+    };
+    // 与 cleanName 的编辑距离不超过建立索引时给出的距离的至多 limit 个名称, 按距离从小到大
+    std::vector<FuzzyCandidate> findFuzzy(std::string_view cleanName, size_t limit) const;
+
+    // 按名称模式覆盖类型的规则 (见 override_rules.h), 命中时优先于数据库中的条目
+    void setOverrideRules(std::shared_ptr<const OverrideRules> rules) { overrides = std::move(rules); }
+    const OverrideRules* overrideRules() const { return overrides.get(); }
+    const OverrideRule* matchOverride(std::string_view cleanName) const {
+        return overrides ? overrides->match(cleanName) : nullptr;
+    }
+
+private:
+    struct SuggestionIndex {
+        TrigramIndex trigrams;
+        std::vector<ModType> types; // 与索引中的条目编号对应
+    };
+    struct FuzzyIndex {
+        FuzzyNameIndex names;
+        std::vector<ModType> types; // 与索引中的条目编号对应
+        int maxDistance = 0;
+    };
+
+    // 按名称排序的 (名称, 类型), 两种近似索引按同样的顺序编号
+    std::vector<std::pair<std::string_view, ModType>> sortedEntries() const;
+
+    std::unordered_map<std::string, ModType> typeByName;
+    std::unordered_map<std::string, ModType> typeByModId;
+    std::shared_ptr<const SuggestionIndex> suggestions;
+    std::shared_ptr<const FuzzyIndex> fuzzy;
+    std::shared_ptr<const OverrideRules> overrides;
+};
+
+// 单个文件名的分类结果
+struct ClassifyResult {
+    std::string cleanName;       // 清理后的名称
+    std::optional<ModType> type; // 未在数据库中找到时为空
+    std::string overrideRule;    // 类型来自覆盖规则时为规则的模式
+};
+
+// 对单个文件名执行清理并查找类型, 不涉及任何文件操作
+ClassifyResult classifyFileName(const ModIndex& index, const std::string& fullFileName,
+                                NormalizeCache* nameCache = nullptr);
+
+// 是否读取 jar 内的描述文件 (fabric.mod.json 等) 来确定类型
+enum class MetadataMode {
+    Off,      // 只按文件名匹配
+    Fallback, // 文件名在数据库中找不到时才读取 jar
+    Primary   // 优先使用 jar 中声明的类型, 读取不到时再按文件名匹配
+};
+
+// 一次目录分类的统计信息
+struct ClassifyStats {
+    size_t total = 0;        // 处理的文件数
+    size_t classified = 0;   // 成功复制到输出目录
+    size_t skipped = 0;      // 目标已存在而跳过
+    size_t notFound = 0;     // 数据库中没有分类信息
+    size_t failed = 0;       // 复制失败
+    size_t fromMetadata = 0; // 类型来自 jar 内描述文件的文件数
+    size_t fromBytecode = 0; // 类型由字节码扫描推断的文件数
+    size_t fromHashIndex = 0; // 类型来自哈希索引的文件数
+    size_t fromModpack = 0;  // 类型来自整合包声明 (.mrpack 的 env 等) 的文件数
+    size_t downloadOnly = 0; // 只在整合包清单中列出、已分类但需要下载的文件数
+    size_t fromDependency = 0; // 类型由依赖它的 Mod 推出 (或升级) 的文件数
+    size_t fromFuzzy = 0;    // 类型来自编辑距离足够小的唯一一个数据库名称的文件数
+    size_t fromOverride = 0; // 类型来自覆盖规则的文件数
+    size_t missingDependencies = 0; // 没有任何文件提供的依赖数
+    size_t olderVersions = 0; // 同一个 Mod 有更新的版本而跳过的文件数
+};
+
+// 将 inputDir 中的 Mod 按类型复制到 outputDir 的各个子目录
+// scanBytecode 为 true 且 metadataMode 不是 Off 时, 其它方式都确定不了类型的 jar 会扫描字节码推断。
+// hashIndex 不为空时先按 jar 的指纹查找, 找到的类型优先于文件名和描述文件。
+// archiveOutput 不为空时写入各类型的归档 (见 archive_output.h), 而不是子目录; 调用方负责最后调用 finish()。
+// profileOutput 不为空时, 写入 (或已存在于) 类型子目录的文件同时链接到匹配的部署目标 (见 profile_output.h)。
+// withDependencies 为 true 且 metadataMode 不是 Off 时读取所有 jar 声明的依赖 (见 dependency_graph.h):
+// 被依赖的库按依赖者需要的运行端升级类型, 并按各个目标 (没有 profileOutput 时为默认目标) 报告缺少的依赖。
+// dedupeVersions 为 true 时干净名称相同的文件按文件名中的版本号 (见 mod_version.h) 只保留最新的
+// index 建立了编辑距离索引时, 其它方式都确定不了类型的文件在字节码扫描之前按近似名称匹配 (唯一时采纳)
+ClassifyStats classifyMods(const ModIndex& index, const std::string& inputDir, const std::string& outputDir,
+                           NormalizeCache* nameCache = nullptr, MetadataMode metadataMode = MetadataMode::Fallback,
+                           bool scanBytecode = true, const HashIndex* hashIndex = nullptr,
+                           ArchiveOutput* archiveOutput = nullptr, ProfileOutput* profileOutput = nullptr,
+                           bool withDependencies = false, bool dedupeVersions = false);
+
+// 将整合包 (见 modpack.h) 中的 Mod 按类型写到 outputDir 的各个子目录, 不先解压到 Input。
+// 整合包声明的运行端优先于其它所有依据, 其次是清单中的哈希; 每个需要检查内容的 jar 只取出一次。
+// 清单中需要下载的文件只给出分类, 记录在日志中。
+// withDependencies 与 classifyMods 相同, 依赖图只包含整合包内可以读取的 jar
+ClassifyStats classifyModpack(const ModIndex& index, const Modpack& modpack, const std::string& outputDir,
+                              NormalizeCache* nameCache = nullptr, MetadataMode metadataMode = MetadataMode::Fallback,
+                              bool scanBytecode = true, const HashIndex* hashIndex = nullptr,
+                              ArchiveOutput* archiveOutput = nullptr, ProfileOutput* profileOutput = nullptr,
+                              bool withDependencies = false);
@@ -0,0 +1,24 @@
+#include "cpu_features.h"
+
+#ifdef MODCLASSIFIER_X86_AVX2
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+bool cpuHasAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    __cpuidex(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0;
+    // 操作系统必须保存 YMM 寄存器
+    return osxsave && avx2 && (_xgetbv(0) & 0x6) == 0x6;
+#else
+    // 同时检查了操作系统是否保存 YMM 寄存器
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
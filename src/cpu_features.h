@@ -0,0 +1,18 @@
+#pragma once
+
+// --- x86 指令集扩展的运行时检测 ---
+// AVX2 需要运行时检测, 编译时只为对应函数开启指令集
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define MODCLASSIFIER_TARGET_AVX2
+#else
+#define MODCLASSIFIER_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#define MODCLASSIFIER_X86_AVX2 1
+#endif
+
+#ifdef MODCLASSIFIER_X86_AVX2
+// CPU 支持 AVX2 且操作系统保存 YMM 寄存器时返回 true
+bool cpuHasAvx2();
+#endif
@@ -0,0 +1,546 @@
+#include "deflate.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <queue>
+#include <vector>
+
+// 做法与 zlib 的 deflate_slow 相同: 每个位置先插入 3 字节哈希链, 找到匹配后看下一个位置是否有更长的匹配,
+// 有则把当前字节作为字面量输出。符号攒够一块后统计频率, 分别计算三种块类型的位数, 输出最短的一种。
+
+namespace {
+
+constexpr size_t WINDOW_SIZE = 32768;
+constexpr size_t MIN_MATCH = 3;
+constexpr size_t MAX_MATCH = 258;
+constexpr int HASH_BITS = 15;
+constexpr size_t HASH_SIZE = size_t{1} << HASH_BITS;
+
+// 与 zlib 第 6 级相近的参数
+constexpr size_t MAX_CHAIN = 128;  // 每个位置最多比较的候选数
+constexpr size_t GOOD_LENGTH = 8;  // 已有匹配达到这个长度时只比较四分之一的候选
+constexpr size_t NICE_LENGTH = 128; // 找到这么长的匹配立即停止
+constexpr size_t MAX_LAZY = 16;     // 已有匹配不短于这个长度时不再尝试延迟匹配
+constexpr size_t TOO_FAR = 4096;    // 距离超过这个值的 3 字节匹配不如直接输出字面量
+
+// 每块最多的符号数
+constexpr size_t BLOCK_SYMBOLS = 16384;
+// 并行压缩时每段的大小
+constexpr size_t PARALLEL_CHUNK = 128 * 1024;
+// 存储块的最大长度
+constexpr size_t MAX_STORED = 65535;
+
+constexpr int MAX_BITS = 15;
+constexpr int MAX_CODELEN_BITS = 7;
+constexpr int LITLEN_CODES = 286;
+constexpr int DIST_CODES = 30;
+constexpr int CODELEN_CODES = 19;
+constexpr int END_OF_BLOCK = 256;
+
+const uint16_t LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const uint16_t DIST_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+                                193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+                                6145, 8193, 12289, 16385, 24577};
+const uint8_t DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+const uint8_t CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// --- 辅助函数：长度和距离到码的映射 ---
+struct CodeTables {
+    uint8_t lengthCode[MAX_MATCH + 1]; // 长度 -> 码 - 257
+    uint8_t distCodeLow[256];          // 距离 1-256
+    uint8_t distCodeHigh[256];         // 距离 257-32768, 按 (距离 - 1) >> 7 查表
+    uint8_t fixedLitLengths[288];
+};
+
+const CodeTables& codeTables() {
+    static const CodeTables tables = [] {
+        CodeTables t{};
+        for (int code = 0; code < 29; ++code) {
+            int count = 1 << LENGTH_EXTRA[code];
+            for (int k = 0; k < count && LENGTH_BASE[code] + k <= static_cast<int>(MAX_MATCH); ++k) {
+                t.lengthCode[LENGTH_BASE[code] + k] = static_cast<uint8_t>(code);
+            }
+        }
+        // 258 有单独的码 (285), 不能归入 284 的范围
+        t.lengthCode[MAX_MATCH] = 28;
+        for (int code = 0; code < DIST_CODES; ++code) {
+            int count = 1 << DIST_EXTRA[code];
+            for (int k = 0; k < count; ++k) {
+                int distance = DIST_BASE[code] + k;
+                if (distance <= 256) {
+                    t.distCodeLow[distance - 1] = static_cast<uint8_t>(code);
+                } else {
+                    t.distCodeHigh[(distance - 1) >> 7] = static_cast<uint8_t>(code);
+                }
+            }
+        }
+        for (int s = 0; s < 288; ++s) t.fixedLitLengths[s] = s < 144 ? 8 : s < 256 ? 9 : s < 280 ? 7 : 8;
+        return t;
+    }();
+    return tables;
+}
+
+int distanceCode(size_t distance) {
+    const CodeTables& t = codeTables();
+    return distance <= 256 ? t.distCodeLow[distance - 1] : t.distCodeHigh[(distance - 1) >> 7];
+}
+
+uint32_t reverseBits(uint32_t code, int length) {
+    uint32_t result = 0;
+    for (int i = 0; i < length; ++i) {
+        result = (result << 1) | (code & 1);
+        code >>= 1;
+    }
+    return result;
+}
+
+// --- 辅助函数：计算限长的 Huffman 码长 ---
+// 先构建普通的 Huffman 树, 超过 maxBits 的码按 Kraft 不等式调整各长度的个数 (与 miniz 的做法相同),
+// 再按频率从高到低依次分配最短的长度。至少保证两个码, 避免只有一个码时部分解压器拒绝
+void buildLengths(const uint32_t* freq, int n, int maxBits, uint8_t* lengths) {
+    std::fill(lengths, lengths + n, 0);
+    std::vector<int> used;
+    for (int s = 0; s < n; ++s) {
+        if (freq[s] != 0) used.push_back(s);
+    }
+    for (int s = 0; used.size() < 2 && s < n; ++s) {
+        if (freq[s] == 0) used.push_back(s);
+    }
+    std::sort(used.begin(), used.end());
+
+    // 节点: 叶子在前, 内部节点在后; parent 用于计算深度
+    struct Node {
+        uint64_t weight;
+        int parent;
+    };
+    std::vector<Node> nodes;
+    nodes.reserve(used.size() * 2);
+    using Item = std::pair<uint64_t, int>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<>> heap;
+    for (int s : used) {
+        heap.push({std::max<uint64_t>(freq[s], 1), static_cast<int>(nodes.size())});
+        nodes.push_back({std::max<uint64_t>(freq[s], 1), -1});
+    }
+    while (heap.size() > 1) {
+        Item a = heap.top();
+        heap.pop();
+        Item b = heap.top();
+        heap.pop();
+        int parent = static_cast<int>(nodes.size());
+        nodes.push_back({a.first + b.first, -1});
+        nodes[a.second].parent = parent;
+        nodes[b.second].parent = parent;
+        heap.push({a.first + b.first, parent});
+    }
+
+    int counts[MAX_BITS + 2] = {};
+    std::vector<int> depth(nodes.size(), 0);
+    for (int i = static_cast<int>(nodes.size()) - 1; i >= 0; --i) {
+        if (nodes[i].parent >= 0) depth[i] = depth[nodes[i].parent] + 1;
+    }
+    for (size_t i = 0; i < used.size(); ++i) counts[std::min(depth[i], maxBits + 1)]++;
+
+    // 过长的码全部截到 maxBits, 再把较短的码加长直到 Kraft 和恰好为 1
+    counts[maxBits] += counts[maxBits + 1];
+    counts[maxBits + 1] = 0;
+    uint64_t total = 0;
+    for (int len = 1; len <= maxBits; ++len) total += static_cast<uint64_t>(counts[len]) << (maxBits - len);
+    while (total > (uint64_t{1} << maxBits)) {
+        counts[maxBits]--;
+        for (int len = maxBits - 1; len > 0; --len) {
+            if (counts[len] != 0) {
+                counts[len]--;
+                counts[len + 1] += 2;
+                break;
+            }
+        }
+        --total;
+    }
+
+    // 频率高的符号分配短码
+    std::vector<int> byFrequency = used;
+    std::stable_sort(byFrequency.begin(), byFrequency.end(), [&](int a, int b) { return freq[a] > freq[b]; });
+    size_t next = 0;
+    for (int len = 1; len <= maxBits; ++len) {
+        for (int k = 0; k < counts[len]; ++k) lengths[byFrequency[next++]] = static_cast<uint8_t>(len);
+    }
+}
+
+// 由码长生成规范 Huffman 码 (已按位反转, 可以直接从低位写入)
+void buildCodes(const uint8_t* lengths, int n, uint16_t* codes) {
+    uint16_t count[MAX_BITS + 1] = {};
+    for (int s = 0; s < n; ++s) count[lengths[s]]++;
+    count[0] = 0;
+    uint16_t next[MAX_BITS + 1] = {};
+    uint32_t code = 0;
+    for (int len = 1; len <= MAX_BITS; ++len) {
+        code = (code + count[len - 1]) << 1;
+        next[len] = static_cast<uint16_t>(code);
+    }
+    for (int s = 0; s < n; ++s) {
+        int len = lengths[s];
+        codes[s] = len == 0 ? 0 : static_cast<uint16_t>(reverseBits(next[len]++, len));
+    }
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(std::string& output) : out(output) {}
+
+    void put(uint32_t bits, int count) {
+        buffer |= static_cast<uint64_t>(bits) << used;
+        used += count;
+        if (used >= 32) {
+            char bytes[4];
+            for (int i = 0; i < 4; ++i) bytes[i] = static_cast<char>((buffer >> (8 * i)) & 0xFF);
+            out.append(bytes, 4);
+            buffer >>= 32;
+            used -= 32;
+        }
+    }
+
+    // 补齐到字节边界并写出缓冲中的所有位
+    void align() {
+        while (used > 0) {
+            out.push_back(static_cast<char>(buffer & 0xFF));
+            buffer >>= 8;
+            used = used > 8 ? used - 8 : 0;
+        }
+        buffer = 0;
+    }
+
+    void appendBytes(const unsigned char* data, size_t size) {
+        out.append(reinterpret_cast<const char*>(data), size);
+    }
+
+private:
+    std::string& out;
+    uint64_t buffer = 0;
+    int used = 0;
+};
+
+// LZ77 的输出符号: distance 为 0 时 value 是字面量, 否则是匹配长度 (距离最大 32768, 放得下 16 位)
+struct Symbol {
+    uint16_t value;
+    uint16_t distance;
+};
+
+// 码长序列的游程编码: 16 重复前一个码长 3-6 次, 17 重复 0 3-10 次, 18 重复 0 11-138 次
+struct CodeLengthRun {
+    uint8_t symbol;
+    uint8_t extra;
+};
+
+void encodeCodeLengths(const uint8_t* lengths, int n, std::vector<CodeLengthRun>& runs) {
+    runs.clear();
+    int i = 0;
+    while (i < n) {
+        int value = lengths[i];
+        int run = 1;
+        while (i + run < n && lengths[i + run] == value) ++run;
+        i += run;
+        if (value == 0) {
+            while (run >= 11) {
+                int take = std::min(run, 138);
+                runs.push_back({18, static_cast<uint8_t>(take - 11)});
+                run -= take;
+            }
+            if (run >= 3) {
+                runs.push_back({17, static_cast<uint8_t>(run - 3)});
+                run = 0;
+            }
+        } else {
+            runs.push_back({static_cast<uint8_t>(value), 0});
+            --run;
+            while (run >= 3) {
+                int take = std::min(run, 6);
+                runs.push_back({16, static_cast<uint8_t>(take - 3)});
+                run -= take;
+            }
+        }
+        for (; run > 0; --run) runs.push_back({static_cast<uint8_t>(value), 0});
+    }
+}
+
+class Compressor {
+public:
+    Compressor(const unsigned char* input, std::string& output)
+        : data(input), writer(output), head(HASH_SIZE, -1), prev(WINDOW_SIZE, -1) {
+        symbols.reserve(BLOCK_SYMBOLS);
+    }
+
+    void run(size_t begin, size_t end, bool last) {
+        rangeEnd = end;
+        blockStart = begin;
+        size_t dictionary = begin > WINDOW_SIZE ? begin - WINDOW_SIZE : 0;
+        for (size_t q = dictionary; q < begin; ++q) insert(q);
+
+        size_t p = begin;
+        size_t prevLength = 0;
+        size_t prevDistance = 0;
+        bool pending = false; // p - 1 处的字节还没有输出
+        while (p < end) {
+            insert(p);
+            size_t length = 0;
+            size_t distance = 0;
+            if (prevLength < MAX_LAZY) findMatch(p, std::max(prevLength, MIN_MATCH - 1), length, distance);
+            if (length == MIN_MATCH && distance > TOO_FAR) length = 0;
+
+            if (pending && prevLength >= MIN_MATCH && length <= prevLength) {
+                // 前一个位置的匹配更好, 输出它并跳过匹配覆盖的位置
+                emitMatch(prevLength, prevDistance, p - 1);
+                size_t matchEnd = p - 1 + prevLength;
+                for (size_t q = p + 1; q < matchEnd; ++q) insert(q);
+                p = matchEnd;
+                pending = false;
+                prevLength = 0;
+                continue;
+            }
+            if (pending) emitLiteral(p - 1);
+            pending = true;
+            prevLength = length;
+            prevDistance = distance;
+            ++p;
+        }
+        if (pending) emitLiteral(p - 1);
+        flushBlock(end, last);
+        if (!last) {
+            // 空的存储块, 使输出按字节对齐
+            writer.put(0, 3);
+            writer.align();
+            const unsigned char marker[4] = {0x00, 0x00, 0xFF, 0xFF};
+            writer.appendBytes(marker, 4);
+        }
+    }
+
+private:
+    uint32_t hashAt(size_t p) const {
+        uint32_t v = (static_cast<uint32_t>(data[p]) << 16) | (static_cast<uint32_t>(data[p + 1]) << 8) | data[p + 2];
+        return (v * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    void insert(size_t p) {
+        if (p + MIN_MATCH > rangeEnd) return;
+        uint32_t h = hashAt(p);
+        prev[p & (WINDOW_SIZE - 1)] = head[h];
+        head[h] = static_cast<int64_t>(p);
+    }
+
+    // 在哈希链上找比 best 更长的匹配, p 已经插入链中
+    void findMatch(size_t p, size_t best, size_t& length, size_t& distance) const {
+        size_t limit = std::min(MAX_MATCH, rangeEnd - p);
+        if (limit < MIN_MATCH || best >= limit) return;
+        size_t chain = best >= GOOD_LENGTH ? MAX_CHAIN / 4 : MAX_CHAIN;
+        int64_t candidate = prev[p & (WINDOW_SIZE - 1)];
+        const unsigned char* current = data + p;
+        while (candidate >= 0 && chain-- > 0) {
+            auto c = static_cast<size_t>(candidate);
+            if (p - c > WINDOW_SIZE) break;
+            const unsigned char* match = data + c;
+            if (match[best] == current[best] && match[0] == current[0] && match[1] == current[1]) {
+                size_t len = 2;
+                while (len < limit && match[len] == current[len]) ++len;
+                if (len > best) {
+                    best = len;
+                    length = len;
+                    distance = p - c;
+                    if (len >= NICE_LENGTH || len == limit) break;
+                }
+            }
+            int64_t next = prev[c & (WINDOW_SIZE - 1)];
+            // 槽位已被窗口之外的新位置覆盖时链到此为止
+            if (next >= candidate) break;
+            candidate = next;
+        }
+    }
+
+    void emitLiteral(size_t p) {
+        symbols.push_back({data[p], 0});
+        if (symbols.size() == BLOCK_SYMBOLS) flushBlock(p + 1, false);
+    }
+
+    void emitMatch(size_t length, size_t distance, size_t p) {
+        symbols.push_back({static_cast<uint16_t>(length), static_cast<uint16_t>(distance)});
+        if (symbols.size() == BLOCK_SYMBOLS) flushBlock(p + length, false);
+    }
+
+    void writeStored(size_t end, bool last) {
+        size_t p = blockStart;
+        do {
+            size_t size = std::min(MAX_STORED, end - p);
+            bool final = last && p + size == end;
+            writer.put(final ? 1 : 0, 3);
+            writer.align();
+            unsigned char header[4] = {static_cast<unsigned char>(size & 0xFF), static_cast<unsigned char>(size >> 8),
+                                       static_cast<unsigned char>(~size & 0xFF),
+                                       static_cast<unsigned char>((~size >> 8) & 0xFF)};
+            writer.appendBytes(header, 4);
+            writer.appendBytes(data + p, size);
+            p += size;
+        } while (p < end);
+    }
+
+    void writeSymbols(const uint16_t* litCodes, const uint8_t* litLengths, const uint16_t* distCodes,
+                      const uint8_t* distLengths) {
+        const CodeTables& t = codeTables();
+        for (const Symbol& symbol : symbols) {
+            if (symbol.distance == 0) {
+                writer.put(litCodes[symbol.value], litLengths[symbol.value]);
+                continue;
+            }
+            int lengthCode = t.lengthCode[symbol.value];
+            writer.put(litCodes[257 + lengthCode], litLengths[257 + lengthCode]);
+            if (LENGTH_EXTRA[lengthCode] != 0) {
+                writer.put(symbol.value - LENGTH_BASE[lengthCode], LENGTH_EXTRA[lengthCode]);
+            }
+            size_t distance = symbol.distance;
+            int distCode = distanceCode(distance);
+            writer.put(distCodes[distCode], distLengths[distCode]);
+            if (DIST_EXTRA[distCode] != 0) {
+                writer.put(static_cast<uint32_t>(distance - DIST_BASE[distCode]), DIST_EXTRA[distCode]);
+            }
+        }
+        writer.put(litCodes[END_OF_BLOCK], litLengths[END_OF_BLOCK]);
+    }
+
+    // 输出 [blockStart, end) 对应的符号, 选择位数最少的块类型
+    void flushBlock(size_t end, bool last) {
+        if (symbols.empty() && !last) {
+            blockStart = end;
+            return;
+        }
+        const CodeTables& t = codeTables();
+        uint32_t litFreq[LITLEN_CODES] = {};
+        uint32_t distFreq[DIST_CODES] = {};
+        uint64_t extraBits = 0;
+        for (const Symbol& symbol : symbols) {
+            if (symbol.distance == 0) {
+                litFreq[symbol.value]++;
+                continue;
+            }
+            int lengthCode = t.lengthCode[symbol.value];
+            int distCode = distanceCode(symbol.distance);
+            litFreq[257 + lengthCode]++;
+            distFreq[distCode]++;
+            extraBits += LENGTH_EXTRA[lengthCode] + DIST_EXTRA[distCode];
+        }
+        litFreq[END_OF_BLOCK] = 1;
+
+        uint8_t litLengths[LITLEN_CODES];
+        uint8_t distLengths[DIST_CODES];
+        buildLengths(litFreq, LITLEN_CODES, MAX_BITS, litLengths);
+        buildLengths(distFreq, DIST_CODES, MAX_BITS, distLengths);
+
+        int hlit = LITLEN_CODES;
+        while (hlit > 257 && litLengths[hlit - 1] == 0) --hlit;
+        int hdist = DIST_CODES;
+        while (hdist > 1 && distLengths[hdist - 1] == 0) --hdist;
+        uint8_t combined[LITLEN_CODES + DIST_CODES];
+        std::copy(litLengths, litLengths + hlit, combined);
+        std::copy(distLengths, distLengths + hdist, combined + hlit);
+        std::vector<CodeLengthRun> runs;
+        encodeCodeLengths(combined, hlit + hdist, runs);
+        uint32_t codeLengthFreq[CODELEN_CODES] = {};
+        for (const CodeLengthRun& run : runs) codeLengthFreq[run.symbol]++;
+        uint8_t codeLengthLengths[CODELEN_CODES];
+        buildLengths(codeLengthFreq, CODELEN_CODES, MAX_CODELEN_BITS, codeLengthLengths);
+        int hclen = CODELEN_CODES;
+        while (hclen > 4 && codeLengthLengths[CODE_LENGTH_ORDER[hclen - 1]] == 0) --hclen;
+
+        // 各块类型的位数
+        uint64_t dynamicBits = 3 + 5 + 5 + 4 + 3 * static_cast<uint64_t>(hclen) + extraBits;
+        uint64_t fixedBits = 3 + extraBits;
+        for (int s = 0; s < CODELEN_CODES; ++s) dynamicBits += uint64_t{codeLengthFreq[s]} * codeLengthLengths[s];
+        dynamicBits += uint64_t{codeLengthFreq[16]} * 2 + uint64_t{codeLengthFreq[17]} * 3 +
+                       uint64_t{codeLengthFreq[18]} * 7;
+        for (int s = 0; s < LITLEN_CODES; ++s) {
+            dynamicBits += uint64_t{litFreq[s]} * litLengths[s];
+            fixedBits += uint64_t{litFreq[s]} * t.fixedLitLengths[s];
+        }
+        for (int s = 0; s < DIST_CODES; ++s) {
+            dynamicBits += uint64_t{distFreq[s]} * distLengths[s];
+            fixedBits += uint64_t{distFreq[s]} * 5;
+        }
+        size_t rawSize = end - blockStart;
+        uint64_t storedBits = (rawSize / MAX_STORED + 1) * (3 + 7 + 32) + 8 * static_cast<uint64_t>(rawSize);
+
+        if (storedBits <= fixedBits && storedBits <= dynamicBits) {
+            writeStored(end, last);
+        } else if (fixedBits <= dynamicBits) {
+            uint16_t litCodes[288];
+            uint16_t distCodes[DIST_CODES];
+            uint8_t fixedDistLengths[DIST_CODES];
+            std::fill(fixedDistLengths, fixedDistLengths + DIST_CODES, 5);
+            buildCodes(t.fixedLitLengths, 288, litCodes);
+            buildCodes(fixedDistLengths, DIST_CODES, distCodes);
+            writer.put(last ? 1 : 0, 1);
+            writer.put(1, 2);
+            writeSymbols(litCodes, t.fixedLitLengths, distCodes, fixedDistLengths);
+        } else {
+            uint16_t litCodes[LITLEN_CODES];
+            uint16_t distCodes[DIST_CODES];
+            uint16_t codeLengthCodes[CODELEN_CODES];
+            buildCodes(litLengths, LITLEN_CODES, litCodes);
+            buildCodes(distLengths, DIST_CODES, distCodes);
+            buildCodes(codeLengthLengths, CODELEN_CODES, codeLengthCodes);
+            writer.put(last ? 1 : 0, 1);
+            writer.put(2, 2);
+            writer.put(static_cast<uint32_t>(hlit - 257), 5);
+            writer.put(static_cast<uint32_t>(hdist - 1), 5);
+            writer.put(static_cast<uint32_t>(hclen - 4), 4);
+            for (int i = 0; i < hclen; ++i) writer.put(codeLengthLengths[CODE_LENGTH_ORDER[i]], 3);
+            for (const CodeLengthRun& run : runs) {
+                writer.put(codeLengthCodes[run.symbol], codeLengthLengths[run.symbol]);
+                if (run.symbol == 16) writer.put(run.extra, 2);
+                if (run.symbol == 17) writer.put(run.extra, 3);
+                if (run.symbol == 18) writer.put(run.extra, 7);
+            }
+            writeSymbols(litCodes, litLengths, distCodes, distLengths);
+        }
+        if (last) writer.align();
+
+        symbols.clear();
+        blockStart = end;
+    }
+
+    const unsigned char* data;
+    BitWriter writer;
+    std::vector<int64_t> head;
+    std::vector<int64_t> prev;
+    std::vector<Symbol> symbols;
+    size_t rangeEnd = 0;
+    size_t blockStart = 0;
+};
+
+} // namespace
+
+void deflateRange(const unsigned char* data, size_t begin, size_t end, std::string& out, bool last) {
+    Compressor compressor(data, out);
+    compressor.run(begin, end, last);
+}
+
+void deflateRaw(const unsigned char* data, size_t size, std::string& out) {
+    deflateRange(data, 0, size, out, true);
+}
+
+void deflateParallel(const unsigned char* data, size_t size, std::string& out, ThreadPool& pool) {
+    size_t chunks = (size + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK;
+    if (chunks <= 1 || pool.size() <= 1) {
+        deflateRaw(data, size, out);
+        return;
+    }
+    std::vector<std::string> parts(chunks);
+    parallelFor(pool, chunks, [&](size_t i) {
+        size_t begin = i * PARALLEL_CHUNK;
+        size_t end = std::min(size, begin + PARALLEL_CHUNK);
+        deflateRange(data, begin, end, parts[i], i + 1 == chunks);
+    });
+    size_t total = 0;
+    for (const std::string& part : parts) total += part.size();
+    out.reserve(out.size() + total);
+    for (const std::string& part : parts) out += part;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "thread_pool.h"
+
+// --- DEFLATE 压缩 (RFC 1951) ---
+// 只输出原始 DEFLATE 数据流 (zip 中 method 8 的条目), 与 inflate.h 对应, 不依赖 zlib。
+// LZ77 使用哈希链和一步延迟匹配, 每个块在存储、固定 Huffman 和动态 Huffman 中选最短的一种。
+
+// 压缩 data 的 [begin, end) 追加到 out; begin 之前最多 32 KiB 的数据作为字典参与匹配。
+// last 为 false 时以空的存储块结束 (同 zlib 的 Z_SYNC_FLUSH), 输出按字节对齐, 可以与下一段的输出直接拼接
+void deflateRange(const unsigned char* data, size_t begin, size_t end, std::string& out, bool last);
+
+// 压缩整段数据, 等同于 deflateRange(data, 0, size, out, true)
+void deflateRaw(const unsigned char* data, size_t size, std::string& out);
+
+// 把数据切成固定大小的段在线程池中并行压缩再拼接 (与 pigz 相同的做法), 每段以前一段的末尾为字典,
+// 压缩率与单线程基本一致; 数据较小时直接在当前线程压缩
+void deflateParallel(const unsigned char* data, size_t size, std::string& out, ThreadPool& pool);
@@ -0,0 +1,175 @@
+#include "dependency_graph.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+constexpr uint8_t EDGE_CLIENT = 1;
+constexpr uint8_t EDGE_SERVER = 2;
+
+// --- 辅助函数：节点类型在两端的需求, 没有类型和 Unknown 都视为两端都不需要 ---
+void typeLevels(const std::optional<ModType>& type, uint8_t& client, uint8_t& server) {
+    client = server = 0;
+    if (!type || *type == ModType::Unknown) return;
+    SideMask mask = modTypeToSideMask(*type);
+    client = static_cast<uint8_t>(clientRequirement(mask));
+    server = static_cast<uint8_t>(serverRequirement(mask));
+}
+
+// --- 辅助函数：目标运行的端 ---
+// 接受仅客户端 (仅服务端) 的 Mod 的目标会运行这一端; 都不接受时两端的依赖都算
+uint8_t profileSides(const OutputProfile& profile) {
+    uint8_t sides = 0;
+    if (profile.accepts(ModType::ClientOnly)) sides |= EDGE_CLIENT;
+    if (profile.accepts(ModType::ServerOnly)) sides |= EDGE_SERVER;
+    return sides == 0 ? EDGE_CLIENT | EDGE_SERVER : sides;
+}
+
+} // namespace
+
+DependencyGraph::DependencyGraph(std::vector<DependencyNode> dependencyNodes) : nodes(std::move(dependencyNodes)) {
+    // 先登记自身的 modId, 再登记 provides 和内嵌 jar, 已有的不覆盖
+    std::unordered_map<std::string_view, uint32_t> provider;
+    for (uint32_t i = 0; i < nodes.size(); ++i) {
+        if (!nodes[i].ids.empty() && !nodes[i].ids.front().empty()) provider.emplace(nodes[i].ids.front(), i);
+    }
+    for (uint32_t i = 0; i < nodes.size(); ++i) {
+        for (size_t k = 1; k < nodes[i].ids.size(); ++k) {
+            if (!nodes[i].ids[k].empty()) provider.emplace(nodes[i].ids[k], i);
+        }
+    }
+
+    edgeStart.reserve(nodes.size() + 1);
+    unresolvedStart.reserve(nodes.size() + 1);
+    for (uint32_t i = 0; i < nodes.size(); ++i) {
+        edgeStart.push_back(static_cast<uint32_t>(edgeTarget.size()));
+        unresolvedStart.push_back(static_cast<uint32_t>(unresolved.size()));
+        const std::vector<DeclaredDependency>& dependencies = nodes[i].dependencies;
+        for (uint32_t d = 0; d < dependencies.size(); ++d) {
+            uint8_t sides = (dependencies[d].client ? EDGE_CLIENT : 0) | (dependencies[d].server ? EDGE_SERVER : 0);
+            if (sides == 0) continue;
+            auto it = provider.find(dependencies[d].modId);
+            if (it == provider.end()) {
+                unresolved.push_back(d);
+            } else if (it->second != i) {
+                // 依赖自己内嵌的库时不需要边
+                edgeTarget.push_back(it->second);
+                edgeSides.push_back(sides);
+            }
+        }
+    }
+    edgeStart.push_back(static_cast<uint32_t>(edgeTarget.size()));
+    unresolvedStart.push_back(static_cast<uint32_t>(unresolved.size()));
+}
+
+std::vector<DependencyPromotion> DependencyGraph::promote() {
+    size_t count = nodes.size();
+    std::vector<uint8_t> levels[2] = {std::vector<uint8_t>(count), std::vector<uint8_t>(count)};
+    for (size_t i = 0; i < count; ++i) typeLevels(nodes[i].type, levels[0][i], levels[1][i]);
+
+    constexpr uint32_t NO_PARENT = UINT32_MAX;
+    std::vector<uint32_t> parent(count, NO_PARENT);
+    std::vector<uint32_t> queue;
+    std::vector<uint8_t> visited(count);
+    queue.reserve(count);
+    for (int side = 0; side < 2; ++side) {
+        uint8_t edgeMask = side == 0 ? EDGE_CLIENT : EDGE_SERVER;
+        std::vector<uint8_t>& level = levels[side];
+        // 先传播必装, 再传播可选; 已经必装的节点不会被降级
+        for (uint8_t target : {static_cast<uint8_t>(SideRequirement::Required),
+                               static_cast<uint8_t>(SideRequirement::Optional)}) {
+            queue.clear();
+            std::fill(visited.begin(), visited.end(), 0);
+            for (uint32_t i = 0; i < count; ++i) {
+                if (level[i] >= target) {
+                    queue.push_back(i);
+                    visited[i] = 1;
+                }
+            }
+            for (size_t head = 0; head < queue.size(); ++head) {
+                uint32_t u = queue[head];
+                for (uint32_t e = edgeStart[u]; e < edgeStart[u + 1]; ++e) {
+                    uint32_t v = edgeTarget[e];
+                    if (!(edgeSides[e] & edgeMask) || visited[v]) continue;
+                    visited[v] = 1;
+                    if (level[v] < target) {
+                        level[v] = target;
+                        parent[v] = u;
+                    }
+                    queue.push_back(v);
+                }
+            }
+        }
+    }
+
+    std::vector<DependencyPromotion> promotions;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (parent[i] == NO_PARENT) continue;
+        uint8_t client = levels[0][i];
+        uint8_t server = levels[1][i];
+        constexpr uint8_t OPTIONAL = static_cast<uint8_t>(SideRequirement::Optional);
+        constexpr uint8_t REQUIRED = static_cast<uint8_t>(SideRequirement::Required);
+        if (client == OPTIONAL && server == 0) client = REQUIRED;
+        if (server == OPTIONAL && client == 0) server = REQUIRED;
+        std::optional<ModType> promoted = sideMaskToModType(
+            makeSideMask(static_cast<SideRequirement>(client), static_cast<SideRequirement>(server)));
+        if (!promoted || promoted == nodes[i].type) continue;
+        promotions.push_back({i, nodes[i].type, *promoted, parent[i]});
+        nodes[i].type = promoted;
+    }
+    return promotions;
+}
+
+ProfileClosure DependencyGraph::closure(const OutputProfile& profile) const {
+    ProfileClosure result;
+    uint8_t sides = profileSides(profile);
+    std::vector<uint8_t> visited(nodes.size());
+    std::vector<uint32_t> queue;
+    for (uint32_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i].type && profile.accepts(*nodes[i].type)) {
+            queue.push_back(i);
+            visited[i] = 1;
+        }
+    }
+    result.members = queue.size();
+
+    for (size_t head = 0; head < queue.size(); ++head) {
+        uint32_t u = queue[head];
+        if (head >= result.members) result.extra.push_back(u);
+        for (uint32_t e = edgeStart[u]; e < edgeStart[u + 1]; ++e) {
+            uint32_t v = edgeTarget[e];
+            if (!(edgeSides[e] & sides) || visited[v]) continue;
+            visited[v] = 1;
+            queue.push_back(v);
+        }
+        for (uint32_t k = unresolvedStart[u]; k < unresolvedStart[u + 1]; ++k) {
+            const DeclaredDependency& dependency = nodes[u].dependencies[unresolved[k]];
+            uint8_t dependencySides = (dependency.client ? EDGE_CLIENT : 0) | (dependency.server ? EDGE_SERVER : 0);
+            if (dependencySides & sides) result.missing.emplace_back(u, dependency.modId);
+        }
+    }
+    return result;
+}
+
+std::vector<MissingDependency> DependencyGraph::missingDependencies(const std::vector<OutputProfile>& profiles) const {
+    std::map<std::string, std::pair<std::set<size_t>, std::vector<std::string>>> byModId;
+    for (const OutputProfile& profile : profiles) {
+        ProfileClosure result = closure(profile);
+        for (const auto& [node, modId] : result.missing) {
+            auto& [requiredBy, affected] = byModId[modId];
+            requiredBy.insert(node);
+            if (affected.empty() || affected.back() != profile.name) affected.push_back(profile.name);
+        }
+    }
+
+    std::vector<MissingDependency> missing;
+    missing.reserve(byModId.size());
+    for (auto& [modId, entry] : byModId) {
+        missing.push_back({modId, std::vector<size_t>(entry.first.begin(), entry.first.end()), std::move(entry.second)});
+    }
+    return missing;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "jar_metadata.h"
+#include "mod_info.h"
+#include "profile_output.h"
+
+// --- Mod 依赖图 ---
+// 由 jar 描述文件中声明的必需依赖 (fabric.mod.json 的 depends, mods.toml 的 [[dependencies]]) 建立,
+// 按 mod ID 把每条依赖连接到提供这个 ID 的文件 (自身的 modId、provides 和内嵌 jar 的 mod ID)。
+// 出边以 CSR 形式存放 (每个节点的边在一个数组中连续), 建图和每次遍历都是 O(V + E),
+// 几百个 Mod 的整合包在一毫秒内完成。
+
+struct DependencyNode {
+    std::string fileName;
+    std::optional<ModType> type;  // 分类结果; 没有类型的文件只作为依赖的提供者
+    std::vector<std::string> ids; // 提供的 mod ID, 第一个为自身的 modId (没有时为空字符串)
+    std::vector<DeclaredDependency> dependencies;
+};
+
+// 依赖推出的类型变化
+struct DependencyPromotion {
+    size_t node;
+    std::optional<ModType> from;
+    ModType to;
+    size_t requiredBy; // 使它升级的依赖者之一
+};
+
+// 没有任何文件提供的依赖
+struct MissingDependency {
+    std::string modId;
+    std::vector<size_t> requiredBy;    // 需要它的节点, 按下标排序
+    std::vector<std::string> profiles; // 受影响的目标
+};
+
+// 一个目标的依赖闭包: 按类型属于目标的 Mod 加上它们传递依赖的 Mod
+struct ProfileClosure {
+    size_t members = 0;       // 按类型属于目标的 Mod 数
+    std::vector<size_t> extra; // 闭包中按类型不属于目标的节点, 需要一起安装
+    std::vector<std::pair<size_t, std::string>> missing; // (需要它的节点, 缺少的 mod ID)
+};
+
+class DependencyGraph {
+public:
+    // 同一个 ID 有多个提供者时, 自身 modId 优先于 provides / 内嵌 jar, 其次以先出现的为准
+    explicit DependencyGraph(std::vector<DependencyNode> dependencyNodes);
+
+    size_t size() const { return nodes.size(); }
+    size_t edgeCount() const { return edgeTarget.size(); }
+    const DependencyNode& node(size_t i) const { return nodes[i]; }
+
+    // 把需求沿依赖边传播: 依赖者在某一端必装 (可选) 时, 被依赖者在这一端至少必装 (可选)。
+    // 每一端的每个级别各做一次多源遍历, 共四次。更新节点的类型并返回发生变化的节点。
+    // 只在一端可选的组合没有对应类型, 视为这一端必装 (与 ClientOnly / ServerOnly 的含义一致)
+    std::vector<DependencyPromotion> promote();
+
+    // 目标的闭包, 只沿目标运行的一端需要的边遍历
+    ProfileClosure closure(const OutputProfile& profile) const;
+
+    // 所有目标闭包中缺少的依赖, 按 mod ID 排序
+    std::vector<MissingDependency> missingDependencies(const std::vector<OutputProfile>& profiles) const;
+
+private:
+    std::vector<DependencyNode> nodes;
+    // 节点 i 的出边为 edgeTarget[edgeStart[i] .. edgeStart[i + 1]), edgeSides 位 0 为客户端、位 1 为服务端
+    std::vector<uint32_t> edgeStart;
+    std::vector<uint32_t> edgeTarget;
+    std::vector<uint8_t> edgeSides;
+    // 节点 i 未解析的依赖为 nodes[i].dependencies[unresolved[k]], k 属于 [unresolvedStart[i], unresolvedStart[i + 1])
+    std::vector<uint32_t> unresolvedStart;
+    std::vector<uint32_t> unresolved;
+};
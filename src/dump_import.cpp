@@ -0,0 +1,510 @@
+#include "dump_import.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include "hash_index.h"
+#include "include/nlohmann/json.hpp"
+#include "logger.h"
+#include "mapped_file.h"
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace {
+
+// 单条记录中最多收集的哈希数, 防止构造的记录占用过多内存
+constexpr size_t MAX_HASHES_PER_RECORD = 256;
+// 归并时每个有序段的读缓冲区下限
+constexpr size_t MIN_RUN_BUFFER = 64 * 1024;
+// NDJSON 中最多记录多少个解析错误的详细信息
+constexpr size_t MAX_LOGGED_ERRORS = 5;
+
+// 有序段中每个条目的大小: u64 键, u64 序号, u8 种类, u8 类型
+constexpr size_t RUN_ENTRY_SIZE = 18;
+
+enum class Side { Required, Optional, Unsupported };
+
+std::optional<Side> parseSide(std::string_view value) {
+    if (value == "required") return Side::Required;
+    if (value == "optional") return Side::Optional;
+    if (value == "unsupported") return Side::Unsupported;
+    return std::nullopt;
+}
+
+struct SortEntry {
+    uint64_t key;
+    uint64_t sequence;
+    uint8_t kind;
+    uint8_t type;
+};
+
+bool entryLess(const SortEntry& a, const SortEntry& b) {
+    if (a.kind != b.kind) return a.kind < b.kind;
+    if (a.key != b.key) return a.key < b.key;
+    return a.sequence < b.sequence;
+}
+
+bool sameHash(const SortEntry& a, const SortEntry& b) {
+    return a.kind == b.kind && a.key == b.key;
+}
+
+void encodeEntry(const SortEntry& entry, char* out) {
+    for (int i = 0; i < 8; ++i) out[i] = static_cast<char>((entry.key >> (8 * i)) & 0xFF);
+    for (int i = 0; i < 8; ++i) out[8 + i] = static_cast<char>((entry.sequence >> (8 * i)) & 0xFF);
+    out[16] = static_cast<char>(entry.kind);
+    out[17] = static_cast<char>(entry.type);
+}
+
+SortEntry decodeEntry(const unsigned char* in) {
+    SortEntry entry{};
+    for (int i = 7; i >= 0; --i) entry.key = (entry.key << 8) | in[i];
+    for (int i = 7; i >= 0; --i) entry.sequence = (entry.sequence << 8) | in[8 + i];
+    entry.kind = in[16];
+    entry.type = in[17];
+    return entry;
+}
+
+// 读取一个有序段, 带固定大小的缓冲区
+class RunReader {
+public:
+    RunReader(const fs::path& path, size_t bufferSize) : in(path, std::ios::binary), buffer(bufferSize) {}
+
+    // 读取下一个条目, 段结束时返回 false
+    bool next(SortEntry& entry) {
+        if (position + RUN_ENTRY_SIZE > available) {
+            size_t remaining = available - position;
+            std::memmove(buffer.data(), buffer.data() + position, remaining);
+            in.read(reinterpret_cast<char*>(buffer.data()) + remaining,
+                    static_cast<std::streamsize>(buffer.size() - remaining));
+            available = remaining + static_cast<size_t>(in.gcount());
+            position = 0;
+            if (available < RUN_ENTRY_SIZE) return false;
+        }
+        entry = decodeEntry(buffer.data() + position);
+        position += RUN_ENTRY_SIZE;
+        return true;
+    }
+
+private:
+    std::ifstream in;
+    std::vector<unsigned char> buffer;
+    size_t available = 0;
+    size_t position = 0;
+};
+
+// --- 外部排序 ---
+// 条目先放入内存缓冲区, 满了就排序、合并重复项并写成一个有序段; 结束时多路归并所有段
+class ExternalSorter {
+public:
+    ExternalSorter(const fs::path& indexPath, size_t memoryBudget, DumpImportStats& stats)
+        : basePath(indexPath), budget(memoryBudget), stats(stats) {
+        capacity = std::max<size_t>(1024, memoryBudget / sizeof(SortEntry));
+        buffer.reserve(std::min<size_t>(capacity, 1 << 16));
+    }
+
+    ~ExternalSorter() {
+        std::error_code ec;
+        for (const fs::path& run : runs) fs::remove(run, ec);
+    }
+
+    ExternalSorter(const ExternalSorter&) = delete;
+    ExternalSorter& operator=(const ExternalSorter&) = delete;
+
+    bool add(HashKind kind, uint64_t key, uint8_t type) {
+        buffer.push_back({key, nextSequence++, static_cast<uint8_t>(kind), type});
+        if (buffer.size() >= capacity) return spill();
+        return true;
+    }
+
+    // 归并所有条目并按顺序交给 writer
+    bool finish(HashIndexWriter& writer) {
+        if (runs.empty()) {
+            sortAndCollapse();
+            for (const SortEntry& entry : buffer) emit(writer, entry);
+            buffer.clear();
+            return true;
+        }
+        if (!buffer.empty() && !spill()) return false;
+        buffer.clear();
+        buffer.shrink_to_fit();
+
+        size_t readerBuffer = std::max(MIN_RUN_BUFFER, budget / runs.size());
+        readerBuffer -= readerBuffer % RUN_ENTRY_SIZE;
+        std::vector<std::unique_ptr<RunReader>> readers;
+        using HeapItem = std::pair<SortEntry, size_t>;
+        auto heapGreater = [](const HeapItem& a, const HeapItem& b) { return entryLess(b.first, a.first); };
+        std::priority_queue<HeapItem, std::vector<HeapItem>, decltype(heapGreater)> heap(heapGreater);
+        for (size_t i = 0; i < runs.size(); ++i) {
+            readers.push_back(std::make_unique<RunReader>(runs[i], readerBuffer));
+            SortEntry entry;
+            if (readers.back()->next(entry)) heap.push({entry, i});
+        }
+
+        // 相同哈希的条目按序号升序出堆, 保留最后一个
+        std::optional<SortEntry> pending;
+        while (!heap.empty()) {
+            auto [entry, source] = heap.top();
+            heap.pop();
+            SortEntry following;
+            if (readers[source]->next(following)) heap.push({following, source});
+
+            if (pending && sameHash(*pending, entry)) {
+                if (pending->type != entry.type) ++stats.conflicts;
+                pending = entry;
+                continue;
+            }
+            if (pending) emit(writer, *pending);
+            pending = entry;
+        }
+        if (pending) emit(writer, *pending);
+        return true;
+    }
+
+private:
+    void sortAndCollapse() {
+        std::sort(buffer.begin(), buffer.end(), entryLess);
+        size_t out = 0;
+        for (size_t i = 0; i < buffer.size(); ++i) {
+            if (out > 0 && sameHash(buffer[out - 1], buffer[i])) {
+                if (buffer[out - 1].type != buffer[i].type) ++stats.conflicts;
+                buffer[out - 1] = buffer[i];
+            } else {
+                buffer[out++] = buffer[i];
+            }
+        }
+        buffer.resize(out);
+    }
+
+    bool spill() {
+        sortAndCollapse();
+        fs::path runPath = basePath;
+        runPath += ".run" + std::to_string(runs.size()) + ".tmp";
+        std::ofstream out(runPath, std::ios::binary | std::ios::trunc);
+        runs.push_back(runPath);
+        if (!out.is_open()) {
+            logMessage("无法写入临时文件: " + runPath.string(), true);
+            return false;
+        }
+        char encoded[RUN_ENTRY_SIZE];
+        for (const SortEntry& entry : buffer) {
+            encodeEntry(entry, encoded);
+            out.write(encoded, RUN_ENTRY_SIZE);
+        }
+        out.close();
+        if (!out) {
+            logMessage("写入临时文件失败: " + runPath.string(), true);
+            return false;
+        }
+        ++stats.runs;
+        buffer.clear();
+        return true;
+    }
+
+    void emit(HashIndexWriter& writer, const SortEntry& entry) {
+        writer.append(static_cast<HashKind>(entry.kind), entry.key, entry.type);
+        ++stats.entries;
+    }
+
+    fs::path basePath;
+    size_t budget;
+    size_t capacity;
+    DumpImportStats& stats;
+    std::vector<SortEntry> buffer;
+    std::vector<fs::path> runs;
+    uint64_t nextSequence = 0;
+};
+
+// --- SAX 解析 ---
+// 记录是第 recordDepth 层的对象 (NDJSON 为 1, 数组快照为 2); 只保留当前记录需要的字段
+class DumpRecordHandler : public nlohmann::json_sax<json> {
+public:
+    DumpRecordHandler(ExternalSorter& sorter, DumpImportStats& stats, size_t recordDepth)
+        : sorter(sorter), stats(stats), recordDepth(recordDepth) {}
+
+    const std::string& errorMessage() const { return error; }
+    bool writeFailed() const { return sorterFailed; }
+
+    bool null() override { return value(); }
+    bool boolean(bool) override { return value(); }
+    bool number_integer(number_integer_t number) override {
+        if (number >= 0) return number_unsigned(static_cast<number_unsigned_t>(number));
+        return value();
+    }
+    bool number_unsigned(number_unsigned_t number) override {
+        if (keyApplies() && isFingerprintKey() && number <= UINT32_MAX) {
+            addHash(HashKind::CurseForge, hashKeyFromCurseForge(static_cast<uint32_t>(number)));
+        }
+        return value();
+    }
+    bool number_float(number_float_t, const string_t&) override { return value(); }
+    bool binary(binary_t&) override { return value(); }
+
+    bool string(string_t& text) override {
+        if (keyApplies()) {
+            if (containers.size() == recordDepth) {
+                if (currentKey == "client_side") clientSide = text;
+                if (currentKey == "server_side") serverSide = text;
+                if (currentKey == "type") typeName = text;
+            }
+            if (currentKey == "sha1") {
+                if (auto key = hashKeyFromHex(text, 20)) addHash(HashKind::Sha1, *key);
+            } else if (currentKey == "sha512") {
+                if (auto key = hashKeyFromHex(text, 64)) addHash(HashKind::Sha512, *key);
+            } else if (isFingerprintKey()) {
+                // 有的快照把 CurseForge 指纹写成字符串
+                uint64_t number = 0;
+                bool digits = !text.empty() && text.size() <= 10;
+                for (char c : text) {
+                    if (c < '0' || c > '9') {
+                        digits = false;
+                        break;
+                    }
+                    number = number * 10 + static_cast<uint64_t>(c - '0');
+                }
+                if (digits && number <= UINT32_MAX) {
+                    addHash(HashKind::CurseForge, hashKeyFromCurseForge(static_cast<uint32_t>(number)));
+                }
+            }
+        }
+        return value();
+    }
+
+    bool start_object(std::size_t) override {
+        containers.push_back(false);
+        hasKey = false;
+        if (containers.size() == recordDepth) beginRecord();
+        return true;
+    }
+
+    bool key(string_t& name) override {
+        currentKey = name;
+        hasKey = true;
+        return true;
+    }
+
+    bool end_object() override {
+        if (containers.size() == recordDepth) endRecord();
+        containers.pop_back();
+        hasKey = false;
+        return !sorterFailed;
+    }
+
+    bool start_array(std::size_t) override {
+        containers.push_back(true);
+        return true;
+    }
+
+    bool end_array() override {
+        containers.pop_back();
+        hasKey = false;
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& e) override {
+        error = "位置 " + std::to_string(position) + ": " + e.what();
+        return false;
+    }
+
+    // NDJSON 每行开始前重置状态
+    void reset() {
+        containers.clear();
+        hasKey = false;
+        inRecord = false;
+    }
+
+private:
+    // 值属于最近的键: 当前容器是对象, 并且位于某条记录之内
+    bool keyApplies() const {
+        return inRecord && hasKey && !containers.empty() && !containers.back();
+    }
+
+    bool isFingerprintKey() const {
+        return currentKey == "fingerprint" || currentKey == "fileFingerprint" || currentKey == "file_fingerprint" ||
+               currentKey == "curseforge_fingerprint";
+    }
+
+    bool value() {
+        hasKey = false;
+        return true;
+    }
+
+    void addHash(HashKind kind, uint64_t key) {
+        if (hashes.size() < MAX_HASHES_PER_RECORD) hashes.emplace_back(kind, key);
+    }
+
+    void beginRecord() {
+        inRecord = true;
+        clientSide.clear();
+        serverSide.clear();
+        typeName.clear();
+        hashes.clear();
+    }
+
+    void endRecord() {
+        inRecord = false;
+        ++stats.records;
+        if (hashes.empty()) return;
+
+        std::optional<ModType> type;
+        if (!typeName.empty()) type = ModInfo::parseModType(typeName);
+        if (!type) type = modTypeFromSides(clientSide, serverSide);
+        if (!type) {
+            ++stats.withoutSide;
+            return;
+        }
+        uint8_t code = encodeModType(*type);
+        for (const auto& [kind, key] : hashes) {
+            if (!sorter.add(kind, key, code)) {
+                sorterFailed = true;
+                return;
+            }
+            ++stats.hashes;
+        }
+    }
+
+    ExternalSorter& sorter;
+    DumpImportStats& stats;
+    size_t recordDepth;
+    std::vector<bool> containers; // true 为数组
+    std::string currentKey;
+    bool hasKey = false;
+    bool inRecord = false;
+    bool sorterFailed = false;
+    std::string clientSide;
+    std::string serverSide;
+    std::string typeName;
+    std::vector<std::pair<HashKind, uint64_t>> hashes;
+    std::string error;
+};
+
+// --- 辅助函数：导入一个快照文件 ---
+bool importDump(const fs::path& path, ExternalSorter& sorter, DumpImportStats& stats) {
+    auto start = std::chrono::steady_clock::now();
+    size_t recordsBefore = stats.records;
+    MappedFile file;
+    if (!file.open(path)) {
+        std::error_code ec;
+        if (fs::is_regular_file(path, ec) && fs::file_size(path, ec) == 0) {
+            logMessage("快照文件为空, 已跳过: " + path.string());
+            return true;
+        }
+        logMessage("无法读取快照文件: " + path.string(), true);
+        return false;
+    }
+
+    const char* begin = reinterpret_cast<const char*>(file.data());
+    const char* end = begin + file.size();
+    // 跳过 UTF-8 BOM 和开头的空白, 以第一个字符区分数组和 NDJSON
+    const char* p = begin;
+    if (end - p >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0) p += 3;
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p;
+
+    if (p < end && *p == '[') {
+        DumpRecordHandler handler(sorter, stats, 2);
+        if (!json::sax_parse(p, end, &handler)) {
+            if (handler.writeFailed()) return false;
+            logMessage("快照文件 " + path.string() + " 解析失败" +
+                               (handler.errorMessage().empty() ? std::string() : ", " + handler.errorMessage()),
+                       true);
+            return false;
+        }
+    } else {
+        DumpRecordHandler handler(sorter, stats, 1);
+        size_t lineNumber = 0;
+        while (p < end) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+            if (lineEnd == nullptr) lineEnd = end;
+            ++lineNumber;
+            const char* contentEnd = lineEnd;
+            while (contentEnd > p && (contentEnd[-1] == '\r' || contentEnd[-1] == ' ' || contentEnd[-1] == '\t')) {
+                --contentEnd;
+            }
+            if (contentEnd > p) {
+                handler.reset();
+                if (!json::sax_parse(p, contentEnd, &handler)) {
+                    if (handler.writeFailed()) return false;
+                    if (stats.invalidLines++ < MAX_LOGGED_ERRORS) {
+                        logMessage("快照文件 " + path.string() + " 第 " + std::to_string(lineNumber) +
+                                           " 行无法解析, 已跳过: " + handler.errorMessage(),
+                                   true);
+                    }
+                }
+            }
+            p = lineEnd + (lineEnd < end ? 1 : 0);
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1) << "已导入快照 " << path.string() << ": " << stats.records - recordsBefore
+       << " 条记录, " << static_cast<double>(file.size()) / (1024.0 * 1024.0) << " MiB, 耗时 " << seconds
+       << " 秒 (" << static_cast<double>(file.size()) / (1024.0 * 1024.0) / std::max(seconds, 1e-9) << " MiB/s)";
+    logMessage(ss.str());
+    return true;
+}
+
+} // namespace
+
+std::optional<ModType> modTypeFromSides(std::string_view clientSide, std::string_view serverSide) {
+    std::optional<Side> client = parseSide(clientSide);
+    std::optional<Side> server = parseSide(serverSide);
+    if (!client || !server) return std::nullopt;
+    if (*server == Side::Unsupported) {
+        if (*client == Side::Unsupported) return std::nullopt;
+        return ModType::ClientOnly;
+    }
+    if (*client == Side::Unsupported) return ModType::ServerOnly;
+    if (*client == Side::Required) {
+        return *server == Side::Required ? ModType::ClientAndServerRequired : ModType::ClientRequiredServerOptional;
+    }
+    return *server == Side::Required ? ModType::ClientOptionalServerRequired : ModType::ClientOptionalServerOptional;
+}
+
+bool importMetadataDumps(const std::vector<fs::path>& dumps, const fs::path& indexPath, size_t memoryBudget,
+                         DumpImportStats* statsOut) {
+    DumpImportStats stats;
+    ExternalSorter sorter(indexPath, memoryBudget, stats);
+
+    // 已有索引中的条目最先导入, 新快照中的同一哈希会覆盖它们
+    {
+        HashIndex existing;
+        if (existing.load(indexPath)) {
+            for (size_t k = 0; k < HASH_KIND_COUNT; ++k) {
+                bool ok = true;
+                existing.forEach(static_cast<HashKind>(k), [&](uint64_t key, uint8_t type) {
+                    if (ok) ok = sorter.add(static_cast<HashKind>(k), key, type);
+                });
+                if (!ok) return false;
+            }
+            logMessage("已载入现有哈希索引中的 " + std::to_string(existing.size()) + " 个条目。");
+        }
+    }
+
+    for (const fs::path& dump : dumps) {
+        if (!importDump(dump, sorter, stats)) return false;
+    }
+
+    HashIndexWriter writer(indexPath);
+    if (!writer.isOpen()) {
+        logMessage("无法写入哈希索引: " + indexPath.string(), true);
+        return false;
+    }
+    if (!sorter.finish(writer) || !writer.finish()) return false;
+
+    std::stringstream ss;
+    ss << "哈希索引已写入 " << indexPath.string() << ": " << stats.entries << " 个条目 (来自 " << stats.records
+       << " 条记录, " << stats.withoutSide << " 条没有运行端信息, " << stats.conflicts << " 次类型冲突, "
+       << stats.runs << " 个临时有序段)";
+    if (stats.invalidLines > 0) ss << ", " << stats.invalidLines << " 行无法解析";
+    logMessage(ss.str());
+    if (statsOut) *statsOut = stats;
+    return true;
+}
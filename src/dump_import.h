@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "mod_info.h"
+
+// --- 导入 Modrinth / CurseForge 元数据快照 ---
+// 快照可以是 NDJSON (每行一个对象) 或一个 JSON 数组, 文件通过内存映射交给 nlohmann 的 SAX 接口逐条解析,
+// 不会把整个文件读成 DOM。每条记录中识别的字段:
+//   client_side / server_side: Modrinth 的 required / optional / unsupported
+//   type:                      直接给出 mods_data.json 中的类型名, 优先于 client_side / server_side
+//   sha1 / sha512:             十六进制字符串, 可以出现在任意嵌套位置 (例如 files[].hashes.sha1)
+//   fingerprint / fileFingerprint: CurseForge 指纹
+// 提取出的 (哈希, 类型) 在内存中攒够预算后排序写成临时的有序段, 最后多路归并写出哈希索引 (见 hash_index.h),
+// 因此几 GB 的快照也只占用固定的内存。同一个哈希出现多次时以后导入的为准, 已有索引中的条目最先导入。
+
+struct DumpImportStats {
+    size_t records = 0;      // 解析的记录数
+    size_t hashes = 0;       // 记录中带运行端信息的哈希数
+    size_t withoutSide = 0;  // 有哈希但没有可用运行端信息而跳过的记录
+    size_t invalidLines = 0; // NDJSON 中无法解析的行
+    size_t conflicts = 0;    // 同一个哈希对应不同类型的次数
+    size_t runs = 0;         // 写入磁盘的有序段数
+    size_t entries = 0;      // 写出的索引条目数
+};
+
+// Modrinth 的 client_side / server_side 组合对应的类型; 两端都不支持或信息不全时为空
+std::optional<ModType> modTypeFromSides(std::string_view clientSide, std::string_view serverSide);
+
+// 导入 dumps 中的所有快照并与 indexPath 已有的条目合并, 替换 indexPath。memoryBudget 为排序缓冲区的字节数
+bool importMetadataDumps(const std::vector<std::filesystem::path>& dumps, const std::filesystem::path& indexPath,
+                         size_t memoryBudget, DumpImportStats* stats = nullptr);
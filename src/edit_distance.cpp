@@ -0,0 +1,284 @@
+#include "edit_distance.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+#include "cpu_features.h"
+#include "normalizer.h"
+
+namespace {
+
+// 参与比较的名称的最大长度, 更长的名称不建索引
+constexpr size_t MAX_KEY_LENGTH = 255;
+
+// 位并行算法一个字能容纳的最大长度
+constexpr size_t WORD_BITS = 64;
+
+// 模式串中每个字符出现位置的位图
+using PatternMasks = std::array<uint64_t, 256>;
+
+void buildPatternMasks(std::string_view pattern, PatternMasks& peq) {
+    peq.fill(0);
+    for (size_t i = 0; i < pattern.size(); ++i) peq[static_cast<unsigned char>(pattern[i])] |= uint64_t{1} << i;
+}
+
+// --- 辅助函数：Myers / Hyyrö 位并行编辑距离 ---
+// 模式串 (m 个字符, 1 <= m <= 64) 的 DP 列用垂直差分 Pv / Mv 表示, score 为最后一行的值。
+// 全局编辑距离的第 0 行逐列加一, 因此水平差分左移时移入 1。每列之后最后一行最多再减少剩余的列数,
+// 已经不可能回到 maxDistance 以内时提前结束
+int myersDistance(const PatternMasks& peq, size_t m, const unsigned char* text, size_t n, int maxDistance) {
+    const uint64_t high = uint64_t{1} << (m - 1);
+    uint64_t pv = ~uint64_t{0};
+    uint64_t mv = 0;
+    int score = static_cast<int>(m);
+    for (size_t j = 0; j < n; ++j) {
+        uint64_t eq = peq[text[j]];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        if (ph & high) {
+            ++score;
+        } else if (mh & high) {
+            --score;
+        }
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+        if (score - static_cast<int>(n - j - 1) > maxDistance) return maxDistance + 1;
+    }
+    return score;
+}
+
+#ifdef MODCLASSIFIER_X86_AVX2
+// 同一个模式串与 4 个等长的文本同时比较, 每个 64 位通道一份状态; 加法只在通道内进位, 与标量版本逐位相同。
+// 每 8 列检查一次, 4 个通道都已超出 maxDistance 时提前结束
+MODCLASSIFIER_TARGET_AVX2 void myersDistance4(const PatternMasks& peq, size_t m, const unsigned char* const* texts,
+                                              size_t n, int maxDistance, int* distances) {
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m128i highShift = _mm_cvtsi32_si128(static_cast<int>(m - 1));
+    __m256i pv = ones;
+    __m256i mv = _mm256_setzero_si256();
+    __m256i score = _mm256_set1_epi64x(static_cast<long long>(m));
+    const unsigned char* t0 = texts[0];
+    const unsigned char* t1 = texts[1];
+    const unsigned char* t2 = texts[2];
+    const unsigned char* t3 = texts[3];
+    for (size_t j = 0; j < n; ++j) {
+        __m256i eq = _mm256_set_epi64x(static_cast<long long>(peq[t3[j]]), static_cast<long long>(peq[t2[j]]),
+                                       static_cast<long long>(peq[t1[j]]), static_cast<long long>(peq[t0[j]]));
+        __m256i xv = _mm256_or_si256(eq, mv);
+        __m256i xh = _mm256_or_si256(
+            _mm256_xor_si256(_mm256_add_epi64(_mm256_and_si256(eq, pv), pv), pv), eq);
+        __m256i ph = _mm256_or_si256(mv, _mm256_xor_si256(_mm256_or_si256(xh, pv), ones));
+        __m256i mh = _mm256_and_si256(pv, xh);
+        score = _mm256_add_epi64(score, _mm256_and_si256(_mm256_srl_epi64(ph, highShift), one));
+        score = _mm256_sub_epi64(score, _mm256_and_si256(_mm256_srl_epi64(mh, highShift), one));
+        ph = _mm256_or_si256(_mm256_slli_epi64(ph, 1), one);
+        mh = _mm256_slli_epi64(mh, 1);
+        pv = _mm256_or_si256(mh, _mm256_xor_si256(_mm256_or_si256(xv, ph), ones));
+        mv = _mm256_and_si256(ph, xv);
+        if ((j & 7) == 7) {
+            __m256i bound = _mm256_set1_epi64x(static_cast<long long>(maxDistance) + static_cast<long long>(n - j - 1));
+            if (_mm256_movemask_epi8(_mm256_cmpgt_epi64(score, bound)) == -1) {
+                for (int lane = 0; lane < 4; ++lane) distances[lane] = maxDistance + 1;
+                return;
+            }
+        }
+    }
+    alignas(32) long long lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), score);
+    for (int lane = 0; lane < 4; ++lane) {
+        distances[lane] = lanes[lane] > maxDistance ? maxDistance + 1 : static_cast<int>(lanes[lane]);
+    }
+}
+
+const bool HAS_AVX2 = cpuHasAvx2();
+#endif
+
+// --- 辅助函数：超过 64 个字符时只计算宽度为 2 * maxDistance + 1 的对角带 ---
+int bandedDistance(std::string_view a, std::string_view b, int maxDistance) {
+    const size_t n = a.size();
+    const size_t m = b.size();
+    const int unreachable = maxDistance + 1;
+    std::vector<int> previous(m + 1);
+    std::vector<int> current(m + 1);
+    for (size_t j = 0; j <= m; ++j) previous[j] = j <= static_cast<size_t>(maxDistance) ? static_cast<int>(j) : unreachable;
+    for (size_t i = 1; i <= n; ++i) {
+        size_t from = i > static_cast<size_t>(maxDistance) ? i - maxDistance : 1;
+        size_t to = std::min(m, i + maxDistance);
+        std::fill(current.begin(), current.end(), unreachable);
+        current[0] = i <= static_cast<size_t>(maxDistance) ? static_cast<int>(i) : unreachable;
+        int rowMin = current[0];
+        for (size_t j = from; j <= to; ++j) {
+            int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+            int value = std::min({previous[j - 1] + cost, previous[j] + 1, current[j - 1] + 1});
+            current[j] = std::min(value, unreachable);
+            rowMin = std::min(rowMin, current[j]);
+        }
+        if (rowMin > maxDistance) return unreachable;
+        std::swap(previous, current);
+    }
+    return std::min(previous[m], unreachable);
+}
+
+// --- 辅助函数：字符集合 ---
+// 字母和数字各占一位, 其它字符散列到剩余的位; 一方有而另一方没有的每一位至少需要一次编辑
+uint64_t characterMask(std::string_view key) {
+    uint64_t mask = 0;
+    for (char c : key) {
+        unsigned char u = static_cast<unsigned char>(c);
+        unsigned bit;
+        if (u >= 'a' && u <= 'z') {
+            bit = u - 'a';
+        } else if (u >= '0' && u <= '9') {
+            bit = 26 + (u - '0');
+        } else {
+            bit = 36 + u % 28;
+        }
+        mask |= uint64_t{1} << bit;
+    }
+    return mask;
+}
+
+} // namespace
+
+int editDistance(std::string_view a, std::string_view b, int maxDistance) {
+    if (maxDistance < 0) return 0;
+    if (a.size() < b.size()) std::swap(a, b);
+    // 长度差本身就是距离的下界
+    if (a.size() - b.size() > static_cast<size_t>(maxDistance)) return maxDistance + 1;
+    if (b.empty()) return static_cast<int>(a.size());
+    if (b.size() > WORD_BITS) return bandedDistance(a, b, maxDistance);
+    PatternMasks peq;
+    buildPatternMasks(b, peq);
+    return myersDistance(peq, b.size(), reinterpret_cast<const unsigned char*>(a.data()), a.size(), maxDistance);
+}
+
+std::string FuzzyNameIndex::comparisonKey(std::string_view name) {
+    name = stripNameExtension(name);
+    std::string key(name);
+    for (char& c : key) c = toLowerAscii(c);
+    return key;
+}
+
+void FuzzyNameIndex::build(const std::vector<std::string_view>& entries) {
+    names.clear();
+    nameOffsets.assign(1, 0);
+    size_t totalLength = 0;
+    for (std::string_view entry : entries) totalLength += entry.size();
+    names.reserve(totalLength);
+    nameOffsets.reserve(entries.size() + 1);
+
+    // 先按比较用的名称长度计数, 再按长度分组依次放入
+    std::vector<std::string> entryKeys;
+    entryKeys.reserve(entries.size());
+    lengthStart.assign(MAX_KEY_LENGTH + 2, 0);
+    for (std::string_view entry : entries) {
+        names.append(entry);
+        nameOffsets.push_back(static_cast<uint32_t>(names.size()));
+        entryKeys.push_back(comparisonKey(entry));
+        size_t length = entryKeys.back().size();
+        if (length <= MAX_KEY_LENGTH) ++lengthStart[length + 1];
+    }
+    for (size_t length = 0; length <= MAX_KEY_LENGTH; ++length) lengthStart[length + 1] += lengthStart[length];
+    keyStart.assign(MAX_KEY_LENGTH + 1, 0);
+    size_t keyBytes = 0;
+    for (size_t length = 0; length <= MAX_KEY_LENGTH; ++length) {
+        keyStart[length] = keyBytes;
+        keyBytes += static_cast<size_t>(lengthStart[length + 1] - lengthStart[length]) * length;
+    }
+
+    keys.assign(keyBytes, '\0');
+    sortedEntry.assign(lengthStart.back(), 0);
+    sortedMask.assign(lengthStart.back(), 0);
+    std::vector<uint32_t> fill(lengthStart.begin(), lengthStart.end() - 1);
+    for (uint32_t entry = 0; entry < entryKeys.size(); ++entry) {
+        const std::string& key = entryKeys[entry];
+        if (key.size() > MAX_KEY_LENGTH) continue;
+        uint32_t position = fill[key.size()]++;
+        sortedEntry[position] = entry;
+        sortedMask[position] = characterMask(key);
+        size_t offset = keyStart[key.size()] + static_cast<size_t>(position - lengthStart[key.size()]) * key.size();
+        std::copy(key.begin(), key.end(), keys.begin() + static_cast<std::ptrdiff_t>(offset));
+    }
+}
+
+std::vector<FuzzyMatch> FuzzyNameIndex::search(std::string_view query, int maxDistance, size_t limit) const {
+    std::vector<FuzzyMatch> matches;
+    if (limit == 0 || maxDistance < 0 || sortedEntry.empty()) return matches;
+    const std::string key = comparisonKey(query);
+    const size_t m = key.size();
+    const uint64_t queryMask = characterMask(key);
+    const size_t d = static_cast<size_t>(maxDistance);
+
+    // 较短的一方作为位并行算法的模式串; 查询本身不超过 64 个字符时, 长度不超过它的组直接把查询当作模式串
+    const bool bitParallel = m > 0 && m <= WORD_BITS;
+    PatternMasks peq;
+    if (bitParallel) buildPatternMasks(key, peq);
+    const unsigned char* keyData = reinterpret_cast<const unsigned char*>(keys.data());
+
+    auto accept = [&](uint32_t position, int distance) {
+        if (distance <= maxDistance) matches.push_back({sortedEntry[position], distance});
+    };
+
+    size_t minLength = m > d ? m - d : 0;
+    size_t maxLength = std::min(MAX_KEY_LENGTH, m + d);
+    for (size_t length = minLength; length <= maxLength; ++length) {
+        const size_t begin = lengthStart[length];
+        const size_t end = lengthStart[length + 1];
+        if (begin == end) continue;
+        const unsigned char* base = keyData + keyStart[length];
+
+        // 字符集合先排除明显不可能的名称, 剩下的每 4 个一批
+        std::array<uint32_t, 4> batch;
+        size_t batchSize = 0;
+        auto flush = [&]() {
+#ifdef MODCLASSIFIER_X86_AVX2
+            if (HAS_AVX2 && bitParallel && batchSize > 1) {
+                const unsigned char* texts[4];
+                for (size_t lane = 0; lane < 4; ++lane) {
+                    uint32_t position = batch[lane < batchSize ? lane : 0];
+                    texts[lane] = base + static_cast<size_t>(position - begin) * length;
+                }
+                int distances[4];
+                myersDistance4(peq, m, texts, length, maxDistance, distances);
+                for (size_t lane = 0; lane < batchSize; ++lane) accept(batch[lane], distances[lane]);
+                batchSize = 0;
+                return;
+            }
+#endif
+            for (size_t lane = 0; lane < batchSize; ++lane) {
+                const unsigned char* text = base + static_cast<size_t>(batch[lane] - begin) * length;
+                int distance;
+                if (bitParallel) {
+                    distance = myersDistance(peq, m, text, length, maxDistance);
+                } else {
+                    distance = editDistance(key, std::string_view(reinterpret_cast<const char*>(text), length),
+                                            maxDistance);
+                }
+                accept(batch[lane], distance);
+            }
+            batchSize = 0;
+        };
+        for (size_t position = begin; position < end; ++position) {
+            uint64_t mask = sortedMask[position];
+            if (static_cast<size_t>(std::popcount(queryMask & ~mask)) > d ||
+                static_cast<size_t>(std::popcount(mask & ~queryMask)) > d) {
+                continue;
+            }
+            batch[batchSize++] = static_cast<uint32_t>(position);
+            if (batchSize == batch.size()) flush();
+        }
+        flush();
+    }
+
+    std::sort(matches.begin(), matches.end(), [](const FuzzyMatch& a, const FuzzyMatch& b) {
+        return a.distance != b.distance ? a.distance < b.distance : a.entry < b.entry;
+    });
+    if (matches.size() > limit) matches.resize(limit);
+    return matches;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// --- 编辑距离 (Levenshtein) ---
+// 使用 Myers / Hyyrö 的位并行算法: 较短的一方不超过 64 个字符时, 整列 DP 状态放在一个 64 位字中,
+// 每读入另一方的一个字符只需十几条位运算。超过 64 个字符时退回到只计算对角带的普通 DP。
+
+// a 与 b 的编辑距离; 超过 maxDistance 时提前结束并返回 maxDistance + 1
+int editDistance(std::string_view a, std::string_view b, int maxDistance);
+
+// --- 按编辑距离查找近似名称 ---
+// 名称转小写并去掉扩展名后按长度分组, 同一组的名称定长连续存放。查询时只比较长度相差不超过最大距离的组,
+// 并用字符集合先排除明显不可能的名称 (一方有而另一方完全没有的字符种类数不超过距离)。
+// 支持 AVX2 时一次比较同一组中的 4 个名称, 每个 64 位通道各自运行一份位并行算法。
+// 建好后只读, 可以在多个线程中同时查询。
+
+struct FuzzyMatch {
+    uint32_t entry; // 条目编号, 即构建时名称的下标
+    int distance;
+};
+
+class FuzzyNameIndex {
+public:
+    FuzzyNameIndex() = default;
+
+    void build(const std::vector<std::string_view>& names);
+
+    size_t size() const { return nameOffsets.empty() ? 0 : nameOffsets.size() - 1; }
+    std::string_view name(uint32_t entry) const {
+        return std::string_view(names).substr(nameOffsets[entry], nameOffsets[entry + 1] - nameOffsets[entry]);
+    }
+
+    // 编辑距离不超过 maxDistance 的至多 limit 个条目, 按距离从小到大 (相同时按编号)
+    std::vector<FuzzyMatch> search(std::string_view query, int maxDistance, size_t limit) const;
+
+    // 比较时使用的形式: 转小写并去掉扩展名
+    static std::string comparisonKey(std::string_view name);
+
+private:
+    std::string names; // 原始名称, 连续存放
+    std::vector<uint32_t> nameOffsets;
+    std::string keys;                  // 比较用的名称, 按长度分组, 组内定长
+    std::vector<uint32_t> lengthStart; // 长度为 L 的组为排序后的第 [lengthStart[L], lengthStart[L + 1]) 个
+    std::vector<size_t> keyStart;      // 长度为 L 的组在 keys 中的起点
+    std::vector<uint32_t> sortedEntry; // 排序后第 p 个对应的条目编号
+    std::vector<uint64_t> sortedMask;  // 排序后第 p 个的字符集合
+};
@@ -0,0 +1,876 @@
+#include "fingerprint.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <system_error>
+#include <utility>
+#include "byte_order.h"
+#include "logger.h"
+#include "mapped_file.h"
+#include "normalizer.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MODCLASSIFIER_SSE2 1
+#endif
+
+// SHA-NI 需要运行时检测, 编译时只为对应函数开启指令集
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define MODCLASSIFIER_TARGET_SHA
+#else
+#include <cpuid.h>
+#define MODCLASSIFIER_TARGET_SHA __attribute__((target("sha,sse4.1")))
+#endif
+#define MODCLASSIFIER_X86_SHA 1
+#endif
+
+// ARMv8 的加密扩展是编译时特性 (Apple Silicon 等默认开启)
+#if defined(__aarch64__) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+#include <arm_neon.h>
+#define MODCLASSIFIER_ARM_SHA 1
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 每次交给各个算法的数据块, 足够小以留在 L2 缓存中
+constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+// --- 辅助函数：大端序读取 (SHA 的消息字) ---
+uint32_t readBE32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 | static_cast<uint32_t>(p[2]) << 8 |
+           static_cast<uint32_t>(p[3]);
+}
+
+uint64_t readBE64(const unsigned char* p) {
+    return static_cast<uint64_t>(readBE32(p)) << 32 | readBE32(p + 4);
+}
+
+void writeBE32(unsigned char* p, uint32_t value) {
+    for (int i = 3; i >= 0; --i, value >>= 8) p[i] = static_cast<unsigned char>(value);
+}
+
+void writeBE64(unsigned char* p, uint64_t value) {
+    for (int i = 7; i >= 0; --i, value >>= 8) p[i] = static_cast<unsigned char>(value);
+}
+
+// --- SHA-1 ---
+using Sha1BlockFunction = void (*)(uint32_t* state, const unsigned char* data, size_t blocks);
+
+void sha1BlocksScalar(uint32_t* state, const unsigned char* data, size_t blocks) {
+    uint32_t w[80];
+    for (; blocks > 0; --blocks, data += 64) {
+        for (int i = 0; i < 16; ++i) w[i] = readBE32(data + 4 * i);
+        for (int i = 16; i < 80; ++i) w[i] = std::rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t temp = std::rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = std::rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+    }
+}
+
+#ifdef MODCLASSIFIER_X86_SHA
+// 每组 4 轮, 奇偶组交替使用两个 E 寄存器; 第 g 组使用消息 msg[g % 4], 同时为第 g + 4 组准备消息
+// (sha1msg1 / 异或 / sha1msg2 三步)。组号是模板参数, 展开后所有下标都是常量, 消息留在寄存器中
+template <int G>
+MODCLASSIFIER_TARGET_SHA inline void sha1Group(__m128i& abcd, __m128i (&e)[2], __m128i (&msg)[4]) {
+    __m128i& input = e[G & 1];
+    const __m128i current = msg[G & 3];
+    if constexpr (G == 0) {
+        input = _mm_add_epi32(input, current);
+    } else {
+        input = _mm_sha1nexte_epu32(input, current);
+    }
+    e[(G + 1) & 1] = abcd;
+    if constexpr (G >= 3 && G <= 18) msg[(G + 1) & 3] = _mm_sha1msg2_epu32(msg[(G + 1) & 3], current);
+    abcd = _mm_sha1rnds4_epu32(abcd, input, G / 5);
+    if constexpr (G >= 1 && G <= 16) msg[(G + 3) & 3] = _mm_sha1msg1_epu32(msg[(G + 3) & 3], current);
+    if constexpr (G >= 2 && G <= 17) msg[(G + 2) & 3] = _mm_xor_si128(msg[(G + 2) & 3], current);
+}
+
+template <int... G>
+MODCLASSIFIER_TARGET_SHA inline void sha1AllGroups(__m128i& abcd, __m128i (&e)[2], __m128i (&msg)[4],
+                                                  std::integer_sequence<int, G...>) {
+    (sha1Group<G>(abcd, e, msg), ...);
+}
+
+MODCLASSIFIER_TARGET_SHA void sha1BlocksShaNi(uint32_t* state, const unsigned char* data, size_t blocks) {
+    const __m128i byteSwap = _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL);
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1B);
+    __m128i e[2] = {_mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0), _mm_setzero_si128()};
+
+    for (; blocks > 0; --blocks, data += 64) {
+        const __m128i abcdSaved = abcd;
+        const __m128i eSaved = e[0];
+        __m128i msg[4];
+        for (int i = 0; i < 4; ++i) {
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * i)), byteSwap);
+        }
+        sha1AllGroups(abcd, e, msg, std::make_integer_sequence<int, 20>());
+        // 最后一组 (奇数组) 把下一块的 E 留在 e[0]
+        e[0] = _mm_sha1nexte_epu32(e[0], eSaved);
+        abcd = _mm_add_epi32(abcd, abcdSaved);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1B));
+    state[4] = static_cast<uint32_t>(_mm_extract_epi32(e[0], 3));
+}
+
+bool cpuHasShaNi() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuidex(info, 7, 0);
+    bool sha = (info[1] & (1 << 29)) != 0;
+    __cpuid(info, 1);
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+#else
+    unsigned a, b, c, d;
+    if (!__get_cpuid_count(7, 0, &a, &b, &c, &d)) return false;
+    bool sha = (b & (1u << 29)) != 0;
+    if (!__get_cpuid(1, &a, &b, &c, &d)) return false;
+    bool sse41 = (c & (1u << 19)) != 0;
+#endif
+    return sha && sse41;
+}
+#endif
+
+#ifdef MODCLASSIFIER_ARM_SHA
+// 每组 4 轮, 奇偶组交替使用两个 E 寄存器; 提前两组加上轮常量, 提前四组扩展消息
+void sha1BlocksArm(uint32_t* state, const unsigned char* data, size_t blocks) {
+    static const uint32_t ROUND_CONSTANTS[4] = {0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC, 0xCA62C1D6};
+    uint32x4_t abcd = vld1q_u32(state);
+    uint32_t e0 = state[4];
+
+    for (; blocks > 0; --blocks, data += 64) {
+        const uint32x4_t abcdSaved = abcd;
+        const uint32_t eSaved = e0;
+        uint32x4_t msg[4];
+        for (int i = 0; i < 4; ++i) msg[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16 * i)));
+
+        uint32x4_t wk[2] = {vaddq_u32(msg[0], vdupq_n_u32(ROUND_CONSTANTS[0])),
+                            vaddq_u32(msg[1], vdupq_n_u32(ROUND_CONSTANTS[0]))};
+        uint32_t e[2] = {e0, 0};
+        for (int g = 0; g < 20; ++g) {
+            uint32_t input = e[g & 1];
+            e[(g + 1) & 1] = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+            if (g < 5) {
+                abcd = vsha1cq_u32(abcd, input, wk[g & 1]);
+            } else if (g < 10 || g >= 15) {
+                abcd = vsha1pq_u32(abcd, input, wk[g & 1]);
+            } else {
+                abcd = vsha1mq_u32(abcd, input, wk[g & 1]);
+            }
+            if (g + 2 < 20) wk[g & 1] = vaddq_u32(msg[(g + 2) & 3], vdupq_n_u32(ROUND_CONSTANTS[(g + 2) / 5]));
+            if (g >= 1 && g <= 16) msg[(g - 1) & 3] = vsha1su1q_u32(msg[(g - 1) & 3], msg[(g + 2) & 3]);
+            if (g <= 15) msg[g & 3] = vsha1su0q_u32(msg[g & 3], msg[(g + 1) & 3], msg[(g + 2) & 3]);
+        }
+
+        e0 = eSaved + e[0];
+        abcd = vaddq_u32(abcd, abcdSaved);
+    }
+
+    vst1q_u32(state, abcd);
+    state[4] = e0;
+}
+#endif
+
+// 启动时选定 SHA-1 实现
+struct Sha1Backend {
+    Sha1BlockFunction blocks;
+    const char* name;
+};
+
+Sha1Backend selectSha1Backend() {
+#ifdef MODCLASSIFIER_X86_SHA
+    if (cpuHasShaNi()) return {sha1BlocksShaNi, "SHA-NI"};
+#endif
+#ifdef MODCLASSIFIER_ARM_SHA
+    return {sha1BlocksArm, "ARMv8"};
+#else
+    return {sha1BlocksScalar, "标量"};
+#endif
+}
+
+const Sha1Backend SHA1_BACKEND = selectSha1Backend();
+
+// SHA-1 和 SHA-512 共用的分块缓冲: 凑满一个块才压缩, 整块的数据直接从输入压缩
+template <size_t BlockSize, typename Compress>
+void bufferBlocks(unsigned char* buffer, size_t& buffered, const unsigned char* data, size_t size, Compress compress) {
+    if (buffered > 0) {
+        size_t take = std::min(size, BlockSize - buffered);
+        std::memcpy(buffer + buffered, data, take);
+        buffered += take;
+        data += take;
+        size -= take;
+        if (buffered < BlockSize) return;
+        compress(buffer, 1);
+        buffered = 0;
+    }
+    size_t blocks = size / BlockSize;
+    if (blocks > 0) compress(data, blocks);
+    data += blocks * BlockSize;
+    size -= blocks * BlockSize;
+    if (size > 0) std::memcpy(buffer, data, size);
+    buffered = size;
+}
+
+class Sha1Hasher {
+public:
+    explicit Sha1Hasher(Sha1BlockFunction blocks = SHA1_BACKEND.blocks) : compressBlocks(blocks) {}
+
+    void update(const unsigned char* data, size_t size) {
+        total += size;
+        bufferBlocks<64>(buffer, buffered, data, size,
+                         [&](const unsigned char* blocks, size_t count) { compressBlocks(state, blocks, count); });
+    }
+
+    void finish(uint8_t* digest) {
+        uint64_t bitLength = total * 8;
+        unsigned char padding[72] = {0x80};
+        size_t padLength = (buffered < 56 ? 56 : 120) - buffered;
+        update(padding, padLength);
+        unsigned char length[8];
+        writeBE64(length, bitLength);
+        update(length, 8);
+        for (int i = 0; i < 5; ++i) writeBE32(digest + 4 * i, state[i]);
+    }
+
+private:
+    Sha1BlockFunction compressBlocks;
+    uint32_t state[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    unsigned char buffer[64] = {};
+    size_t buffered = 0;
+    uint64_t total = 0;
+};
+
+// --- SHA-512 ---
+// 没有通用的硬件指令 (SHA-NI 只覆盖 SHA-1 / SHA-256), 使用标量实现
+constexpr uint64_t SHA512_ROUND_CONSTANTS[80] = {
+        0x428a2f98d728ae22, 0x7137449123ef65cd, 0xb5c0fbcfec4d3b2f, 0xe9b5dba58189dbbc, 0x3956c25bf348b538,
+        0x59f111f1b605d019, 0x923f82a4af194f9b, 0xab1c5ed5da6d8118, 0xd807aa98a3030242, 0x12835b0145706fbe,
+        0x243185be4ee4b28c, 0x550c7dc3d5ffb4e2, 0x72be5d74f27b896f, 0x80deb1fe3b1696b1, 0x9bdc06a725c71235,
+        0xc19bf174cf692694, 0xe49b69c19ef14ad2, 0xefbe4786384f25e3, 0x0fc19dc68b8cd5b5, 0x240ca1cc77ac9c65,
+        0x2de92c6f592b0275, 0x4a7484aa6ea6e483, 0x5cb0a9dcbd41fbd4, 0x76f988da831153b5, 0x983e5152ee66dfab,
+        0xa831c66d2db43210, 0xb00327c898fb213f, 0xbf597fc7beef0ee4, 0xc6e00bf33da88fc2, 0xd5a79147930aa725,
+        0x06ca6351e003826f, 0x142929670a0e6e70, 0x27b70a8546d22ffc, 0x2e1b21385c26c926, 0x4d2c6dfc5ac42aed,
+        0x53380d139d95b3df, 0x650a73548baf63de, 0x766a0abb3c77b2a8, 0x81c2c92e47edaee6, 0x92722c851482353b,
+        0xa2bfe8a14cf10364, 0xa81a664bbc423001, 0xc24b8b70d0f89791, 0xc76c51a30654be30, 0xd192e819d6ef5218,
+        0xd69906245565a910, 0xf40e35855771202a, 0x106aa07032bbd1b8, 0x19a4c116b8d2d0c8, 0x1e376c085141ab53,
+        0x2748774cdf8eeb99, 0x34b0bcb5e19b48a8, 0x391c0cb3c5c95a63, 0x4ed8aa4ae3418acb, 0x5b9cca4f7763e373,
+        0x682e6ff3d6b2b8a3, 0x748f82ee5defb2fc, 0x78a5636f43172f60, 0x84c87814a1f0ab72, 0x8cc702081a6439ec,
+        0x90befffa23631e28, 0xa4506cebde82bde9, 0xbef9a3f7b2c67915, 0xc67178f2e372532b, 0xca273eceea26619c,
+        0xd186b8c721c0c207, 0xeada7dd6cde0eb1e, 0xf57d4f7fee6ed178, 0x06f067aa72176fba, 0x0a637dc5a2c898a6,
+        0x113f9804bef90dae, 0x1b710b35131c471b, 0x28db77f523047d84, 0x32caab7b40c72493, 0x3c9ebe0a15c9bebc,
+        0x431d67c49c100d4c, 0x4cc5d4becb3e42b6, 0x597f299cfc657e2a, 0x5fcb6fab3ad6faec, 0x6c44198c4a475817};
+
+// 单轮只更新 d 和 h, 其余变量通过每 8 轮轮换参数顺序体现, 省去逐轮移动寄存器
+inline void sha512Round(uint64_t a, uint64_t b, uint64_t c, uint64_t& d, uint64_t e, uint64_t f, uint64_t g,
+                        uint64_t& h, uint64_t constantPlusMessage) {
+    uint64_t s1 = std::rotr(e, 14) ^ std::rotr(e, 18) ^ std::rotr(e, 41);
+    uint64_t choose = g ^ (e & (f ^ g));
+    uint64_t temp1 = h + s1 + choose + constantPlusMessage;
+    uint64_t s0 = std::rotr(a, 28) ^ std::rotr(a, 34) ^ std::rotr(a, 39);
+    uint64_t majority = (a & b) | (c & (a | b));
+    d += temp1;
+    h = temp1 + s0 + majority;
+}
+
+void sha512Blocks(uint64_t* state, const unsigned char* data, size_t blocks) {
+    uint64_t w[80];
+    for (; blocks > 0; --blocks, data += 128) {
+        for (int i = 0; i < 16; ++i) w[i] = readBE64(data + 8 * i);
+        for (int i = 16; i < 80; ++i) {
+            uint64_t s0 = std::rotr(w[i - 15], 1) ^ std::rotr(w[i - 15], 8) ^ (w[i - 15] >> 7);
+            uint64_t s1 = std::rotr(w[i - 2], 19) ^ std::rotr(w[i - 2], 61) ^ (w[i - 2] >> 6);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint64_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint64_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 80; i += 8) {
+            sha512Round(a, b, c, d, e, f, g, h, SHA512_ROUND_CONSTANTS[i] + w[i]);
+            sha512Round(h, a, b, c, d, e, f, g, SHA512_ROUND_CONSTANTS[i + 1] + w[i + 1]);
+            sha512Round(g, h, a, b, c, d, e, f, SHA512_ROUND_CONSTANTS[i + 2] + w[i + 2]);
+            sha512Round(f, g, h, a, b, c, d, e, SHA512_ROUND_CONSTANTS[i + 3] + w[i + 3]);
+            sha512Round(e, f, g, h, a, b, c, d, SHA512_ROUND_CONSTANTS[i + 4] + w[i + 4]);
+            sha512Round(d, e, f, g, h, a, b, c, SHA512_ROUND_CONSTANTS[i + 5] + w[i + 5]);
+            sha512Round(c, d, e, f, g, h, a, b, SHA512_ROUND_CONSTANTS[i + 6] + w[i + 6]);
+            sha512Round(b, c, d, e, f, g, h, a, SHA512_ROUND_CONSTANTS[i + 7] + w[i + 7]);
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+class Sha512Hasher {
+public:
+    void update(const unsigned char* data, size_t size) {
+        total += size;
+        bufferBlocks<128>(buffer, buffered, data, size,
+                          [&](const unsigned char* blocks, size_t count) { sha512Blocks(state, blocks, count); });
+    }
+
+    void finish(uint8_t* digest) {
+        uint64_t byteLength = total;
+        unsigned char padding[144] = {0x80};
+        size_t padLength = (buffered < 112 ? 112 : 240) - buffered;
+        update(padding, padLength);
+        // 128 位的位长度
+        unsigned char length[16];
+        writeBE64(length, byteLength >> 61);
+        writeBE64(length + 8, byteLength << 3);
+        update(length, 16);
+        for (int i = 0; i < 8; ++i) writeBE64(digest + 8 * i, state[i]);
+    }
+
+private:
+    uint64_t state[8] = {0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+                         0x510e527fade682d1, 0x9b05688c2b3e6c1f, 0x1f83d9abfb41bd6b, 0x5be0cd19137e2179};
+    unsigned char buffer[128] = {};
+    size_t buffered = 0;
+    uint64_t total = 0;
+};
+
+// --- CurseForge 指纹 ---
+// 制表符、换行、回车和空格不参与计算
+bool isFingerprintWhitespace(unsigned char c) {
+    return c == 9 || c == 10 || c == 13 || c == 32;
+}
+
+#ifdef MODCLASSIFIER_SSE2
+// 16 个字节中空白字符的位掩码
+inline unsigned whitespaceMask(__m128i block) {
+    __m128i tab = _mm_cmpeq_epi8(block, _mm_set1_epi8(9));
+    __m128i newline = _mm_cmpeq_epi8(block, _mm_set1_epi8(10));
+    __m128i carriage = _mm_cmpeq_epi8(block, _mm_set1_epi8(13));
+    __m128i space = _mm_cmpeq_epi8(block, _mm_set1_epi8(32));
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(tab, newline), _mm_or_si128(carriage, space))));
+}
+#endif
+
+// --- 辅助函数：统计去掉空白后的长度 ---
+// MurmurHash2 开始计算前就需要总长度, 因此先单独扫描一遍 (只读内存, 远快于哈希本身)
+uint64_t countNonWhitespace(const unsigned char* data, size_t size) {
+    uint64_t whitespace = 0;
+    size_t i = 0;
+#ifdef MODCLASSIFIER_SSE2
+    for (; i + 16 <= size; i += 16) {
+        whitespace += static_cast<uint64_t>(
+                std::popcount(whitespaceMask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)))));
+    }
+#endif
+    for (; i < size; ++i) whitespace += isFingerprintWhitespace(data[i]) ? 1 : 0;
+    return size - whitespace;
+}
+
+// --- 辅助函数：去掉空白字符 ---
+// output 至少要有 size + 16 字节; 没有空白的 16 字节整块直接写出, 返回写出的字节数
+size_t stripWhitespace(const unsigned char* data, size_t size, unsigned char* output) {
+    unsigned char* out = output;
+    size_t i = 0;
+#ifdef MODCLASSIFIER_SSE2
+    for (; i + 16 <= size; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        unsigned mask = whitespaceMask(block);
+        if (mask == 0) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), block);
+            out += 16;
+            continue;
+        }
+        unsigned keep = ~mask & 0xFFFF;
+        while (keep != 0) {
+            *out++ = data[i + static_cast<size_t>(std::countr_zero(keep))];
+            keep &= keep - 1;
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if (!isFingerprintWhitespace(data[i])) *out++ = data[i];
+    }
+    return static_cast<size_t>(out - output);
+}
+
+// 流式 MurmurHash2, 输入是已经去掉空白的数据
+class CurseForgeHasher {
+public:
+    explicit CurseForgeHasher(uint64_t strippedLength) : hash(1u ^ static_cast<uint32_t>(strippedLength)) {}
+
+    void update(const unsigned char* data, size_t size) {
+        while (pendingSize > 0 && pendingSize < 4 && size > 0) {
+            pending[pendingSize++] = *data++;
+            --size;
+        }
+        if (pendingSize == 4) {
+            mix(readLe32(pending));
+            pendingSize = 0;
+        }
+        for (; size >= 4; data += 4, size -= 4) mix(readLe32(data));
+        while (size > 0) {
+            pending[pendingSize++] = *data++;
+            --size;
+        }
+    }
+
+    uint32_t finish() {
+        switch (pendingSize) {
+            case 3: hash ^= static_cast<uint32_t>(pending[2]) << 16; [[fallthrough]];
+            case 2: hash ^= static_cast<uint32_t>(pending[1]) << 8; [[fallthrough]];
+            case 1:
+                hash ^= pending[0];
+                hash *= MULTIPLIER;
+                break;
+            default: break;
+        }
+        hash ^= hash >> 13;
+        hash *= MULTIPLIER;
+        hash ^= hash >> 15;
+        return hash;
+    }
+
+private:
+    static constexpr uint32_t MULTIPLIER = 0x5bd1e995;
+
+    void mix(uint32_t k) {
+        k *= MULTIPLIER;
+        k ^= k >> 24;
+        k *= MULTIPLIER;
+        hash *= MULTIPLIER;
+        hash ^= k;
+    }
+
+    uint32_t hash;
+    unsigned char pending[4] = {};
+    size_t pendingSize = 0;
+};
+
+// --- XXH3-64 (种子 0, 默认密钥) ---
+constexpr uint64_t XXH_PRIME32_1 = 0x9E3779B1;
+constexpr uint64_t XXH_PRIME32_2 = 0x85EBCA77;
+constexpr uint64_t XXH_PRIME32_3 = 0xC2B2AE3D;
+constexpr uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87;
+constexpr uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4F;
+constexpr uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9;
+constexpr uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63;
+constexpr uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5;
+constexpr uint64_t XXH_PRIME_MX1 = 0x165667919E3779F9;
+constexpr uint64_t XXH_PRIME_MX2 = 0x9FB21C651E98DF25;
+
+constexpr size_t XXH_SECRET_SIZE = 192;
+constexpr size_t XXH_STRIPE_LENGTH = 64;
+constexpr size_t XXH_STRIPES_PER_BLOCK = (XXH_SECRET_SIZE - XXH_STRIPE_LENGTH) / 8;
+constexpr size_t XXH_BUFFER_SIZE = 256;
+constexpr size_t XXH_MIDSIZE_MAX = 240;
+
+constexpr unsigned char XXH_SECRET[XXH_SECRET_SIZE] = {
+        0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+        0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+        0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+        0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+        0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+        0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+        0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+        0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+        0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+        0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+        0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+        0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+uint64_t multiplyFold64(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+    uint64_t aLow = a & 0xFFFFFFFF, aHigh = a >> 32, bLow = b & 0xFFFFFFFF, bHigh = b >> 32;
+    uint64_t lowLow = aLow * bLow, highLow = aHigh * bLow, lowHigh = aLow * bHigh, highHigh = aHigh * bHigh;
+    uint64_t cross = (lowLow >> 32) + (highLow & 0xFFFFFFFF) + lowHigh;
+    uint64_t high = (highLow >> 32) + (cross >> 32) + highHigh;
+    uint64_t low = (cross << 32) | (lowLow & 0xFFFFFFFF);
+    return low ^ high;
+#endif
+}
+
+uint64_t byteSwap64(uint64_t value) {
+    uint64_t result = 0;
+    for (int i = 0; i < 8; ++i, value >>= 8) result = (result << 8) | (value & 0xFF);
+    return result;
+}
+
+uint64_t xxh64Avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t xxh3Avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= XXH_PRIME_MX1;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t xxh3Rrmxmx(uint64_t h, uint64_t length) {
+    h ^= std::rotl(h, 49) ^ std::rotl(h, 24);
+    h *= XXH_PRIME_MX2;
+    h ^= (h >> 35) + length;
+    h *= XXH_PRIME_MX2;
+    h ^= h >> 28;
+    return h;
+}
+
+uint64_t xxh3Mix16(const unsigned char* input, const unsigned char* secret) {
+    return multiplyFold64(readLe64(input) ^ readLe64(secret), readLe64(input + 8) ^ readLe64(secret + 8));
+}
+
+// 不超过 240 字节的输入一次算完
+uint64_t xxh3Short(const unsigned char* input, size_t length) {
+    const unsigned char* secret = XXH_SECRET;
+    if (length == 0) return xxh64Avalanche(readLe64(secret + 56) ^ readLe64(secret + 64));
+    if (length <= 3) {
+        uint32_t combined = static_cast<uint32_t>(input[0]) << 16 | static_cast<uint32_t>(input[length >> 1]) << 24 |
+                            static_cast<uint32_t>(input[length - 1]) | static_cast<uint32_t>(length) << 8;
+        uint64_t bitflip = readLe32(secret) ^ readLe32(secret + 4);
+        return xxh64Avalanche(combined ^ bitflip);
+    }
+    if (length <= 8) {
+        uint64_t bitflip = readLe64(secret + 8) ^ readLe64(secret + 16);
+        uint64_t value = readLe32(input + length - 4) + (static_cast<uint64_t>(readLe32(input)) << 32);
+        return xxh3Rrmxmx(value ^ bitflip, length);
+    }
+    if (length <= 16) {
+        uint64_t low = readLe64(input) ^ (readLe64(secret + 24) ^ readLe64(secret + 32));
+        uint64_t high = readLe64(input + length - 8) ^ (readLe64(secret + 40) ^ readLe64(secret + 48));
+        uint64_t acc = length + byteSwap64(low) + high + multiplyFold64(low, high);
+        return xxh3Avalanche(acc);
+    }
+
+    uint64_t acc = length * XXH_PRIME64_1;
+    if (length <= 128) {
+        if (length > 32) {
+            if (length > 64) {
+                if (length > 96) {
+                    acc += xxh3Mix16(input + 48, secret + 96);
+                    acc += xxh3Mix16(input + length - 64, secret + 112);
+                }
+                acc += xxh3Mix16(input + 32, secret + 64);
+                acc += xxh3Mix16(input + length - 48, secret + 80);
+            }
+            acc += xxh3Mix16(input + 16, secret + 32);
+            acc += xxh3Mix16(input + length - 32, secret + 48);
+        }
+        acc += xxh3Mix16(input, secret);
+        acc += xxh3Mix16(input + length - 16, secret + 16);
+        return xxh3Avalanche(acc);
+    }
+
+    size_t rounds = length / 16;
+    for (size_t i = 0; i < 8; ++i) acc += xxh3Mix16(input + 16 * i, secret + 16 * i);
+    acc = xxh3Avalanche(acc);
+    for (size_t i = 8; i < rounds; ++i) acc += xxh3Mix16(input + 16 * i, secret + 16 * (i - 8) + 3);
+    acc += xxh3Mix16(input + length - 16, secret + 136 - 17);
+    return xxh3Avalanche(acc);
+}
+
+// 更长的输入按 64 字节条带累加, 每 16 个条带 (一个块) 打乱一次累加器; 支持流式输入
+class Xxh3Hasher {
+public:
+    void update(const unsigned char* data, size_t size) {
+        total += size;
+        if (buffered + size <= XXH_BUFFER_SIZE) {
+            std::memcpy(buffer + buffered, data, size);
+            buffered += size;
+            return;
+        }
+        if (buffered > 0) {
+            size_t take = XXH_BUFFER_SIZE - buffered;
+            std::memcpy(buffer + buffered, data, take);
+            data += take;
+            size -= take;
+            consumeStripes(buffer, XXH_BUFFER_SIZE / XXH_STRIPE_LENGTH);
+            buffered = 0;
+        }
+        // 最后至少留下一个字节在缓冲区中: 结束时的最后一个条带必须包含输入的末尾
+        if (size > XXH_BUFFER_SIZE) {
+            size_t stripes = (size - 1) / XXH_STRIPE_LENGTH;
+            consumeStripes(data, stripes);
+            data += stripes * XXH_STRIPE_LENGTH;
+            size -= stripes * XXH_STRIPE_LENGTH;
+            std::memcpy(buffer + XXH_BUFFER_SIZE - XXH_STRIPE_LENGTH, data - XXH_STRIPE_LENGTH, XXH_STRIPE_LENGTH);
+        }
+        std::memcpy(buffer, data, size);
+        buffered = size;
+    }
+
+    uint64_t finish() {
+        if (total <= XXH_MIDSIZE_MAX) return xxh3Short(buffer, static_cast<size_t>(total));
+
+        if (buffered >= XXH_STRIPE_LENGTH) {
+            consumeStripes(buffer, (buffered - 1) / XXH_STRIPE_LENGTH);
+            accumulateStripe(buffer + buffered - XXH_STRIPE_LENGTH, XXH_SECRET + XXH_SECRET_SIZE - XXH_STRIPE_LENGTH - 7);
+        } else {
+            // 最后一个条带的前半部分来自上一次消耗的数据
+            unsigned char lastStripe[XXH_STRIPE_LENGTH];
+            size_t catchUp = XXH_STRIPE_LENGTH - buffered;
+            std::memcpy(lastStripe, buffer + XXH_BUFFER_SIZE - catchUp, catchUp);
+            std::memcpy(lastStripe + catchUp, buffer, buffered);
+            accumulateStripe(lastStripe, XXH_SECRET + XXH_SECRET_SIZE - XXH_STRIPE_LENGTH - 7);
+        }
+
+        uint64_t result = total * XXH_PRIME64_1;
+        for (size_t i = 0; i < 4; ++i) {
+            result += multiplyFold64(acc[2 * i] ^ readLe64(XXH_SECRET + 11 + 16 * i),
+                                     acc[2 * i + 1] ^ readLe64(XXH_SECRET + 11 + 16 * i + 8));
+        }
+        return xxh3Avalanche(result);
+    }
+
+private:
+    void accumulateStripe(const unsigned char* input, const unsigned char* secret) {
+        for (size_t i = 0; i < 8; ++i) {
+            uint64_t value = readLe64(input + 8 * i);
+            uint64_t key = value ^ readLe64(secret + 8 * i);
+            acc[i ^ 1] += value;
+            acc[i] += (key & 0xFFFFFFFF) * (key >> 32);
+        }
+    }
+
+    void scramble() {
+        const unsigned char* secret = XXH_SECRET + XXH_SECRET_SIZE - XXH_STRIPE_LENGTH;
+        for (size_t i = 0; i < 8; ++i) {
+            uint64_t value = acc[i];
+            value ^= value >> 47;
+            value ^= readLe64(secret + 8 * i);
+            acc[i] = value * XXH_PRIME32_1;
+        }
+    }
+
+    void consumeStripes(const unsigned char* input, size_t stripes) {
+        for (size_t s = 0; s < stripes; ++s, input += XXH_STRIPE_LENGTH) {
+            accumulateStripe(input, XXH_SECRET + 8 * stripesInBlock);
+            if (++stripesInBlock == XXH_STRIPES_PER_BLOCK) {
+                scramble();
+                stripesInBlock = 0;
+            }
+        }
+    }
+
+    uint64_t acc[8] = {XXH_PRIME32_3, XXH_PRIME64_1, XXH_PRIME64_2, XXH_PRIME64_3,
+                       XXH_PRIME64_4, XXH_PRIME32_2, XXH_PRIME64_5, XXH_PRIME32_1};
+    unsigned char buffer[XXH_BUFFER_SIZE] = {};
+    size_t buffered = 0;
+    size_t stripesInBlock = 0;
+    uint64_t total = 0;
+};
+
+} // namespace
+
+Fingerprint fingerprintBytes(const unsigned char* data, size_t size, unsigned kinds) {
+    Fingerprint result;
+    result.kinds = kinds & FINGERPRINT_ALL;
+
+    Sha1Hasher sha1;
+    Sha512Hasher sha512;
+    Xxh3Hasher xxh3;
+    bool wantCurseForge = (kinds & FINGERPRINT_CURSEFORGE) != 0;
+    CurseForgeHasher curseforge(wantCurseForge ? countNonWhitespace(data, size) : 0);
+    thread_local std::vector<unsigned char> stripped;
+    if (wantCurseForge) stripped.resize(CHUNK_SIZE + 16);
+
+    for (size_t offset = 0; offset < size; offset += CHUNK_SIZE) {
+        const unsigned char* chunk = data + offset;
+        size_t length = std::min(CHUNK_SIZE, size - offset);
+        if (kinds & FINGERPRINT_SHA1) sha1.update(chunk, length);
+        if (kinds & FINGERPRINT_SHA512) sha512.update(chunk, length);
+        if (kinds & FINGERPRINT_XXH3) xxh3.update(chunk, length);
+        if (wantCurseForge) curseforge.update(stripped.data(), stripWhitespace(chunk, length, stripped.data()));
+    }
+
+    if (kinds & FINGERPRINT_SHA1) sha1.finish(result.sha1.data());
+    if (kinds & FINGERPRINT_SHA512) sha512.finish(result.sha512.data());
+    if (kinds & FINGERPRINT_XXH3) result.xxh3 = xxh3.finish();
+    if (wantCurseForge) result.curseforge = curseforge.finish();
+    return result;
+}
+
+bool fingerprintFile(const fs::path& path, Fingerprint& result, unsigned kinds) {
+    MappedFile file;
+    if (file.open(path)) {
+        result = fingerprintBytes(file.data(), file.size(), kinds);
+        return true;
+    }
+    // 空文件无法映射, 但仍然有指纹
+    std::error_code ec;
+    if (fs::is_regular_file(path, ec) && fs::file_size(path, ec) == 0 && !ec) {
+        result = fingerprintBytes(nullptr, 0, kinds);
+        return true;
+    }
+    return false;
+}
+
+std::vector<std::optional<Fingerprint>> fingerprintFiles(const std::vector<fs::path>& files, ThreadPool& pool,
+                                                         unsigned kinds) {
+    std::vector<std::optional<Fingerprint>> results(files.size());
+    parallelFor(pool, files.size(), [&](size_t i) {
+        Fingerprint fingerprint;
+        if (fingerprintFile(files[i], fingerprint, kinds)) results[i] = fingerprint;
+    });
+    return results;
+}
+
+std::string toHex(const uint8_t* bytes, size_t size) {
+    static const char DIGITS[] = "0123456789abcdef";
+    std::string text;
+    text.reserve(size * 2);
+    for (size_t i = 0; i < size; ++i) {
+        text.push_back(DIGITS[bytes[i] >> 4]);
+        text.push_back(DIGITS[bytes[i] & 0x0F]);
+    }
+    return text;
+}
+
+const char* sha1Implementation() {
+    return SHA1_BACKEND.name;
+}
+
+bool fingerprintSelfTest() {
+    struct TestVector {
+        std::string input;
+        const char* sha1;
+        const char* sha512;
+        uint32_t curseforge;
+        uint64_t xxh3;
+    };
+    // 第二组 3000 字节, 跨越 SHA 的多个块、XXH3 的多个块和流式缓冲区
+    std::string pattern(3000, '\0');
+    for (size_t i = 0; i < pattern.size(); ++i) pattern[i] = static_cast<char>((i * 31 + 7) & 0xFF);
+    const TestVector vectors[] = {
+            {"abc", "a9993e364706816aba3e25717850c26c9cd0d89d",
+             "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+             "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f",
+             0x60a4fcc1, 0x78af5f94892f3950},
+            {pattern, "f673573aee1f6cac6d13162dea65bd01bf6701b1",
+             "230a919a322fbb970f6fc511dc9a338c04a81538b1e83dd3913afe08c1a06b00"
+             "7d22ec1e7a175131f52d4607041739805dadfc125fde0693b477fd12a1b65057",
+             0xc2855fe4, 0x6eb4b5bfe14d9786},
+    };
+
+    for (const TestVector& vector : vectors) {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(vector.input.data());
+        Fingerprint fingerprint = fingerprintBytes(bytes, vector.input.size());
+        if (toHex(fingerprint.sha1.data(), fingerprint.sha1.size()) != vector.sha1 ||
+            toHex(fingerprint.sha512.data(), fingerprint.sha512.size()) != vector.sha512 ||
+            fingerprint.curseforge != vector.curseforge || fingerprint.xxh3 != vector.xxh3) {
+            return false;
+        }
+
+        // 硬件实现与标量实现逐字节喂入时结果一致, 检查流式缓冲的边界
+        Sha1Hasher hardware;
+        Sha1Hasher scalar(sha1BlocksScalar);
+        Xxh3Hasher xxh3;
+        for (size_t i = 0; i < vector.input.size(); ++i) {
+            hardware.update(bytes + i, 1);
+            scalar.update(bytes + i, 1);
+            xxh3.update(bytes + i, 1);
+        }
+        std::array<uint8_t, 20> hardwareDigest{}, scalarDigest{};
+        hardware.finish(hardwareDigest.data());
+        scalar.finish(scalarDigest.data());
+        if (hardwareDigest != fingerprint.sha1 || scalarDigest != fingerprint.sha1 || xxh3.finish() != vector.xxh3) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool runFingerprintReport(const fs::path& directory) {
+    if (!fingerprintSelfTest()) {
+        logMessage("指纹算法自检失败, SHA-1 实现: " + std::string(sha1Implementation()), true);
+        return false;
+    }
+
+    std::vector<fs::path> jars;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec) && hasExtension(it->path().filename().string(), ".jar")) jars.push_back(it->path());
+    }
+    if (jars.empty()) {
+        logMessage("目录 '" + directory.string() + "' 中没有找到 jar。", true);
+        return false;
+    }
+    std::sort(jars.begin(), jars.end());
+
+    ThreadPool pool(std::min(defaultThreadCount(), jars.size()));
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::optional<Fingerprint>> fingerprints = fingerprintFiles(jars, pool);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t totalBytes = 0;
+    size_t failures = 0;
+    for (size_t i = 0; i < jars.size(); ++i) {
+        if (!fingerprints[i]) {
+            logMessage("无法读取文件: " + jars[i].string(), true);
+            ++failures;
+            continue;
+        }
+        totalBytes += fs::file_size(jars[i], ec);
+        const Fingerprint& fingerprint = *fingerprints[i];
+        std::stringstream ss;
+        ss << jars[i].filename().string() << " sha1=" << toHex(fingerprint.sha1.data(), fingerprint.sha1.size())
+           << " sha512=" << toHex(fingerprint.sha512.data(), fingerprint.sha512.size())
+           << " curseforge=" << fingerprint.curseforge << " xxh3=" << std::hex << std::setw(16)
+           << std::setfill('0') << fingerprint.xxh3;
+        logMessage(ss.str());
+    }
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1) << "已计算 " << jars.size() - failures << " 个 jar 的指纹, 共 "
+       << static_cast<double>(totalBytes) / (1024.0 * 1024.0) << " MiB, 耗时 " << seconds * 1000.0 << " 毫秒 ("
+       << static_cast<double>(totalBytes) / (1024.0 * 1024.0) / std::max(seconds, 1e-9) << " MiB/s, "
+       << pool.size() << " 个线程, SHA-1 实现: " << sha1Implementation() << ")";
+    logMessage(ss.str());
+    return failures == 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+#include "thread_pool.h"
+
+// --- jar 指纹 ---
+// Modrinth 按 SHA-1 / SHA-512 查询文件, CurseForge 的指纹是去掉空白字符 (制表符、换行、回车、空格)
+// 之后的 MurmurHash2 (种子 1), 本地去重使用 XXH3-64。文件只映射一次, 按块依次交给需要的算法,
+// 同一块数据在缓存中时算完所有摘要。SHA-1 在支持 SHA-NI (x86) 或 ARMv8 加密扩展时使用硬件指令。
+
+// 需要计算的摘要, 可以按位组合
+constexpr unsigned FINGERPRINT_SHA1 = 1u << 0;
+constexpr unsigned FINGERPRINT_SHA512 = 1u << 1;
+constexpr unsigned FINGERPRINT_CURSEFORGE = 1u << 2;
+constexpr unsigned FINGERPRINT_XXH3 = 1u << 3;
+constexpr unsigned FINGERPRINT_ALL = FINGERPRINT_SHA1 | FINGERPRINT_SHA512 | FINGERPRINT_CURSEFORGE | FINGERPRINT_XXH3;
+
+struct Fingerprint {
+    unsigned kinds = 0; // 实际计算了哪些摘要 (FINGERPRINT_* 的组合)
+    std::array<uint8_t, 20> sha1{};
+    std::array<uint8_t, 64> sha512{};
+    uint32_t curseforge = 0;
+    uint64_t xxh3 = 0;
+};
+
+// 计算内存中数据的指纹
+Fingerprint fingerprintBytes(const unsigned char* data, size_t size, unsigned kinds = FINGERPRINT_ALL);
+
+// 映射文件并计算指纹, 文件无法读取时返回 false
+bool fingerprintFile(const std::filesystem::path& path, Fingerprint& result, unsigned kinds = FINGERPRINT_ALL);
+
+// 在线程池中并行计算多个文件的指纹, 结果与 files 一一对应, 读取失败的文件为空
+std::vector<std::optional<Fingerprint>> fingerprintFiles(const std::vector<std::filesystem::path>& files,
+                                                         ThreadPool& pool, unsigned kinds = FINGERPRINT_ALL);
+
+// 小写十六进制字符串
+std::string toHex(const uint8_t* bytes, size_t size);
+
+// 当前使用的 SHA-1 实现, 用于日志: "SHA-NI"、"ARMv8" 或 "标量"
+const char* sha1Implementation();
+
+// 用已知的测试向量检查所有算法 (包括当前机器选用的硬件实现), 全部正确时返回 true
+bool fingerprintSelfTest();
+
+// --fingerprint <目录>: 计算目录中所有 jar 的指纹并输出, 附带吞吐量统计
+bool runFingerprintReport(const std::filesystem::path& directory);
@@ -0,0 +1,213 @@
+#include "hash_index.h"
+
+#include <cstring>
+#include <iterator>
+#include <system_error>
+#include <vector>
+#include "byte_order.h"
+#include "logger.h"
+
+namespace fs = std::filesystem;
+
+static constexpr char MAGIC[4] = {'M', 'C', 'H', 'I'};
+static constexpr uint32_t FORMAT_VERSION = 1;
+static constexpr size_t HEADER_SIZE = 8 + 8 * HASH_KIND_COUNT;
+static constexpr size_t KEY_SIZE = 8;
+
+// 文件中的类型编码, 下标即编码
+static constexpr ModType TYPE_CODES[] = {
+        ModType::ClientOnly,
+        ModType::ServerOnly,
+        ModType::ClientRequiredServerOptional,
+        ModType::ClientOptionalServerRequired,
+        ModType::ClientAndServerRequired,
+        ModType::ClientOptionalServerOptional,
+        ModType::Unknown,
+};
+
+uint64_t hashKeyFromDigest(const uint8_t* digest) {
+    uint64_t key = 0;
+    for (int i = 0; i < 8; ++i) key = (key << 8) | digest[i];
+    return key;
+}
+
+std::optional<uint64_t> hashKeyFromHex(std::string_view hex, size_t digestBytes) {
+    if (hex.size() != digestBytes * 2) return std::nullopt;
+    uint64_t key = 0;
+    for (size_t i = 0; i < hex.size(); ++i) {
+        char c = hex[i];
+        uint64_t nibble;
+        if (c >= '0' && c <= '9') {
+            nibble = static_cast<uint64_t>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = static_cast<uint64_t>(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            nibble = static_cast<uint64_t>(c - 'A' + 10);
+        } else {
+            return std::nullopt;
+        }
+        if (i < 16) key = (key << 4) | nibble;
+    }
+    return key;
+}
+
+uint8_t encodeModType(ModType type) {
+    for (size_t i = 0; i < std::size(TYPE_CODES); ++i) {
+        if (TYPE_CODES[i] == type) return static_cast<uint8_t>(i);
+    }
+    return static_cast<uint8_t>(std::size(TYPE_CODES) - 1);
+}
+
+std::optional<ModType> decodeModType(uint8_t code) {
+    if (code >= std::size(TYPE_CODES)) return std::nullopt;
+    return TYPE_CODES[code];
+}
+
+bool HashIndex::load(const fs::path& path) {
+    mapped.close();
+    for (Section& section : sections) section = {};
+    if (!fs::exists(path)) return false;
+    if (!mapped.open(path)) {
+        logMessage("无法映射哈希索引: " + path.string(), true);
+        return false;
+    }
+    const unsigned char* base = mapped.data();
+    if (mapped.size() < HEADER_SIZE || std::memcmp(base, MAGIC, 4) != 0 || readLe32(base + 4) != FORMAT_VERSION) {
+        logMessage("哈希索引格式无效, 已忽略: " + path.string(), true);
+        mapped.close();
+        return false;
+    }
+
+    uint64_t counts[HASH_KIND_COUNT];
+    uint64_t total = 0;
+    for (size_t k = 0; k < HASH_KIND_COUNT; ++k) {
+        counts[k] = readLe64(base + 8 + 8 * k);
+        // 防止构造的条目数在计算长度时溢出
+        if (counts[k] > mapped.size()) {
+            total = UINT64_MAX;
+            break;
+        }
+        total += counts[k];
+    }
+    if (total == UINT64_MAX || HEADER_SIZE + total * (KEY_SIZE + 1) != mapped.size()) {
+        logMessage("哈希索引长度不匹配, 已忽略: " + path.string(), true);
+        mapped.close();
+        return false;
+    }
+
+    const unsigned char* keys = base + HEADER_SIZE;
+    const unsigned char* types = keys + total * KEY_SIZE;
+    for (size_t k = 0; k < HASH_KIND_COUNT; ++k) {
+        sections[k] = {keys, types, static_cast<size_t>(counts[k])};
+        keys += counts[k] * KEY_SIZE;
+        types += counts[k];
+    }
+    return true;
+}
+
+size_t HashIndex::size() const {
+    size_t total = 0;
+    for (const Section& section : sections) total += section.count;
+    return total;
+}
+
+unsigned HashIndex::fingerprintKinds() const {
+    unsigned kinds = 0;
+    if (count(HashKind::Sha1) > 0) kinds |= FINGERPRINT_SHA1;
+    if (count(HashKind::Sha512) > 0) kinds |= FINGERPRINT_SHA512;
+    if (count(HashKind::CurseForge) > 0) kinds |= FINGERPRINT_CURSEFORGE;
+    return kinds;
+}
+
+uint64_t HashIndex::keyAt(const Section& section, size_t i) {
+    return readLe64(section.keys + i * KEY_SIZE);
+}
+
+std::optional<ModType> HashIndex::find(HashKind kind, uint64_t key) const {
+    const Section& section = sections[static_cast<size_t>(kind)];
+    size_t low = 0;
+    size_t high = section.count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (keyAt(section, middle) < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low == section.count || keyAt(section, low) != key) return std::nullopt;
+    return decodeModType(section.types[low]);
+}
+
+std::optional<ModType> HashIndex::find(const Fingerprint& fingerprint) const {
+    std::optional<ModType> type;
+    if (fingerprint.kinds & FINGERPRINT_SHA1) type = find(HashKind::Sha1, hashKeyFromDigest(fingerprint.sha1.data()));
+    if (!type && (fingerprint.kinds & FINGERPRINT_SHA512)) {
+        type = find(HashKind::Sha512, hashKeyFromDigest(fingerprint.sha512.data()));
+    }
+    if (!type && (fingerprint.kinds & FINGERPRINT_CURSEFORGE)) {
+        type = find(HashKind::CurseForge, hashKeyFromCurseForge(fingerprint.curseforge));
+    }
+    return type;
+}
+
+HashIndexWriter::HashIndexWriter(const fs::path& path)
+    : targetPath(path), keysPath(fs::path(path) += ".tmp"), typesPath(fs::path(path) += ".types.tmp") {
+    keysOut.open(keysPath, std::ios::binary | std::ios::trunc);
+    typesOut.open(typesPath, std::ios::binary | std::ios::trunc);
+    // 头部先占位, 结束时再填写条目数
+    std::string placeholder(HEADER_SIZE, '\0');
+    keysOut.write(placeholder.data(), static_cast<std::streamsize>(placeholder.size()));
+}
+
+HashIndexWriter::~HashIndexWriter() {
+    if (finished) return;
+    keysOut.close();
+    typesOut.close();
+    std::error_code ec;
+    fs::remove(keysPath, ec);
+    fs::remove(typesPath, ec);
+}
+
+void HashIndexWriter::append(HashKind kind, uint64_t key, uint8_t typeCode) {
+    writeLe64(keysOut, key);
+    typesOut.put(static_cast<char>(typeCode));
+    ++counts[static_cast<size_t>(kind)];
+}
+
+bool HashIndexWriter::finish() {
+    typesOut.close();
+    if (!keysOut || !typesOut) {
+        logMessage("写入哈希索引失败: " + keysPath.string(), true);
+        return false;
+    }
+
+    // 把类型拼接到键之后
+    {
+        std::ifstream typesIn(typesPath, std::ios::binary);
+        std::vector<char> buffer(1 << 20);
+        while (typesIn) {
+            typesIn.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            keysOut.write(buffer.data(), typesIn.gcount());
+        }
+    }
+    keysOut.seekp(0);
+    keysOut.write(MAGIC, 4);
+    writeLe32(keysOut, FORMAT_VERSION);
+    for (uint64_t count : counts) writeLe64(keysOut, count);
+    keysOut.close();
+    if (!keysOut) {
+        logMessage("写入哈希索引失败: " + keysPath.string(), true);
+        return false;
+    }
+
+    std::error_code ec;
+    fs::remove(typesPath, ec);
+    fs::rename(keysPath, targetPath, ec);
+    if (ec) {
+        logMessage("无法替换哈希索引 " + targetPath.string() + ": " + ec.message(), true);
+        return false;
+    }
+    finished = true;
+    return true;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string_view>
+#include "fingerprint.h"
+#include "mapped_file.h"
+#include "mod_info.h"
+
+// --- 按文件哈希查找 Mod 类型的索引 ---
+// 由 Modrinth / CurseForge 的元数据快照导入 (见 dump_import.h), 与 mods_data.json 放在同一目录。
+// 同一个 jar 不论改成什么文件名, 哈希都不变, 因此分类时先按指纹查这个索引, 查不到再按文件名匹配。
+// 文件格式 (小端), 通过内存映射直接二分查找:
+//   头部:   magic "MCHI" | u32 格式版本 | u64 条目数 x 3 (SHA-1, SHA-512, CurseForge 各一节)
+//   键:     每节的键按升序排列, u64; SHA-1 / SHA-512 取摘要的前 8 字节 (大端), CurseForge 为 32 位指纹
+//   类型:   与键一一对应的 u8 类型编码
+// 64 位前缀对加密哈希足够区分数千万个文件, 换来的是每个条目只占 9 字节。
+
+enum class HashKind : uint8_t {
+    Sha1 = 0,
+    Sha512 = 1,
+    CurseForge = 2,
+};
+
+constexpr size_t HASH_KIND_COUNT = 3;
+
+// 各种哈希对应的索引键
+uint64_t hashKeyFromDigest(const uint8_t* digest);
+inline uint64_t hashKeyFromCurseForge(uint32_t fingerprint) {
+    return fingerprint;
+}
+// 十六进制摘要 (例如清单中的 sha1) 的索引键; 要求整个字符串都是 digestBytes 字节的十六进制, 避免把其它字段误当作哈希
+std::optional<uint64_t> hashKeyFromHex(std::string_view hex, size_t digestBytes);
+
+// 类型在文件中的编码, 与枚举的顺序无关
+uint8_t encodeModType(ModType type);
+std::optional<ModType> decodeModType(uint8_t code);
+
+class HashIndex {
+public:
+    HashIndex() = default;
+
+    HashIndex(const HashIndex&) = delete;
+    HashIndex& operator=(const HashIndex&) = delete;
+
+    // 映射索引文件, 文件不存在或损坏时返回 false (此时视为空索引)
+    bool load(const std::filesystem::path& path);
+
+    bool empty() const { return size() == 0; }
+    size_t size() const;
+    size_t count(HashKind kind) const { return sections[static_cast<size_t>(kind)].count; }
+
+    // 需要为查询计算哪些指纹 (FINGERPRINT_* 的组合), 只包含索引中有条目的种类
+    unsigned fingerprintKinds() const;
+
+    std::optional<ModType> find(HashKind kind, uint64_t key) const;
+    // 依次按 SHA-1、SHA-512、CurseForge 指纹查找
+    std::optional<ModType> find(const Fingerprint& fingerprint) const;
+
+    // 按顺序遍历某一节的条目 (键升序), 用于导入时与新数据合并
+    template <typename Visitor>
+    void forEach(HashKind kind, Visitor&& visit) const {
+        const Section& section = sections[static_cast<size_t>(kind)];
+        for (size_t i = 0; i < section.count; ++i) visit(keyAt(section, i), section.types[i]);
+    }
+
+private:
+    struct Section {
+        const unsigned char* keys = nullptr;
+        const unsigned char* types = nullptr;
+        size_t count = 0;
+    };
+
+    static uint64_t keyAt(const Section& section, size_t i);
+
+    MappedFile mapped;
+    Section sections[HASH_KIND_COUNT];
+};
+
+// 按 (种类, 键) 升序写入索引文件: 键直接写入临时文件, 类型先写入旁边的文件, 结束时拼接并填写头部,
+// 最后替换目标文件。内存占用与条目数无关
+class HashIndexWriter {
+public:
+    explicit HashIndexWriter(const std::filesystem::path& path);
+    ~HashIndexWriter();
+
+    HashIndexWriter(const HashIndexWriter&) = delete;
+    HashIndexWriter& operator=(const HashIndexWriter&) = delete;
+
+    bool isOpen() const { return keysOut.is_open() && typesOut.is_open(); }
+
+    // 必须按 (种类, 键) 严格升序调用
+    void append(HashKind kind, uint64_t key, uint8_t typeCode);
+
+    // 完成写入并替换目标文件
+    bool finish();
+
+private:
+    std::filesystem::path targetPath;
+    std::filesystem::path keysPath;
+    std::filesystem::path typesPath;
+    std::ofstream keysOut;
+    std::ofstream typesOut;
+    uint64_t counts[HASH_KIND_COUNT] = {};
+    bool finished = false;
+};
@@ -0,0 +1,123 @@
+/*
+ * libmodclassifier 对外 C 接口
+ *
+ * 供启动器等长期运行的宿主程序嵌入使用: 数据库在 mc_db_open 时加载,
+ * 之后的所有查询都复用同一个句柄, 需要时可用 mc_db_reload 原地更新。接口只使用 C 类型, ABI 在同一 MC_API_VERSION 内保持稳定。
+ *
+ * 线程安全: 同一个 mc_db 句柄可以在多个线程中同时调用 mc_classify_* 和 mc_db_reload,
+ * mc_db_close 必须在所有调用结束后进行。
+ */
+#ifndef MODCLASSIFIER_H
+#define MODCLASSIFIER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(MODCLASSIFIER_SHARED)
+#  ifdef MODCLASSIFIER_BUILDING
+#    define MC_API __declspec(dllexport)
+#  else
+#    define MC_API __declspec(dllimport)
+#  endif
+#elif defined(MODCLASSIFIER_SHARED) && defined(__GNUC__)
+#  define MC_API __attribute__((visibility("default")))
+#else
+#  define MC_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 接口版本, 不兼容的修改会递增 */
+#define MC_API_VERSION 1
+
+/* Mod 类型, 数值与 mods_data.json 中的 type 一一对应, 不会重新编号 */
+typedef enum mc_mod_type {
+    MC_TYPE_NOT_FOUND = -1,                       /* 数据库中没有该 Mod */
+    MC_TYPE_CLIENT_ONLY = 0,                      /* client_only */
+    MC_TYPE_SERVER_ONLY = 1,                      /* server_only */
+    MC_TYPE_CLIENT_REQUIRED_SERVER_OPTIONAL = 2,  /* client_required_server_optional */
+    MC_TYPE_CLIENT_OPTIONAL_SERVER_REQUIRED = 3,  /* client_optional_server_required */
+    MC_TYPE_CLIENT_AND_SERVER_REQUIRED = 4,       /* client_and_server_required */
+    MC_TYPE_CLIENT_OPTIONAL_SERVER_OPTIONAL = 5,  /* client_optional_server_optional */
+    MC_TYPE_UNKNOWN = 6                           /* unknown */
+} mc_mod_type;
+
+typedef enum mc_status {
+    MC_OK = 0,
+    MC_ERR_INVALID_ARGUMENT = 1,
+    MC_ERR_IO = 2,              /* 文件或目录无法访问 */
+    MC_ERR_PARSE = 3,           /* 数据库文件无法解析 */
+    MC_ERR_INTERNAL = 4
+} mc_status;
+
+/* 数据库句柄, 内部结构不对外公开 */
+typedef struct mc_db mc_db;
+
+/* 目录分类的统计信息 */
+typedef struct mc_dir_stats {
+    size_t total;       /* 处理的文件数 */
+    size_t classified;  /* 成功复制到输出目录 */
+    size_t skipped;     /* 目标已存在而跳过 */
+    size_t not_found;   /* 数据库中没有分类信息 */
+    size_t failed;      /* 复制失败 */
+} mc_dir_stats;
+
+/* 日志回调, is_error 非零表示错误; message 为 UTF-8, 仅在回调期间有效。
+ * 回调不持有库内部的锁, 可以在其中调用其它 mc_* 函数; 多个线程可能同时调用回调 */
+typedef void (*mc_log_fn)(const char* message, int is_error, void* user_data);
+
+/* 返回库实现的接口版本 (MC_API_VERSION) */
+MC_API uint32_t mc_api_version(void);
+
+/* 设置日志回调并关闭控制台输出; fn 为 NULL 时恢复控制台输出 */
+MC_API void mc_set_log_callback(mc_log_fn fn, void* user_data);
+
+/* 加载 mods_data.json (也可以是分片目录), 成功时 *out_db 指向新句柄 */
+MC_API mc_status mc_db_open(const char* json_path, mc_db** out_db);
+
+/*
+ * 按顺序叠加 count 个数据库 (后面的优先, 与命令行的 --db 相同), 每一个可以是 JSON 文件或分片目录;
+ * rules_path 非 NULL 时同时载入覆盖规则文件 (与命令行的 --rules 相同)。成功时 *out_db 指向新句柄
+ */
+MC_API mc_status mc_db_open_layers(const char* const* paths, size_t count, const char* rules_path, mc_db** out_db);
+
+/* 重新读取打开时的各个文件 (及覆盖规则) 并原子替换索引; 正在进行的查询继续使用旧索引,
+ * 失败时保留旧索引并返回错误码 */
+MC_API mc_status mc_db_reload(mc_db* db);
+
+/* 释放句柄, 传入 NULL 时不做任何事 */
+MC_API void mc_db_close(mc_db* db);
+
+/* 数据库中可按文件名匹配的名称数 (含别名) */
+MC_API size_t mc_db_size(const mc_db* db);
+
+/*
+ * 对单个文件名 (例如 "jei-1.20.1-forge-15.2.0.27.jar") 分类。
+ * clean_name 非 NULL 时写入清理后的名称 (必要时截断, 总是以 '\0' 结尾)。
+ */
+MC_API mc_mod_type mc_classify_name(const mc_db* db, const char* file_name,
+                                    char* clean_name, size_t clean_name_size);
+
+/*
+ * 按 jar 描述文件中的 mod ID (例如 "jei") 精确查找, 只匹配数据库中带 modid 的条目, 不区分大小写。
+ */
+MC_API mc_mod_type mc_classify_modid(const mc_db* db, const char* mod_id);
+
+/* 对 count 个文件名批量分类, 结果写入 out_types[0..count) */
+MC_API mc_status mc_classify_batch(const mc_db* db, const char* const* file_names, size_t count,
+                                   mc_mod_type* out_types);
+
+/* 将 input_dir 中的 Mod 按类型复制到 output_dir 的子目录, out_stats 可以为 NULL */
+MC_API mc_status mc_classify_dir(const mc_db* db, const char* input_dir, const char* output_dir,
+                                 mc_dir_stats* out_stats);
+
+/* 类型对应的 JSON 字符串 (例如 "client_only"), MC_TYPE_NOT_FOUND 返回 "not_found" */
+MC_API const char* mc_mod_type_name(mc_mod_type type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MODCLASSIFIER_H */
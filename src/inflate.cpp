@@ -0,0 +1,470 @@
+#include "inflate.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// 解码方式与 zlib 的 inflate_fast 类似: 每次从 64 位缓冲中取一级表索引位数查表,
+// 码长超过一级表位数时再查一次子表; 一次补充缓冲后足够解出一个完整的长度-距离对。
+
+namespace {
+
+constexpr int MAX_BITS = 15;       // Huffman 码的最大长度
+constexpr int MAX_LITLEN = 286;    // 字面量/长度码个数
+constexpr int MAX_DIST = 30;       // 距离码个数
+constexpr int FIXED_LITLEN = 288;  // 固定 Huffman 表中的字面量/长度码个数 (含两个保留码)
+constexpr int FIXED_DIST = 32;
+
+constexpr int LITLEN_ROOT_BITS = 9;
+constexpr int DIST_ROOT_BITS = 6;
+constexpr int CODELEN_ROOT_BITS = 7;
+// 一级表加上所有子表的上限, 留有余量; 建表时越界视为数据损坏
+constexpr size_t LITLEN_TABLE_SIZE = 2048;
+constexpr size_t DIST_TABLE_SIZE = 1024;
+constexpr size_t CODELEN_TABLE_SIZE = 1 << CODELEN_ROOT_BITS;
+
+// 超过这个大小的线程窗口缓冲区在下次使用前释放, 避免个别大条目长期占用内存
+constexpr size_t MAX_RETAINED_WINDOW = 4 * 1024 * 1024;
+
+// --- 表项格式 ---
+// 高 16 位为值, 8-15 位为操作, 低 8 位为需要消耗的位数
+enum : uint32_t {
+    OP_LITERAL = 0x00, // 值为字节
+    OP_BASE = 0x10,    // 值为长度/距离基数, 低 4 位为额外位数
+    OP_END = 0x20,     // 块结束
+    OP_LINK = 0x40,    // 值为子表偏移, 低 4 位为子表索引位数
+    OP_INVALID = 0x80
+};
+
+constexpr uint32_t makeEntry(uint32_t value, uint32_t op, uint32_t bits) {
+    return (value << 16) | (op << 8) | bits;
+}
+constexpr uint32_t entryBits(uint32_t entry) { return entry & 0xFF; }
+constexpr uint32_t entryOp(uint32_t entry) { return (entry >> 8) & 0xFF; }
+constexpr uint32_t entryValue(uint32_t entry) { return entry >> 16; }
+
+const uint16_t LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const uint16_t DIST_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+                                193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+                                6145, 8193, 12289, 16385, 24577};
+const uint8_t DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+// 动态块中码长码的传输顺序
+const uint8_t CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// --- 辅助函数：每个符号对应的表项 (不含位数) ---
+struct SymbolTables {
+    uint32_t litlen[FIXED_LITLEN];
+    uint32_t dist[FIXED_DIST];
+    uint32_t codelen[19];
+};
+
+const SymbolTables& symbolTables() {
+    static const SymbolTables tables = [] {
+        SymbolTables t{};
+        for (int s = 0; s < FIXED_LITLEN; ++s) {
+            if (s < 256) {
+                t.litlen[s] = makeEntry(static_cast<uint32_t>(s), OP_LITERAL, 0);
+            } else if (s == 256) {
+                t.litlen[s] = makeEntry(0, OP_END, 0);
+            } else if (s < 257 + 29) {
+                t.litlen[s] = makeEntry(LENGTH_BASE[s - 257], OP_BASE | LENGTH_EXTRA[s - 257], 0);
+            } else {
+                t.litlen[s] = makeEntry(0, OP_INVALID, 0);
+            }
+        }
+        for (int s = 0; s < FIXED_DIST; ++s) {
+            t.dist[s] = s < MAX_DIST ? makeEntry(DIST_BASE[s], OP_BASE | DIST_EXTRA[s], 0) : makeEntry(0, OP_INVALID, 0);
+        }
+        for (int s = 0; s < 19; ++s) t.codelen[s] = makeEntry(static_cast<uint32_t>(s), OP_LITERAL, 0);
+        return t;
+    }();
+    return tables;
+}
+
+uint32_t reverseBits(uint32_t code, int length) {
+    uint32_t result = 0;
+    for (int i = 0; i < length; ++i) {
+        result = (result << 1) | (code & 1);
+        code >>= 1;
+    }
+    return result;
+}
+
+// --- 辅助函数：由码长构建解码表 ---
+// DEFLATE 的码按最高位先发送, 而位缓冲从最低位取, 所以表索引是反转后的码。
+// 码长不超过 rootBits 的码在一级表中重复填充; 更长的码按前 rootBits 位分组, 每组一个子表,
+// 子表大小按 zlib 的方法由剩余各长度码的个数确定。超额的码返回 false, 不完整的码留下无效表项。
+bool buildTable(uint32_t* table, size_t capacity, int rootBits, const uint8_t* lengths, int n,
+                const uint32_t* symbolEntries) {
+    uint16_t count[MAX_BITS + 1] = {};
+    for (int s = 0; s < n; ++s) count[lengths[s]]++;
+
+    const size_t rootSize = size_t{1} << rootBits;
+    const uint32_t invalid = makeEntry(0, OP_INVALID, static_cast<uint32_t>(rootBits));
+    std::fill(table, table + rootSize, invalid);
+    if (count[0] == n) return true; // 没有任何码, 只要不被使用就是合法的
+
+    int left = 1;
+    for (int len = 1; len <= MAX_BITS; ++len) {
+        left <<= 1;
+        left -= count[len];
+        if (left < 0) return false;
+    }
+
+    uint16_t offsets[MAX_BITS + 2] = {};
+    for (int len = 1; len <= MAX_BITS; ++len) offsets[len + 1] = static_cast<uint16_t>(offsets[len] + count[len]);
+    uint16_t sorted[FIXED_LITLEN];
+    for (int s = 0; s < n; ++s) {
+        if (lengths[s] != 0) sorted[offsets[lengths[s]]++] = static_cast<uint16_t>(s);
+    }
+
+    uint16_t remaining[MAX_BITS + 1];
+    std::copy(count, count + MAX_BITS + 1, remaining);
+    size_t used = rootSize;
+    uint32_t currentPrefix = UINT32_MAX;
+    size_t subtable = 0;
+    int subBits = 0;
+    uint32_t code = 0;
+    int index = 0;
+    for (int len = 1; len <= MAX_BITS; ++len, code <<= 1) {
+        for (int k = 0; k < count[len]; ++k, ++code, --remaining[len]) {
+            uint16_t symbol = sorted[index++];
+            uint32_t reversed = reverseBits(code, len);
+            if (len <= rootBits) {
+                uint32_t entry = symbolEntries[symbol] | static_cast<uint32_t>(len);
+                for (size_t i = reversed; i < rootSize; i += size_t{1} << len) table[i] = entry;
+                continue;
+            }
+
+            uint32_t prefix = reversed & static_cast<uint32_t>(rootSize - 1);
+            if (prefix != currentPrefix) {
+                // 新的子表: 位数至少能容纳当前长度, 且足够放下同一前缀下剩余的更长的码
+                int bits = len - rootBits;
+                int slots = 1 << bits;
+                while (bits + rootBits < MAX_BITS) {
+                    slots -= remaining[bits + rootBits];
+                    if (slots <= 0) break;
+                    ++bits;
+                    slots <<= 1;
+                }
+                subBits = bits;
+                subtable = used;
+                used += size_t{1} << subBits;
+                if (used > capacity) return false;
+                std::fill(table + subtable, table + used, makeEntry(0, OP_INVALID, static_cast<uint32_t>(subBits)));
+                table[prefix] = makeEntry(static_cast<uint32_t>(subtable), OP_LINK | static_cast<uint32_t>(subBits),
+                                          static_cast<uint32_t>(rootBits));
+                currentPrefix = prefix;
+            }
+            int drop = len - rootBits;
+            uint32_t entry = symbolEntries[symbol] | static_cast<uint32_t>(drop);
+            for (size_t i = reversed >> rootBits; i < (size_t{1} << subBits); i += size_t{1} << drop) {
+                table[subtable + i] = entry;
+            }
+        }
+    }
+    return true;
+}
+
+// 输入在数据流结束之前用完时抛出, 在入口函数中转换为 Truncated
+struct InputExhausted {};
+
+class Decoder {
+public:
+    // 从 output[start] 开始写入; output 中 start 之后已有的内容只当作可用空间
+    Decoder(const unsigned char* input, size_t inputSize, std::string& output, size_t start, size_t maxOutput)
+        : in(input), inSize(inputSize), out(output), outStart(start), outPos(start),
+          outLimit(maxOutput > SIZE_MAX - start ? SIZE_MAX : start + maxOutput),
+          writeEnd(std::min(output.size(), outLimit)) {}
+
+    void setStopCheck(const InflateStopCheck* check, size_t interval) {
+        stopCheck = check;
+        checkInterval = std::max<size_t>(interval, 1);
+        nextCheck = check ? outStart + checkInterval : SIZE_MAX;
+    }
+
+    // 初始输出空间的估计, 按需增长
+    void reserveHint(size_t bytes) {
+        size_t wanted = std::min(outLimit, outStart + bytes);
+        if (out.size() < wanted) out.resize(wanted);
+        writeEnd = std::min(out.size(), outLimit);
+    }
+
+    size_t produced() const { return outPos - outStart; }
+    size_t end() const { return outPos; }
+
+    InflateStatus run() {
+        int last;
+        do {
+            refill();
+            last = static_cast<int>(take(1));
+            uint32_t type = take(2);
+            InflateStatus status;
+            if (type == 0) {
+                status = stored();
+            } else if (type == 1) {
+                const FixedTables& fixed = fixedTables();
+                status = codes(fixed.litlen, fixed.dist);
+            } else if (type == 2) {
+                status = dynamic();
+            } else {
+                return InflateStatus::Corrupt;
+            }
+            if (status != InflateStatus::Ok) return status;
+        } while (!last);
+        // 补出的 0 位恰好解码成块结束符时, 数据流实际上并不完整
+        if (overrun * 8 > bitCount) return InflateStatus::Truncated;
+        return InflateStatus::Ok;
+    }
+
+private:
+    struct FixedTables {
+        uint32_t litlen[LITLEN_TABLE_SIZE];
+        uint32_t dist[DIST_TABLE_SIZE];
+    };
+
+    static const FixedTables& fixedTables() {
+        static const FixedTables* tables = [] {
+            static FixedTables t;
+            uint8_t lengths[FIXED_LITLEN];
+            int s = 0;
+            for (; s < 144; ++s) lengths[s] = 8;
+            for (; s < 256; ++s) lengths[s] = 9;
+            for (; s < 280; ++s) lengths[s] = 7;
+            for (; s < FIXED_LITLEN; ++s) lengths[s] = 8;
+            buildTable(t.litlen, LITLEN_TABLE_SIZE, LITLEN_ROOT_BITS, lengths, FIXED_LITLEN, symbolTables().litlen);
+            std::fill(lengths, lengths + FIXED_DIST, uint8_t{5});
+            buildTable(t.dist, DIST_TABLE_SIZE, DIST_ROOT_BITS, lengths, FIXED_DIST, symbolTables().dist);
+            return &t;
+        }();
+        return *tables;
+    }
+
+    // 补充位缓冲到至少 57 位; 输入用完后补 0, 真正用到补出的位时视为截断
+    void refill() {
+        if (inSize - inPos >= 8) {
+            while (bitCount <= 56) {
+                bitBuffer |= static_cast<uint64_t>(in[inPos++]) << bitCount;
+                bitCount += 8;
+            }
+            return;
+        }
+        while (bitCount <= 56) {
+            if (inPos < inSize) {
+                bitBuffer |= static_cast<uint64_t>(in[inPos++]) << bitCount;
+            } else {
+                ++overrun;
+            }
+            bitCount += 8;
+        }
+        if (overrun * 8 > bitCount) throw InputExhausted{};
+    }
+
+    uint32_t take(uint32_t bits) {
+        uint32_t value = static_cast<uint32_t>(bitBuffer & ((uint64_t{1} << bits) - 1));
+        bitBuffer >>= bits;
+        bitCount -= bits;
+        return value;
+    }
+
+    // 查表解码一个符号, 返回消耗位数之后的表项
+    uint32_t decode(const uint32_t* table, int rootBits) {
+        uint32_t entry = table[bitBuffer & ((uint64_t{1} << rootBits) - 1)];
+        if (entryOp(entry) & OP_LINK) {
+            take(entryBits(entry));
+            uint32_t subBits = entryOp(entry) & 0x0F;
+            entry = table[entryValue(entry) + (bitBuffer & ((uint64_t{1} << subBits) - 1))];
+        }
+        take(entryBits(entry));
+        return entry;
+    }
+
+    // 确保还能写入 n 字节, 超过 maxOutput 时返回能写入的字节数
+    size_t ensure(size_t n) {
+        size_t available = outLimit - outPos;
+        if (n > available) n = available;
+        if (outPos + n > out.size()) {
+            size_t grown = std::max(outPos + n, out.size() + (out.size() - outStart) + 1024);
+            out.resize(std::min(grown, outLimit));
+        }
+        writeEnd = std::min(out.size(), outLimit);
+        return n;
+    }
+
+    bool checkpoint() {
+        nextCheck = outPos + checkInterval;
+        return (*stopCheck)(std::string_view(out.data() + outStart, outPos - outStart));
+    }
+
+    InflateStatus stored() {
+        // 丢弃到字节边界为止的位, 再把位缓冲中预读的整字节退回输入
+        take(bitCount & 7);
+        size_t buffered = bitCount / 8;
+        size_t virtualBytes = std::min(overrun, buffered);
+        overrun -= virtualBytes;
+        inPos -= buffered - virtualBytes;
+        bitBuffer = 0;
+        bitCount = 0;
+        if (overrun > 0 || inSize - inPos < 4) throw InputExhausted{};
+
+        size_t len = in[inPos] | (in[inPos + 1] << 8);
+        size_t nlen = in[inPos + 2] | (in[inPos + 3] << 8);
+        inPos += 4;
+        if (len != (~nlen & 0xFFFF)) return InflateStatus::Corrupt;
+        if (inSize - inPos < len) throw InputExhausted{};
+
+        // 存储块最长 64 KB, 分段复制, 让提前结束的判断不必等到整块复制完
+        while (len > 0) {
+            size_t chunk = std::min(len, nextCheck > outPos ? nextCheck - outPos : len);
+            size_t room = ensure(chunk);
+            std::memcpy(&out[outPos], in + inPos, room);
+            outPos += room;
+            inPos += room;
+            len -= room;
+            if (room < chunk) return InflateStatus::OutputLimit;
+            if (outPos >= nextCheck && checkpoint()) return InflateStatus::Stopped;
+        }
+        return InflateStatus::Ok;
+    }
+
+    InflateStatus codes(const uint32_t* litlen, const uint32_t* dist) {
+        for (;;) {
+            if (outPos >= nextCheck && checkpoint()) return InflateStatus::Stopped;
+            refill();
+            uint32_t entry = decode(litlen, LITLEN_ROOT_BITS);
+            uint32_t op = entryOp(entry);
+            if (op == OP_LITERAL) {
+                if (outPos == writeEnd && ensure(1) == 0) return InflateStatus::OutputLimit;
+                out[outPos++] = static_cast<char>(entryValue(entry));
+                continue;
+            }
+            if (op == OP_END) return InflateStatus::Ok;
+            if (!(op & OP_BASE)) return InflateStatus::Corrupt;
+
+            size_t length = entryValue(entry) + take(op & 0x0F);
+            entry = decode(dist, DIST_ROOT_BITS);
+            op = entryOp(entry);
+            if (!(op & OP_BASE) || (op & (OP_LINK | OP_INVALID))) return InflateStatus::Corrupt;
+            size_t distance = entryValue(entry) + take(op & 0x0F);
+            if (distance > outPos - outStart) return InflateStatus::Corrupt;
+
+            size_t room = ensure(length);
+            char* dst = &out[outPos];
+            const char* src = dst - distance;
+            if (distance >= room) {
+                std::memcpy(dst, src, room);
+            } else if (distance == 1) {
+                std::memset(dst, *src, room);
+            } else {
+                // 复制区间与输出重叠, 必须按顺序逐字节复制
+                for (size_t i = 0; i < room; ++i) dst[i] = src[i];
+            }
+            outPos += room;
+            if (room < length) return InflateStatus::OutputLimit;
+        }
+    }
+
+    InflateStatus dynamic() {
+        refill();
+        int nlen = static_cast<int>(take(5)) + 257;
+        int ndist = static_cast<int>(take(5)) + 1;
+        int ncode = static_cast<int>(take(4)) + 4;
+        if (nlen > MAX_LITLEN || ndist > MAX_DIST) return InflateStatus::Corrupt;
+
+        uint8_t lengths[MAX_LITLEN + MAX_DIST] = {};
+        refill();
+        for (int i = 0; i < ncode; ++i) lengths[CODE_LENGTH_ORDER[i]] = static_cast<uint8_t>(take(3));
+        uint32_t codelenTable[CODELEN_TABLE_SIZE];
+        if (!buildTable(codelenTable, CODELEN_TABLE_SIZE, CODELEN_ROOT_BITS, lengths, 19, symbolTables().codelen)) {
+            return InflateStatus::Corrupt;
+        }
+
+        int index = 0;
+        while (index < nlen + ndist) {
+            refill();
+            uint32_t entry = decode(codelenTable, CODELEN_ROOT_BITS);
+            if (entryOp(entry) != OP_LITERAL) return InflateStatus::Corrupt;
+            uint32_t symbol = entryValue(entry);
+            if (symbol < 16) {
+                lengths[index++] = static_cast<uint8_t>(symbol);
+                continue;
+            }
+            uint8_t repeated = 0;
+            int repeat;
+            if (symbol == 16) {
+                if (index == 0) return InflateStatus::Corrupt;
+                repeated = lengths[index - 1];
+                repeat = 3 + static_cast<int>(take(2));
+            } else if (symbol == 17) {
+                repeat = 3 + static_cast<int>(take(3));
+            } else {
+                repeat = 11 + static_cast<int>(take(7));
+            }
+            if (index + repeat > nlen + ndist) return InflateStatus::Corrupt;
+            while (repeat--) lengths[index++] = repeated;
+        }
+        if (lengths[256] == 0) return InflateStatus::Corrupt; // 没有块结束符
+
+        if (!buildTable(litlenTable, LITLEN_TABLE_SIZE, LITLEN_ROOT_BITS, lengths, nlen, symbolTables().litlen) ||
+            !buildTable(distTable, DIST_TABLE_SIZE, DIST_ROOT_BITS, lengths + nlen, ndist, symbolTables().dist)) {
+            return InflateStatus::Corrupt;
+        }
+        return codes(litlenTable, distTable);
+    }
+
+    const unsigned char* in;
+    size_t inSize;
+    size_t inPos = 0;
+    uint64_t bitBuffer = 0;
+    uint32_t bitCount = 0;
+    size_t overrun = 0; // 输入用完后补出的 0 字节数
+
+    std::string& out;
+    size_t outStart;
+    size_t outPos;
+    size_t outLimit;
+    size_t writeEnd; // min(out.size(), outLimit), 写字面量时只需与它比较
+
+    const InflateStopCheck* stopCheck = nullptr;
+    size_t checkInterval = SIZE_MAX;
+    size_t nextCheck = SIZE_MAX;
+
+    uint32_t litlenTable[LITLEN_TABLE_SIZE];
+    uint32_t distTable[DIST_TABLE_SIZE];
+};
+
+InflateStatus runDecoder(Decoder& decoder) {
+    try {
+        return decoder.run();
+    } catch (const InputExhausted&) {
+        return InflateStatus::Truncated;
+    }
+}
+
+} // namespace
+
+InflateStatus inflateRaw(const unsigned char* input, size_t inputSize, std::string& output, size_t maxOutput) {
+    Decoder decoder(input, inputSize, output, output.size(), maxOutput);
+    // 元数据条目的压缩率一般在 2-4 倍, 先按 4 倍预留
+    decoder.reserveHint(inputSize > SIZE_MAX / 4 ? SIZE_MAX : inputSize * 4 + 64);
+    InflateStatus status = runDecoder(decoder);
+    output.resize(decoder.end());
+    return status;
+}
+
+InflateResult inflateToWindow(const unsigned char* input, size_t inputSize, size_t maxOutput,
+                              const InflateStopCheck& shouldStop, size_t checkInterval) {
+    // 窗口缓冲区的长度只增不减, 每次从头覆盖写入, 实际长度由 decoder.end() 给出, 省去清零和分配
+    thread_local std::string window;
+    if (window.size() > MAX_RETAINED_WINDOW) std::string().swap(window);
+
+    Decoder decoder(input, inputSize, window, 0, maxOutput);
+    decoder.reserveHint(inputSize > SIZE_MAX / 4 ? SIZE_MAX : inputSize * 4 + 64);
+    if (shouldStop) decoder.setStopCheck(&shouldStop, checkInterval);
+    InflateStatus status = runDecoder(decoder);
+    return {status, std::string_view(window.data(), decoder.end())};
+}
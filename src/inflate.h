@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// --- DEFLATE 解压 (RFC 1951) ---
+// 只处理原始 DEFLATE 数据流 (zip 中 method 8 的条目), 不含 zlib/gzip 头。
+// 使用查表解码 Huffman 码 (一级表 + 子表), 不依赖 zlib。
+
+enum class InflateStatus {
+    Ok,
+    Stopped,      // 调用方要求提前结束
+    OutputLimit,  // 解压结果超过 maxOutput, 输出中保留前 maxOutput 字节
+    Truncated,    // 输入在数据流结束之前用完
+    Corrupt       // 数据流格式错误
+};
+
+// 解压 input 追加到 output, 最多输出 maxOutput 字节
+InflateStatus inflateRaw(const unsigned char* input, size_t inputSize, std::string& output, size_t maxOutput);
+
+// 提前结束的判断: 参数为目前为止解压出的全部数据, 返回 true 表示需要的内容已经拿到
+using InflateStopCheck = std::function<bool(std::string_view produced)>;
+
+struct InflateResult {
+    InflateStatus status;
+    std::string_view data; // 指向当前线程复用的窗口缓冲区, 在本线程下一次调用前有效
+};
+
+// 解压到当前线程复用的缓冲区 (避免为每个小条目分配内存), 每产出约 checkInterval 字节调用一次
+// shouldStop; 它返回 true 时立即停止并返回 Stopped, 此时 data 是已解压的前缀
+InflateResult inflateToWindow(const unsigned char* input, size_t inputSize, size_t maxOutput,
+                              const InflateStopCheck& shouldStop = nullptr, size_t checkInterval = 512);
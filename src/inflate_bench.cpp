@@ -0,0 +1,212 @@
+#include "inflate_bench.h"
+
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include "inflate.h"
+#include "jar_metadata.h"
+#include "logger.h"
+#include "normalizer.h"
+#include "zip_reader.h"
+
+#ifdef MODCLASSIFIER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 参与测试的条目: 分类时读取的描述文件, 以及大多数 jar 都有的 mcmod.info / MANIFEST.MF
+constexpr std::string_view BENCH_ENTRY_NAMES[] = {"fabric.mod.json", "quilt.mod.json", "META-INF/mods.toml",
+                                                  "META-INF/neoforge.mods.toml", "mcmod.info",
+                                                  "META-INF/MANIFEST.MF"};
+
+// 超过这个大小的条目不是正常的描述文件, 不参与测试
+constexpr uint64_t MAX_BENCH_ENTRY_SIZE = 1024 * 1024;
+
+struct BenchEntry {
+    std::vector<unsigned char> compressed;
+    size_t uncompressedSize = 0;
+    uint32_t crc32 = 0;
+};
+
+// --- 辅助函数：收集目录中所有 jar 的 DEFLATE 描述文件 ---
+// 含描述文件的 jar 保持打开, 用于测量完整的元数据读取
+void collectEntries(const fs::path& directory, std::vector<BenchEntry>& entries,
+                    std::vector<std::unique_ptr<ZipReader>>& jars) {
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec) || !hasExtension(it->path().filename().string(), ".jar")) continue;
+        auto jar = std::make_unique<ZipReader>();
+        if (!jar->open(it->path())) continue;
+
+        bool hasEntry = false;
+        jar->forEachEntry([&](const ZipEntry& entry) {
+            for (std::string_view name : BENCH_ENTRY_NAMES) {
+                if (entry.name != name || entry.method != 8 || entry.isEncrypted() ||
+                    entry.uncompressedSize > MAX_BENCH_ENTRY_SIZE) {
+                    continue;
+                }
+                const unsigned char* raw = jar->rawData(entry);
+                if (raw == nullptr) continue;
+                BenchEntry sample;
+                sample.compressed.assign(raw, raw + entry.compressedSize);
+                sample.uncompressedSize = static_cast<size_t>(entry.uncompressedSize);
+                sample.crc32 = entry.crc32;
+                entries.push_back(std::move(sample));
+                hasEntry = true;
+            }
+            return true;
+        });
+        if (hasEntry) jars.push_back(std::move(jar));
+    }
+}
+
+// --- 辅助函数：测量平均每个条目的耗时 (纳秒) ---
+// 反复处理全部条目直到累计时间足够长以降低噪声, 取三轮最小值
+template <typename Body>
+double measureNanosPerItem(size_t itemCount, Body&& body) {
+    using clock = std::chrono::steady_clock;
+    double best = 0;
+    for (int round = 0; round < 3; ++round) {
+        size_t passes = 0;
+        auto start = clock::now();
+        auto elapsed = clock::duration::zero();
+        do {
+            body();
+            ++passes;
+            elapsed = clock::now() - start;
+        } while (elapsed < std::chrono::milliseconds(50));
+        double perItem = std::chrono::duration<double, std::nano>(elapsed).count() /
+                         static_cast<double>(passes * itemCount);
+        if (round == 0 || perItem < best) best = perItem;
+    }
+    return best;
+}
+
+void logResult(const std::string& label, double nanos, double averageBytes) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1) << "  " << label << ": 每个条目 " << nanos << " 纳秒, "
+       << averageBytes / nanos * 1000.0 << " MB/s";
+    logMessage(ss.str());
+}
+
+#ifdef MODCLASSIFIER_HAVE_ZLIB
+// --- 辅助函数：用 zlib 解压原始 DEFLATE 数据 ---
+// 复用同一个 z_stream, 与本程序复用窗口缓冲区的做法对等
+class ZlibInflater {
+public:
+    ZlibInflater() { ready = inflateInit2(&stream, -MAX_WBITS) == Z_OK; }
+    ~ZlibInflater() {
+        if (ready) inflateEnd(&stream);
+    }
+
+    bool run(const BenchEntry& entry, std::string& out) {
+        if (!ready || inflateReset(&stream) != Z_OK) return false;
+        out.resize(entry.uncompressedSize);
+        stream.next_in = const_cast<Bytef*>(entry.compressed.data());
+        stream.avail_in = static_cast<uInt>(entry.compressed.size());
+        stream.next_out = reinterpret_cast<Bytef*>(out.data());
+        stream.avail_out = static_cast<uInt>(out.size());
+        int status = ::inflate(&stream, Z_FINISH);
+        return status == Z_STREAM_END && stream.total_out == entry.uncompressedSize;
+    }
+
+private:
+    z_stream stream{};
+    bool ready = false;
+};
+#endif
+
+} // namespace
+
+// 运行基准测试, 解压结果全部正确时返回 true
+bool runInflateBenchmark(const fs::path& inputDirectory) {
+    std::vector<BenchEntry> entries;
+    std::vector<std::unique_ptr<ZipReader>> jars;
+    collectEntries(inputDirectory, entries, jars);
+    if (entries.empty()) {
+        logMessage("目录 '" + inputDirectory.string() + "' 中没有找到包含压缩描述文件的 jar。", true);
+        return false;
+    }
+
+    size_t totalBytes = 0;
+    size_t totalCompressed = 0;
+    for (const BenchEntry& entry : entries) {
+        totalBytes += entry.uncompressedSize;
+        totalCompressed += entry.compressed.size();
+    }
+    double averageBytes = static_cast<double>(totalBytes) / static_cast<double>(entries.size());
+    {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(1) << "解压基准测试: " << jars.size() << " 个 jar, " << entries.size()
+           << " 个条目, 平均 " << averageBytes << " 字节, 压缩率 "
+           << static_cast<double>(totalBytes) / static_cast<double>(totalCompressed);
+        logMessage(ss.str());
+    }
+
+    // 先校验: 两种接口的输出都要与 CRC 一致, 有 zlib 时再逐字节比较
+    size_t failures = 0;
+    std::string output;
+#ifdef MODCLASSIFIER_HAVE_ZLIB
+    ZlibInflater zlib;
+    std::string reference;
+#endif
+    for (const BenchEntry& entry : entries) {
+        output.clear();
+        bool ok = inflateRaw(entry.compressed.data(), entry.compressed.size(), output, entry.uncompressedSize) ==
+                          InflateStatus::Ok &&
+                  output.size() == entry.uncompressedSize &&
+                  zipCrc32(0, reinterpret_cast<const unsigned char*>(output.data()), output.size()) == entry.crc32;
+        InflateResult window = inflateToWindow(entry.compressed.data(), entry.compressed.size(), entry.uncompressedSize);
+        ok = ok && window.status == InflateStatus::Ok && window.data == output;
+#ifdef MODCLASSIFIER_HAVE_ZLIB
+        ok = ok && zlib.run(entry, reference) && reference == output;
+#endif
+        if (!ok) ++failures;
+    }
+    if (failures > 0) {
+        logMessage("解压基准测试: " + std::to_string(failures) + " 个条目的解压结果不正确。", true);
+        return false;
+    }
+
+    double freshNanos = measureNanosPerItem(entries.size(), [&] {
+        for (const BenchEntry& entry : entries) {
+            std::string fresh;
+            inflateRaw(entry.compressed.data(), entry.compressed.size(), fresh, entry.uncompressedSize);
+        }
+    });
+    logResult("inflateRaw (每次新分配)", freshNanos, averageBytes);
+
+    double windowNanos = measureNanosPerItem(entries.size(), [&] {
+        for (const BenchEntry& entry : entries) {
+            inflateToWindow(entry.compressed.data(), entry.compressed.size(), entry.uncompressedSize);
+        }
+    });
+    logResult("inflateToWindow (复用窗口)", windowNanos, averageBytes);
+
+#ifdef MODCLASSIFIER_HAVE_ZLIB
+    double zlibNanos = measureNanosPerItem(entries.size(), [&] {
+        for (const BenchEntry& entry : entries) zlib.run(entry, reference);
+    });
+    logResult("zlib (复用 z_stream)", zlibNanos, averageBytes);
+#else
+    logMessage("  构建时没有找到 zlib, 跳过对比。");
+#endif
+
+    // 完整的元数据读取: 查找描述文件, 解压到读出 mod ID 和运行环境为止
+    double metadataNanos = measureNanosPerItem(jars.size(), [&] {
+        JarMetadata metadata;
+        for (const auto& jar : jars) readJarMetadata(*jar, metadata);
+    });
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1) << "  readJarMetadata (提前停止): 每个 jar " << metadataNanos << " 纳秒";
+    logMessage(ss.str());
+    return true;
+}
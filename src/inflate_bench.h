@@ -0,0 +1,11 @@
+#pragma once
+
+#include <filesystem>
+
+// --- 元数据解压基准测试 ---
+// 从目录中的 jar 收集描述文件 (fabric.mod.json, mods.toml, MANIFEST.MF 等) 的压缩数据,
+// 先校验解压结果, 再比较 inflateRaw, inflateToWindow, 读取元数据时的提前停止
+// 以及 zlib (构建时找到 zlib 才会比较) 的单条目耗时。
+
+// 运行基准测试, 解压结果全部正确时返回 true
+bool runInflateBenchmark(const std::filesystem::path& inputDirectory);
@@ -0,0 +1,496 @@
+#include "jar_metadata.h"
+
+#include <string_view>
+#include <vector>
+#include "logger.h"
+#include "toml_scanner.h"
+
+namespace {
+
+// 描述文件不会很大, 超过这个大小的条目视为异常, 不解压
+constexpr size_t MAX_DESCRIPTOR_SIZE = 1024 * 1024;
+
+// --- 辅助函数：流式提取 JSON 中指定路径的字符串值 ---
+// 只跟踪对象嵌套和键名, 不校验语法, 因此也能读取字符串中含有未转义换行等
+// 加载器能容忍、但严格解析会失败的描述文件; 支持 // 和 /* */ 注释。
+// 可以对不断变长的同一段前缀反复调用 scan(), 每次从上次停下的位置继续,
+// 所有目标字段都找到后返回 true, 配合 inflateToWindow 在读到需要的字段后提前停止解压。
+// 另外可以收集列表: 指定路径上对象的所有键名 (例如 "depends"), 或数组中直接出现的字符串 (例如 "provides");
+// 有列表要收集时需要扫描完整个文档, 不会提前停止。
+class JsonFieldScanner {
+public:
+    // 路径用 '.' 连接各级键名, 例如 "minecraft.environment"; 数组中的值不会匹配
+    explicit JsonFieldScanner(std::vector<std::string> targetPaths, std::vector<std::string> listPaths = {})
+        : targets(std::move(targetPaths)), values(targets.size()), found(targets.size(), false),
+          lists(std::move(listPaths)), listValues(lists.size()) {}
+
+    // complete 为 true 表示 text 已是完整文档, 末尾的标量可以直接结束
+    bool scan(std::string_view text, bool complete) {
+        if (pos == 0 && text.size() >= 3 && text.compare(0, 3, "\xEF\xBB\xBF") == 0) pos = 3;
+        while (pos < text.size() && (remaining > 0 || !lists.empty())) {
+            size_t tokenStart = pos;
+            if (!step(text, complete)) {
+                pos = tokenStart; // 记号不完整, 等待更多数据
+                break;
+            }
+        }
+        return remaining == 0 && lists.empty();
+    }
+
+    // 未找到的字段为空字符串
+    const std::string& value(size_t index) const { return values[index]; }
+    // 第 index 个列表收集到的键名或字符串, 按出现顺序
+    const std::vector<std::string>& list(size_t index) const { return listValues[index]; }
+
+private:
+    struct Frame {
+        bool isObject;
+        bool expectingKey;
+        bool inArray;      // 本层或外层是数组, 计入 arrayDepth
+        size_t pathLength; // 进入这一层之前 path 的长度
+        int listIndex;     // 这一层的键名 (对象) 或字符串元素 (数组) 属于第几个列表, -1 表示不收集
+    };
+
+    bool step(std::string_view text, bool complete) {
+        char c = text[pos];
+        switch (c) {
+            case ' ': case '\t': case '\r': case '\n': case ',':
+                ++pos;
+                return true;
+            case ':':
+                ++pos;
+                return true;
+            case '/':
+                return skipComment(text);
+            case '{':
+            case '[': {
+                ++pos;
+                // 对象的路径为父级路径加上当前键名, 数组中的内容不参与匹配
+                bool inArray = c == '[' || arrayDepth > 0;
+                int listIndex = arrayDepth == 0 && !frames.empty() ? findList() : -1;
+                frames.push_back({c == '{', c == '{', inArray, path.size(), listIndex});
+                if (inArray) ++arrayDepth;
+                else if (frames.size() > 1) appendKey();
+                return true;
+            }
+            case '}':
+            case ']':
+                ++pos;
+                if (frames.empty()) return true;
+                if (frames.back().inArray) --arrayDepth;
+                path.resize(frames.back().pathLength);
+                frames.pop_back();
+                valueDone();
+                return true;
+            case '"': {
+                std::string_view raw;
+                bool escaped = false;
+                if (!readString(text, raw, escaped)) return false;
+                if (!frames.empty() && frames.back().isObject && frames.back().expectingKey) {
+                    key.assign(raw);
+                    frames.back().expectingKey = false;
+                    collect(escaped ? unescape(raw) : std::string(raw));
+                } else if (!frames.empty() && !frames.back().isObject) {
+                    collect(escaped ? unescape(raw) : std::string(raw));
+                } else {
+                    matchValue(raw, escaped);
+                    valueDone();
+                }
+                return true;
+            }
+            default: {
+                // 数字、true/false/null 等标量, 不需要取值, 跳到分隔符即可
+                size_t end = pos;
+                while (end < text.size() && text[end] != ',' && text[end] != '}' && text[end] != ']' &&
+                       text[end] != ' ' && text[end] != '\n' && text[end] != '\r' && text[end] != '\t') {
+                    ++end;
+                }
+                if (end == text.size() && !complete) return false;
+                pos = end;
+                valueDone();
+                return true;
+            }
+        }
+    }
+
+    bool skipComment(std::string_view text) {
+        if (pos + 1 >= text.size()) return false;
+        if (text[pos + 1] == '/') {
+            size_t end = text.find('\n', pos);
+            if (end == std::string_view::npos) return false;
+            pos = end + 1;
+        } else if (text[pos + 1] == '*') {
+            size_t end = text.find("*/", pos + 2);
+            if (end == std::string_view::npos) return false;
+            pos = end + 2;
+        } else {
+            ++pos;
+        }
+        return true;
+    }
+
+    bool readString(std::string_view text, std::string_view& raw, bool& escaped) {
+        // 长字符串 (例如 description) 可能跨越多次 scan(), 从上次扫描到的位置继续找结尾引号
+        size_t p = pendingString > pos ? pendingString : pos + 1;
+        escaped = pendingEscaped;
+        while (p < text.size() && text[p] != '"') {
+            if (text[p] == '\\') {
+                if (p + 1 >= text.size()) break;
+                escaped = true;
+                ++p;
+            }
+            ++p;
+        }
+        if (p >= text.size() || text[p] != '"') {
+            pendingString = p;
+            pendingEscaped = escaped;
+            return false;
+        }
+        pendingString = 0;
+        pendingEscaped = false;
+        raw = text.substr(pos + 1, p - pos - 1);
+        pos = p + 1;
+        return true;
+    }
+
+    void appendKey() {
+        if (!path.empty()) path.push_back('.');
+        path += key;
+    }
+
+    void matchValue(std::string_view raw, bool escaped) {
+        if (frames.empty() || !frames.back().isObject || arrayDepth > 0) return;
+        size_t base = path.size();
+        appendKey();
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (found[i] || path != targets[i]) continue;
+            values[i] = escaped ? unescape(raw) : std::string(raw);
+            found[i] = true;
+            --remaining;
+        }
+        path.resize(base);
+    }
+
+    // 当前键对应的值 (即将进入的对象或数组) 是否是要收集的列表
+    int findList() {
+        if (lists.empty() || !frames.back().isObject) return -1;
+        size_t base = path.size();
+        appendKey();
+        int index = -1;
+        for (size_t i = 0; i < lists.size() && index < 0; ++i) {
+            if (path == lists[i]) index = static_cast<int>(i);
+        }
+        path.resize(base);
+        return index;
+    }
+
+    // 只收集直接位于列表对象或数组中的字符串, 更深层的不收集
+    void collect(std::string text) {
+        if (frames.back().listIndex >= 0) listValues[frames.back().listIndex].push_back(std::move(text));
+    }
+
+    void valueDone() {
+        if (!frames.empty() && frames.back().isObject) frames.back().expectingKey = true;
+    }
+
+    static std::string unescape(std::string_view raw) {
+        std::string result;
+        result.reserve(raw.size());
+        for (size_t i = 0; i < raw.size(); ++i) {
+            if (raw[i] != '\\' || i + 1 >= raw.size()) {
+                result.push_back(raw[i]);
+                continue;
+            }
+            char e = raw[++i];
+            switch (e) {
+                case 'n': result.push_back('\n'); break;
+                case 't': result.push_back('\t'); break;
+                case 'r': result.push_back('\r'); break;
+                case 'b': result.push_back('\b'); break;
+                case 'f': result.push_back('\f'); break;
+                default: result.push_back(e); break; // \" \\ \/ 以及不处理的 \u
+            }
+        }
+        return result;
+    }
+
+    std::vector<std::string> targets;
+    std::vector<std::string> values;
+    std::vector<bool> found;
+    std::vector<std::string> lists;
+    std::vector<std::vector<std::string>> listValues;
+    size_t remaining = targets.size();
+    size_t pos = 0;
+    size_t pendingString = 0; // 未读完的字符串已扫描到的位置
+    bool pendingEscaped = false;
+    std::vector<Frame> frames;
+    size_t arrayDepth = 0; // 位于数组内 (或数组内的对象中) 的层数
+    std::string path;      // 当前对象的键名路径
+    std::string key;       // 最近读到的键名
+};
+
+// 游戏本体、Java 和加载器: 总是存在, 不作为依赖记录; mods.toml 中对它们的依赖声明的 side 就是 Mod 自身的运行端
+bool isPlatformMod(const std::string& modId) {
+    return modId == "minecraft" || modId == "java" || modId == "forge" || modId == "neoforge" ||
+           modId == "fabricloader" || modId == "quilt_loader";
+}
+
+// 读取 fabric.mod.json / quilt.mod.json, 拿到 mod ID 和运行环境后立即停止解压。
+// 读取依赖时 fabric 取 depends 对象的键名, quilt 取 depends 数组中的字符串 (对象形式的依赖不读取)
+bool readJsonDescriptor(const ZipReader& jar, const ZipEntry& entry, MetadataSource source, bool withDependencies,
+                        JarMetadata& metadata) {
+    bool isQuilt = source == MetadataSource::QuiltModJson;
+    std::vector<std::string> lists;
+    if (withDependencies) {
+        lists = isQuilt ? std::vector<std::string>{"quilt_loader.depends", "quilt_loader.provides"}
+                        : std::vector<std::string>{"depends", "provides"};
+    }
+    JsonFieldScanner scanner(isQuilt ? std::vector<std::string>{"quilt_loader.id", "minecraft.environment"}
+                                     : std::vector<std::string>{"id", "environment"},
+                             std::move(lists));
+    std::string_view text;
+    bool stopped = false;
+    if (!jar.extractToWindow(entry, MAX_DESCRIPTOR_SIZE, text, [&](std::string_view prefix) {
+            return stopped = scanner.scan(prefix, false);
+        })) {
+        return false;
+    }
+    if (!stopped) scanner.scan(text, true);
+
+    metadata.source = source;
+    metadata.modId = scanner.value(0);
+    std::string environment = scanner.value(1);
+    if (environment.empty()) environment = "*"; // 两种格式的默认值都是 "*"
+    metadata.evidence = "environment = " + environment;
+    metadata.type = environmentToModType(environment);
+    if (withDependencies) {
+        for (const std::string& modId : scanner.list(0)) {
+            if (!isPlatformMod(modId)) metadata.dependencies.push_back({modId, true, true});
+        }
+        metadata.providedIds = scanner.list(1);
+    }
+    return true;
+}
+
+std::string upperAscii(std::string_view text) {
+    std::string result(text);
+    for (char& c : result) {
+        if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+    }
+    return result;
+}
+
+// 读取 mods.toml / neoforge.mods.toml; 依赖声明在文件末尾, 需要完整解压
+bool readTomlDescriptor(const ZipReader& jar, const ZipEntry& entry, MetadataSource source, bool withDependencies,
+                        JarMetadata& metadata) {
+    std::string_view text;
+    if (!jar.extractToWindow(entry, MAX_DESCRIPTOR_SIZE, text)) return false;
+    metadata.source = source;
+    ModsTomlInfo info;
+    if (!parseModsToml(text, info)) return true; // 连 modId 都读不到的文件不可信, 不给出类型
+    metadata.modId = info.modId;
+    metadata.type = inferModsTomlType(info, metadata.evidence);
+    if (withDependencies) {
+        for (const auto& dependency : info.dependencies) {
+            if (!dependency.required || dependency.owner != info.modId || dependency.modId.empty() ||
+                isPlatformMod(dependency.modId)) {
+                continue;
+            }
+            metadata.dependencies.push_back(
+                {dependency.modId, dependency.side != "SERVER", dependency.side != "CLIENT"});
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool parseModsToml(std::string_view text, ModsTomlInfo& info) {
+    info = ModsTomlInfo{};
+    if (text.size() >= 3 && text.compare(0, 3, "\xEF\xBB\xBF") == 0) text.remove_prefix(3);
+
+    constexpr std::string_view DEPENDENCY_PREFIX = "dependencies.";
+    size_t firstModSerial = 0;        // 第一个 [[mods]] 的表头序号, 0 表示还没遇到
+    size_t dependencySerial = 0;      // 当前依赖对应的表头序号
+    TomlScanner scanner(text);
+    TomlField field;
+    while (scanner.next(field)) {
+        if (field.table.empty()) {
+            if (field.key == "clientSideOnly") info.clientSideOnly = field.value == "true";
+        } else if (field.table == "mods") {
+            // 一个 jar 可以声明多个 Mod, 以第一个为准
+            if (firstModSerial == 0) firstModSerial = field.tableSerial;
+            if (field.tableSerial != firstModSerial) continue;
+            if (field.key == "modId" && field.isString) info.modId = std::string(field.value);
+            if (field.key == "displayTest") info.displayTest = upperAscii(field.value);
+        } else if (field.table.substr(0, DEPENDENCY_PREFIX.size()) == DEPENDENCY_PREFIX) {
+            if (info.dependencies.empty() || field.tableSerial != dependencySerial) {
+                info.dependencies.emplace_back();
+                info.dependencies.back().owner = std::string(field.table.substr(DEPENDENCY_PREFIX.size()));
+                dependencySerial = field.tableSerial;
+            }
+            ModsTomlDependency& dependency = info.dependencies.back();
+            if (field.key == "modId") {
+                dependency.modId = std::string(field.value);
+            } else if (field.key == "mandatory") {
+                dependency.required = field.value == "true";
+            } else if (field.key == "type") {
+                dependency.required = upperAscii(field.value) == "REQUIRED";
+            } else if (field.key == "side") {
+                dependency.side = upperAscii(field.value);
+            }
+        }
+    }
+    return !info.modId.empty();
+}
+
+std::optional<ModType> inferModsTomlType(const ModsTomlInfo& info, std::string& evidence) {
+    if (info.clientSideOnly) {
+        evidence = "clientSideOnly = true";
+        return ModType::ClientOnly;
+    }
+    // 取值含义见 Forge MDK 模板中的说明:
+    // IGNORE_ALL_VERSION 用于没有服务端部分的 Mod, IGNORE_SERVER_VERSION 用于仅服务端的 Mod
+    if (info.displayTest == "IGNORE_ALL_VERSION") {
+        evidence = "displayTest = IGNORE_ALL_VERSION";
+        return ModType::ClientOnly;
+    }
+    if (info.displayTest == "IGNORE_SERVER_VERSION") {
+        evidence = "displayTest = IGNORE_SERVER_VERSION";
+        return ModType::ServerOnly;
+    }
+
+    bool clientSide = false;
+    bool serverSide = false;
+    bool bothSides = false;
+    for (const auto& dependency : info.dependencies) {
+        if (!dependency.required || dependency.owner != info.modId || !isPlatformMod(dependency.modId)) continue;
+        if (dependency.side == "CLIENT") {
+            clientSide = true;
+        } else if (dependency.side == "SERVER") {
+            serverSide = true;
+        } else {
+            bothSides = true;
+        }
+    }
+    if (clientSide && !serverSide && !bothSides) {
+        evidence = "依赖 side = CLIENT";
+        return ModType::ClientOnly;
+    }
+    if (serverSide && !clientSide && !bothSides) {
+        evidence = "依赖 side = SERVER";
+        return ModType::ServerOnly;
+    }
+
+    evidence = info.displayTest.empty() ? "displayTest 未声明" : "displayTest = " + info.displayTest;
+    return ModType::ClientAndServerRequired;
+}
+
+const char* metadataSourceName(MetadataSource source) {
+    switch (source) {
+        case MetadataSource::FabricModJson: return "fabric.mod.json";
+        case MetadataSource::QuiltModJson: return "quilt.mod.json";
+        case MetadataSource::ForgeModsToml: return "mods.toml";
+        case MetadataSource::NeoForgeModsToml: return "neoforge.mods.toml";
+        default: return "无";
+    }
+}
+
+std::optional<ModType> environmentToModType(const std::string& environment) {
+    if (environment == "client") return ModType::ClientOnly;
+    if (environment == "server" || environment == "dedicated_server") return ModType::ServerOnly;
+    if (environment == "*") return ModType::ClientAndServerRequired;
+    return std::nullopt;
+}
+
+bool readJarMetadata(const ZipReader& jar, JarMetadata& metadata, bool withDependencies) {
+    metadata = JarMetadata{};
+
+    // 一次遍历中央目录同时查找所有描述文件, 数组下标即优先级
+    constexpr std::string_view DESCRIPTOR_NAMES[] = {"quilt.mod.json", "fabric.mod.json",
+                                                     "META-INF/neoforge.mods.toml", "META-INF/mods.toml"};
+    constexpr MetadataSource DESCRIPTOR_SOURCES[] = {MetadataSource::QuiltModJson, MetadataSource::FabricModJson,
+                                                     MetadataSource::NeoForgeModsToml, MetadataSource::ForgeModsToml};
+    constexpr size_t DESCRIPTOR_COUNT = sizeof(DESCRIPTOR_NAMES) / sizeof(DESCRIPTOR_NAMES[0]);
+    std::optional<ZipEntry> found[DESCRIPTOR_COUNT];
+    jar.forEachEntry([&](const ZipEntry& entry) {
+        for (size_t i = 0; i < DESCRIPTOR_COUNT; ++i) {
+            if (entry.name != DESCRIPTOR_NAMES[i]) continue;
+            found[i] = entry;
+            return i != 0; // 最高优先级的已找到, 不必再看后面的条目
+        }
+        return true;
+    });
+
+    for (size_t i = 0; i < DESCRIPTOR_COUNT; ++i) {
+        if (!found[i]) continue;
+        MetadataSource source = DESCRIPTOR_SOURCES[i];
+        bool ok = source == MetadataSource::QuiltModJson || source == MetadataSource::FabricModJson
+                          ? readJsonDescriptor(jar, *found[i], source, withDependencies, metadata)
+                          : readTomlDescriptor(jar, *found[i], source, withDependencies, metadata);
+        if (ok) return true;
+        metadata = JarMetadata{};
+    }
+    return false;
+}
+
+bool readBundledMetadata(const NestedJarSet& nested, JarMetadata& metadata) {
+    metadata = JarMetadata{};
+    std::optional<JarMetadata> clientOnly;
+    std::optional<JarMetadata> serverOnly;
+    std::optional<JarMetadata> neutral;
+    for (size_t i = 0; i < nested.size(); ++i) {
+        JarMetadata declared;
+        if (!readJarMetadata(nested[i].reader, declared) || !declared.type) continue;
+        declared.nestedPath = nested[i].path;
+        std::optional<JarMetadata>& slot = *declared.type == ModType::ClientOnly   ? clientOnly
+                                           : *declared.type == ModType::ServerOnly ? serverOnly
+                                                                                   : neutral;
+        if (!slot) slot = std::move(declared);
+    }
+
+    if (clientOnly && serverOnly) {
+        metadata = *clientOnly;
+        metadata.type = ModType::ClientAndServerRequired;
+        metadata.evidence = "同时内嵌仅客户端的 " + clientOnly->nestedPath + " 和仅服务端的 " + serverOnly->nestedPath;
+    } else if (clientOnly || serverOnly || neutral) {
+        metadata = clientOnly ? *clientOnly : serverOnly ? *serverOnly : *neutral;
+        metadata.evidence = "内嵌 jar " + metadata.nestedPath + ", " + metadata.evidence;
+    } else {
+        return false;
+    }
+    // 容器本身不是内嵌的这个 Mod, 不用它的 mod ID 查数据库
+    metadata.modId.clear();
+    return true;
+}
+
+bool readJarOrBundledMetadata(const ZipReader& jar, const std::string& jarName, JarMetadata& metadata,
+                              bool withDependencies) {
+    bool declared = readJarMetadata(jar, metadata, withDependencies);
+    if (declared && !withDependencies) return true;
+
+    NestedJarSet nested;
+    nested.open(jar);
+    if (nested.limitReached()) {
+        logMessage("jar " + jarName + " 的内嵌 jar 超出深度或大小限制, 只展开了前 " + std::to_string(nested.size()) +
+                   " 个", true);
+    }
+    if (!declared && !readBundledMetadata(nested, metadata)) return false;
+    if (withDependencies) {
+        // 内嵌的库随这个 jar 一起加载, 依赖它们的 Mod 不需要另外安装
+        for (size_t i = 0; i < nested.size(); ++i) {
+            JarMetadata inner;
+            if (readJarMetadata(nested[i].reader, inner) && !inner.modId.empty()) {
+                metadata.providedIds.push_back(inner.modId);
+            }
+        }
+    }
+    return true;
+}
+
+bool readJarMetadata(const std::filesystem::path& jarPath, JarMetadata& metadata, bool withDependencies) {
+    metadata = JarMetadata{};
+    ZipReader jar;
+    if (!jar.open(jarPath)) return false;
+    return readJarOrBundledMetadata(jar, jarPath.filename().string(), metadata, withDependencies);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mod_info.h"
+#include "nested_jar.h"
+#include "zip_reader.h"
+
+// --- jar 内声明的 Mod 元数据 ---
+// 从 Mod 自带的描述文件中读取运行环境和 mod ID, 作为文件名匹配之外的分类依据
+
+enum class MetadataSource {
+    None,             // 没有可识别的描述文件
+    FabricModJson,    // fabric.mod.json
+    QuiltModJson,     // quilt.mod.json
+    ForgeModsToml,    // META-INF/mods.toml
+    NeoForgeModsToml  // META-INF/neoforge.mods.toml
+};
+
+// 描述文件中声明的必需依赖 (游戏本体和加载器除外)
+struct DeclaredDependency {
+    std::string modId;
+    bool client = true; // 这一端需要; mods.toml 的 side = CLIENT / SERVER 时只有一端
+    bool server = true;
+};
+
+struct JarMetadata {
+    MetadataSource source = MetadataSource::None;
+    std::string modId;
+    std::string evidence;        // 推出类型所依据的字段, 用于日志, 例如 "environment = client"
+    std::optional<ModType> type; // 推出的类型, 无法识别时为空
+    std::string nestedPath;      // 类型来自内嵌 jar 时为它在顶层 jar 中的路径
+    // 以下两项只在要求读取依赖时填写
+    std::vector<std::string> providedIds; // modId 之外同样满足依赖的 ID: provides 和内嵌 jar 的 mod ID
+    std::vector<DeclaredDependency> dependencies;
+};
+
+// --- mods.toml 中与运行端相关的字段 ---
+struct ModsTomlDependency {
+    std::string owner;     // [[dependencies.<owner>]] 中声明依赖的 Mod
+    std::string modId;     // 被依赖的 Mod
+    bool required = true;  // Forge 的 mandatory 或 NeoForge 的 type = "required"
+    std::string side = "BOTH";
+};
+
+struct ModsTomlInfo {
+    std::string modId;           // 第一个 [[mods]] 的 modId
+    std::string displayTest;     // 例如 MATCH_VERSION, IGNORE_SERVER_VERSION, IGNORE_ALL_VERSION
+    bool clientSideOnly = false; // 较新的 Forge 支持的顶层字段
+    std::vector<ModsTomlDependency> dependencies;
+};
+
+// 流式扫描 mods.toml 文本, 只提取上面的字段; 找不到 modId 时返回 false
+bool parseModsToml(std::string_view text, ModsTomlInfo& info);
+
+// 由 mods.toml 的字段推断类型, 依据依次为 clientSideOnly, displayTest, 对游戏本体/加载器的依赖的 side;
+// 都没有时按 Forge 的默认行为视为客户端和服务端都必装
+std::optional<ModType> inferModsTomlType(const ModsTomlInfo& info, std::string& evidence);
+
+// 描述文件的名称, 用于日志
+const char* metadataSourceName(MetadataSource source);
+
+// 把 fabric/quilt 的 environment 取值转换为 ModType:
+// client -> 仅客户端, server/dedicated_server -> 仅服务端, * -> 客户端和服务端都必装
+std::optional<ModType> environmentToModType(const std::string& environment);
+
+// 从已打开的 jar 中读取元数据, 只查一次中央目录并解压一个小条目; 没有可识别的描述文件时返回 false
+// 同时存在多种描述文件时的优先级: quilt.mod.json, fabric.mod.json, neoforge.mods.toml, mods.toml。
+// withDependencies 为 true 时同时读取 depends / [[dependencies]] 和 provides, 需要解压整个描述文件
+bool readJarMetadata(const ZipReader& jar, JarMetadata& metadata, bool withDependencies = false);
+
+// 由内嵌 jar 的描述文件推断容器 jar 的类型, 用于顶层没有描述文件的 jar (例如只打包了若干 Mod 的合集)。
+// 依赖库通常声明为双端, 因此只要内嵌的 Mod 中有仅客户端 (或仅服务端) 的, 且没有相反一端的, 就取这一端;
+// 两端都有时视为双端必装。没有任何内嵌描述文件时返回 false
+bool readBundledMetadata(const NestedJarSet& nested, JarMetadata& metadata);
+
+// 从已打开的 jar 读取元数据, 顶层没有描述文件时再展开内嵌 jar 查找; jarName 只用于日志。
+// withDependencies 为 true 时还会展开内嵌 jar, 把它们的 mod ID 计入 providedIds
+bool readJarOrBundledMetadata(const ZipReader& jar, const std::string& jarName, JarMetadata& metadata,
+                              bool withDependencies = false);
+
+// 打开 jar 文件并读取元数据; 顶层没有描述文件时再展开内嵌 jar 查找
+bool readJarMetadata(const std::filesystem::path& jarPath, JarMetadata& metadata, bool withDependencies = false);
@@ -0,0 +1,79 @@
+#include "logger.h"
+
+#include <ctime>      // 用于获取当前时间作为日志时间戳
+#include <fstream>
+#include <iomanip>    // 用于 std::put_time
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+// 全局日志状态, 由 logMutex 保护
+static std::ofstream logFile;
+static LogCallback logCallback;
+static bool consoleLogging = true;
+static std::mutex logMutex;
+
+bool openLogFile(const std::filesystem::path& path) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    if (logFile.is_open()) logFile.close();
+    logFile.open(path, std::ios::out | std::ios::trunc);
+    return logFile.is_open();
+}
+
+void closeLogFile() {
+    std::lock_guard<std::mutex> lock(logMutex);
+    if (logFile.is_open()) logFile.close();
+}
+
+void setLogCallback(LogCallback callback) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    logCallback = std::move(callback);
+}
+
+void setConsoleLogging(bool enabled) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    consoleLogging = enabled;
+}
+
+// --- 辅助函数：输出日志信息到控制台和文件 ---
+void logMessage(const std::string& message, bool isError) {
+    // 获取当前时间作为时间戳
+    std::time_t now = std::time(nullptr);
+    std::tm ltm{};
+#ifdef _WIN32
+    localtime_s(&ltm, &now);
+#else
+    localtime_r(&now, &ltm);
+#endif
+
+    // 格式化时间戳
+    std::stringstream ss;
+    ss << std::put_time(&ltm, "[%Y-%m-%d %H:%M:%S]");
+
+    // 回调在释放锁之后调用: 宿主的回调可能再调用库中会写日志的函数, 持锁调用会自锁死, 慢的回调也会串行化所有工作线程
+    LogCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+
+        // 输出到控制台
+        if (consoleLogging) {
+            if (isError) {
+                std::cerr << ss.str() << " 错误: " << message << std::endl;
+            } else {
+                std::cout << ss.str() << " 信息: " << message << std::endl;
+            }
+        }
+
+        // 输出到日志文件
+        if (logFile.is_open()) {
+            logFile << ss.str() << " " << (isError ? "错误" : "信息") << ": " << message << std::endl;
+            logFile.flush(); // 立即刷新缓冲区, 确保信息写入文件
+        }
+
+        callback = logCallback;
+    }
+
+    if (callback) {
+        callback(message, isError);
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <string>
+
+// 日志回调: 嵌入到其它程序 (例如启动器) 时, 宿主可以接管所有日志输出
+using LogCallback = std::function<void(const std::string& message, bool isError)>;
+
+// 打开日志文件 (覆盖写入), 失败时返回 false
+bool openLogFile(const std::filesystem::path& path);
+void closeLogFile();
+
+// 设置日志回调, 传入空回调恢复默认行为
+void setLogCallback(LogCallback callback);
+
+// 是否把日志同时输出到控制台 (默认开启)
+void setConsoleLogging(bool enabled);
+
+// 输出日志信息到控制台、日志文件和回调, 可在多个线程中同时调用
+void logMessage(const std::string& message, bool isError = false);
@@ -1,15 +1,30 @@
+// 命令行前端: 负责参数、工作目录和交互, 分类逻辑都在 libmodclassifier 中
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <vector>
 #include <filesystem> // C++17 文件系统库
-#include <regex>      // 用于正则表达式
-#include <map>        // 用于快速查找 Mod 类型
-#include <algorithm>  // 用于 std::transform
-#include <ctime>      // 用于获取当前时间作为日志时间戳
-#include <iomanip>    // 用于 std::put_time
+#include <memory>
+#include <optional>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
 #include <cstdlib>    // 用于 system("pause")
-#include "include/nlohmann/json.hpp"
+#include "archive_output.h"
+#include "classifier.h"
+#include "dump_import.h"
+#include "fingerprint.h"
+#include "inflate_bench.h"
+#include "logger.h"
+#include "mod_info.h"
+#include "modpack.h"
+#include "mod_layers.h"
+#include "modpack_diff.h"
+#include "normalize_cache.h"
+#include "normalizer_stress.h"
+#include "profile_output.h"
+#include "server.h"
+#include "unknown_report.h"
 
 // 针对 Windows 平台的乱码问题, 引入 Windows.h
 #ifdef _WIN32
@@ -23,7 +38,6 @@
 #endif
 
 namespace fs = std::filesystem;
-using json = nlohmann::json;
 
 // 跨平台的按任意键函数 (最终版)
 void pressAnyKeyToExit() {
@@ -51,261 +65,216 @@ void pressAnyKeyToExit() {
 }
 
 
-// 全局日志文件流
-std::ofstream logFile;
 // 日志文件名, 现在只是文件名, 完整路径在运行时确定
 const std::string LOG_FILENAME_BASE = "mod_classifier.log";
-
-// --- 辅助函数：输出日志信息到控制台和文件 ---
-void logMessage(const std::string& message, bool isError = false) {
-    // 获取当前时间作为时间戳
-    std::time_t now = std::time(nullptr);
-    std::tm* ltm = std::localtime(&now);
-
-    // 格式化时间戳
-    std::stringstream ss;
-    ss << std::put_time(ltm, "[%Y-%m-%d %H:%M:%S]");
-
-    // 输出到控制台
-    if (isError) {
-        std::cerr << ss.str() << " 错误: " << message << std::endl;
-    } else {
-        std::cout << ss.str() << " 信息: " << message << std::endl;
-    }
-
-    // 输出到日志文件
-    if (logFile.is_open()) {
-        logFile << ss.str() << " " << (isError ? "错误" : "信息") << ": " << message << std::endl;
-        logFile.flush(); // 立即刷新缓冲区, 确保信息写入文件
-    }
-}
-
-// --- 1. Mod 数据结构定义 ---
-enum class ModType {
-    ClientOnly,                 // 仅客户端
-    ServerOnly,                 // 仅服务端
-    ClientRequiredServerOptional, // 客户端必装, 服务端可选
-    ClientOptionalServerRequired, // 客户端可选, 服务端必装
-    ClientAndServerRequired,    // 客户端和服务端都必装
-    ClientOptionalServerOptional,   // 客户端可选, 服务端可选
-    Unknown                     // 未知类型 (需在JSON中指定)
+// 文件名清理缓存, 与 mods_data.json 放在同一目录
+const std::string NAME_CACHE_FILENAME = "mod_name_cache.bin";
+// 由平台元数据快照导入的哈希索引, 与 mods_data.json 放在同一目录
+const std::string HASH_INDEX_FILENAME = "mods_hash_index.bin";
+
+// 分片的数据库目录, 存在时作为 mods_data.json 之上的一层 (没有 --db 时)
+const std::string DATABASE_SHARD_DIRECTORY = "mods_data.d";
+
+// 各层数据库合并结果的缓存, 各层都没有变化时代替解析 JSON
+const std::string DATABASE_CACHE_FILENAME = "mods_data_merged.bin";
+
+// 按名称模式覆盖类型的规则, 与 mods_data.json 放在同一目录
+const std::string OVERRIDE_RULES_FILENAME = "mods_rules.json";
+
+// --fuzzy 允许的最大编辑距离
+constexpr int MAX_FUZZY_DISTANCE = 8;
+
+// 命令行选项
+struct CliOptions {
+    bool stressNormalizer = false; // --stress-normalizer
+    std::string benchInflate;      // --bench-inflate <目录>, 非空时运行解压基准测试
+    std::string fingerprint;       // --fingerprint <目录>, 非空时输出目录中 jar 的指纹
+    std::string input;             // --input <目录或整合包>, 默认为 Input 目录
+    std::string diffOld;           // --diff <旧> <新>, 非空时对比两个目录或整合包后退出
+    std::string diffNew;
+    std::string unknownReport;     // --unknown-report <文件>, 非空时把找不到的名称聚类写成 JSON 后退出
+    bool useNameCache = true;      // --no-name-cache 关闭
+    bool scanBytecode = true;      // --no-bytecode 关闭
+    bool useHashIndex = true;      // --no-hash-index 关闭
+    bool resolveDependencies = true; // --no-dependencies 关闭
+    bool dedupeVersions = false;   // --dedupe-versions
+    bool suggestNames = true;      // --no-suggestions 关闭
+    int fuzzyDistance = 0;         // --fuzzy <距离>, 大于 0 时按编辑距离匹配找不到的名称
+    std::string rules;             // --rules <文件>, 为空时使用默认的规则文件 (存在时)
+    std::vector<std::string> databases; // --db <文件或目录>, 可以重复, 后面的优先; 为空时使用 mods_data.json 和 mods_data.d
+    std::vector<std::string> importDumps; // --import-dump <文件>, 可以重复; 非空时导入快照后退出
+    size_t importMemoryMiB = 256;  // --import-memory <MiB>, 导入时排序缓冲区的大小
+    std::string serveSocket;       // --serve <套接字路径>, 非空时进入服务模式
+    size_t serveWorkers = 0;       // --workers <线程数>
+    MetadataMode metadataMode = MetadataMode::Fallback; // --metadata <off|fallback|primary>
+    std::optional<ArchiveCompression> archiveOutput;    // --archive-output <store|deflate>, 设置时写入各类型的 zip
+    std::string profiles;          // --profiles <文件|default>, 非空时同时填充部署目标目录
 };
 
-struct ModInfo {
-    std::string name; // Mod 文件名 (这里指干净的名称, 用于匹配 JSON)
-    ModType type;     // Mod 类型
-
-    // 辅助函数, 将字符串转换为 ModType 枚举
-    static ModType stringToModType(const std::string& typeStr) {
-        if (typeStr == "client_only") return ModType::ClientOnly;
-        if (typeStr == "server_only") return ModType::ServerOnly;
-        if (typeStr == "client_required_server_optional") return ModType::ClientRequiredServerOptional;
-        if (typeStr == "client_optional_server_required") return ModType::ClientOptionalServerRequired;
-        if (typeStr == "client_and_server_required") return ModType::ClientAndServerRequired;
-        if (typeStr == "client_optional_server_optional") return ModType::ClientOptionalServerOptional;
-        if (typeStr == "unknown") return ModType::Unknown; // 显式支持 unknown 类型
-        return ModType::Unknown; // 默认回退, 但主要依赖JSON的正确性
-    }
-
-    // 辅助函数, 将 ModType 枚举转换为对应的目录名
-    static std::string modTypeToDirectory(ModType type) {
-        switch (type) {
-            case ModType::ClientOnly: return "ClientOnly";
-            case ModType::ServerOnly: return "ServerOnly";
-            case ModType::ClientRequiredServerOptional: return "ClientRequiredServerOptional";
-            case ModType::ClientOptionalServerRequired: return "ClientOptionalServerRequired";
-            case ModType::ClientAndServerRequired: return "ClientAndServerRequired";
-            case ModType::ClientOptionalServerOptional: return "ClientOptionalServerOptional";
-            case ModType::Unknown: return "Unknown"; // 处理在JSON中指定的Unknown类型
-            default: return "Unknown";
-        }
-    }
-};
-
-// --- 辅助函数：从 Mod 文件名中提取干净的名称 ---
-// 排除版本号和方括号内的中文译名
-std::string getCleanModName(const std::string& fullFileName) {
-    // 找到最后一个点, 分离文件名和扩展名 (例如 ".jar")
-    size_t lastDotPos = fullFileName.rfind('.');
-    std::string nameWithoutExt;
-    std::string extension;
-
-    if (lastDotPos != std::string::npos) {
-        nameWithoutExt = fullFileName.substr(0, lastDotPos);
-        extension = fullFileName.substr(lastDotPos); // 包含点, 例如 ".jar"
-    } else {
-        nameWithoutExt = fullFileName;
-        extension = "";
-    }
-
-    // 1. 移除方括号内的内容
-    std::regex bracket_regex("\\[[^\\]]*\\]");
-    nameWithoutExt = std::regex_replace(nameWithoutExt, bracket_regex, "");
-
-    // 2a. 移除特定的非标准分隔符, 如 '·'
-    nameWithoutExt = std::regex_replace(nameWithoutExt, std::regex("\xC2\xB7"), "");
-
-    // 2b. 处理混合语言前缀
-    size_t last_non_ascii_pos = std::string::npos;
-    for (int i = nameWithoutExt.length() - 1; i >= 0; --i) {
-        if (static_cast<unsigned char>(nameWithoutExt[i]) > 127) {
-            last_non_ascii_pos = i;
-            break;
+// 解析命令行参数, 遇到无法识别的参数时记录错误并返回 false
+bool parseArguments(int argc, char* argv[], CliOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto nextValue = [&](std::string& value) {
+            if (i + 1 >= argc) {
+                logMessage("参数 " + arg + " 缺少取值。", true);
+                return false;
+            }
+            value = argv[++i];
+            return true;
+        };
+
+        if (arg == "--stress-normalizer") {
+            options.stressNormalizer = true;
+        } else if (arg == "--bench-inflate") {
+            if (!nextValue(options.benchInflate)) return false;
+        } else if (arg == "--fingerprint") {
+            if (!nextValue(options.fingerprint)) return false;
+        } else if (arg == "--input") {
+            if (!nextValue(options.input)) return false;
+        } else if (arg == "--diff") {
+            if (!nextValue(options.diffOld) || !nextValue(options.diffNew)) return false;
+        } else if (arg == "--unknown-report") {
+            if (!nextValue(options.unknownReport)) return false;
+        } else if (arg == "--no-name-cache") {
+            options.useNameCache = false;
+        } else if (arg == "--no-bytecode") {
+            options.scanBytecode = false;
+        } else if (arg == "--no-hash-index") {
+            options.useHashIndex = false;
+        } else if (arg == "--no-dependencies") {
+            options.resolveDependencies = false;
+        } else if (arg == "--dedupe-versions") {
+            options.dedupeVersions = true;
+        } else if (arg == "--no-suggestions") {
+            options.suggestNames = false;
+        } else if (arg == "--db") {
+            std::string value;
+            if (!nextValue(value)) return false;
+            options.databases.push_back(value);
+        } else if (arg == "--rules") {
+            if (!nextValue(options.rules)) return false;
+        } else if (arg == "--fuzzy") {
+            std::string value;
+            if (!nextValue(value)) return false;
+            try {
+                options.fuzzyDistance = std::stoi(value);
+            } catch (const std::exception&) {
+                options.fuzzyDistance = 0;
+            }
+            // 距离太大时几乎任何短名称都能匹配上, 没有意义
+            if (options.fuzzyDistance < 1 || options.fuzzyDistance > MAX_FUZZY_DISTANCE) {
+                logMessage("无效的编辑距离: " + value + " (可选 1 到 " + std::to_string(MAX_FUZZY_DISTANCE) + ")", true);
+                return false;
+            }
+        } else if (arg == "--import-dump") {
+            std::string value;
+            if (!nextValue(value)) return false;
+            options.importDumps.push_back(value);
+        } else if (arg == "--import-memory") {
+            std::string value;
+            if (!nextValue(value)) return false;
+            try {
+                options.importMemoryMiB = static_cast<size_t>(std::stoul(value));
+            } catch (const std::exception&) {
+                logMessage("无效的内存大小: " + value, true);
+                return false;
+            }
+            if (options.importMemoryMiB == 0) {
+                logMessage("无效的内存大小: " + value, true);
+                return false;
+            }
+        } else if (arg == "--metadata") {
+            std::string value;
+            if (!nextValue(value)) return false;
+            if (value == "off") {
+                options.metadataMode = MetadataMode::Off;
+            } else if (value == "fallback") {
+                options.metadataMode = MetadataMode::Fallback;
+            } else if (value == "primary") {
+                options.metadataMode = MetadataMode::Primary;
+            } else {
+                logMessage("无效的元数据模式: " + value + " (可选 off, fallback, primary)", true);
+                return false;
+            }
+        } else if (arg == "--archive-output") {
+            std::string value;
+            if (!nextValue(value)) return false;
+            if (value == "store") {
+                options.archiveOutput = ArchiveCompression::Store;
+            } else if (value == "deflate") {
+                options.archiveOutput = ArchiveCompression::Deflate;
+            } else {
+                logMessage("无效的归档模式: " + value + " (可选 store, deflate)", true);
+                return false;
+            }
+        } else if (arg == "--profiles") {
+            if (!nextValue(options.profiles)) return false;
+        } else if (arg == "--serve") {
+            if (!nextValue(options.serveSocket)) return false;
+        } else if (arg == "--workers") {
+            std::string value;
+            if (!nextValue(value)) return false;
+            try {
+                options.serveWorkers = static_cast<size_t>(std::stoul(value));
+            } catch (const std::exception&) {
+                logMessage("无效的线程数: " + value, true);
+                return false;
+            }
+        } else {
+            logMessage("无法识别的参数: " + arg, true);
+            return false;
         }
     }
-
-    if (last_non_ascii_pos != std::string::npos && last_non_ascii_pos + 1 < nameWithoutExt.length()) {
-        std::string suffix_part = nameWithoutExt.substr(last_non_ascii_pos + 1);
-        auto it = std::find_if(suffix_part.begin(), suffix_part.end(), [](char c){
-            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
-        });
-
-        if (it != suffix_part.end()) {
-            nameWithoutExt = suffix_part;
-        }
+    if (!options.profiles.empty() && options.archiveOutput) {
+        // 部署目标链接到类型子目录中的文件, 写入归档时没有这些文件
+        logMessage("--profiles 不能与 --archive-output 同时使用。", true);
+        return false;
     }
+    return true;
+}
 
-    // 3. 移除文件名开头的 Minecraft 版本号
-    std::regex mc_version_prefix_regex("^[0-9]+\\.[0-9]+(?:\\.[0-9]+)*[-_]", std::regex_constants::icase);
-    nameWithoutExt = std::regex_replace(nameWithoutExt, mc_version_prefix_regex, "");
-
-    // 4. 移除 "for [加载器名称]" 模式
-    std::regex for_loader_regex("\\s+for\\s+[a-zA-Z]+", std::regex_constants::icase);
-    nameWithoutExt = std::regex_replace(nameWithoutExt, for_loader_regex, "");
-
-    // 5. 在加载器和数字之间插入空格, 以规范 "forge1.20.1" 这样的名称
-    std::regex loader_digit_regex(
-            "(forge|fabric|quilt|neoforge|rift|liteloader|nilloader)"
-            "([0-9])",
-            std::regex_constants::icase
-    );
-    nameWithoutExt = std::regex_replace(nameWithoutExt, loader_digit_regex, "$1 $2");
-
-    // 6. 迭代移除文件名末尾的版本号、加载器等后缀
-    std::regex suffix_regex(
-            "[-_+\\s.]+"
-            "(?:"
-            "v?[0-9]+(?:[\\._\\-][0-9a-zA-Z_+-]+)*"
-            "|mc[0-9]+(?:\\.[0-9]+)*"
-            "|forge|fabric|quilt|neoforge|rift|liteloader|nilloader"
-            "|snapshot|pre|rc|beta|alpha"
-            "|universal|all|mc"
-            ")"
-            "\\s*$", std::regex_constants::icase
-    );
-
-    std::string tempName = nameWithoutExt;
-    std::string prevName;
-    do {
-        prevName = tempName;
-        tempName = std::regex_replace(tempName, suffix_regex, "");
-    } while (tempName != prevName);
-    nameWithoutExt = tempName;
-
-    // 7. 移除多余的空格, 并修剪首尾空格和分隔符
-    nameWithoutExt = std::regex_replace(nameWithoutExt, std::regex(" +"), " ");
-    size_t first = nameWithoutExt.find_first_not_of(" -_");
-    if (std::string::npos == first) {
-        nameWithoutExt = "";
-    } else {
-        size_t last = nameWithoutExt.find_last_not_of(" -_");
-        nameWithoutExt = nameWithoutExt.substr(first, (last - first + 1));
+// 各层数据库 (见 mod_layers.h): 用 --db 指定的各层, 没有时为 mods_data.json 以及存在时的 mods_data.d 目录
+std::vector<fs::path> databaseLayers(const CliOptions& options, const std::string& jsonDataFile) {
+    std::vector<fs::path> layers;
+    if (options.databases.empty()) {
+        layers.emplace_back(jsonDataFile);
+        if (fs::is_directory(DATABASE_SHARD_DIRECTORY)) layers.emplace_back(DATABASE_SHARD_DIRECTORY);
     }
-
-    // 8. 将清理后的名称转换为小写
-    std::transform(nameWithoutExt.begin(), nameWithoutExt.end(), nameWithoutExt.begin(),
-                   [](unsigned char c){ return std::tolower(c); });
-
-    return nameWithoutExt + extension;
+    for (const std::string& database : options.databases) layers.emplace_back(database);
+    return layers;
 }
 
-// --- 2. JSON 读写 ---
-std::vector<ModInfo> readModDataFromJson(const std::string& filePath) {
-    std::vector<ModInfo> mods;
-    std::ifstream file(filePath);
-    if (!file.is_open()) {
-        logMessage("无法打开 JSON 文件: " + filePath, true);
-        return mods;
-    }
-
-    try {
-        json data = json::parse(file);
-        if (!data.is_array()) {
-            logMessage("JSON 文件内容不是一个有效的数组。", true);
-            file.close();
-            return mods;
-        }
-        for (const auto& item : data) {
-            if (item.is_object() && item.count("name") && item.count("type")) {
-                ModInfo mod;
-                mod.name = item.at("name").get<std::string>();
-                std::transform(mod.name.begin(), mod.name.end(), mod.name.begin(),
-                               [](unsigned char c){ return std::tolower(c); });
-                mod.type = ModInfo::stringToModType(item.at("type").get<std::string>());
-                mods.push_back(mod);
-            } else {
-                logMessage("JSON 文件中存在无效的 Mod 条目, 已跳过。", true);
-            }
-        }
-    } catch (const json::exception& e) {
-        logMessage("解析 JSON 文件失败: " + std::string(e.what()), true);
-    }
-    file.close();
-    return mods;
+// 覆盖规则文件: 用 --rules 指定的文件, 没有时为存在的默认文件; 都没有时为空, 不使用规则
+fs::path overrideRulesPath(const CliOptions& options) {
+    if (!options.rules.empty()) return options.rules;
+    return fs::exists(OVERRIDE_RULES_FILENAME) ? fs::path(OVERRIDE_RULES_FILENAME) : fs::path();
 }
 
-// --- 3. Mod 分类逻辑 & 4. 文件操作 ---
-void classifyMods(const std::vector<ModInfo>& mods, const std::string& inputDir, const std::string& outputDir) {
-    // 确保输出目录和所有可能的子目录都存在
-    fs::create_directories(outputDir);
-    fs::create_directories(fs::path(outputDir) / "ClientOnly");
-    fs::create_directories(fs::path(outputDir) / "ServerOnly");
-    fs::create_directories(fs::path(outputDir) / "ClientRequiredServerOptional");
-    fs::create_directories(fs::path(outputDir) / "ClientOptionalServerRequired");
-    fs::create_directories(fs::path(outputDir) / "ClientAndServerRequired");
-    fs::create_directories(fs::path(outputDir) / "ClientOptionalServerOptional");
-    fs::create_directories(fs::path(outputDir) / "Unknown"); // 为在JSON中指定的Unknown类型创建目录
-
-    // 创建一个映射, 用于快速查找 Mod 类型
-    std::map<std::string, ModType> modTypeMap;
-    for (const auto& mod : mods) {
-        modTypeMap[mod.name] = mod.type;
-    }
-
-    // 遍历 Input 目录中的所有文件
-    for (const auto& entry : fs::directory_iterator(inputDir)) {
-        if (entry.is_regular_file()) {
-            std::string fullFileName = entry.path().filename().string();
-            std::string cleanFileName = getCleanModName(fullFileName);
-
-            // 在映射中查找干净的 Mod 名称
-            auto it = modTypeMap.find(cleanFileName);
-            if (it != modTypeMap.end()) {
-                // 找到了匹配项, 进行分类
-                ModType type = it->second;
-                std::string targetSubDir = ModInfo::modTypeToDirectory(type);
-                fs::path destinationPath = fs::path(outputDir) / targetSubDir / fullFileName;
-
-                // 检查目标文件是否已存在
-                if (fs::exists(destinationPath) && fs::is_regular_file(destinationPath)) {
-                    logMessage("已跳过 Mod: " + fullFileName + ", 因为它已存在于目标目录: " + targetSubDir);
-                    continue;
-                }
-
-                try {
-                    fs::copy(entry.path(), destinationPath, fs::copy_options::overwrite_existing);
-                    logMessage("已分类 Mod: " + fullFileName + " 到 " + targetSubDir);
-                } catch (const fs::filesystem_error& e) {
-                    logMessage("无法分类 Mod " + fullFileName + ": " + e.what(), true);
-                }
-            } else {
-                // 未找到匹配项, 记录错误, 不移动文件
-                logMessage("未在 mods_data.json 中找到 Mod 的分类信息: " + fullFileName + " (干净名称: " + cleanFileName + ")", true);
-            }
-        }
-    }
+// 载入并合并各层数据库。用 --db 指定的每一层都必须能读取, 否则返回 false;
+// 只有默认的数据库时与以前一样, 出错也继续使用已读取的部分
+bool loadModIndex(const CliOptions& options, const std::string& jsonDataFile, ModIndex& index) {
+    MergedModData merged;
+    bool loaded = loadModLayers(databaseLayers(options, jsonDataFile), DATABASE_CACHE_FILENAME, merged);
+    index = ModIndex(std::move(merged.names), std::move(merged.modIds));
+    return loaded || options.databases.empty();
 }
 
+// 载入覆盖规则: 用 --rules 指定的文件必须能读取, 默认的文件不存在时不使用规则
+bool loadOverrideRules(const CliOptions& options, ModIndex& index) {
+    fs::path path = overrideRulesPath(options);
+    if (path.empty()) return true;
+    auto start = std::chrono::steady_clock::now();
+    auto rules = std::make_shared<OverrideRules>();
+    if (!rules->load(path)) return false;
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2) << "已载入 " << rules->size() << " 条覆盖规则 (" << path.string()
+       << "), 自动机共 " << rules->stateCount() << " 个状态, 耗时 " << elapsed << " 毫秒";
+    logMessage(ss.str());
+    index.setOverrideRules(std::move(rules));
+    return true;
+}
 
 int main(int argc, char* argv[]) {
 #ifdef _WIN32
@@ -330,66 +299,274 @@ int main(int argc, char* argv[]) {
         logFilePath = LOG_FILENAME_BASE;
     }
 
-    logFile.open(logFilePath, std::ios::out | std::ios::trunc);
-    if (!logFile.is_open()) {
+    if (!openLogFile(logFilePath)) {
         std::cerr << "错误: 无法打开日志文件: " << logFilePath << std::endl;
     }
 
     logMessage("程序启动。");
 
-    std::string inputDirectory = "Input";
+    CliOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        closeLogFile();
+        return 1;
+    }
+
+    if (options.stressNormalizer) {
+        bool passed = runNormalizerStressTest();
+        logMessage(passed ? "文件名清理压力测试全部通过。" : "文件名清理压力测试未通过, 清理耗时不是线性增长。", !passed);
+        closeLogFile();
+        return passed ? 0 : 1;
+    }
+
+    if (!options.benchInflate.empty()) {
+        bool passed = runInflateBenchmark(options.benchInflate);
+        closeLogFile();
+        return passed ? 0 : 1;
+    }
+
+    if (!options.fingerprint.empty()) {
+        bool passed = runFingerprintReport(options.fingerprint);
+        closeLogFile();
+        return passed ? 0 : 1;
+    }
+
+    std::string inputDirectory = options.input.empty() ? "Input" : options.input;
     std::string outputDirectory = "Output";
     std::string jsonDataFile = "mods_data.json";
 
-    if (!fs::exists(inputDirectory)) {
-        logMessage("检测到 'Input' 文件夹不存在, 正在创建...", false);
+    // 导入平台元数据快照, 生成哈希索引后退出
+    if (!options.importDumps.empty()) {
+        std::vector<fs::path> dumps(options.importDumps.begin(), options.importDumps.end());
+        bool imported = importMetadataDumps(dumps, HASH_INDEX_FILENAME, options.importMemoryMiB * 1024 * 1024);
+        closeLogFile();
+        return imported ? 0 : 1;
+    }
+
+    // 对比两个版本的整合包, 只按文件名查类型, 不读取 jar, 也不写出文件
+    if (!options.diffOld.empty()) {
+        ModIndex index;
+        if (!loadModIndex(options, jsonDataFile, index) || !loadOverrideRules(options, index)) {
+            closeLogFile();
+            return 1;
+        }
+        NormalizeCache nameCache;
+        if (options.useNameCache) nameCache.load(NAME_CACHE_FILENAME);
+        bool compared = runModpackDiff(options.diffOld, options.diffNew, index,
+                                       options.useNameCache ? &nameCache : nullptr);
+        if (options.useNameCache) nameCache.save();
+        closeLogFile();
+        return compared ? 0 : 1;
+    }
+
+    // 把找不到的名称聚类, 写出可以编辑后并入数据库的条目
+    if (!options.unknownReport.empty()) {
+        ModIndex index;
+        if (!loadModIndex(options, jsonDataFile, index) || !loadOverrideRules(options, index)) {
+            closeLogFile();
+            return 1;
+        }
+        NormalizeCache nameCache;
+        if (options.useNameCache) nameCache.load(NAME_CACHE_FILENAME);
+        bool written = runUnknownReport(inputDirectory, options.unknownReport, index,
+                                        options.useNameCache ? &nameCache : nullptr);
+        if (options.useNameCache) nameCache.save();
+        closeLogFile();
+        return written ? 0 : 1;
+    }
+
+    // 服务模式: 数据库常驻内存并在文件变化时热重载, 不创建 Input/Output, 也不等待按键。
+    // 各层数据库和覆盖规则与分类时相同, 任何一个文件变化都会重新加载
+    if (!options.serveSocket.empty()) {
+        ModDatabase database(databaseLayers(options, jsonDataFile), overrideRulesPath(options),
+                             DATABASE_CACHE_FILENAME);
+        if (!database.reload()) {
+            closeLogFile();
+            return 1;
+        }
+
+        ServerOptions serverOptions;
+        serverOptions.socketPath = options.serveSocket;
+        serverOptions.workerThreads = options.serveWorkers;
+        int exitCode = runClassifyServer(serverOptions, database);
+        closeLogFile();
+        return exitCode;
+    }
+
+    // 输入为整合包归档时直接从归档中读取, 不需要 Input 目录
+    Modpack modpack;
+    bool fromModpack = fs::is_regular_file(inputDirectory);
+    if (fromModpack) {
+        if (!isModpackArchive(inputDirectory) || !modpack.open(inputDirectory)) {
+            logMessage("无法打开整合包: " + inputDirectory + " (支持 .zip 和 .mrpack)", true);
+            closeLogFile();
+            pressAnyKeyToExit();
+            return 1;
+        }
+        logMessage("已打开 " + std::string(modpackFormatName(modpack.format())) + " 整合包 " + inputDirectory + ", 共 " +
+                   std::to_string(modpack.entries().size()) + " 个 Mod");
+    } else if (!fs::exists(inputDirectory)) {
+        logMessage("检测到 '" + inputDirectory + "' 文件夹不存在, 正在创建...", false);
         if (!fs::create_directories(inputDirectory)) {
-            logMessage("无法创建 'Input' 文件夹。", true);
-            logFile.close();
+            logMessage("无法创建 '" + inputDirectory + "' 文件夹。", true);
+            closeLogFile();
             pressAnyKeyToExit();
             return 1;
         }
     } else if (!fs::is_directory(inputDirectory)) {
-        logMessage("'Input' 路径存在但不是一个目录。", true);
-        logFile.close();
+        logMessage("'" + inputDirectory + "' 路径存在但不是一个目录。", true);
+        closeLogFile();
         pressAnyKeyToExit();
         return 1;
     }
 
-    if (!fs::exists(jsonDataFile)) {
-        logMessage("检测到 'mods_data.json' 文件不存在, 正在创建...", false);
-        std::ofstream outFile(jsonDataFile);
-        if (outFile.is_open()) {
-            outFile << "[]";
-            outFile.close();
-            logMessage("'mods_data.json' 已成功创建和初始化。", false);
-        } else {
-            logMessage("无法创建或写入 'mods_data.json' 文件。", true);
-            logFile.close();
+    // 指定了各层数据库时不使用默认的 mods_data.json, 各层在合并时检查
+    if (options.databases.empty()) {
+        if (!fs::exists(jsonDataFile)) {
+            logMessage("检测到 'mods_data.json' 文件不存在, 正在创建...", false);
+            std::ofstream outFile(jsonDataFile);
+            if (outFile.is_open()) {
+                outFile << "[]";
+                outFile.close();
+                logMessage("'mods_data.json' 已成功创建和初始化。", false);
+            } else {
+                logMessage("无法创建或写入 'mods_data.json' 文件。", true);
+                closeLogFile();
+                pressAnyKeyToExit();
+                return 1;
+            }
+        } else if (!fs::is_regular_file(jsonDataFile)) {
+            logMessage("'mods_data.json' 路径存在但不是一个文件。", true);
+            closeLogFile();
             pressAnyKeyToExit();
             return 1;
         }
-    } else if (!fs::is_regular_file(jsonDataFile)) {
-        logMessage("'mods_data.json' 路径存在但不是一个文件。", true);
-        logFile.close();
-        pressAnyKeyToExit();
-        return 1;
     }
 
     logMessage("正在读取 Mod 数据...");
-    std::vector<ModInfo> mods = readModDataFromJson(jsonDataFile);
+    ModIndex index;
+    if (!loadModIndex(options, jsonDataFile, index)) {
+        closeLogFile();
+        pressAnyKeyToExit();
+        return 1;
+    }
 
-    if (mods.empty()) {
+    if (index.size() == 0 && index.modIdCount() == 0) {
         logMessage("没有从 JSON 文件中读取到 Mod 数据, 文件可能为空或有误。", false);
     }
 
+    // 文件名清理缓存, 可通过 --no-name-cache 关闭
+    bool useNameCache = options.useNameCache;
+    NormalizeCache nameCache;
+    if (useNameCache) {
+        nameCache.load(NAME_CACHE_FILENAME);
+    }
+
+    // 哈希索引不存在时按文件名等方式分类
+    HashIndex hashIndex;
+    if (options.useHashIndex && hashIndex.load(HASH_INDEX_FILENAME)) {
+        logMessage("已载入哈希索引, 共 " + std::to_string(hashIndex.size()) + " 个条目。");
+    }
+
     logMessage("开始分类 Mod...");
-    classifyMods(mods, inputDirectory, outputDirectory);
+    if (!loadOverrideRules(options, index)) {
+        closeLogFile();
+        pressAnyKeyToExit();
+        return 1;
+    }
+    if (options.suggestNames) {
+        auto start = std::chrono::steady_clock::now();
+        index.buildSuggestionIndex();
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2) << "已为 " << index.size() << " 个名称建立近似匹配索引, 耗时 "
+           << elapsed << " 毫秒";
+        logMessage(ss.str());
+    }
+    if (options.fuzzyDistance > 0) {
+        auto start = std::chrono::steady_clock::now();
+        index.buildFuzzyIndex(options.fuzzyDistance);
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2) << "已为 " << index.size() << " 个名称建立编辑距离索引, 耗时 "
+           << elapsed << " 毫秒";
+        logMessage(ss.str());
+    }
+    NormalizeCache* cache = useNameCache ? &nameCache : nullptr;
+    if (fromModpack && options.dedupeVersions) {
+        logMessage("--dedupe-versions 只用于目录输入, 整合包中的文件不去重。", true);
+    }
+    // 部署目标: "default" 为内置的 server / client / lan-host, 否则为 JSON 文件
+    std::unique_ptr<ProfileOutput> profileOutput;
+    if (!options.profiles.empty()) {
+        std::vector<OutputProfile> profiles;
+        if (options.profiles == "default") {
+            profiles = defaultOutputProfiles();
+        } else if (!loadOutputProfiles(options.profiles, profiles)) {
+            closeLogFile();
+            pressAnyKeyToExit();
+            return 1;
+        }
+        profileOutput = std::make_unique<ProfileOutput>(outputDirectory, std::move(profiles));
+        if (!profileOutput->createDirectories()) {
+            closeLogFile();
+            pressAnyKeyToExit();
+            return 1;
+        }
+    }
+    // 写入 Output 下各类型的 zip, 而不是子目录
+    std::unique_ptr<ArchiveOutput> archiveOutput;
+    if (options.archiveOutput) archiveOutput = std::make_unique<ArchiveOutput>(outputDirectory, *options.archiveOutput);
+    ClassifyStats stats = fromModpack ? classifyModpack(index, modpack, outputDirectory, cache, options.metadataMode,
+                                                        options.scanBytecode, &hashIndex, archiveOutput.get(),
+                                                        profileOutput.get(), options.resolveDependencies)
+                                      : classifyMods(index, inputDirectory, outputDirectory, cache,
+                                                     options.metadataMode, options.scanBytecode, &hashIndex,
+                                                     archiveOutput.get(), profileOutput.get(),
+                                                     options.resolveDependencies, options.dedupeVersions);
+    if (archiveOutput && !archiveOutput->finish()) {
+        logMessage("部分归档写出失败, 请查看上面的错误。", true);
+    }
+    if (profileOutput) profileOutput->logSummary();
+    if (stats.olderVersions > 0) {
+        logMessage("有 " + std::to_string(stats.olderVersions) + " 个 Mod 存在更新的版本, 已跳过。");
+    }
+    if (stats.fromModpack > 0) {
+        logMessage("其中 " + std::to_string(stats.fromModpack) + " 个 Mod 的类型来自整合包声明的运行端。");
+    }
+    if (stats.downloadOnly > 0) {
+        logMessage("另有 " + std::to_string(stats.downloadOnly) + " 个 Mod 只在整合包清单中列出, 已分类但需要下载。");
+    }
+    if (stats.fromOverride > 0) {
+        logMessage("其中 " + std::to_string(stats.fromOverride) + " 个 Mod 的类型来自覆盖规则。");
+    }
+    if (stats.fromHashIndex > 0) {
+        logMessage("其中 " + std::to_string(stats.fromHashIndex) + " 个 Mod 的类型来自哈希索引。");
+    }
+    if (stats.fromMetadata > 0) {
+        logMessage("其中 " + std::to_string(stats.fromMetadata) + " 个 Mod 的类型来自 jar 内的描述文件。");
+    }
+    if (stats.fromBytecode > 0) {
+        logMessage("其中 " + std::to_string(stats.fromBytecode) + " 个 Mod 的类型由字节码扫描推断。");
+    }
+    if (stats.fromFuzzy > 0) {
+        logMessage("其中 " + std::to_string(stats.fromFuzzy) + " 个 Mod 的类型来自编辑距离以内唯一的近似名称。");
+    }
+    if (stats.fromDependency > 0) {
+        logMessage("其中 " + std::to_string(stats.fromDependency) + " 个 Mod 的类型按依赖它的 Mod 调整。");
+    }
+    if (stats.missingDependencies > 0) {
+        logMessage("有 " + std::to_string(stats.missingDependencies) + " 个依赖没有对应的文件, 请查看上面的错误。", true);
+    }
+
+    if (useNameCache) {
+        nameCache.logSummary();
+        nameCache.save();
+    }
 
     logMessage("Mod 分类完成！", false);
 
     pressAnyKeyToExit();
 
-    logFile.close();
+    closeLogFile();
     return 0;
 }
\ No newline at end of file
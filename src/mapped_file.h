@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+// --- 只读内存映射文件 ---
+// Windows 下使用 CreateFileMapping, 其它平台使用 mmap; 映射失败时 data() 返回 nullptr
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 映射整个文件, 空文件或打开失败时返回 false
+    bool open(const std::filesystem::path& path);
+    void close();
+
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const unsigned char* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    // 实际类型为 HANDLE, 避免在头文件中引入 windows.h
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
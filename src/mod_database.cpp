@@ -0,0 +1,160 @@
+#include "mod_database.h"
+
+#include <iomanip>
+#include <sstream>
+#include "logger.h"
+#include "mod_layers.h"
+#include "override_rules.h"
+
+namespace fs = std::filesystem;
+
+// 旧一代被最后一个读者释放时调用, 记录它处理过的查询次数
+static void releaseGeneration(const IndexGeneration* generation) {
+    if (generation->generation > 1 || generation->queries.load() > 0) {
+        logMessage("第 " + std::to_string(generation->generation) + " 代索引已释放, 共处理 " +
+                   std::to_string(generation->queries.load()) + " 次查询");
+    }
+    delete generation;
+}
+
+ModDatabase::ModDatabase(fs::path jsonPath) : ModDatabase(std::vector<fs::path>{std::move(jsonPath)}, fs::path()) {}
+
+ModDatabase::ModDatabase(std::vector<fs::path> layers, fs::path rulesPath, fs::path cachePath)
+    : layers(std::move(layers)), rulesPath(std::move(rulesPath)), cachePath(std::move(cachePath)) {
+    for (const fs::path& layer : this->layers) {
+        sourceDescription += (sourceDescription.empty() ? "" : " + ") + layer.string();
+    }
+    if (!this->rulesPath.empty()) sourceDescription += " (覆盖规则 " + this->rulesPath.string() + ")";
+}
+
+ModDatabase::~ModDatabase() {
+    stopWatcher();
+}
+
+bool ModDatabase::readStamps(std::vector<FileStamp>& stamps) const {
+    std::vector<fs::path> files;
+    bool listed = listModLayerFiles(layers, files);
+    if (!rulesPath.empty()) files.push_back(rulesPath);
+    stamps.assign(files.size(), FileStamp());
+    for (size_t i = 0; i < files.size(); ++i) {
+        std::error_code ec;
+        stamps[i].path = std::move(files[i]);
+        stamps[i].modified = fs::last_write_time(stamps[i].path, ec);
+        if (ec) return false;
+        stamps[i].size = fs::file_size(stamps[i].path, ec);
+        if (ec) return false;
+    }
+    return listed;
+}
+
+bool ModDatabase::reload(ModDataStatus* status) {
+    std::lock_guard<std::mutex> lock(reloadMutex);
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<FileStamp> stamps;
+    readStamps(stamps);
+    // 无论成功与否都记录这次看到的版本, 写了一半的文件会在下次修改时重试, 不会反复报错
+    loadedStamps = stamps;
+
+    auto fail = [&](ModDataStatus readStatus) {
+        if (status != nullptr) *status = readStatus;
+        if (acquire()) {
+            logMessage("重新加载 " + sourceDescription + " 失败, 继续使用第 " +
+                       std::to_string(acquire()->generation) + " 代索引", true);
+        }
+        return false;
+    };
+    ModDataStatus readStatus = ModDataStatus::Ok;
+    MergedModData merged;
+    if (!loadModLayers(layers, cachePath, merged, &readStatus)) return fail(readStatus);
+    std::shared_ptr<OverrideRules> rules;
+    if (!rulesPath.empty()) {
+        rules = std::make_shared<OverrideRules>();
+        if (!rules->load(rulesPath)) {
+            return fail(fs::exists(rulesPath) ? ModDataStatus::ParseFailed : ModDataStatus::OpenFailed);
+        }
+    }
+    if (status != nullptr) *status = ModDataStatus::Ok;
+
+    std::shared_ptr<IndexGeneration> generation(new IndexGeneration, releaseGeneration);
+    generation->index = ModIndex(std::move(merged.names), std::move(merged.modIds));
+    if (rules) generation->index.setOverrideRules(std::move(rules));
+    generation->generation = nextGeneration++;
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double nanos = std::chrono::duration<double, std::nano>(elapsed).count();
+    generation->buildMillis = nanos / 1e6;
+
+    std::shared_ptr<const IndexGeneration> published = generation;
+    std::shared_ptr<const IndexGeneration> previous =
+            current.exchange(std::move(generation), std::memory_order_acq_rel);
+    lastReloadNanos.store(nanos);
+    ++reloads;
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2)
+       << "已加载第 " << published->generation << " 代索引: " << published->index.size() << " 个文件名, "
+       << published->index.modIdCount() << " 个 mod ID";
+    if (const OverrideRules* rules = published->index.overrideRules()) ss << ", " << rules->size() << " 条覆盖规则";
+    ss << ", 耗时 "
+       << published->buildMillis << " 毫秒";
+    if (previous) {
+        ss << ", 上一代 (第 " << previous->generation << " 代) 已处理 " << previous->queries.load() << " 次查询";
+    }
+    logMessage(ss.str());
+    return true;
+}
+
+bool ModDatabase::reloadIfChanged() {
+    std::vector<FileStamp> stamps;
+    if (!readStamps(stamps)) return false;
+    {
+        std::lock_guard<std::mutex> lock(reloadMutex);
+        if (stamps == loadedStamps) return false;
+    }
+    logMessage("检测到 " + sourceDescription + " 已修改, 正在后台重新加载...");
+    return reload();
+}
+
+void ModDatabase::startWatcher(std::chrono::milliseconds interval) {
+    stopWatcher();
+    {
+        std::lock_guard<std::mutex> lock(watcherMutex);
+        watcherStopping = false;
+    }
+    watcher = std::thread([this, interval] { watcherLoop(interval); });
+}
+
+void ModDatabase::stopWatcher() {
+    {
+        std::lock_guard<std::mutex> lock(watcherMutex);
+        watcherStopping = true;
+    }
+    watcherWake.notify_all();
+    if (watcher.joinable()) watcher.join();
+}
+
+void ModDatabase::requestReload() {
+    {
+        std::lock_guard<std::mutex> lock(watcherMutex);
+        reloadRequested = true;
+    }
+    watcherWake.notify_all();
+}
+
+void ModDatabase::watcherLoop(std::chrono::milliseconds interval) {
+    std::unique_lock<std::mutex> lock(watcherMutex);
+    while (!watcherStopping) {
+        watcherWake.wait_for(lock, interval, [this] { return watcherStopping || reloadRequested; });
+        if (watcherStopping) break;
+        bool forced = reloadRequested;
+        reloadRequested = false;
+        lock.unlock();
+        if (forced) {
+            logMessage("收到重新加载请求, 正在后台重新加载 " + sourceDescription + "...");
+            reload();
+        } else {
+            reloadIfChanged();
+        }
+        lock.lock();
+    }
+}
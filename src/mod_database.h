@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "classifier.h"
+#include "mod_info.h"
+
+// --- 一代索引 ---
+// 每次重新加载都会生成新的一代, 发布后只读; 最后一个持有者释放时记录这一代的查询次数
+struct IndexGeneration {
+    ModIndex index;
+    uint64_t generation = 0;
+    double buildMillis = 0;                  // 解析 JSON 并构建索引的耗时
+    mutable std::atomic<uint64_t> queries{0}; // 在这一代上执行的查询次数
+
+    // 记录一次查询 (可能包含多个文件名)
+    void countQuery(uint64_t names = 1) const { queries.fetch_add(names, std::memory_order_relaxed); }
+};
+
+// --- 可热重载的 Mod 数据库 ---
+// 每一代由各层数据库 (文件或分片目录, 见 mod_layers.h) 合并而成, 并挂上覆盖规则, 与命令行分类时的索引一致。
+// 查询方通过 acquire() 取得当前一代的快照, 整个请求期间持有它即可;
+// 重新加载在后台线程中解析并构建新索引, 然后原子地替换指针 (RCU 风格),
+// 旧索引在所有正在使用它的查询结束后自动释放, 查询路径上没有锁。
+class ModDatabase {
+public:
+    explicit ModDatabase(std::filesystem::path jsonPath);
+    // layers 后面的优先; rulesPath 不为空时每次加载都读取这个覆盖规则文件, 读取失败视为加载失败;
+    // cachePath 不为空时使用并更新合并结果的缓存
+    ModDatabase(std::vector<std::filesystem::path> layers, std::filesystem::path rulesPath,
+                std::filesystem::path cachePath = {});
+    ~ModDatabase();
+
+    ModDatabase(const ModDatabase&) = delete;
+    ModDatabase& operator=(const ModDatabase&) = delete;
+
+    // 同步加载 (用于启动), 失败时保留当前一代并返回 false; status 可选, 用于区分失败原因
+    bool reload(ModDataStatus* status = nullptr);
+
+    // 任何一个文件 (含分片的增减和覆盖规则) 的修改时间或大小变化时重新加载, 没有变化时返回 false
+    bool reloadIfChanged();
+
+    std::shared_ptr<const IndexGeneration> acquire() const {
+        return current.load(std::memory_order_acquire);
+    }
+
+    // 启动后台线程, 每隔 interval 检查一次文件是否变化
+    void startWatcher(std::chrono::milliseconds interval);
+    void stopWatcher();
+
+    // 请求后台线程立即重新加载 (例如收到 SIGHUP), 不等待完成
+    void requestReload();
+
+    // 日志中使用的数据库描述 (各层及规则文件的路径)
+    const std::string& description() const { return sourceDescription; }
+    uint64_t reloadCount() const { return reloads.load(); }
+    double lastReloadMillis() const { return lastReloadNanos.load() / 1e6; }
+
+private:
+    struct FileStamp {
+        std::filesystem::path path;
+        std::filesystem::file_time_type modified{};
+        uintmax_t size = 0;
+        bool operator==(const FileStamp& other) const {
+            return path == other.path && modified == other.modified && size == other.size;
+        }
+    };
+
+    // 所有参与加载的文件的状态, 任何一个无法读取时返回 false
+    bool readStamps(std::vector<FileStamp>& stamps) const;
+    void watcherLoop(std::chrono::milliseconds interval);
+
+    std::vector<std::filesystem::path> layers;
+    std::filesystem::path rulesPath;
+    std::filesystem::path cachePath;
+    std::string sourceDescription;
+    std::atomic<std::shared_ptr<const IndexGeneration>> current;
+    std::mutex reloadMutex;          // 串行化重新加载, 不影响查询
+    std::vector<FileStamp> loadedStamps; // 由 reloadMutex 保护
+    uint64_t nextGeneration = 1;     // 由 reloadMutex 保护
+    std::atomic<uint64_t> reloads{0};
+    std::atomic<double> lastReloadNanos{0};
+
+    std::thread watcher;
+    std::mutex watcherMutex;
+    std::condition_variable watcherWake;
+    bool watcherStopping = false;    // 由 watcherMutex 保护
+    bool reloadRequested = false;    // 由 watcherMutex 保护
+};
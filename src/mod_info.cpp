@@ -0,0 +1,215 @@
+#include "mod_info.h"
+
+#include <cstring>    // 用于 std::memcmp
+#include "include/nlohmann/json.hpp"
+#include "logger.h"
+#include "mapped_file.h"
+#include "normalizer.h"
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+
+std::string lowerCopy(std::string_view text) {
+    std::string lower(text);
+    for (char& c : lower) c = toLowerAscii(c);
+    return lower;
+}
+
+// --- SAX 解析 ---
+// 顶层必须是数组, 条目是其中的对象; 只保留 name、modid、type 和 aliases, 其余字段及更深的值直接跳过
+class ModEntryHandler : public nlohmann::json_sax<json> {
+public:
+    ModEntryHandler(std::vector<ModInfo>& mods, std::vector<std::string>& warnings, std::string source)
+        : mods(mods), warnings(warnings), source(std::move(source)) {}
+
+    bool notArray() const { return rootNotArray; }
+    const std::string& errorMessage() const { return error; }
+
+    bool null() override { return scalar(nullptr); }
+    bool boolean(bool) override { return scalar(nullptr); }
+    bool number_integer(number_integer_t) override { return scalar(nullptr); }
+    bool number_unsigned(number_unsigned_t) override { return scalar(nullptr); }
+    bool number_float(number_float_t, const string_t&) override { return scalar(nullptr); }
+    bool binary(binary_t&) override { return scalar(nullptr); }
+    bool string(string_t& text) override { return scalar(&text); }
+
+    bool start_object(std::size_t) override { return open(false); }
+    bool start_array(std::size_t) override { return open(true); }
+
+    bool key(string_t& name) override {
+        if (inEntryObject()) currentKey = name;
+        return true;
+    }
+
+    bool end_object() override {
+        containers.pop_back();
+        if (containers.size() == 1) endEntry();
+        return true;
+    }
+
+    bool end_array() override {
+        containers.pop_back();
+        if (containers.size() == 2) inAliases = false;
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& e) override {
+        error = "位置 " + std::to_string(position) + ": " + e.what();
+        return false;
+    }
+
+private:
+    // 正位于一个条目的字段上 (条目对象直接包含的值)
+    bool inEntryObject() const { return containers.size() == 2 && !containers.back(); }
+    // 正位于 aliases 数组的元素上
+    bool inAliasArray() const { return inAliases && containers.size() == 3; }
+
+    bool scalar(const string_t* text) {
+        if (containers.empty()) {
+            rootNotArray = true;
+            return false;
+        }
+        if (containers.size() == 1) {
+            invalidEntry();
+        } else if (inEntryObject()) {
+            field(text);
+        } else if (inAliasArray()) {
+            if (text) {
+                entry.aliases.push_back(lowerCopy(*text));
+            } else {
+                aliasesValid = false;
+            }
+        }
+        return true;
+    }
+
+    bool open(bool isArray) {
+        if (containers.empty()) {
+            if (!isArray) {
+                rootNotArray = true;
+                return false;
+            }
+        } else if (containers.size() == 1) {
+            if (isArray) {
+                invalidEntry();
+            } else {
+                beginEntry();
+            }
+        } else if (inEntryObject()) {
+            if (isArray && currentKey == "aliases") {
+                entry.aliases.clear();
+                aliasesValid = true;
+                inAliases = true;
+            } else {
+                field(nullptr);
+            }
+        } else if (inAliasArray()) {
+            aliasesValid = false;
+        }
+        containers.push_back(isArray);
+        return true;
+    }
+
+    // 条目的一个字段; text 为空表示值不是字符串
+    void field(const string_t* text) {
+        if (currentKey == "name") {
+            hasName = text != nullptr;
+            if (text) entry.name = lowerCopy(*text);
+        } else if (currentKey == "modid") {
+            hasModId = text != nullptr;
+            if (text) entry.modId = lowerCopy(*text);
+        } else if (currentKey == "type") {
+            hasType = text != nullptr;
+            if (text) entry.type = ModInfo::stringToModType(*text);
+        } else if (currentKey == "aliases") {
+            entry.aliases.clear();
+            aliasesValid = false;
+        }
+    }
+
+    void beginEntry() {
+        entry = ModInfo();
+        hasName = false;
+        hasModId = false;
+        hasType = false;
+        aliasesValid = true;
+        inAliases = false;
+        currentKey.clear();
+    }
+
+    void endEntry() {
+        // 旧格式只有 {name, type}; 新格式可以用 modid 代替 name, 并附带 aliases
+        if (!hasType || (!hasName && !hasModId)) {
+            invalidEntry();
+            return;
+        }
+        if (!hasName) entry.name.clear();
+        if (!hasModId) entry.modId.clear();
+        if (!aliasesValid) {
+            warnings.push_back(source + " 中 Mod 条目 " + (hasName ? entry.name : entry.modId) +
+                               " 的 aliases 中有无效的值, 已跳过。");
+        }
+        mods.push_back(std::move(entry));
+    }
+
+    void invalidEntry() { warnings.push_back(source + " 中存在无效的 Mod 条目, 已跳过。"); }
+
+    std::vector<ModInfo>& mods;
+    std::vector<std::string>& warnings;
+    std::string source;
+    std::vector<bool> containers; // true 为数组
+    std::string currentKey;
+    ModInfo entry;
+    bool hasName = false;
+    bool hasModId = false;
+    bool hasType = false;
+    bool aliasesValid = true;
+    bool inAliases = false;
+    bool rootNotArray = false;
+    std::string error;
+};
+
+} // namespace
+
+// --- 2. JSON 读取 ---
+std::vector<ModInfo> parseModData(const fs::path& path, ModDataStatus& status, std::string& error,
+                                  std::vector<std::string>& warnings) {
+    std::vector<ModInfo> mods;
+    status = ModDataStatus::Ok;
+    MappedFile file;
+    if (!file.open(path)) {
+        // 空文件无法映射, 与单个文件时一样视为解析失败
+        std::error_code ec;
+        bool empty = fs::is_regular_file(path, ec) && fs::file_size(path, ec) == 0;
+        status = empty ? ModDataStatus::ParseFailed : ModDataStatus::OpenFailed;
+        error = empty ? "文件为空" : "无法打开";
+        return mods;
+    }
+
+    const char* p = reinterpret_cast<const char*>(file.data());
+    const char* end = p + file.size();
+    if (end - p >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0) p += 3;
+    ModEntryHandler handler(mods, warnings, path.string());
+    if (!json::sax_parse(p, end, &handler)) {
+        status = ModDataStatus::ParseFailed;
+        error = handler.notArray() ? "内容不是一个有效的数组" : handler.errorMessage();
+    }
+    return mods;
+}
+
+std::vector<ModInfo> readModDataFromJson(const std::string& filePath, ModDataStatus* status) {
+    ModDataStatus result;
+    std::string error;
+    std::vector<std::string> warnings;
+    std::vector<ModInfo> mods = parseModData(filePath, result, error, warnings);
+    for (const std::string& warning : warnings) logMessage(warning, true);
+    if (result == ModDataStatus::OpenFailed) {
+        logMessage("无法打开 JSON 文件: " + filePath, true);
+    } else if (result == ModDataStatus::ParseFailed) {
+        logMessage("解析 JSON 文件 " + filePath + " 失败: " + error, true);
+    }
+    if (status) *status = result;
+    return mods;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// --- 1. Mod 数据结构定义 ---
+enum class ModType {
+    ClientOnly,                 // 仅客户端
+    ServerOnly,                 // 仅服务端
+    ClientRequiredServerOptional, // 客户端必装, 服务端可选
+    ClientOptionalServerRequired, // 客户端可选, 服务端必装
+    ClientAndServerRequired,    // 客户端和服务端都必装
+    ClientOptionalServerOptional,   // 客户端可选, 服务端可选
+    Unknown                     // 未知类型 (需在JSON中指定)
+};
+
+// --- 运行端需求的位掩码 ---
+// 除 Unknown 外, 每个 ModType 实际上是两个两位字段: 客户端和服务端各自 不需要 / 可选 / 必装。
+// 位 0-1 为客户端, 位 2-3 为服务端, 位 4 表示 Unknown; 取值都小于 32, 一组可接受的掩码可以放进一个 uint32_t
+enum class SideRequirement : uint8_t {
+    None = 0,
+    Optional = 1,
+    Required = 2
+};
+
+using SideMask = uint8_t;
+
+constexpr SideMask SIDE_MASK_UNKNOWN = 1u << 4;
+
+constexpr SideMask makeSideMask(SideRequirement client, SideRequirement server) {
+    return static_cast<SideMask>(static_cast<unsigned>(client) | (static_cast<unsigned>(server) << 2));
+}
+
+constexpr SideRequirement clientRequirement(SideMask mask) {
+    return static_cast<SideRequirement>(mask & 0x3);
+}
+
+constexpr SideRequirement serverRequirement(SideMask mask) {
+    return static_cast<SideRequirement>((mask >> 2) & 0x3);
+}
+
+constexpr SideMask modTypeToSideMask(ModType type) {
+    switch (type) {
+        case ModType::ClientOnly: return makeSideMask(SideRequirement::Required, SideRequirement::None);
+        case ModType::ServerOnly: return makeSideMask(SideRequirement::None, SideRequirement::Required);
+        case ModType::ClientRequiredServerOptional:
+            return makeSideMask(SideRequirement::Required, SideRequirement::Optional);
+        case ModType::ClientOptionalServerRequired:
+            return makeSideMask(SideRequirement::Optional, SideRequirement::Required);
+        case ModType::ClientAndServerRequired: return makeSideMask(SideRequirement::Required, SideRequirement::Required);
+        case ModType::ClientOptionalServerOptional:
+            return makeSideMask(SideRequirement::Optional, SideRequirement::Optional);
+        default: return SIDE_MASK_UNKNOWN;
+    }
+}
+
+// 掩码对应的类型; 没有对应类型的组合 (例如只有一端可选) 为空
+constexpr std::optional<ModType> sideMaskToModType(SideMask mask) {
+    constexpr ModType TYPES[] = {ModType::ClientOnly, ModType::ServerOnly, ModType::ClientRequiredServerOptional,
+                                 ModType::ClientOptionalServerRequired, ModType::ClientAndServerRequired,
+                                 ModType::ClientOptionalServerOptional, ModType::Unknown};
+    for (ModType type : TYPES) {
+        if (modTypeToSideMask(type) == mask) return type;
+    }
+    return std::nullopt;
+}
+
+struct ModInfo {
+    std::string name; // Mod 文件名 (这里指干净的名称, 用于匹配 JSON); 只按 mod ID 登记时为空
+    ModType type;     // Mod 类型
+    std::string modId;                // 可选, jar 描述文件中声明的 mod ID
+    std::vector<std::string> aliases; // 可选, 同一个 Mod 的其它干净文件名 (例如上游改过的文件名)
+
+    // 辅助函数, 严格解析 JSON 中使用的类型字符串, 无法识别时返回 nullopt (用于区分 "unknown" 和拼写错误)
+    static std::optional<ModType> parseModType(std::string_view typeStr) {
+        if (typeStr == "client_only") return ModType::ClientOnly;
+        if (typeStr == "server_only") return ModType::ServerOnly;
+        if (typeStr == "client_required_server_optional") return ModType::ClientRequiredServerOptional;
+        if (typeStr == "client_optional_server_required") return ModType::ClientOptionalServerRequired;
+        if (typeStr == "client_and_server_required") return ModType::ClientAndServerRequired;
+        if (typeStr == "client_optional_server_optional") return ModType::ClientOptionalServerOptional;
+        if (typeStr == "unknown") return ModType::Unknown; // 显式支持 unknown 类型
+        return std::nullopt;
+    }
+
+    // 辅助函数, 将字符串转换为 ModType 枚举
+    static ModType stringToModType(const std::string& typeStr) {
+        return parseModType(typeStr).value_or(ModType::Unknown); // 默认回退, 但主要依赖JSON的正确性
+    }
+
+    // 辅助函数, 将 ModType 枚举转换为 JSON 中使用的字符串
+    static std::string modTypeToString(ModType type) {
+        switch (type) {
+            case ModType::ClientOnly: return "client_only";
+            case ModType::ServerOnly: return "server_only";
+            case ModType::ClientRequiredServerOptional: return "client_required_server_optional";
+            case ModType::ClientOptionalServerRequired: return "client_optional_server_required";
+            case ModType::ClientAndServerRequired: return "client_and_server_required";
+            case ModType::ClientOptionalServerOptional: return "client_optional_server_optional";
+            case ModType::Unknown: return "unknown";
+            default: return "unknown";
+        }
+    }
+
+    // 辅助函数, 将 ModType 枚举转换为对应的目录名
+    static std::string modTypeToDirectory(ModType type) {
+        switch (type) {
+            case ModType::ClientOnly: return "ClientOnly";
+            case ModType::ServerOnly: return "ServerOnly";
+            case ModType::ClientRequiredServerOptional: return "ClientRequiredServerOptional";
+            case ModType::ClientOptionalServerRequired: return "ClientOptionalServerRequired";
+            case ModType::ClientAndServerRequired: return "ClientAndServerRequired";
+            case ModType::ClientOptionalServerOptional: return "ClientOptionalServerOptional";
+            case ModType::Unknown: return "Unknown"; // 处理在JSON中指定的Unknown类型
+            default: return "Unknown";
+        }
+    }
+};
+
+// 读取 Mod 数据的结果
+enum class ModDataStatus {
+    Ok,
+    OpenFailed,  // 文件无法打开
+    ParseFailed  // 文件不是有效的 JSON 数组
+};
+
+// 从 JSON 文件读取 Mod 数据 (SAX, 不构造 JSON 树), 不写日志, 可以在多个线程中同时调用。
+// 每个条目需要字符串的 type 以及 name 和 modid 中的至少一个, aliases 可选; 名称和 mod ID 统一转为小写。
+// 无效的条目跳过并记入 warnings, 文件本身的错误通过 status 和 error 返回, 此时结果为已读取的部分
+std::vector<ModInfo> parseModData(const std::filesystem::path& path, ModDataStatus& status, std::string& error,
+                                  std::vector<std::string>& warnings);
+
+// 同 parseModData, 警告和错误记录到日志
+std::vector<ModInfo> readModDataFromJson(const std::string& filePath, ModDataStatus* status = nullptr);
@@ -0,0 +1,382 @@
+#include "mod_layers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>    // 用于 std::memcmp
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string_view>
+#include "byte_order.h"
+#include "logger.h"
+#include "mapped_file.h"
+#include "normalizer.h"
+#include "thread_pool.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char MAGIC[4] = {'M', 'C', 'D', 'B'};
+constexpr uint32_t FORMAT_VERSION = 1;
+constexpr size_t HEADER_SIZE = 24;
+
+// 日志中最多逐条列出的冲突数, 其余只给出数量
+constexpr size_t MAX_LOGGED_CONFLICTS = 50;
+
+// 参与合并的一个文件: 单个文件的层, 或分片目录中的一个分片
+struct LayerSource {
+    fs::path path;
+    size_t layer = 0;
+};
+
+// 一个文件的状态, 与缓存中记录的一致时缓存有效
+struct LayerStamp {
+    std::string path;
+    uint64_t size = 0;
+    int64_t modified = 0;
+    bool operator==(const LayerStamp& other) const {
+        return path == other.path && size == other.size && modified == other.modified;
+    }
+};
+
+bool readStamp(const fs::path& path, LayerStamp& stamp) {
+    std::error_code ec;
+    stamp.path = path.string();
+    stamp.size = fs::file_size(path, ec);
+    if (ec) return false;
+    auto modified = fs::last_write_time(path, ec);
+    if (ec) return false;
+    stamp.modified = static_cast<int64_t>(modified.time_since_epoch().count());
+    return true;
+}
+
+// 顺序读取缓存内容, 越界后所有读取都失败
+class CacheReader {
+public:
+    CacheReader(const unsigned char* data, size_t size) : p(data), end(data + size) {}
+
+    bool ok() const { return valid; }
+    bool atEnd() const { return p == end; }
+
+    uint32_t u32() {
+        if (!take(4)) return 0;
+        return readLe32(p - 4);
+    }
+    uint64_t u64() {
+        if (!take(8)) return 0;
+        return readLe64(p - 8);
+    }
+    std::string_view bytes(size_t length) {
+        if (!take(length)) return {};
+        return std::string_view(reinterpret_cast<const char*>(p - length), length);
+    }
+
+private:
+    bool take(size_t length) {
+        if (!valid || static_cast<size_t>(end - p) < length) {
+            valid = false;
+            return false;
+        }
+        p += length;
+        return true;
+    }
+
+    const unsigned char* p;
+    const unsigned char* end;
+    bool valid = true;
+};
+
+// --- 辅助函数：展开各层 ---
+// 目录展开为其中的 .json 分片 (按路径排序, 优先级依次升高), 其余路径原样作为一个文件; 无法列出目录时返回 false。
+// report 为 false 时不写日志 (用于定期检查文件是否变化)
+bool listSources(const std::vector<fs::path>& layers, std::vector<LayerSource>& sources, bool report = true) {
+    bool complete = true;
+    for (size_t layer = 0; layer < layers.size(); ++layer) {
+        std::error_code ec;
+        if (!fs::is_directory(layers[layer], ec)) {
+            sources.push_back({layers[layer], layer});
+            continue;
+        }
+        std::vector<fs::path> shards;
+        for (fs::recursive_directory_iterator it(layers[layer], ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->is_regular_file(ec) && hasExtension(it->path().filename().string(), ".json")) {
+                shards.push_back(it->path());
+            }
+        }
+        if (ec) {
+            if (report) logMessage("无法列出数据库目录 " + layers[layer].string() + ": " + ec.message(), true);
+            complete = false;
+            continue;
+        }
+        if (shards.empty() && report) logMessage("数据库目录 " + layers[layer].string() + " 中没有 .json 分片。");
+        std::sort(shards.begin(), shards.end());
+        for (fs::path& shard : shards) sources.push_back({std::move(shard), layer});
+    }
+    return complete;
+}
+
+// --- 辅助函数：读取与写入缓存 ---
+// 格式: 头部 (魔数, 版本, 文件数, 名称数, mod ID 数, 冲突数), 每个文件的 (路径, 大小, 修改时间), 然后依次为
+// 名称和 mod ID 的 (长度, 字节, 类型)。缓存不存在、格式不对或任何一个文件有变化时返回 false
+bool readCache(const fs::path& cachePath, const std::vector<LayerStamp>& stamps, MergedModData& merged) {
+    if (!fs::exists(cachePath)) return false;
+    MappedFile mapped;
+    if (!mapped.open(cachePath)) return false;
+    const unsigned char* base = mapped.data();
+    if (mapped.size() < HEADER_SIZE || std::memcmp(base, MAGIC, 4) != 0 || readLe32(base + 4) != FORMAT_VERSION) {
+        logMessage("数据库缓存格式无效, 将重新生成: " + cachePath.string(), true);
+        return false;
+    }
+    CacheReader reader(base + HEADER_SIZE, mapped.size() - HEADER_SIZE);
+    uint32_t fileCount = readLe32(base + 8);
+    uint32_t nameCount = readLe32(base + 12);
+    uint32_t modIdCount = readLe32(base + 16);
+    uint32_t conflictCount = readLe32(base + 20);
+    if (fileCount != stamps.size()) return false;
+    for (const LayerStamp& expected : stamps) {
+        LayerStamp stored;
+        stored.path = std::string(reader.bytes(reader.u32()));
+        stored.size = reader.u64();
+        stored.modified = static_cast<int64_t>(reader.u64());
+        if (!reader.ok() || !(stored == expected)) return false;
+    }
+
+    MergedModData loaded;
+    auto readEntries = [&](uint32_t count, std::vector<std::pair<std::string, ModType>>& entries) {
+        // 每个条目至少 5 字节, 先检查数量以免按损坏的数量预留内存
+        if (static_cast<uint64_t>(count) * 5 > mapped.size()) return false;
+        entries.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            std::string_view key = reader.bytes(reader.u32());
+            std::string_view type = reader.bytes(1);
+            if (!reader.ok()) return false;
+            auto value = static_cast<unsigned char>(type[0]);
+            if (value > static_cast<unsigned char>(ModType::Unknown)) return false;
+            entries.emplace_back(std::string(key), static_cast<ModType>(value));
+        }
+        return true;
+    };
+    if (!readEntries(nameCount, loaded.names) || !readEntries(modIdCount, loaded.modIds) || !reader.atEnd()) {
+        logMessage("数据库缓存已损坏, 将重新生成: " + cachePath.string(), true);
+        return false;
+    }
+    loaded.conflictCount = conflictCount;
+    merged = std::move(loaded);
+    return true;
+}
+
+bool writeCache(const fs::path& cachePath, const std::vector<LayerStamp>& stamps, const MergedModData& merged) {
+    std::string data(MAGIC, sizeof(MAGIC));
+    appendLe32(data, FORMAT_VERSION);
+    appendLe32(data, static_cast<uint32_t>(stamps.size()));
+    appendLe32(data, static_cast<uint32_t>(merged.names.size()));
+    appendLe32(data, static_cast<uint32_t>(merged.modIds.size()));
+    appendLe32(data, static_cast<uint32_t>(merged.conflictCount));
+    for (const LayerStamp& stamp : stamps) {
+        appendLe32(data, static_cast<uint32_t>(stamp.path.size()));
+        data += stamp.path;
+        appendLe64(data, stamp.size);
+        appendLe64(data, static_cast<uint64_t>(stamp.modified));
+    }
+    for (const auto* entries : {&merged.names, &merged.modIds}) {
+        for (const auto& [key, type] : *entries) {
+            appendLe32(data, static_cast<uint32_t>(key.size()));
+            data += key;
+            data.push_back(static_cast<char>(type));
+        }
+    }
+
+    fs::path tempPath = cachePath;
+    tempPath += ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            logMessage("无法写入数据库缓存: " + tempPath.string(), true);
+            return false;
+        }
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!out) {
+            logMessage("写入数据库缓存失败: " + tempPath.string(), true);
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tempPath, cachePath, ec);
+    if (ec) {
+        logMessage("无法替换数据库缓存 " + cachePath.string() + ": " + ec.message(), true);
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+// --- 辅助函数：列出合并时的冲突 ---
+// 不同层之间的覆盖是分层的本意, 作为信息记录; 同一文件或同一层的两个分片中类型不同的重复条目多半是数据错误
+void logConflicts(const std::vector<LayerSource>& sources, const MergedModData& merged) {
+    size_t logged = 0;
+    for (const LayerConflict& conflict : merged.conflicts) {
+        if (logged++ == MAX_LOGGED_CONFLICTS) break;
+        const LayerSource& kept = sources[conflict.keptSource];
+        const LayerSource& dropped = sources[conflict.droppedSource];
+        std::string what = std::string(conflict.modId ? "mod ID " : "名称 ") + conflict.key;
+        if (conflict.keptSource == conflict.droppedSource) {
+            logMessage(kept.path.string() + " 中 " + what + " 重复且类型不同: 采用后出现的 " +
+                       ModInfo::modTypeToString(conflict.kept) + ", 忽略 " +
+                       ModInfo::modTypeToString(conflict.dropped), true);
+        } else if (kept.layer == dropped.layer) {
+            logMessage("分片 " + dropped.path.string() + " 与 " + kept.path.string() + " 中都有 " + what +
+                       " 且类型不同: 采用后者的 " + ModInfo::modTypeToString(conflict.kept) + ", 忽略 " +
+                       ModInfo::modTypeToString(conflict.dropped), true);
+        } else {
+            logMessage(what + ": " + kept.path.string() + " 的 " + ModInfo::modTypeToString(conflict.kept) +
+                       " 覆盖 " + dropped.path.string() + " 的 " + ModInfo::modTypeToString(conflict.dropped));
+        }
+    }
+    if (merged.conflicts.size() > MAX_LOGGED_CONFLICTS) {
+        logMessage("另有 " + std::to_string(merged.conflicts.size() - MAX_LOGGED_CONFLICTS) + " 个冲突未列出。");
+    }
+}
+
+} // namespace
+
+bool listModLayerFiles(const std::vector<fs::path>& layers, std::vector<fs::path>& files) {
+    std::vector<LayerSource> sources;
+    bool listed = listSources(layers, sources, false);
+    files.clear();
+    for (LayerSource& source : sources) files.push_back(std::move(source.path));
+    return listed;
+}
+
+MergedModData mergeModLayers(const std::vector<std::vector<ModInfo>>& sources) {
+    // 一条记录指向某个文件中的名称或 mod ID; ordinal 为在整个输入中的顺序, 越大越优先
+    struct Record {
+        std::string_view key;
+        uint32_t ordinal;
+        uint32_t source;
+        ModType type;
+    };
+    size_t nameTotal = 0;
+    size_t modIdTotal = 0;
+    for (const std::vector<ModInfo>& mods : sources) {
+        for (const ModInfo& mod : mods) {
+            nameTotal += (mod.name.empty() ? 0 : 1) + mod.aliases.size();
+            modIdTotal += mod.modId.empty() ? 0 : 1;
+        }
+    }
+    std::vector<Record> names;
+    std::vector<Record> modIds;
+    names.reserve(nameTotal);
+    modIds.reserve(modIdTotal);
+    uint32_t ordinal = 0;
+    for (uint32_t source = 0; source < sources.size(); ++source) {
+        for (const ModInfo& mod : sources[source]) {
+            if (!mod.name.empty()) names.push_back({mod.name, ordinal++, source, mod.type});
+            for (const std::string& alias : mod.aliases) names.push_back({alias, ordinal++, source, mod.type});
+            if (!mod.modId.empty()) modIds.push_back({mod.modId, ordinal++, source, mod.type});
+        }
+    }
+
+    MergedModData merged;
+    auto merge = [&](std::vector<Record>& records, std::vector<std::pair<std::string, ModType>>& out, bool modId) {
+        std::sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+            return a.key != b.key ? a.key < b.key : a.ordinal > b.ordinal;
+        });
+        for (size_t i = 0; i < records.size();) {
+            const Record& winner = records[i];
+            out.emplace_back(std::string(winner.key), winner.type);
+            size_t end = i + 1;
+            for (; end < records.size() && records[end].key == winner.key; ++end) {
+                const Record& loser = records[end];
+                if (loser.type == winner.type) {
+                    ++merged.redundant;
+                    continue;
+                }
+                merged.conflicts.push_back(
+                    {std::string(winner.key), modId, winner.type, winner.source, loser.type, loser.source});
+            }
+            i = end;
+        }
+    };
+    merged.names.reserve(names.size());
+    merge(names, merged.names, false);
+    merged.modIds.reserve(modIds.size());
+    merge(modIds, merged.modIds, true);
+    merged.conflictCount = merged.conflicts.size();
+    return merged;
+}
+
+bool loadModLayers(const std::vector<fs::path>& layers, const fs::path& cachePath, MergedModData& merged,
+                   ModDataStatus* status) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<LayerSource> sources;
+    bool listed = listSources(layers, sources);
+    std::vector<LayerStamp> stamps(sources.size());
+    bool stamped = listed;
+    for (size_t i = 0; i < sources.size(); ++i) stamped = readStamp(sources[i].path, stamps[i]) && stamped;
+
+    if (stamped && !cachePath.empty() && readCache(cachePath, stamps, merged)) {
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2) << "已从缓存载入 " << layers.size() << " 层数据库 ("
+           << sources.size() << " 个文件) 的合并结果: " << merged.names.size() << " 个名称, "
+           << merged.modIds.size() << " 个 mod ID (合并时有 " << merged.conflictCount << " 个冲突), 耗时 " << elapsed
+           << " 毫秒";
+        logMessage(ss.str());
+        if (status) *status = ModDataStatus::Ok;
+        return true;
+    }
+
+    // 每个文件由一个任务解析, 结果写入各自的位置, 之后按文件顺序记录日志
+    struct ParsedSource {
+        std::vector<ModInfo> mods;
+        ModDataStatus status = ModDataStatus::Ok;
+        std::string error;
+        std::vector<std::string> warnings;
+    };
+    std::vector<ParsedSource> parsed(sources.size());
+    size_t threads = std::min(defaultThreadCount(), std::max<size_t>(sources.size(), 1));
+    {
+        ThreadPool pool(threads);
+        parallelFor(pool, sources.size(), [&](size_t i) {
+            ParsedSource& result = parsed[i];
+            result.mods = parseModData(sources[i].path, result.status, result.error, result.warnings);
+        });
+    }
+    auto parsedAt = std::chrono::steady_clock::now();
+
+    bool complete = listed;
+    if (status) *status = listed ? ModDataStatus::Ok : ModDataStatus::OpenFailed;
+    std::vector<std::vector<ModInfo>> contents(sources.size());
+    for (size_t i = 0; i < sources.size(); ++i) {
+        ParsedSource& result = parsed[i];
+        for (const std::string& warning : result.warnings) logMessage(warning, true);
+        if (result.status == ModDataStatus::OpenFailed) {
+            logMessage("无法打开 JSON 文件: " + sources[i].path.string(), true);
+        } else if (result.status == ModDataStatus::ParseFailed) {
+            logMessage("解析 JSON 文件 " + sources[i].path.string() + " 失败: " + result.error, true);
+        }
+        if (result.status != ModDataStatus::Ok && complete) {
+            complete = false;
+            if (status) *status = result.status;
+        }
+        contents[i] = std::move(result.mods);
+    }
+    merged = mergeModLayers(contents);
+    auto finished = std::chrono::steady_clock::now();
+    double parseMillis = std::chrono::duration<double, std::milli>(parsedAt - start).count();
+    double mergeMillis = std::chrono::duration<double, std::milli>(finished - parsedAt).count();
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2) << "已合并 " << layers.size() << " 层数据库 (" << sources.size()
+       << " 个文件): " << merged.names.size() << " 个名称, " << merged.modIds.size() << " 个 mod ID, "
+       << merged.conflictCount << " 个冲突, " << merged.redundant << " 个类型相同的重复条目; 用 " << threads
+       << " 个线程读取耗时 " << parseMillis << " 毫秒, 合并耗时 " << mergeMillis << " 毫秒";
+    logMessage(ss.str());
+    logConflicts(sources, merged);
+
+    if (!complete) return false;
+    if (stamped && !cachePath.empty()) writeCache(cachePath, stamps, merged);
+    return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+#include "mod_info.h"
+
+// --- 分层的 Mod 数据库 ---
+// 按顺序给出多个 mods_data.json 格式的数据库 (例如 社区数据库 -> 站点数据库 -> 本机覆盖), 后面的层优先,
+// 同一层中后出现的条目优先 (与单个文件时一致)。
+// 一层也可以是目录 (例如 mods_data.d/): 其中 (含子目录) 的每个 .json 文件是这一层的一个分片, 按相对路径排序,
+// 例如按首字母或作者拆分, 避免贡献者都改同一个大数组。分片之间不应重复, 类型不同的重复条目作为错误报告。
+// 所有文件 (单个文件的层和各个分片) 由线程池并行读取, 每个文件一个 SAX 解析器, 直接生成条目而不构造 JSON 树;
+// 各自写入自己的结果, 读取期间没有共享的表, 也不需要锁, 跨分片的重复在之后排序时才发现。
+// 合并时不为每一层建立哈希表: 所有层的 (名称或别名 -> 类型) 和 (mod ID -> 类型) 放进一个扁平数组,
+// 按 (键, 文件, 条目顺序) 排序后一遍扫描, 每个键只保留优先级最高的一条, 类型不同的其余条目记为冲突;
+// 结果已经排序去重, 可以直接批量建立索引。
+// 合并结果写入二进制缓存, 记录每个文件的路径、大小和修改时间; 文件都没有变化 (也没有增减分片) 时直接读取缓存,
+// 不再解析 JSON。
+
+// 合并时被覆盖的一条类型不同的条目
+struct LayerConflict {
+    std::string key;
+    bool modId = false; // 冲突的是 mod ID, 而不是名称或别名
+    ModType kept;
+    size_t keptSource = 0; // 在 mergeModLayers 的输入中的序号
+    ModType dropped;
+    size_t droppedSource = 0;
+};
+
+struct MergedModData {
+    std::vector<std::pair<std::string, ModType>> names;  // 按名称排序, 没有重复
+    std::vector<std::pair<std::string, ModType>> modIds; // 按 mod ID 排序, 没有重复
+    std::vector<LayerConflict> conflicts;                // 按键排序; 读取缓存时为空, 只有 conflictCount
+    size_t conflictCount = 0;
+    size_t redundant = 0; // 被覆盖但类型相同的条目数
+};
+
+// 合并已经读出的各个文件, sources[0] 优先级最低
+MergedModData mergeModLayers(const std::vector<std::vector<ModInfo>>& sources);
+
+// 读取并合并各层 (文件或分片目录), cachePath 不为空时优先使用并更新缓存; 合并结果和冲突写入日志。
+// 任何一个文件无法读取或解析时返回 false (merged 中为其余文件的合并结果), 此时不写缓存;
+// status 可选, 为第一个出错的文件的状态 (无法列出分片目录时为 OpenFailed)
+bool loadModLayers(const std::vector<std::filesystem::path>& layers, const std::filesystem::path& cachePath,
+                   MergedModData& merged, ModDataStatus* status = nullptr);
+
+// 各层展开后参与合并的文件 (分片目录展开为其中的分片), 不写日志; 无法列出某个目录时返回 false
+bool listModLayerFiles(const std::vector<std::filesystem::path>& layers, std::vector<std::filesystem::path>& files);
@@ -0,0 +1,154 @@
+#include "mod_version.h"
+
+#include "normalizer.h"
+
+namespace {
+
+// 预发布标记的顺序, 正式版排在最后
+constexpr int RANK_RELEASE = 4;
+
+struct QualifierRank {
+    std::string_view word;
+    int rank;
+};
+
+constexpr QualifierRank QUALIFIERS[] = {
+    {"snapshot", 0}, {"alpha", 1}, {"a", 1}, {"beta", 2}, {"b", 2}, {"pre", 3}, {"rc", 3}, {"release", RANK_RELEASE},
+};
+
+// 与版本先后无关的字母段
+constexpr std::string_view IGNORED_WORDS[] = {"forge", "fabric", "quilt", "neoforge", "rift", "liteloader",
+                                              "nilloader", "mc", "universal", "all", "v"};
+
+bool equalsNoCase(std::string_view text, std::string_view word) {
+    if (text.size() != word.size()) return false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (toLowerAscii(text[i]) != word[i]) return false;
+    }
+    return true;
+}
+
+enum class TokenKind { End, Number, Qualifier, Word };
+
+struct Token {
+    TokenKind kind = TokenKind::End;
+    std::string_view text; // 数字段已去掉前导零
+    int rank = 0;          // 预发布标记的顺序
+};
+
+// --- 辅助函数：逐个取出版本中的数字段和字母段 ---
+class VersionTokens {
+public:
+    explicit VersionTokens(std::string_view text) : text(text) {}
+
+    Token next() {
+        while (pos < text.size()) {
+            char c = text[pos];
+            if (isAsciiDigit(c)) {
+                size_t start = pos;
+                while (pos < text.size() && isAsciiDigit(text[pos])) ++pos;
+                size_t significant = start;
+                while (significant + 1 < pos && text[significant] == '0') ++significant;
+                return {TokenKind::Number, text.substr(significant, pos - significant), 0};
+            }
+            if (isAsciiAlpha(c)) {
+                size_t start = pos;
+                while (pos < text.size() && isAsciiAlpha(text[pos])) ++pos;
+                std::string_view word = text.substr(start, pos - start);
+                if (isIgnored(word)) continue;
+                for (const QualifierRank& qualifier : QUALIFIERS) {
+                    if (equalsNoCase(word, qualifier.word)) return {TokenKind::Qualifier, word, qualifier.rank};
+                }
+                return {TokenKind::Word, word, 0};
+            }
+            ++pos; // 分隔符和其它字符
+        }
+        return {};
+    }
+
+private:
+    static bool isIgnored(std::string_view word) {
+        for (std::string_view ignored : IGNORED_WORDS) {
+            if (equalsNoCase(word, ignored)) return true;
+        }
+        return false;
+    }
+
+    std::string_view text;
+    size_t pos = 0;
+};
+
+int compareNumbers(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+    int result = a.compare(b);
+    return result < 0 ? -1 : result > 0 ? 1 : 0;
+}
+
+int compareWords(std::string_view a, std::string_view b) {
+    size_t length = a.size() < b.size() ? a.size() : b.size();
+    for (size_t i = 0; i < length; ++i) {
+        char x = toLowerAscii(a[i]);
+        char y = toLowerAscii(b[i]);
+        if (x != y) return x < y ? -1 : 1;
+    }
+    return a.size() == b.size() ? 0 : a.size() < b.size() ? -1 : 1;
+}
+
+// 一方已经结束时, 另一方剩余的第一个段决定先后: 预发布标记说明对方是预发布版, 否则对方更新
+int compareWithEnd(const Token& remaining) {
+    if (remaining.kind == TokenKind::Qualifier) return remaining.rank < RANK_RELEASE ? 1 : 0;
+    return -1;
+}
+
+// 段的类别: 预发布标记 < 字母 < 数字; 1.0-beta 比 1.0-foo 旧, 1.0-foo 比 1.0.1 旧
+int kindOrder(const Token& token) {
+    switch (token.kind) {
+        case TokenKind::Qualifier: return 0;
+        case TokenKind::Word: return 1;
+        default: return 2;
+    }
+}
+
+int compareParts(std::string_view a, std::string_view b) {
+    VersionTokens left(a);
+    VersionTokens right(b);
+    while (true) {
+        Token x = left.next();
+        Token y = right.next();
+        if (x.kind == TokenKind::End && y.kind == TokenKind::End) return 0;
+        if (x.kind == TokenKind::End) return compareWithEnd(y);
+        if (y.kind == TokenKind::End) return -compareWithEnd(x);
+
+        int result = 0;
+        if (x.kind != y.kind) {
+            result = kindOrder(x) < kindOrder(y) ? -1 : 1;
+        } else if (x.kind == TokenKind::Number) {
+            result = compareNumbers(x.text, y.text);
+        } else if (x.kind == TokenKind::Qualifier) {
+            result = x.rank == y.rank ? 0 : x.rank < y.rank ? -1 : 1;
+        } else {
+            result = compareWords(x.text, y.text);
+        }
+        if (result != 0) return result;
+    }
+}
+
+} // namespace
+
+int compareModVersions(std::string_view a, std::string_view b) {
+    size_t plusA = a.find('+');
+    size_t plusB = b.find('+');
+    std::string_view mainA = a.substr(0, plusA);
+    std::string_view mainB = b.substr(0, plusB);
+    int result = compareParts(mainA, mainB);
+    if (result != 0) return result;
+    std::string_view buildA = plusA == std::string_view::npos ? std::string_view() : a.substr(plusA + 1);
+    std::string_view buildB = plusB == std::string_view::npos ? std::string_view() : b.substr(plusB + 1);
+    return compareParts(buildA, buildB);
+}
+
+std::string extractModVersion(const std::string& fullFileName) {
+    std::string version;
+    getCleanModName(fullFileName, &version);
+    return version;
+}
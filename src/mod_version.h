@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// --- Mod 版本号比较 ---
+// 文件名中的版本号大致遵循 semver, 但常混有 Minecraft 版本和加载器名, 例如
+// "1.20.1-15.2.0.27"、"mc1.20.1-2.3"、"1.0.0-beta.3+build.7"、"forge-1.20.1-47.2.0"。
+// 比较时把版本拆成数字段和字母段 (分隔符和字母/数字的边界都会切分), 不分配内存:
+//   - 数字段按数值比较 (任意长度, 不会溢出)
+//   - snapshot < alpha (a) < beta (b) < pre / rc < 正式版, 正式版即没有预发布标记
+//   - 加载器名、mc、universal 等与版本无关的字母段忽略, 其它字母段按不区分大小写的字典序比较
+//   - 较短的版本在对方后面还有数字段时较旧 (1.0 < 1.0.1), 后面是预发布标记时较新 (1.0 > 1.0-beta)
+//   - '+' 之后的构建信息只在其余部分相同时才参与比较
+
+// a 比 b 旧时返回负数, 相同时返回 0, 较新时返回正数
+int compareModVersions(std::string_view a, std::string_view b);
+
+// 文件名中的版本信息, 即 getCleanModName 去掉的部分
+std::string extractModVersion(const std::string& fullFileName);
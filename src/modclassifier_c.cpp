@@ -0,0 +1,198 @@
+// libmodclassifier 的 C 接口实现, 只负责参数检查、类型转换和异常隔离,
+// 具体逻辑都在 C++ 模块中
+#include "include/modclassifier.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <vector>
+#include "classifier.h"
+#include "logger.h"
+#include "mod_database.h"
+#include "mod_info.h"
+
+// 每次调用都取当前一代的快照, 因此 mc_db_reload 可以与查询并发进行
+struct mc_db {
+    explicit mc_db(const char* path) : database(path) {}
+    mc_db(std::vector<std::filesystem::path> layers, std::filesystem::path rulesPath)
+        : database(std::move(layers), std::move(rulesPath)) {}
+    ModDatabase database;
+};
+
+static mc_status toCStatus(ModDataStatus status) {
+    switch (status) {
+        case ModDataStatus::Ok: return MC_OK;
+        case ModDataStatus::OpenFailed: return MC_ERR_IO;
+        default: return MC_ERR_PARSE;
+    }
+}
+
+static mc_mod_type toCType(const std::optional<ModType>& type) {
+    if (!type) return MC_TYPE_NOT_FOUND;
+    // ModType 的枚举顺序与 mc_mod_type 的数值一致
+    return static_cast<mc_mod_type>(static_cast<int>(*type));
+}
+
+extern "C" {
+
+uint32_t mc_api_version(void) {
+    return MC_API_VERSION;
+}
+
+void mc_set_log_callback(mc_log_fn fn, void* user_data) {
+    if (fn == nullptr) {
+        setLogCallback(nullptr);
+        setConsoleLogging(true);
+        return;
+    }
+    setConsoleLogging(false);
+    setLogCallback([fn, user_data](const std::string& message, bool isError) {
+        fn(message.c_str(), isError ? 1 : 0, user_data);
+    });
+}
+
+mc_status mc_db_open(const char* json_path, mc_db** out_db) {
+    if (json_path == nullptr || out_db == nullptr) return MC_ERR_INVALID_ARGUMENT;
+    *out_db = nullptr;
+    try {
+        auto db = std::make_unique<mc_db>(json_path);
+        ModDataStatus status = ModDataStatus::Ok;
+        if (!db->database.reload(&status)) return toCStatus(status);
+        *out_db = db.release();
+        return MC_OK;
+    } catch (const std::bad_alloc&) {
+        return MC_ERR_INTERNAL;
+    } catch (const std::exception& e) {
+        logMessage(std::string("加载数据库失败: ") + e.what(), true);
+        return MC_ERR_INTERNAL;
+    }
+}
+
+mc_status mc_db_open_layers(const char* const* paths, size_t count, const char* rules_path, mc_db** out_db) {
+    if (paths == nullptr || count == 0 || out_db == nullptr) return MC_ERR_INVALID_ARGUMENT;
+    *out_db = nullptr;
+    try {
+        std::vector<std::filesystem::path> layers;
+        for (size_t i = 0; i < count; ++i) {
+            if (paths[i] == nullptr) return MC_ERR_INVALID_ARGUMENT;
+            layers.emplace_back(paths[i]);
+        }
+        auto db = std::make_unique<mc_db>(std::move(layers),
+                                          rules_path ? std::filesystem::path(rules_path) : std::filesystem::path());
+        ModDataStatus status = ModDataStatus::Ok;
+        if (!db->database.reload(&status)) return toCStatus(status);
+        *out_db = db.release();
+        return MC_OK;
+    } catch (const std::bad_alloc&) {
+        return MC_ERR_INTERNAL;
+    } catch (const std::exception& e) {
+        logMessage(std::string("加载数据库失败: ") + e.what(), true);
+        return MC_ERR_INTERNAL;
+    }
+}
+
+mc_status mc_db_reload(mc_db* db) {
+    if (db == nullptr) return MC_ERR_INVALID_ARGUMENT;
+    try {
+        ModDataStatus status = ModDataStatus::Ok;
+        db->database.reload(&status);
+        return toCStatus(status);
+    } catch (const std::bad_alloc&) {
+        return MC_ERR_INTERNAL;
+    } catch (const std::exception& e) {
+        logMessage(std::string("重新加载数据库失败: ") + e.what(), true);
+        return MC_ERR_INTERNAL;
+    }
+}
+
+void mc_db_close(mc_db* db) {
+    delete db;
+}
+
+size_t mc_db_size(const mc_db* db) {
+    return db ? db->database.acquire()->index.size() : 0;
+}
+
+mc_mod_type mc_classify_name(const mc_db* db, const char* file_name, char* clean_name, size_t clean_name_size) {
+    if (db == nullptr || file_name == nullptr) return MC_TYPE_NOT_FOUND;
+    try {
+        ClassifyResult result = classifyFileName(db->database.acquire()->index, file_name);
+        if (clean_name != nullptr && clean_name_size > 0) {
+            size_t length = std::min(result.cleanName.size(), clean_name_size - 1);
+            std::memcpy(clean_name, result.cleanName.data(), length);
+            clean_name[length] = '\0';
+        }
+        return toCType(result.type);
+    } catch (const std::exception&) {
+        return MC_TYPE_NOT_FOUND;
+    }
+}
+
+mc_mod_type mc_classify_modid(const mc_db* db, const char* mod_id) {
+    if (db == nullptr || mod_id == nullptr) return MC_TYPE_NOT_FOUND;
+    try {
+        return toCType(db->database.acquire()->index.findModId(mod_id));
+    } catch (const std::exception&) {
+        return MC_TYPE_NOT_FOUND;
+    }
+}
+
+mc_status mc_classify_batch(const mc_db* db, const char* const* file_names, size_t count, mc_mod_type* out_types) {
+    if (db == nullptr || (count > 0 && (file_names == nullptr || out_types == nullptr))) {
+        return MC_ERR_INVALID_ARGUMENT;
+    }
+    try {
+        // 整批使用同一代索引
+        std::shared_ptr<const IndexGeneration> snapshot = db->database.acquire();
+        for (size_t i = 0; i < count; ++i) {
+            out_types[i] = file_names[i] ? toCType(classifyFileName(snapshot->index, file_names[i]).type) : MC_TYPE_NOT_FOUND;
+        }
+        return MC_OK;
+    } catch (const std::exception&) {
+        return MC_ERR_INTERNAL;
+    }
+}
+
+mc_status mc_classify_dir(const mc_db* db, const char* input_dir, const char* output_dir, mc_dir_stats* out_stats) {
+    if (db == nullptr || input_dir == nullptr || output_dir == nullptr) return MC_ERR_INVALID_ARGUMENT;
+    if (out_stats != nullptr) *out_stats = mc_dir_stats{};
+    try {
+        if (!std::filesystem::is_directory(input_dir)) {
+            logMessage(std::string("输入路径不是一个目录: ") + input_dir, true);
+            return MC_ERR_IO;
+        }
+        ClassifyStats stats = classifyMods(db->database.acquire()->index, input_dir, output_dir);
+        if (out_stats != nullptr) {
+            out_stats->total = stats.total;
+            out_stats->classified = stats.classified;
+            out_stats->skipped = stats.skipped;
+            out_stats->not_found = stats.notFound;
+            out_stats->failed = stats.failed;
+        }
+        return MC_OK;
+    } catch (const std::filesystem::filesystem_error& e) {
+        logMessage(std::string("分类目录失败: ") + e.what(), true);
+        return MC_ERR_IO;
+    } catch (const std::exception& e) {
+        logMessage(std::string("分类目录失败: ") + e.what(), true);
+        return MC_ERR_INTERNAL;
+    }
+}
+
+const char* mc_mod_type_name(mc_mod_type type) {
+    switch (type) {
+        case MC_TYPE_CLIENT_ONLY: return "client_only";
+        case MC_TYPE_SERVER_ONLY: return "server_only";
+        case MC_TYPE_CLIENT_REQUIRED_SERVER_OPTIONAL: return "client_required_server_optional";
+        case MC_TYPE_CLIENT_OPTIONAL_SERVER_REQUIRED: return "client_optional_server_required";
+        case MC_TYPE_CLIENT_AND_SERVER_REQUIRED: return "client_and_server_required";
+        case MC_TYPE_CLIENT_OPTIONAL_SERVER_OPTIONAL: return "client_optional_server_optional";
+        case MC_TYPE_UNKNOWN: return "unknown";
+        default: return "not_found";
+    }
+}
+
+} // extern "C"
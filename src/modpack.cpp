@@ -0,0 +1,216 @@
+#include "modpack.h"
+
+#include <fstream>
+#include <system_error>
+#include <unordered_map>
+#include "dump_import.h"
+#include "hash_index.h"
+#include "include/nlohmann/json.hpp"
+#include "logger.h"
+#include "normalizer.h"
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace {
+
+// 超过这个大小的 jar 视为异常, 不解压
+constexpr uint64_t MAX_JAR_SIZE = 1024ull * 1024 * 1024;
+// modrinth.index.json / manifest.json 的大小上限
+constexpr uint64_t MAX_MANIFEST_SIZE = 64ull * 1024 * 1024;
+
+constexpr std::string_view MODRINTH_INDEX = "modrinth.index.json";
+constexpr std::string_view CURSEFORGE_MANIFEST = "manifest.json";
+constexpr std::string_view CLIENT_OVERRIDES = "client-overrides/";
+constexpr std::string_view SERVER_OVERRIDES = "server-overrides/";
+
+// --- 辅助函数：取出直接位于 mods 目录下的文件名 ---
+// 不是 Mod 或文件名可能逃出输出目录 (含反斜杠、盘符、"..") 时返回空
+std::string_view modFileName(std::string_view path) {
+    size_t slash = path.rfind('/');
+    if (slash == std::string_view::npos) return {};
+    std::string_view name = path.substr(slash + 1);
+    std::string_view directory = path.substr(0, slash);
+    size_t parentStart = directory.rfind('/');
+    std::string_view parent = parentStart == std::string_view::npos ? directory : directory.substr(parentStart + 1);
+    if (parent != "mods") return {};
+    if (name.empty() || name == "." || name == ".." || name.find_first_of("\\:") != std::string_view::npos) return {};
+    return name;
+}
+
+std::string sideEvidence(const std::string& client, const std::string& server) {
+    return "env client=" + client + ", server=" + server;
+}
+
+} // namespace
+
+bool isModpackArchive(const fs::path& path) {
+    std::string fileName = path.filename().string();
+    return hasExtension(fileName, ".zip") || hasExtension(fileName, ".mrpack");
+}
+
+const char* modpackFormatName(ModpackFormat format) {
+    switch (format) {
+        case ModpackFormat::Modrinth: return "Modrinth (.mrpack)";
+        case ModpackFormat::CurseForge: return "CurseForge";
+        default: return "zip";
+    }
+}
+
+bool Modpack::open(const fs::path& path) {
+    archivePath = path;
+    mods.clear();
+    curseForgeFiles = 0;
+    packFormat = ModpackFormat::Zip;
+    if (!archive.open(path)) return false;
+
+    std::optional<ZipEntry> modrinthIndex;
+    std::optional<ZipEntry> curseForgeManifest;
+    bool complete = archive.forEachEntry([&](const ZipEntry& entry) {
+        if (entry.name == MODRINTH_INDEX) modrinthIndex = entry;
+        if (entry.name == CURSEFORGE_MANIFEST) curseForgeManifest = entry;
+        if (entry.isDirectory()) return true;
+        std::string_view name = modFileName(entry.name);
+        if (name.empty()) return true;
+
+        ModpackEntry mod;
+        mod.fileName = std::string(name);
+        mod.path = std::string(entry.name);
+        mod.entry = entry;
+        if (entry.name.starts_with(CLIENT_OVERRIDES)) {
+            mod.declared = ModType::ClientOnly;
+            mod.declaredEvidence = "client-overrides";
+        } else if (entry.name.starts_with(SERVER_OVERRIDES)) {
+            mod.declared = ModType::ServerOnly;
+            mod.declaredEvidence = "server-overrides";
+        }
+        mods.push_back(std::move(mod));
+        return true;
+    });
+    if (!complete) {
+        logMessage("整合包的中央目录已损坏: " + path.string(), true);
+        return false;
+    }
+
+    if (modrinthIndex) {
+        packFormat = ModpackFormat::Modrinth;
+        readModrinthIndex(*modrinthIndex);
+    } else if (curseForgeManifest) {
+        packFormat = ModpackFormat::CurseForge;
+        readCurseForgeManifest(*curseForgeManifest);
+    }
+    return true;
+}
+
+void Modpack::readModrinthIndex(const ZipEntry& indexEntry) {
+    std::string text;
+    if (!archive.extract(indexEntry, text, MAX_MANIFEST_SIZE)) {
+        logMessage("无法读取整合包中的 modrinth.index.json", true);
+        return;
+    }
+    json index = json::parse(text, nullptr, false);
+    if (index.is_discarded() || !index.is_object() || !index.contains("files") || !index["files"].is_array()) {
+        logMessage("整合包中的 modrinth.index.json 格式无效", true);
+        return;
+    }
+
+    // 清单中的文件一般不在归档里; 已经随归档打包的 (例如重新压缩过的实例) 合并到同一个条目
+    std::unordered_map<std::string, size_t> byPath;
+    for (size_t i = 0; i < mods.size(); ++i) byPath.emplace(mods[i].path, i);
+
+    size_t listed = mods.size();
+    for (const auto& file : index["files"]) {
+        if (!file.is_object() || !file.contains("path") || !file["path"].is_string()) continue;
+        std::string path = file["path"].get<std::string>();
+        std::string_view name = modFileName(path);
+        if (name.empty()) continue;
+
+        ModpackEntry* mod;
+        auto found = byPath.find(path);
+        if (found == byPath.end()) found = byPath.find("overrides/" + path);
+        if (found != byPath.end()) {
+            mod = &mods[found->second];
+        } else {
+            mods.push_back({});
+            mod = &mods.back();
+            mod->fileName = std::string(name);
+            mod->path = path;
+        }
+
+        if (file.contains("env") && file["env"].is_object()) {
+            // 整合包是不可信的输入, env 中的值不是字符串时 (例如 null) 忽略这个声明, 而不是让 value() 抛出异常
+            const json& env = file["env"];
+            auto side = [&](const char* key) -> std::optional<std::string> {
+                if (!env.contains(key)) return std::string();
+                if (!env[key].is_string()) return std::nullopt;
+                return env[key].get<std::string>();
+            };
+            std::optional<std::string> client = side("client");
+            std::optional<std::string> server = side("server");
+            if (!client || !server) {
+                logMessage("modrinth.index.json 中 " + path + " 的 env 取值无效, 已忽略其声明的运行端", true);
+            } else if (auto type = modTypeFromSides(*client, *server)) {
+                mod->declared = type;
+                mod->declaredEvidence = sideEvidence(*client, *server);
+            }
+        }
+        if (file.contains("hashes") && file["hashes"].is_object()) {
+            const json& hashes = file["hashes"];
+            if (hashes.contains("sha1") && hashes["sha1"].is_string()) {
+                mod->sha1Key = hashKeyFromHex(hashes["sha1"].get<std::string>(), 20);
+            }
+            if (hashes.contains("sha512") && hashes["sha512"].is_string()) {
+                mod->sha512Key = hashKeyFromHex(hashes["sha512"].get<std::string>(), 64);
+            }
+        }
+    }
+    logMessage("modrinth.index.json 中列出 " + std::to_string(mods.size() - listed) + " 个需要下载的 Mod");
+}
+
+void Modpack::readCurseForgeManifest(const ZipEntry& manifestEntry) {
+    std::string text;
+    if (!archive.extract(manifestEntry, text, MAX_MANIFEST_SIZE)) {
+        logMessage("无法读取整合包中的 manifest.json", true);
+        return;
+    }
+    json manifest = json::parse(text, nullptr, false);
+    if (manifest.is_discarded() || !manifest.is_object() || !manifest.contains("files") ||
+        !manifest["files"].is_array()) {
+        logMessage("整合包中的 manifest.json 格式无效", true);
+        return;
+    }
+    curseForgeFiles = manifest["files"].size();
+}
+
+bool Modpack::load(const ModpackEntry& mod, std::string& storage, std::string_view& bytes) const {
+    bytes = {};
+    if (!mod.entry) return false;
+    if (mod.entry->method == 0) return archive.extractToWindow(*mod.entry, MAX_JAR_SIZE, bytes);
+    if (!archive.extract(*mod.entry, storage, MAX_JAR_SIZE)) return false;
+    bytes = storage;
+    return true;
+}
+
+bool Modpack::write(const ModpackEntry& mod, const fs::path& destination, std::string& error) const {
+    if (!mod.entry) {
+        error = "归档中没有这个文件";
+        return false;
+    }
+    std::string storage;
+    std::string_view bytes;
+    if (!load(mod, storage, bytes)) {
+        error = "条目已损坏、加密或使用了不支持的压缩方法";
+        return false;
+    }
+
+    std::ofstream out(destination, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    out.close();
+    if (!out) {
+        error = "无法写入 " + destination.string();
+        std::error_code ec;
+        fs::remove(destination, ec);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mod_info.h"
+#include "zip_reader.h"
+
+// --- 整合包归档 ---
+// 直接从整合包 (.zip / .mrpack / CurseForge 导出的 .zip) 的中央目录中列出 mods/ 下的文件, 不解压到 Input。
+// 归档通过内存映射打开, 只有需要读取 jar 内容 (指纹、描述文件、字节码) 或写出分类结果时才取出对应条目:
+// 存储的条目直接引用归档数据, 压缩的条目解压到内存中。
+//   .mrpack:    modrinth.index.json 的 files[] 中 mods/ 下的文件带有 env.client / env.server 和哈希,
+//               这些文件不在归档里 (由启动器下载), 直接按 env 和哈希分类; overrides/ 中的 jar 正常分类,
+//               client-overrides/ 和 server-overrides/ 中的 jar 视为仅客户端 / 仅服务端
+//   CurseForge: manifest.json 的 files[] 只有项目 ID 和文件 ID, 无法离线分类, 只统计个数; overrides/ 中的 jar 正常分类
+//   其它 zip:   所有直接位于名为 mods 的目录下的文件
+
+enum class ModpackFormat {
+    Zip,        // 普通 zip
+    Modrinth,   // .mrpack (modrinth.index.json)
+    CurseForge  // CurseForge 导出 (manifest.json)
+};
+
+struct ModpackEntry {
+    std::string fileName;            // 文件名 (不含目录), 用于匹配数据库和写出
+    std::string path;                // 在归档或清单中的完整路径
+    std::optional<ZipEntry> entry;   // 只在清单中列出、归档中没有文件时为空
+    std::optional<ModType> declared; // 整合包声明的运行端
+    std::string declaredEvidence;    // 用于日志, 例如 "env client=required, server=unsupported"
+    std::optional<uint64_t> sha1Key; // 清单给出的哈希对应的索引键, 不读文件即可查哈希索引
+    std::optional<uint64_t> sha512Key;
+};
+
+class Modpack {
+public:
+    Modpack() = default;
+
+    Modpack(const Modpack&) = delete;
+    Modpack& operator=(const Modpack&) = delete;
+
+    // 映射归档并列出其中的 Mod, 不是有效的 zip 时返回 false
+    bool open(const std::filesystem::path& path);
+
+    const std::filesystem::path& path() const { return archivePath; }
+    ModpackFormat format() const { return packFormat; }
+    const std::vector<ModpackEntry>& entries() const { return mods; }
+    // CurseForge 清单中只有项目 ID 的文件数
+    size_t unnamedDownloads() const { return curseForgeFiles; }
+
+    // 取得条目中 jar 的内容: 存储的条目直接指向归档数据, 压缩的条目解压到 storage; 校验失败时返回 false
+    bool load(const ModpackEntry& mod, std::string& storage, std::string_view& bytes) const;
+
+    // 条目压缩数据在归档中的位置, 用于原样复制到其它 zip; 归档中没有这个文件时为 nullptr
+    const unsigned char* rawData(const ModpackEntry& mod) const {
+        return mod.entry ? archive.rawData(*mod.entry) : nullptr;
+    }
+
+    // 把条目写到 destination, 失败时返回 false 并给出原因
+    bool write(const ModpackEntry& mod, const std::filesystem::path& destination, std::string& error) const;
+
+private:
+    void readModrinthIndex(const ZipEntry& indexEntry);
+    void readCurseForgeManifest(const ZipEntry& manifestEntry);
+
+    std::filesystem::path archivePath;
+    ZipReader archive;
+    ModpackFormat packFormat = ModpackFormat::Zip;
+    std::vector<ModpackEntry> mods;
+    size_t curseForgeFiles = 0;
+};
+
+// 路径是否为整合包归档 (.zip / .mrpack, 扩展名不区分大小写)
+bool isModpackArchive(const std::filesystem::path& path);
+
+const char* modpackFormatName(ModpackFormat format);
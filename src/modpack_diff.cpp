@@ -0,0 +1,192 @@
+#include "modpack_diff.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include "logger.h"
+#include "mod_version.h"
+#include "modpack.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string typeName(const std::optional<ModType>& type) {
+    return type ? ModInfo::modTypeToDirectory(*type) : "未分类";
+}
+
+// --- 辅助函数：排序后同一干净名称只保留版本最新的文件 ---
+// 只有重复的名称才需要提取版本号, 通常一边没有重复, 整体是一次排序加一次扫描
+void sortAndDedupe(std::vector<DiffMod>& mods) {
+    std::sort(mods.begin(), mods.end(), [](const DiffMod& a, const DiffMod& b) {
+        return a.cleanName != b.cleanName ? a.cleanName < b.cleanName : a.fileName < b.fileName;
+    });
+    size_t kept = 0;
+    for (size_t i = 0; i < mods.size();) {
+        size_t end = i + 1;
+        while (end < mods.size() && mods[end].cleanName == mods[i].cleanName) ++end;
+        size_t newest = i;
+        if (end - i > 1) {
+            std::string newestVersion = extractModVersion(mods[i].fileName);
+            for (size_t k = i + 1; k < end; ++k) {
+                std::string version = extractModVersion(mods[k].fileName);
+                if (compareModVersions(version, newestVersion) > 0) {
+                    newest = k;
+                    newestVersion = std::move(version);
+                }
+            }
+        }
+        if (kept != newest) mods[kept] = std::move(mods[newest]);
+        ++kept;
+        i = end;
+    }
+    mods.resize(kept);
+}
+
+const char* changeLabel(DiffChange change) {
+    switch (change) {
+        case DiffChange::Added: return "新增";
+        case DiffChange::Removed: return "移除";
+        case DiffChange::Upgraded: return "升级";
+        case DiffChange::Downgraded: return "降级";
+        case DiffChange::Replaced: return "替换";
+        default: return "类型变化";
+    }
+}
+
+} // namespace
+
+bool listDiffMods(const std::string& path, const ModIndex& index, NormalizeCache* nameCache,
+                  std::vector<DiffMod>& mods) {
+    mods.clear();
+    if (fs::is_regular_file(path)) {
+        Modpack modpack;
+        if (!isModpackArchive(path) || !modpack.open(path)) {
+            logMessage("无法打开整合包: " + path + " (支持 .zip 和 .mrpack)", true);
+            return false;
+        }
+        mods.reserve(modpack.entries().size());
+        for (const ModpackEntry& entry : modpack.entries()) {
+            ClassifyResult result = classifyFileName(index, entry.fileName, nameCache);
+            // 整合包声明的运行端优先于数据库, 但不优先于覆盖规则, 与分类时一致
+            bool declared = entry.declared && result.overrideRule.empty();
+            mods.push_back({std::move(result.cleanName), entry.fileName, declared ? entry.declared : result.type});
+        }
+        return true;
+    }
+
+    std::error_code ec;
+    fs::directory_iterator it(path, ec);
+    if (ec) {
+        logMessage("无法读取目录: " + path + " (" + ec.message() + ")", true);
+        return false;
+    }
+    for (const auto& entry : it) {
+        if (!entry.is_regular_file()) continue;
+        std::string fileName = entry.path().filename().string();
+        ClassifyResult result = classifyFileName(index, fileName, nameCache);
+        mods.push_back({std::move(result.cleanName), std::move(fileName), result.type});
+    }
+    return true;
+}
+
+ModpackDiff diffModLists(std::vector<DiffMod> oldMods, std::vector<DiffMod> newMods) {
+    sortAndDedupe(oldMods);
+    sortAndDedupe(newMods);
+
+    ModpackDiff diff;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < oldMods.size() || j < newMods.size()) {
+        if (j == newMods.size() || (i < oldMods.size() && oldMods[i].cleanName < newMods[j].cleanName)) {
+            const DiffMod& removed = oldMods[i++];
+            diff.changes.push_back({DiffChange::Removed, removed.cleanName, removed.fileName, "", removed.type,
+                                    std::nullopt});
+            continue;
+        }
+        if (i == oldMods.size() || newMods[j].cleanName < oldMods[i].cleanName) {
+            const DiffMod& added = newMods[j++];
+            diff.changes.push_back({DiffChange::Added, added.cleanName, "", added.fileName, std::nullopt, added.type});
+            continue;
+        }
+
+        const DiffMod& before = oldMods[i++];
+        const DiffMod& after = newMods[j++];
+        DiffChange change;
+        if (before.fileName == after.fileName) {
+            if (before.type == after.type) {
+                ++diff.unchanged;
+                continue;
+            }
+            change = DiffChange::Reclassified;
+        } else {
+            int order = compareModVersions(extractModVersion(before.fileName), extractModVersion(after.fileName));
+            change = order < 0 ? DiffChange::Upgraded : order > 0 ? DiffChange::Downgraded : DiffChange::Replaced;
+        }
+        diff.changes.push_back({change, after.cleanName, before.fileName, after.fileName, before.type, after.type});
+    }
+    return diff;
+}
+
+void logModpackDiff(const ModpackDiff& diff) {
+    size_t counts[6] = {};
+    for (const DiffEntry& entry : diff.changes) ++counts[static_cast<size_t>(entry.change)];
+    std::stringstream summary;
+    summary << "整合包对比: 新增 " << counts[0] << ", 移除 " << counts[1] << ", 升级 " << counts[2] << ", 降级 "
+            << counts[3] << ", 替换 " << counts[4] << ", 类型变化 " << counts[5] << ", 未变 " << diff.unchanged;
+    logMessage(summary.str());
+
+    // 移除的按原类型分组, 其它按新类型分组; 未分类的排在最后
+    constexpr size_t GROUPS = static_cast<size_t>(ModType::Unknown) + 2;
+    std::vector<const DiffEntry*> groups[GROUPS];
+    for (const DiffEntry& entry : diff.changes) {
+        const std::optional<ModType>& type = entry.change == DiffChange::Removed ? entry.oldType : entry.newType;
+        groups[type ? static_cast<size_t>(*type) : GROUPS - 1].push_back(&entry);
+    }
+    for (size_t g = 0; g < GROUPS; ++g) {
+        if (groups[g].empty()) continue;
+        std::optional<ModType> type;
+        if (g + 1 < GROUPS) type = static_cast<ModType>(g);
+        logMessage("[" + typeName(type) + "] " + std::to_string(groups[g].size()) + " 项变化");
+        for (const DiffEntry* entry : groups[g]) {
+            std::string line = std::string("  ") + changeLabel(entry->change) + ": ";
+            if (entry->change == DiffChange::Added) {
+                line += entry->newFile;
+            } else if (entry->change == DiffChange::Removed) {
+                line += entry->oldFile;
+            } else if (entry->change == DiffChange::Reclassified) {
+                line += entry->newFile;
+            } else {
+                line += entry->oldFile + " -> " + entry->newFile;
+            }
+            bool bothSides = entry->change != DiffChange::Added && entry->change != DiffChange::Removed;
+            if (bothSides && entry->oldType != entry->newType) {
+                line += " (类型 " + typeName(entry->oldType) + " -> " + typeName(entry->newType) + ")";
+            }
+            logMessage(line);
+        }
+    }
+}
+
+bool runModpackDiff(const std::string& oldPath, const std::string& newPath, const ModIndex& index,
+                    NormalizeCache* nameCache) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<DiffMod> oldMods;
+    std::vector<DiffMod> newMods;
+    if (!listDiffMods(oldPath, index, nameCache, oldMods) || !listDiffMods(newPath, index, nameCache, newMods)) {
+        return false;
+    }
+    size_t oldCount = oldMods.size();
+    size_t newCount = newMods.size();
+    ModpackDiff diff = diffModLists(std::move(oldMods), std::move(newMods));
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2) << "已对比 " << oldPath << " (" << oldCount << " 个文件) 和 " << newPath
+       << " (" << newCount << " 个文件), 耗时 " << elapsed << " 毫秒";
+    logMessage(ss.str());
+    logModpackDiff(diff);
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+#include "classifier.h"
+#include "mod_info.h"
+#include "normalize_cache.h"
+
+// --- 整合包对比 ---
+// 比较同一整合包的两个版本 (Input 目录或 .zip / .mrpack 归档), 不读取 jar 内容, 也不做完整分类:
+// 两边的文件名用同一套清理规则 (及文件名缓存) 得到干净名称, 排序后线性归并,
+// 找出新增、移除、版本变化和类型变化的 Mod, 按类型分组报告。类型取自数据库 (按干净名称) 或整合包的声明。
+
+// 一边的一个 Mod
+struct DiffMod {
+    std::string cleanName;
+    std::string fileName;
+    std::optional<ModType> type;
+};
+
+enum class DiffChange {
+    Added,
+    Removed,
+    Upgraded,
+    Downgraded,
+    Replaced,    // 文件名变了, 但版本号分不出先后
+    Reclassified // 文件名相同, 只有类型变了
+};
+
+struct DiffEntry {
+    DiffChange change;
+    std::string cleanName;
+    std::string oldFile; // 新增时为空
+    std::string newFile; // 移除时为空
+    std::optional<ModType> oldType;
+    std::optional<ModType> newType;
+};
+
+struct ModpackDiff {
+    std::vector<DiffEntry> changes; // 按干净名称排序
+    size_t unchanged = 0;
+};
+
+// 列出目录或整合包归档中的 Mod 并查出类型, 无法读取时返回 false
+bool listDiffMods(const std::string& path, const ModIndex& index, NormalizeCache* nameCache,
+                  std::vector<DiffMod>& mods);
+
+// 比较两边; 同一边干净名称重复时只取版本最新的文件
+ModpackDiff diffModLists(std::vector<DiffMod> oldMods, std::vector<DiffMod> newMods);
+
+// 按类型分组写入日志
+void logModpackDiff(const ModpackDiff& diff);
+
+// 完整流程: 列出两边、比较并写入日志, 任何一边无法读取时返回 false
+bool runModpackDiff(const std::string& oldPath, const std::string& newPath, const ModIndex& index,
+                    NormalizeCache* nameCache);
@@ -0,0 +1,67 @@
+#include "nested_jar.h"
+
+#include "normalizer.h"
+
+namespace {
+
+constexpr std::string_view NESTED_JAR_DIRECTORIES[] = {"META-INF/jars/", "META-INF/jarjar/"};
+
+} // namespace
+
+bool isNestedJarEntry(std::string_view name) {
+    if (!hasExtension(name, ".jar")) return false;
+    for (std::string_view directory : NESTED_JAR_DIRECTORIES) {
+        if (name.substr(0, directory.size()) == directory) return true;
+    }
+    return false;
+}
+
+void NestedJarSet::open(const ZipReader& root, const NestedJarLimits& limits) {
+    jars.clear();
+    usedBytes = 0;
+    truncated = false;
+    expand(root, "", 1, limits);
+}
+
+void NestedJarSet::expand(const ZipReader& parent, const std::string& parentPath, size_t depth,
+                          const NestedJarLimits& limits) {
+    // 先收集本层的条目, 再逐个展开
+    std::vector<ZipEntry> entries;
+    parent.forEachEntry([&](const ZipEntry& entry) {
+        if (!entry.isEncrypted() && isNestedJarEntry(entry.name)) entries.push_back(entry);
+        return true;
+    });
+    if (!entries.empty() && depth > limits.maxDepth) {
+        truncated = true;
+        return;
+    }
+
+    for (const ZipEntry& entry : entries) {
+        // 大小以中央目录声明的为准, 解压时也不会超过声明的大小, 因此可以在解压前检查预算
+        if (jars.size() >= limits.maxJars || entry.uncompressedSize > limits.maxTotalBytes - usedBytes) {
+            truncated = true;
+            return;
+        }
+
+        auto nested = std::make_unique<NestedJar>();
+        nested->path = parentPath.empty() ? std::string(entry.name) : parentPath + "!/" + std::string(entry.name);
+        nested->depth = depth;
+        bool opened;
+        if (entry.method == 0) {
+            const unsigned char* raw = parent.rawData(entry);
+            opened = raw != nullptr && entry.compressedSize == entry.uncompressedSize &&
+                     nested->reader.openMemory(raw, static_cast<size_t>(entry.uncompressedSize));
+        } else {
+            opened = parent.extract(entry, nested->storage, static_cast<size_t>(limits.maxTotalBytes - usedBytes)) &&
+                     nested->reader.openMemory(reinterpret_cast<const unsigned char*>(nested->storage.data()),
+                                               nested->storage.size());
+        }
+        usedBytes += entry.uncompressedSize;
+        if (!opened) continue;
+
+        const ZipReader& reader = nested->reader;
+        std::string path = nested->path;
+        jars.push_back(std::move(nested));
+        expand(reader, path, depth + 1, limits);
+    }
+}
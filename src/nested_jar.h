@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "zip_reader.h"
+
+// --- 内嵌 jar ---
+// Fabric / Quilt 把依赖库放在 META-INF/jars/ 下, Forge / NeoForge 的 JarJar 放在 META-INF/jarjar/ 下。
+// 这里递归展开这些内嵌 jar: 存储的条目直接在父 jar 的数据上打开, 压缩的条目解压到内存中打开,
+// 不写临时文件。深度、数量和解压总量都有上限, 恶意构造的 jar 无法耗尽内存或 CPU。
+
+struct NestedJarLimits {
+    size_t maxDepth = 3;                          // 顶层 jar 内的第一层深度为 1
+    size_t maxJars = 256;                         // 展开的内嵌 jar 总数
+    uint64_t maxTotalBytes = 128ull * 1024 * 1024; // 所有内嵌 jar 的解压后大小之和
+};
+
+struct NestedJar {
+    std::string path;    // 从顶层 jar 开始的路径, 例如 "META-INF/jars/a.jar!/META-INF/jars/b.jar"
+    size_t depth = 0;
+    std::string storage; // 压缩条目解压后的数据; 存储的条目为空, 直接引用父 jar 的数据
+    ZipReader reader;
+};
+
+// 一个 jar 中递归展开的全部内嵌 jar; 内嵌 jar 的数据可能引用顶层 jar 或其它内嵌 jar,
+// 因此顶层 ZipReader 必须比这个对象存活更久
+class NestedJarSet {
+public:
+    NestedJarSet() = default;
+
+    NestedJarSet(const NestedJarSet&) = delete;
+    NestedJarSet& operator=(const NestedJarSet&) = delete;
+
+    // 深度优先展开 root 中的内嵌 jar, 会清空之前的结果
+    void open(const ZipReader& root, const NestedJarLimits& limits = {});
+
+    size_t size() const { return jars.size(); }
+    bool empty() const { return jars.empty(); }
+    const NestedJar& operator[](size_t i) const { return *jars[i]; }
+
+    // 是否有内嵌 jar 因为超出限制没有展开
+    bool limitReached() const { return truncated; }
+    uint64_t totalBytes() const { return usedBytes; }
+
+private:
+    void expand(const ZipReader& parent, const std::string& parentPath, size_t depth, const NestedJarLimits& limits);
+
+    std::vector<std::unique_ptr<NestedJar>> jars;
+    uint64_t usedBytes = 0;
+    bool truncated = false;
+};
+
+// 条目是否位于约定的内嵌 jar 目录中
+bool isNestedJarEntry(std::string_view name);
@@ -0,0 +1,207 @@
+#include "normalize_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>    // 用于 std::memcmp
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include "byte_order.h"
+#include "logger.h"
+#include "normalizer.h"
+
+namespace fs = std::filesystem;
+
+static constexpr char MAGIC[4] = {'M', 'C', 'N', 'C'};
+static constexpr uint32_t FORMAT_VERSION = 1;
+static constexpr size_t HEADER_SIZE = 28;
+static constexpr size_t ENTRY_SIZE = 16;
+static constexpr size_t MAX_ENTRIES = 200000;
+
+NormalizeCache::NormalizeCache() : normalizerHash(computeNormalizerHash()) {}
+
+bool NormalizeCache::load(const std::filesystem::path& path) {
+    cachePath = path;
+    mapped.close();
+    entryCount = 0;
+    if (!fs::exists(path)) return false;
+    if (!mapped.open(path)) {
+        logMessage("无法映射文件名缓存: " + path.string(), true);
+        return false;
+    }
+    const unsigned char* base = mapped.data();
+    if (mapped.size() < HEADER_SIZE || std::memcmp(base, MAGIC, 4) != 0 ||
+        readLe32(base + 4) != FORMAT_VERSION) {
+        logMessage("文件名缓存格式无效, 将重新生成: " + path.string(), true);
+        mapped.close();
+        return false;
+    }
+    if (readLe64(base + 8) != normalizerHash) {
+        logMessage("清理规则已变化, 文件名缓存失效, 将重新生成。");
+        mapped.close();
+        return false;
+    }
+    uint32_t count = readLe32(base + 16);
+    uint64_t blobSize = readLe32(base + 20);
+    uint64_t expected = HEADER_SIZE + static_cast<uint64_t>(count) * ENTRY_SIZE + blobSize;
+    if (expected != mapped.size()) {
+        logMessage("文件名缓存长度不匹配, 将重新生成: " + path.string(), true);
+        mapped.close();
+        return false;
+    }
+    const unsigned char* entries = base + HEADER_SIZE;
+    for (uint32_t i = 0; i < count; ++i) {
+        const unsigned char* e = entries + static_cast<size_t>(i) * ENTRY_SIZE;
+        if (static_cast<uint64_t>(readLe32(e)) + readLe32(e + 4) > blobSize ||
+            static_cast<uint64_t>(readLe32(e + 8)) + readLe32(e + 12) > blobSize) {
+            logMessage("文件名缓存条目越界, 将重新生成: " + path.string(), true);
+            mapped.close();
+            return false;
+        }
+    }
+    entryCount = count;
+    storedNormalizeNanos = readLe32(base + 24);
+    touched.assign(count, false);
+    return true;
+}
+
+std::string NormalizeCache::getCleanName(const std::string& fullFileName) {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    std::optional<std::string_view> hit = findMapped(fullFileName);
+    if (!hit) {
+        auto it = added.find(fullFileName);
+        if (it != added.end()) hit = it->second;
+    }
+    auto looked = clock::now();
+    stats.lookupNanos += std::chrono::duration<double, std::nano>(looked - start).count();
+    if (hit) {
+        ++stats.hits;
+        return std::string(*hit);
+    }
+
+    std::string clean = getCleanModName(fullFileName);
+    stats.normalizeNanos += std::chrono::duration<double, std::nano>(clock::now() - looked).count();
+    ++stats.misses;
+    added.emplace(fullFileName, clean);
+    return clean;
+}
+
+bool NormalizeCache::save() {
+    if (cachePath.empty() || added.empty()) return true;
+
+    std::vector<std::pair<std::string, std::string>> all;
+    all.reserve(entryCount + added.size());
+    // 条目过多时只保留本次运行用到的旧条目, 防止缓存无限增长
+    bool pruneUnused = entryCount + added.size() > MAX_ENTRIES;
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        if (pruneUnused && !touched[i]) continue;
+        all.emplace_back(std::string(rawAt(i)), std::string(cleanAt(i)));
+    }
+    for (const auto& item : added) all.push_back(item);
+    std::sort(all.begin(), all.end());
+    all.erase(std::unique(all.begin(), all.end(),
+                          [](const auto& a, const auto& b) { return a.first == b.first; }), all.end());
+
+    std::string blob;
+    std::string index;
+    for (const auto& item : all) {
+        appendLe32(index, static_cast<uint32_t>(blob.size()));
+        appendLe32(index, static_cast<uint32_t>(item.first.size()));
+        blob += item.first;
+        appendLe32(index, static_cast<uint32_t>(blob.size()));
+        appendLe32(index, static_cast<uint32_t>(item.second.size()));
+        blob += item.second;
+    }
+    std::string header(MAGIC, 4);
+    appendLe32(header, FORMAT_VERSION);
+    appendLe32(header, static_cast<uint32_t>(normalizerHash));
+    appendLe32(header, static_cast<uint32_t>(normalizerHash >> 32));
+    appendLe32(header, static_cast<uint32_t>(all.size()));
+    appendLe32(header, static_cast<uint32_t>(blob.size()));
+    appendLe32(header, static_cast<uint32_t>(averageNormalizeNanos()));
+
+    // Windows 下被映射的文件无法被替换, 先解除映射
+    mapped.close();
+    entryCount = 0;
+    touched.clear();
+
+    fs::path tempPath = cachePath;
+    tempPath += ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            logMessage("无法写入文件名缓存: " + tempPath.string(), true);
+            return false;
+        }
+        out.write(header.data(), static_cast<std::streamsize>(header.size()));
+        out.write(index.data(), static_cast<std::streamsize>(index.size()));
+        out.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+        if (!out) {
+            logMessage("写入文件名缓存失败: " + tempPath.string(), true);
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tempPath, cachePath, ec);
+    if (ec) {
+        logMessage("无法替换文件名缓存 " + cachePath.string() + ": " + ec.message(), true);
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    added.clear();
+    return true;
+}
+
+void NormalizeCache::logSummary() const {
+    size_t total = stats.hits + stats.misses;
+    if (total == 0) return;
+    double avgNormalize = averageNormalizeNanos();
+    double avgLookup = stats.lookupNanos / static_cast<double>(total);
+    double savedMs = std::max(0.0, static_cast<double>(stats.hits) * (avgNormalize - avgLookup)) / 1e6;
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1)
+       << "文件名缓存: 命中 " << stats.hits << "/" << total
+       << " (" << 100.0 * static_cast<double>(stats.hits) / static_cast<double>(total) << "%)"
+       << std::setprecision(3) << ", 预计节省 " << savedMs << " 毫秒";
+    logMessage(ss.str());
+}
+
+double NormalizeCache::averageNormalizeNanos() const {
+    if (stats.misses == 0) return storedNormalizeNanos;
+    return stats.normalizeNanos / static_cast<double>(stats.misses);
+}
+
+const unsigned char* NormalizeCache::entryAt(uint32_t i) const {
+    return mapped.data() + HEADER_SIZE + static_cast<size_t>(i) * ENTRY_SIZE;
+}
+
+const char* NormalizeCache::blobBase() const {
+    return reinterpret_cast<const char*>(mapped.data() + HEADER_SIZE + static_cast<size_t>(entryCount) * ENTRY_SIZE);
+}
+
+std::string_view NormalizeCache::rawAt(uint32_t i) const {
+    return {blobBase() + readLe32(entryAt(i)), readLe32(entryAt(i) + 4)};
+}
+
+std::string_view NormalizeCache::cleanAt(uint32_t i) const {
+    return {blobBase() + readLe32(entryAt(i) + 8), readLe32(entryAt(i) + 12)};
+}
+
+std::optional<std::string_view> NormalizeCache::findMapped(std::string_view raw) {
+    uint32_t lo = 0, hi = entryCount;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        std::string_view key = rawAt(mid);
+        if (key < raw) {
+            lo = mid + 1;
+        } else if (raw < key) {
+            hi = mid;
+        } else {
+            touched[mid] = true;
+            return cleanAt(mid);
+        }
+    }
+    return std::nullopt;
+}
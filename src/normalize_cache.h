@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "mapped_file.h"
+
+// --- 文件名清理结果的持久化缓存 ---
+// 同样的 jar 文件名会在大量整合包之间重复出现, 把 "原始文件名 -> 干净名称" 缓存到磁盘,
+// 下次运行通过内存映射直接二分查找, 不再重新执行清理规则。
+// 文件格式 (小端):
+//   头部:   magic "MCNC" | u32 格式版本 | u64 清理规则哈希 | u32 条目数 | u32 字符串区长度
+//           | u32 历史单次清理耗时 (纳秒, 用于在全部命中时估算节省的时间)
+//   索引:   按原始文件名排序的条目 { u32 原名偏移, u32 原名长度, u32 干净名偏移, u32 干净名长度 }
+//   字符串区
+class NormalizeCache {
+public:
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        double lookupNanos = 0;    // 所有查找 (含命中和未命中) 的耗时
+        double normalizeNanos = 0; // 未命中时执行清理规则的耗时
+    };
+
+    NormalizeCache();
+
+    // 加载缓存文件, 文件不存在、损坏或清理规则已变化时返回 false (此时视为空缓存)
+    bool load(const std::filesystem::path& path);
+
+    // 查找缓存, 未命中时执行 getCleanModName 并记录结果
+    std::string getCleanName(const std::string& fullFileName);
+
+    // 将旧条目与本次新增条目合并后写回磁盘 (先写临时文件再替换)
+    bool save();
+
+    const Stats& getStats() const { return stats; }
+
+    // 将命中率和节省的时间写入日志
+    void logSummary() const;
+
+private:
+    // 单次清理的平均耗时, 本次没有未命中项时使用缓存文件中记录的历史值
+    double averageNormalizeNanos() const;
+
+    const unsigned char* entryAt(uint32_t i) const;
+    const char* blobBase() const;
+    std::string_view rawAt(uint32_t i) const;
+    std::string_view cleanAt(uint32_t i) const;
+
+    // 在映射的有序索引中二分查找
+    std::optional<std::string_view> findMapped(std::string_view raw);
+
+    uint64_t normalizerHash;
+    std::filesystem::path cachePath;
+    MappedFile mapped;
+    uint32_t entryCount = 0;
+    double storedNormalizeNanos = 0;
+    std::vector<bool> touched;                               // 映射条目在本次运行中是否被用到
+    std::unordered_map<std::string, std::string> added;      // 本次运行新增的条目
+    Stats stats;
+};
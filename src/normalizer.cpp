@@ -0,0 +1,276 @@
+#include "normalizer.h"
+
+#include <algorithm>  // 用于 std::transform
+#include <cctype>
+#include <vector>
+
+// 版本后缀中可以单独出现的关键字 (加载器、预发布标记等)
+static const std::string_view SUFFIX_KEYWORDS[] = {
+        "forge", "fabric", "quilt", "neoforge", "rift", "liteloader", "nilloader",
+        "snapshot", "pre", "rc", "beta", "alpha",
+        "universal", "all", "mc"
+};
+
+// 需要与紧随其后的数字分开的加载器名称, 顺序即匹配优先级
+static const std::string_view LOADER_NAMES[] = {
+        "forge", "fabric", "quilt", "neoforge", "rift", "liteloader", "nilloader"
+};
+
+// --- 辅助函数：查找文件名末尾可被剥离的版本后缀 ---
+// 后缀语法与旧版正则相同:
+//   分隔符 [-_+\s.]+ 之后跟
+//     v?[0-9]+(?:[._-][0-9a-zA-Z_+-]+)*  |  mc[0-9]+(?:\.[0-9]+)*  |  关键字
+//   末尾允许空白
+// 旧实现用 std::regex 反复替换直到不动点, 嵌套量词会导致回溯爆炸, 超长文件名还会栈溢出。
+// 这里从右向左做一次动态规划, 直接求出"由若干个后缀首尾相接组成"的最长后缀,
+// 与迭代替换的结果一致, 时间和内存都与文件名长度成线性关系。
+// 返回后缀的起始位置, 没有可剥离的后缀时返回 name.size()。
+size_t findVersionSuffixStart(const std::string& name) {
+    size_t end = name.size();
+    while (end > 0 && isSpaceChar(name[end - 1])) {
+        --end;
+    }
+
+    // 每个位置 p 的状态, 含义均为 "name[p, end) 能否被以下结构完整匹配 (之后的部分也合法)"
+    struct State {
+        bool tail = false;     // 一个或多个完整后缀
+        bool alt = false;      // 后缀主体, 其后跟零个或多个完整后缀
+        bool groups = false;   // (?:[._-][0-9a-zA-Z_+-]+)*
+        bool groupBody = false;// [0-9a-zA-Z_+-]+ 再接 groups
+        bool digits = false;   // [0-9]+ 再接 groups
+        bool mcDigits = false; // [0-9]+(?:\.[0-9]+)*
+        bool mcDots = false;   // (?:\.[0-9]+)*
+    };
+    std::vector<State> st(end + 1);
+
+    // 末尾位置: 只有 "零个重复" 的结构可以匹配空串
+    st[end].groups = true;
+    st[end].mcDots = true;
+
+    size_t suffixStart = name.size();
+    for (size_t p = end; p-- > 0;) {
+        const char c = name[p];
+        const State& next = st[p + 1];
+        State& cur = st[p];
+
+        const bool isSeparator = c == '-' || c == '_' || c == '+' || c == '.' || isSpaceChar(c);
+        const bool isGroupChar = isAsciiDigit(c) || isAsciiAlpha(c) || c == '_' || c == '+' || c == '-';
+
+        cur.tail = isSeparator && (next.tail || next.alt);
+        const bool restOk = cur.tail; // p < end, 所以 "已到结尾" 不成立
+
+        cur.groupBody = isGroupChar && (next.groups || next.groupBody);
+        cur.groups = restOk || ((c == '.' || c == '_' || c == '-') && next.groupBody);
+        cur.digits = isAsciiDigit(c) && (next.groups || next.digits);
+        cur.mcDigits = isAsciiDigit(c) && (next.mcDots || next.mcDigits);
+        cur.mcDots = restOk || (c == '.' && next.mcDigits);
+
+        bool alt = cur.digits || ((c == 'v' || c == 'V') && next.digits);
+        if (!alt && p + 2 < end && matchesNoCase(name, p, "mc")) {
+            alt = st[p + 2].mcDigits;
+        }
+        if (!alt) {
+            for (std::string_view keyword : SUFFIX_KEYWORDS) {
+                size_t after = p + keyword.size();
+                if (after <= end && matchesNoCase(name, p, keyword) && (after == end || st[after].tail)) {
+                    alt = true;
+                    break;
+                }
+            }
+        }
+        cur.alt = alt;
+
+        if (cur.tail) {
+            suffixStart = p;
+        }
+    }
+    return suffixStart;
+}
+
+// --- 辅助函数：从 Mod 文件名中提取干净的名称 ---
+// 排除版本号和方括号内的中文译名
+// 全部步骤都是单遍扫描, 对任意 (包括恶意构造的) 文件名都保证线性时间
+std::string getCleanModName(const std::string& fullFileName, std::string* version) {
+    // 找到最后一个点, 分离文件名和扩展名 (例如 ".jar")
+    size_t lastDotPos = fullFileName.rfind('.');
+    std::string nameWithoutExt;
+    std::string extension;
+    if (version) version->clear();
+
+    if (lastDotPos != std::string::npos) {
+        nameWithoutExt = fullFileName.substr(0, lastDotPos);
+        extension = fullFileName.substr(lastDotPos); // 包含点, 例如 ".jar"
+    } else {
+        nameWithoutExt = fullFileName;
+        extension = "";
+    }
+
+    std::string buffer;
+    buffer.reserve(nameWithoutExt.size() + 8);
+
+    // 1. 移除方括号内的内容
+    for (size_t i = 0; i < nameWithoutExt.size();) {
+        if (nameWithoutExt[i] == '[') {
+            size_t close = nameWithoutExt.find(']', i + 1);
+            if (close == std::string::npos) {
+                // 后面再也没有 ']', 剩余部分原样保留
+                buffer.append(nameWithoutExt, i, std::string::npos);
+                break;
+            }
+            i = close + 1;
+        } else {
+            buffer.push_back(nameWithoutExt[i++]);
+        }
+    }
+    nameWithoutExt.swap(buffer);
+    buffer.clear();
+
+    // 2a. 移除特定的非标准分隔符, 如 '·'
+    for (size_t i = 0; i < nameWithoutExt.size(); ++i) {
+        if (nameWithoutExt[i] == '\xC2' && i + 1 < nameWithoutExt.size() && nameWithoutExt[i + 1] == '\xB7') {
+            ++i;
+        } else {
+            buffer.push_back(nameWithoutExt[i]);
+        }
+    }
+    nameWithoutExt.swap(buffer);
+    buffer.clear();
+
+    // 2b. 处理混合语言前缀
+    size_t last_non_ascii_pos = std::string::npos;
+    for (size_t i = nameWithoutExt.length(); i-- > 0;) {
+        if (static_cast<unsigned char>(nameWithoutExt[i]) > 127) {
+            last_non_ascii_pos = i;
+            break;
+        }
+    }
+
+    if (last_non_ascii_pos != std::string::npos && last_non_ascii_pos + 1 < nameWithoutExt.length()) {
+        std::string suffix_part = nameWithoutExt.substr(last_non_ascii_pos + 1);
+        auto it = std::find_if(suffix_part.begin(), suffix_part.end(), [](char c){
+            return isAsciiAlpha(c);
+        });
+
+        if (it != suffix_part.end()) {
+            nameWithoutExt = suffix_part;
+        }
+    }
+
+    // 3. 移除文件名开头的 Minecraft 版本号: ^[0-9]+\.[0-9]+(?:\.[0-9]+)*[-_]
+    {
+        size_t i = 0;
+        while (i < nameWithoutExt.size() && isAsciiDigit(nameWithoutExt[i])) ++i;
+        size_t groups = 0;
+        if (i > 0) {
+            while (i + 1 < nameWithoutExt.size() && nameWithoutExt[i] == '.' && isAsciiDigit(nameWithoutExt[i + 1])) {
+                i += 2;
+                while (i < nameWithoutExt.size() && isAsciiDigit(nameWithoutExt[i])) ++i;
+                ++groups;
+            }
+        }
+        if (groups > 0 && i < nameWithoutExt.size() && (nameWithoutExt[i] == '-' || nameWithoutExt[i] == '_')) {
+            if (version) version->assign(nameWithoutExt, 0, i);
+            nameWithoutExt.erase(0, i + 1);
+        }
+    }
+
+    // 4. 移除 "for [加载器名称]" 模式: \s+for\s+[a-zA-Z]+
+    for (size_t i = 0; i < nameWithoutExt.size();) {
+        if (!isSpaceChar(nameWithoutExt[i])) {
+            buffer.push_back(nameWithoutExt[i++]);
+            continue;
+        }
+        size_t j = i;
+        while (j < nameWithoutExt.size() && isSpaceChar(nameWithoutExt[j])) ++j;
+        size_t k = j + 3;
+        if (matchesNoCase(nameWithoutExt, j, "for") && k < nameWithoutExt.size() && isSpaceChar(nameWithoutExt[k])) {
+            while (k < nameWithoutExt.size() && isSpaceChar(nameWithoutExt[k])) ++k;
+            size_t wordEnd = k;
+            while (wordEnd < nameWithoutExt.size() && isAsciiAlpha(nameWithoutExt[wordEnd])) ++wordEnd;
+            if (wordEnd > k) {
+                i = wordEnd;
+                continue;
+            }
+        }
+        // 同一段空白内的其它起点也不可能匹配, 整段原样保留
+        buffer.append(nameWithoutExt, i, j - i);
+        i = j;
+    }
+    nameWithoutExt.swap(buffer);
+    buffer.clear();
+
+    // 5. 在加载器和数字之间插入空格, 以规范 "forge1.20.1" 这样的名称
+    for (size_t i = 0; i < nameWithoutExt.size();) {
+        bool inserted = false;
+        for (std::string_view loader : LOADER_NAMES) {
+            size_t after = i + loader.size();
+            if (after < nameWithoutExt.size() && isAsciiDigit(nameWithoutExt[after]) && matchesNoCase(nameWithoutExt, i, loader)) {
+                buffer.append(nameWithoutExt, i, loader.size());
+                buffer.push_back(' ');
+                buffer.push_back(nameWithoutExt[after]);
+                i = after + 1;
+                inserted = true;
+                break;
+            }
+        }
+        if (!inserted) {
+            buffer.push_back(nameWithoutExt[i++]);
+        }
+    }
+    nameWithoutExt.swap(buffer);
+    buffer.clear();
+
+    // 6. 一次性移除文件名末尾的版本号、加载器等后缀
+    size_t suffixStart = findVersionSuffixStart(nameWithoutExt);
+    if (version && suffixStart < nameWithoutExt.size()) {
+        if (!version->empty()) version->push_back(' ');
+        version->append(nameWithoutExt, suffixStart, std::string::npos);
+    }
+    nameWithoutExt.erase(suffixStart);
+
+    // 7. 移除多余的空格, 并修剪首尾空格和分隔符
+    for (size_t i = 0; i < nameWithoutExt.size(); ++i) {
+        if (nameWithoutExt[i] == ' ' && !buffer.empty() && buffer.back() == ' ') continue;
+        buffer.push_back(nameWithoutExt[i]);
+    }
+    nameWithoutExt.swap(buffer);
+    size_t first = nameWithoutExt.find_first_not_of(" -_");
+    if (std::string::npos == first) {
+        nameWithoutExt = "";
+    } else {
+        size_t last = nameWithoutExt.find_last_not_of(" -_");
+        nameWithoutExt = nameWithoutExt.substr(first, (last - first + 1));
+    }
+
+    // 8. 将清理后的名称转换为小写
+    std::transform(nameWithoutExt.begin(), nameWithoutExt.end(), nameWithoutExt.begin(),
+                   [](unsigned char c){ return std::tolower(c); });
+
+    return nameWithoutExt + extension;
+}
+// --- 辅助函数：计算当前清理规则的版本哈希 ---
+// 除了修订号, 还对一组覆盖各条规则的样例文件名的清理结果求哈希,
+// 这样即使忘了递增修订号, 只要规则的输出变了, 磁盘缓存也会自动失效
+uint64_t computeNormalizerHash() {
+    static const char* const PROBES[] = {
+            "jei-1.20.1-forge-15.2.0.27.jar",
+            "[我的模组]Xaeros_Minimap_23.9.7_Forge_1.20.jar",
+            "1.12.2-ModName-v2.3.4.jar",
+            "Mod for Fabric 1.0.0+build.7.jar",
+            "modforge1.20.1-3.0.jar",
+            "mod-mc1.16.5-beta.jar",
+            "mod\xC2\xB7name-rc1.jar",
+            "\xE4\xB8\xAD\xE6\x96\x87Mod-1.0.jar",
+            "mod-1.0.0-beta.3+build.7-universal.jar",
+            "Some  Mod - Name-1.2.jar",
+            "noext",
+    };
+    uint64_t hash = fnv1a64(std::to_string(NORMALIZER_REVISION));
+    for (const char* probe : PROBES) {
+        hash = fnv1a64(probe, hash);
+        hash = fnv1a64(std::string_view("\0", 1), hash);
+        hash = fnv1a64(getCleanModName(probe), hash);
+        hash = fnv1a64(std::string_view("\0", 1), hash);
+    }
+    return hash;
+}
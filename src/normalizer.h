@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// --- 辅助函数：文件名清理用到的字符判断 ---
+// 这些判断与原先正则里的字符类保持一致, 只识别 ASCII, 不受 locale 影响
+inline bool isAsciiDigit(char c) { return c >= '0' && c <= '9'; }
+inline bool isAsciiAlpha(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+inline bool isSpaceChar(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r'; }
+inline char toLowerAscii(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; }
+
+// 忽略大小写判断 s 从 pos 开始是否以 word 开头 (word 必须是小写)
+inline bool matchesNoCase(const std::string& s, size_t pos, std::string_view word) {
+    if (pos + word.size() > s.size()) return false;
+    for (size_t i = 0; i < word.size(); ++i) {
+        if (toLowerAscii(s[pos + i]) != word[i]) return false;
+    }
+    return true;
+}
+
+// 忽略大小写判断文件名是否以 extension (小写, 含点, 例如 ".jar") 结尾, 且扩展名之前还有字符
+inline bool hasExtension(std::string_view name, std::string_view extension) {
+    if (name.size() <= extension.size()) return false;
+    size_t pos = name.size() - extension.size();
+    for (size_t i = 0; i < extension.size(); ++i) {
+        if (toLowerAscii(name[pos + i]) != extension[i]) return false;
+    }
+    return true;
+}
+
+// 去掉名称末尾的扩展名: 最后一个 '.' 不在开头, 且之后是不超过 5 个字母数字时才视为扩展名
+inline std::string_view stripNameExtension(std::string_view name) {
+    size_t dot = name.rfind('.');
+    if (dot == std::string_view::npos || dot == 0 || name.size() - dot - 1 > 5) return name;
+    for (size_t i = dot + 1; i < name.size(); ++i) {
+        if (!isAsciiDigit(name[i]) && !isAsciiAlpha(name[i])) return name;
+    }
+    return name.substr(0, dot);
+}
+
+// --- 辅助函数：FNV-1a 64 位哈希 ---
+inline uint64_t fnv1a64(std::string_view data, uint64_t hash = 14695981039346656037ull) {
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// 清理规则的修订号, 修改 getCleanModName 的语义时递增
+constexpr uint32_t NORMALIZER_REVISION = 2;
+
+// 查找文件名 (不含扩展名) 末尾可被剥离的版本后缀, 返回其起始位置, 没有时返回 name.size()
+size_t findVersionSuffixStart(const std::string& name);
+
+// 从 Mod 文件名中提取干净的名称 (小写, 保留扩展名), 用于与 mods_data.json 匹配。
+// version 不为空时同时给出清理过程中去掉的版本信息: 开头的 Minecraft 版本号和末尾的版本后缀,
+// 以空格连接, 原样保留大小写和分隔符 (例如 "1.20.1-15.2.0.27"), 用 compareModVersions 比较
+std::string getCleanModName(const std::string& fullFileName, std::string* version = nullptr);
+
+// 计算当前清理规则的版本哈希, 规则的输出变化时哈希随之变化
+uint64_t computeNormalizerHash();
@@ -0,0 +1,94 @@
+#include "normalizer_stress.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include "logger.h"
+#include "normalizer.h"
+
+// 生成长度约为 length 的对抗性文件名
+std::vector<AdversarialName> generateAdversarialFileNames(size_t length, unsigned int seed) {
+    auto repeatTo = [length](const std::string& prefix, const std::string& unit, const std::string& suffix) {
+        std::string s = prefix;
+        while (s.size() + unit.size() + suffix.size() <= length) s += unit;
+        return s + suffix;
+    };
+
+    std::vector<AdversarialName> names = {
+            {"dots_and_digits",       repeatTo("mod", ".1", ".jar")},
+            {"digits_then_bad_tail",  repeatTo("mod-", "1.", "!.jar")},
+            {"nested_group_overlap",  repeatTo("mod-1", "-a_1+", ".jar")},
+            {"alternating_keywords",  repeatTo("mod", "-forge-fabric", ".jar")},
+            {"mc_versions",           repeatTo("mod", "-mc1.2", ".jar")},
+            {"mc_versions_broken",    repeatTo("mod-mc", "1.", ".x.jar")},
+            {"separator_run",         repeatTo("mod", "-_+ .", "1.jar")},
+            {"unclosed_brackets",     repeatTo("", "[", "mod.jar")},
+            {"many_brackets",         repeatTo("", "[a]", "mod.jar")},
+            {"for_loader_spam",       repeatTo("mod", " for", " x.jar")},
+            {"loader_digits",         repeatTo("", "forge1", ".jar")},
+            {"version_prefix",        repeatTo("1", ".1", "x-mod.jar")},
+            {"non_ascii_mix",         repeatTo("", "\xC2\xB7" "\xE4\xB8\xAD" "a1", ".jar")},
+    };
+
+    // 随机组合最容易触发回溯的字符
+    std::mt19937 rng(seed);
+    const std::string alphabet = "0123456789.-_+ vVmcMC[]forgeab";
+    std::string random;
+    while (random.size() + 4 < length) random.push_back(alphabet[rng() % alphabet.size()]);
+    names.push_back({"random_mix", random + ".jar"});
+    return names;
+}
+
+// 测量单次清理的平均耗时 (纳秒), 重复直到累计时间足够长以降低噪声, 取三轮最小值
+double measureNormalizeNanos(const std::string& fileName) {
+    using clock = std::chrono::steady_clock;
+    double best = 0;
+    for (int round = 0; round < 3; ++round) {
+        size_t iterations = 0;
+        auto start = clock::now();
+        auto elapsed = clock::duration::zero();
+        do {
+            volatile size_t sink = getCleanModName(fileName).size();
+            (void)sink;
+            ++iterations;
+            elapsed = clock::now() - start;
+        } while (elapsed < std::chrono::milliseconds(5));
+        double perCall = std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+        if (round == 0 || perCall < best) best = perCall;
+    }
+    return best;
+}
+
+// 运行压力测试, 全部通过返回 true
+bool runNormalizerStressTest() {
+    const size_t baseLength = 256;
+    const size_t maxLength = 16384;
+    // 长度扩大 64 倍时, 单字符耗时最多允许恶化到基准的 4 倍 (二次复杂度会恶化 64 倍)
+    const double maxPerCharGrowth = 4.0;
+
+    std::vector<AdversarialName> baseline = generateAdversarialFileNames(baseLength);
+    bool allPassed = true;
+    for (size_t f = 0; f < baseline.size(); ++f) {
+        double basePerChar = measureNormalizeNanos(baseline[f].name) / static_cast<double>(baseline[f].name.size());
+        double worstGrowth = 1.0;
+        double largestNanos = 0;
+        for (size_t length = baseLength * 2; length <= maxLength; length *= 2) {
+            AdversarialName sample = generateAdversarialFileNames(length)[f];
+            largestNanos = measureNormalizeNanos(sample.name);
+            double perChar = largestNanos / static_cast<double>(sample.name.size());
+            worstGrowth = std::max(worstGrowth, perChar / basePerChar);
+        }
+
+        bool passed = worstGrowth <= maxPerCharGrowth;
+        allPassed = allPassed && passed;
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2)
+           << "文件名清理压力测试 [" << baseline[f].family << "]: "
+           << maxLength << " 字节耗时 " << largestNanos / 1000.0 << " 微秒, 单字符耗时增长 "
+           << worstGrowth << " 倍 " << (passed ? "通过" : "失败");
+        logMessage(ss.str(), !passed);
+    }
+    return allPassed;
+}
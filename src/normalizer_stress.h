@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// --- 文件名清理的对抗性压力测试 ---
+// 我们会处理用户上传的文件, 文件名完全不可信。这里生成各种针对旧正则实现的病态文件名,
+// 并检查 getCleanModName 的耗时随文件名长度线性增长。
+
+struct AdversarialName {
+    std::string family; // 构造方式, 用于报告
+    std::string name;   // 生成的文件名
+};
+
+// 生成长度约为 length 的对抗性文件名
+std::vector<AdversarialName> generateAdversarialFileNames(size_t length, unsigned int seed = 20240601);
+
+// 测量单次清理的平均耗时 (纳秒)
+double measureNormalizeNanos(const std::string& fileName);
+
+// 运行压力测试, 全部通过返回 true
+bool runNormalizerStressTest();
@@ -0,0 +1,292 @@
+#include "override_rules.h"
+
+#include <algorithm>
+#include <fstream>
+#include <optional>
+#include <unordered_map>
+#include "include/nlohmann/json.hpp"
+#include "logger.h"
+#include "normalizer.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+// --- 辅助函数：按 * 和 ? 拆出字面片段 ---
+std::vector<std::string_view> literalPieces(std::string_view pattern) {
+    std::vector<std::string_view> pieces;
+    size_t begin = 0;
+    for (size_t i = 0; i <= pattern.size(); ++i) {
+        if (i == pattern.size() || pattern[i] == '*' || pattern[i] == '?') {
+            if (i > begin) pieces.push_back(pattern.substr(begin, i - begin));
+            begin = i + 1;
+        }
+    }
+    return pieces;
+}
+
+} // namespace
+
+bool globMatch(std::string_view pattern, std::string_view text) {
+    // 回溯到最近一个 * 的贪心匹配, 最坏为 O(模式长度 * 名称长度)
+    size_t p = 0;
+    size_t t = 0;
+    size_t star = std::string_view::npos;
+    size_t resume = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == toLowerAscii(text[t]))) {
+            ++p;
+            ++t;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            resume = t;
+        } else if (star != std::string_view::npos) {
+            p = star + 1;
+            t = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
+
+bool OverrideRules::load(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        logMessage("无法打开覆盖规则文件: " + path.string(), true);
+        return false;
+    }
+    json data;
+    try {
+        data = json::parse(file);
+    } catch (const json::exception& e) {
+        logMessage("覆盖规则文件解析失败: " + std::string(e.what()), true);
+        return false;
+    }
+    if (!data.is_array()) {
+        logMessage("覆盖规则文件应为规则对象的数组: " + path.string(), true);
+        return false;
+    }
+
+    rules.clear();
+    for (size_t i = 0; i < data.size(); ++i) {
+        const json& item = data[i];
+        std::string where = "第 " + std::to_string(i + 1) + " 条覆盖规则";
+        if (!item.is_object()) {
+            logMessage(where + "应为对象", true);
+            return false;
+        }
+        std::string glob;
+        int patternKeys = 0;
+        std::optional<ModType> type;
+        int priority = 0;
+        for (const auto& [key, value] : item.items()) {
+            if (key == "glob" || key == "prefix" || key == "suffix") {
+                ++patternKeys;
+                if (!value.is_string() || value.get<std::string>().empty()) {
+                    logMessage(where + "的 " + key + " 应为非空字符串", true);
+                    return false;
+                }
+                std::string text = value.get<std::string>();
+                if (key != "glob" && text.find_first_of("*?") != std::string::npos) {
+                    logMessage(where + "的 " + key + " 中不能有 * 或 ?, 需要通配符时请使用 glob", true);
+                    return false;
+                }
+                glob = key == "prefix" ? text + "*" : key == "suffix" ? "*" + text : text;
+            } else if (key == "type") {
+                // 严格解析, 规则文件中的拼写错误不应悄悄变成 unknown
+                std::optional<ModType> parsed;
+                if (value.is_string()) parsed = ModInfo::parseModType(value.get<std::string>());
+                if (!parsed) {
+                    logMessage(where + "的类型无效: " + value.dump(), true);
+                    return false;
+                }
+                type = *parsed;
+            } else if (key == "priority") {
+                if (!value.is_number_integer()) {
+                    logMessage(where + "的 priority 应为整数", true);
+                    return false;
+                }
+                priority = value.get<int>();
+            } else {
+                logMessage(where + "中有未知的字段: " + key, true);
+                return false;
+            }
+        }
+        if (patternKeys != 1 || !type) {
+            logMessage(where + "需要 glob、prefix、suffix 之一以及 type", true);
+            return false;
+        }
+        add(glob, *type, priority);
+    }
+    compile();
+    return true;
+}
+
+void OverrideRules::add(std::string_view glob, ModType type, int priority) {
+    // 连续的 * 与一个 * 等价, 合并后便于识别前缀、后缀等形式
+    std::string pattern;
+    pattern.reserve(glob.size());
+    for (char c : glob) {
+        if (c == '*' && !pattern.empty() && pattern.back() == '*') continue;
+        pattern.push_back(toLowerAscii(c));
+    }
+    rules.push_back({std::move(pattern), type, priority});
+}
+
+void OverrideRules::compile() {
+    unconditional.clear();
+    fragmentLength.clear();
+
+    // 1. 每条规则选出一个片段及判定方式, 相同的片段只保留一份。
+    // 多个片段时选被最少规则用到的片段 (相同时取较长的): 像 "foo*.jar" 中的 ".jar" 几乎出现在每个名称中,
+    // 选它会让这类规则对每个名称都做一次完整匹配
+    std::vector<std::vector<std::string_view>> rulePieces(rules.size());
+    std::unordered_map<std::string_view, uint32_t> pieceRules;
+    for (uint32_t r = 0; r < rules.size(); ++r) {
+        rulePieces[r] = literalPieces(rules[r].pattern);
+        std::vector<std::string_view> distinct = rulePieces[r];
+        std::sort(distinct.begin(), distinct.end());
+        distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+        for (std::string_view piece : distinct) ++pieceRules[piece];
+    }
+    std::unordered_map<std::string_view, uint32_t> fragmentIds;
+    std::vector<std::string_view> fragments;
+    std::vector<std::vector<Trigger>> fragmentTriggers;
+    for (uint32_t r = 0; r < rules.size(); ++r) {
+        std::string_view pattern = rules[r].pattern;
+        const std::vector<std::string_view>& pieces = rulePieces[r];
+        if (pieces.empty()) {
+            unconditional.push_back(r);
+            continue;
+        }
+        Check check = Check::Glob;
+        auto moreSelective = [&](std::string_view a, std::string_view b) {
+            uint32_t usesA = pieceRules[a];
+            uint32_t usesB = pieceRules[b];
+            return usesA != usesB ? usesA < usesB : a.size() > b.size();
+        };
+        std::string_view fragment = *std::min_element(pieces.begin(), pieces.end(), moreSelective);
+        if (pieces.size() == 1 && pattern.find('?') == std::string_view::npos) {
+            bool leadingStar = pattern.front() == '*';
+            bool trailingStar = pattern.back() == '*';
+            check = leadingStar ? (trailingStar ? Check::Contains : Check::Suffix)
+                                : (trailingStar ? Check::Prefix : Check::Exact);
+        }
+        auto [it, inserted] = fragmentIds.emplace(fragment, static_cast<uint32_t>(fragments.size()));
+        if (inserted) {
+            fragments.push_back(fragment);
+            fragmentTriggers.emplace_back();
+        }
+        fragmentTriggers[it->second].push_back({r, check});
+    }
+    triggerStart.assign(1, 0);
+    triggers.clear();
+    for (const std::string_view& fragment : fragments) fragmentLength.push_back(static_cast<uint32_t>(fragment.size()));
+    for (const std::vector<Trigger>& list : fragmentTriggers) {
+        triggers.insert(triggers.end(), list.begin(), list.end());
+        triggerStart.push_back(static_cast<uint32_t>(triggers.size()));
+    }
+
+    // 2. 压缩字母表: 片段中出现的每个字节一类 (大写字母与对应的小写字母同类), 其余字节同为第 0 类
+    std::fill(std::begin(byteClass), std::end(byteClass), uint16_t{0});
+    classCount = 1;
+    for (std::string_view fragment : fragments) {
+        for (char c : fragment) {
+            unsigned char u = static_cast<unsigned char>(c);
+            if (byteClass[u] != 0) continue;
+            byteClass[u] = static_cast<uint16_t>(classCount++);
+            if (u >= 'a' && u <= 'z') byteClass[u - 'a' + 'A'] = byteClass[u];
+        }
+    }
+
+    // 3. 字典树, 0 号为根; 子节点不会是根, 转移为 0 表示没有子节点
+    std::vector<uint32_t> trie(classCount, 0);
+    std::vector<std::vector<uint32_t>> ownFragments(1);
+    for (uint32_t f = 0; f < fragments.size(); ++f) {
+        uint32_t state = 0;
+        for (char c : fragments[f]) {
+            size_t slot = state * classCount + byteClass[static_cast<unsigned char>(c)];
+            if (trie[slot] == 0) {
+                trie[slot] = static_cast<uint32_t>(ownFragments.size());
+                ownFragments.emplace_back();
+                trie.resize(trie.size() + classCount, 0);
+            }
+            state = trie[state * classCount + byteClass[static_cast<unsigned char>(c)]];
+        }
+        ownFragments[state].push_back(f);
+    }
+    dfaStates = ownFragments.size();
+
+    // 4. 按层次计算失败链接, 缺少的转移沿失败链接补全为 DFA; 输出合并失败链接的输出 (较浅的状态先处理)
+    transitions = std::move(trie);
+    std::vector<uint32_t> fail(dfaStates, 0);
+    std::vector<std::vector<uint32_t>> outputs(dfaStates);
+    std::vector<uint32_t> queue;
+    queue.reserve(dfaStates);
+    queue.push_back(0);
+    for (size_t head = 0; head < queue.size(); ++head) {
+        uint32_t state = queue[head];
+        outputs[state] = ownFragments[state];
+        if (state != 0) {
+            const std::vector<uint32_t>& inherited = outputs[fail[state]];
+            outputs[state].insert(outputs[state].end(), inherited.begin(), inherited.end());
+        }
+        for (size_t c = 0; c < classCount; ++c) {
+            uint32_t& next = transitions[state * classCount + c];
+            uint32_t fallback = state == 0 ? 0 : transitions[fail[state] * classCount + c];
+            if (next != 0) {
+                fail[next] = fallback;
+                queue.push_back(next);
+            } else {
+                next = fallback;
+            }
+        }
+    }
+    fragmentStart.assign(1, 0);
+    stateFragments.clear();
+    for (const std::vector<uint32_t>& list : outputs) {
+        stateFragments.insert(stateFragments.end(), list.begin(), list.end());
+        fragmentStart.push_back(static_cast<uint32_t>(stateFragments.size()));
+    }
+}
+
+const OverrideRule* OverrideRules::match(std::string_view cleanName) const {
+    if (rules.empty()) return nullptr;
+    uint32_t best = UINT32_MAX;
+    auto beats = [&](uint32_t r) {
+        return best == UINT32_MAX || rules[r].priority > rules[best].priority ||
+               (rules[r].priority == rules[best].priority && r < best);
+    };
+
+    const size_t n = cleanName.size();
+    const uint32_t* table = transitions.data();
+    const size_t stride = classCount;
+    uint32_t state = 0;
+    for (size_t i = 0; i < n; ++i) {
+        state = table[state * stride + byteClass[static_cast<unsigned char>(cleanName[i])]];
+        for (uint32_t k = fragmentStart[state]; k < fragmentStart[state + 1]; ++k) {
+            uint32_t f = stateFragments[k];
+            bool atStart = i + 1 == fragmentLength[f];
+            bool atEnd = i + 1 == n;
+            for (uint32_t t = triggerStart[f]; t < triggerStart[f + 1]; ++t) {
+                const Trigger& trigger = triggers[t];
+                if (!beats(trigger.rule)) continue;
+                bool matched;
+                switch (trigger.check) {
+                    case Check::Exact: matched = atStart && atEnd; break;
+                    case Check::Prefix: matched = atStart; break;
+                    case Check::Suffix: matched = atEnd; break;
+                    case Check::Contains: matched = true; break;
+                    default: matched = globMatch(rules[trigger.rule].pattern, cleanName); break;
+                }
+                if (matched) best = trigger.rule;
+            }
+        }
+    }
+    for (uint32_t r : unconditional) {
+        if (beats(r) && globMatch(rules[r].pattern, cleanName)) best = r;
+    }
+    return best == UINT32_MAX ? nullptr : &rules[best];
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mod_info.h"
+
+// --- 按名称模式覆盖类型的规则 ---
+// 规则文件为 JSON 数组, 每条规则给出 glob、prefix、suffix 之一, 以及 type 和可选的 priority (默认 0), 例如
+//   [{"glob": "*optifine*", "type": "client_only", "priority": 10}, {"suffix": "-server.jar", "type": "server_only"}]
+// glob 中 * 匹配任意个字符, ? 匹配一个字符; 模式与干净名称都按小写比较。多条规则命中时取 priority 最大的,
+// 相同时取文件中靠前的。
+//
+// 所有模式按 * 和 ? 拆成字面片段, 编译成一个 Aho-Corasick 自动机, 并按模式中出现的字符压缩字母表后展开为 DFA:
+// 名称的每个字节只查一次转移表, 一遍扫描就得到所有片段的出现位置。只有一个片段的规则 (前缀、后缀、包含、精确)
+// 由出现位置直接判定; 其它规则以最长的片段为必要条件, 出现后才做一次完整的 glob 匹配。
+// 编译后只读, 可以在多个线程中同时匹配。
+
+struct OverrideRule {
+    std::string pattern; // 转换为 glob 后的模式 (小写)
+    ModType type;
+    int priority = 0;
+};
+
+class OverrideRules {
+public:
+    OverrideRules() = default;
+
+    // 读取规则文件并编译, 出错时记录日志并返回 false
+    bool load(const std::filesystem::path& path);
+
+    // 追加一条 glob 规则, 之后需要调用 compile()
+    void add(std::string_view glob, ModType type, int priority);
+    void compile();
+
+    size_t size() const { return rules.size(); }
+    bool empty() const { return rules.empty(); }
+    size_t stateCount() const { return dfaStates; }
+
+    // 命中的优先级最高的规则, 没有命中时返回 nullptr
+    const OverrideRule* match(std::string_view cleanName) const;
+
+private:
+    // 片段出现时对规则的判定方式
+    enum class Check : uint8_t {
+        Exact,    // 片段就是整个名称
+        Prefix,   // 片段从名称开头开始
+        Suffix,   // 片段在名称末尾结束
+        Contains, // 片段出现在任意位置
+        Glob      // 片段只是必要条件, 还需要完整匹配
+    };
+    struct Trigger {
+        uint32_t rule;
+        Check check;
+    };
+
+    std::vector<OverrideRule> rules;
+    std::vector<uint32_t> unconditional; // 没有字面片段的规则 (例如 "*" 或 "???"), 总要完整匹配
+
+    // 片段 f 出现时检查 triggers[triggerStart[f] .. triggerStart[f + 1])
+    std::vector<uint32_t> fragmentLength;
+    std::vector<uint32_t> triggerStart;
+    std::vector<Trigger> triggers;
+
+    // DFA: 状态 s 读入字符类 c 后为 transitions[s * classCount + c]
+    uint16_t byteClass[256] = {}; // 字节 -> 字符类
+    size_t classCount = 0;
+    size_t dfaStates = 0;
+    std::vector<uint32_t> transitions;
+    // 状态 s 结束的片段为 stateFragments[fragmentStart[s] .. fragmentStart[s + 1]), 沿后缀链接的输出已经合并
+    std::vector<uint32_t> fragmentStart;
+    std::vector<uint32_t> stateFragments;
+};
+
+// 模式 pattern (* 与 ?) 是否匹配整个 text
+bool globMatch(std::string_view pattern, std::string_view text);
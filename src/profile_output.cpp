@@ -0,0 +1,222 @@
+#include "profile_output.h"
+
+#include <fstream>
+#include <optional>
+#include <system_error>
+#include "include/nlohmann/json.hpp"
+#include "logger.h"
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+
+constexpr SideRequirement ALL_REQUIREMENTS[] = {SideRequirement::None, SideRequirement::Optional,
+                                                SideRequirement::Required};
+
+// --- 辅助函数：解析一端的需求, "unsupported" 为 Modrinth 的写法 ---
+std::optional<SideRequirement> parseRequirement(const std::string& text) {
+    if (text == "required") return SideRequirement::Required;
+    if (text == "optional") return SideRequirement::Optional;
+    if (text == "none" || text == "unsupported") return SideRequirement::None;
+    return std::nullopt;
+}
+
+// --- 辅助函数：把一端接受的需求集合展开成掩码集合 ---
+// 按端组合枚举全部 9 种掩码, 端上的需求在集合中即接受
+uint32_t acceptSide(bool server, uint8_t requirementSet) {
+    uint32_t accept = 0;
+    for (SideRequirement client : ALL_REQUIREMENTS) {
+        for (SideRequirement serverSide : ALL_REQUIREMENTS) {
+            SideRequirement side = server ? serverSide : client;
+            if (requirementSet & (1u << static_cast<unsigned>(side))) accept |= 1u << makeSideMask(client, serverSide);
+        }
+    }
+    return accept;
+}
+
+// --- 辅助函数：读取 "client" / "server" 的值, 可以是单个字符串或字符串数组 ---
+bool readRequirementSet(const json& value, uint8_t& requirementSet, std::string& error) {
+    std::vector<json> items;
+    if (value.is_string()) {
+        items.push_back(value);
+    } else if (value.is_array()) {
+        items.assign(value.begin(), value.end());
+    } else {
+        error = "应为字符串或字符串数组";
+        return false;
+    }
+    for (const json& item : items) {
+        std::optional<SideRequirement> requirement =
+            item.is_string() ? parseRequirement(item.get<std::string>()) : std::nullopt;
+        if (!requirement) {
+            error = "无效的需求 " + item.dump() + " (可用: required, optional, none)";
+            return false;
+        }
+        requirementSet |= static_cast<uint8_t>(1u << static_cast<unsigned>(*requirement));
+    }
+    return true;
+}
+
+// 目标名用作子目录名, 只能是单个路径组成部分, 且不能与类型子目录重名
+bool isValidProfileName(const std::string& name) {
+    if (name.empty() || name == "." || name == ".." || name.find_first_of("/\\:") != std::string::npos) return false;
+    for (int i = 0; i <= static_cast<int>(ModType::Unknown); ++i) {
+        if (name == ModInfo::modTypeToDirectory(static_cast<ModType>(i))) return false;
+    }
+    return true;
+}
+
+OutputProfile makeProfile(std::string name, uint8_t clientSet, uint8_t serverSet, bool unknown) {
+    OutputProfile profile;
+    profile.name = std::move(name);
+    profile.acceptMask = acceptSide(false, clientSet) | acceptSide(true, serverSet);
+    // 两端都不需要的组合不对应任何 Mod, 不放进目标
+    profile.acceptMask &= ~(1u << makeSideMask(SideRequirement::None, SideRequirement::None));
+    if (unknown) profile.acceptMask |= 1u << SIDE_MASK_UNKNOWN;
+    return profile;
+}
+
+constexpr uint8_t REQUIRED_OR_OPTIONAL = (1u << static_cast<unsigned>(SideRequirement::Required)) |
+                                         (1u << static_cast<unsigned>(SideRequirement::Optional));
+constexpr uint8_t REQUIRED_ONLY = 1u << static_cast<unsigned>(SideRequirement::Required);
+
+// 文件放入目标的方式, 依次尝试
+enum class PlaceMethod { HardLink, Symlink, Copy, Failed };
+
+} // namespace
+
+std::vector<OutputProfile> defaultOutputProfiles() {
+    // 局域网主机同时运行客户端和内置服务端: 客户端需要的全部加上服务端必装的
+    return {makeProfile("server", 0, REQUIRED_OR_OPTIONAL, false),
+            makeProfile("client", REQUIRED_OR_OPTIONAL, 0, false),
+            makeProfile("lan-host", REQUIRED_OR_OPTIONAL, REQUIRED_ONLY, false)};
+}
+
+bool loadOutputProfiles(const fs::path& path, std::vector<OutputProfile>& profiles) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        logMessage("无法打开目标配置文件: " + path.string(), true);
+        return false;
+    }
+    json data;
+    try {
+        data = json::parse(file);
+    } catch (const json::exception& e) {
+        logMessage("目标配置文件解析失败: " + std::string(e.what()), true);
+        return false;
+    }
+    if (!data.is_object() || data.empty()) {
+        logMessage("目标配置文件应为以目标名为键的对象: " + path.string(), true);
+        return false;
+    }
+
+    profiles.clear();
+    for (const auto& [name, spec] : data.items()) {
+        if (!isValidProfileName(name)) {
+            logMessage("无效的目标名 \"" + name + "\": 必须是单个目录名, 且不能与类型子目录重名", true);
+            return false;
+        }
+        if (!spec.is_object()) {
+            logMessage("目标 " + name + " 应为对象", true);
+            return false;
+        }
+        uint8_t clientSet = 0;
+        uint8_t serverSet = 0;
+        bool unknown = false;
+        for (const auto& [key, value] : spec.items()) {
+            std::string error;
+            bool ok = true;
+            if (key == "client") {
+                ok = readRequirementSet(value, clientSet, error);
+            } else if (key == "server") {
+                ok = readRequirementSet(value, serverSet, error);
+            } else if (key == "unknown") {
+                ok = value.is_boolean();
+                if (ok) unknown = value.get<bool>();
+                else error = "应为 true 或 false";
+            } else {
+                ok = false;
+                error = "未知的字段";
+            }
+            if (!ok) {
+                logMessage("目标 " + name + " 的 " + key + ": " + error, true);
+                return false;
+            }
+        }
+        OutputProfile profile = makeProfile(name, clientSet, serverSet, unknown);
+        if (profile.acceptMask == 0) logMessage("目标 " + name + " 不接受任何类型的 Mod", true);
+        profiles.push_back(std::move(profile));
+    }
+    return true;
+}
+
+ProfileOutput::ProfileOutput(const fs::path& directory, std::vector<OutputProfile> profiles)
+    : outputDirectory(directory), targets(std::move(profiles)), filesPerTarget(targets.size(), 0) {}
+
+bool ProfileOutput::createDirectories() {
+    for (const OutputProfile& profile : targets) {
+        std::error_code ec;
+        fs::create_directories(outputDirectory / profile.name, ec);
+        if (ec) {
+            logMessage("无法创建目标目录 " + profile.name + ": " + ec.message(), true);
+            return false;
+        }
+    }
+    return true;
+}
+
+void ProfileOutput::add(ModType type, const fs::path& file) {
+    for (size_t t = 0; t < targets.size(); ++t) {
+        const OutputProfile& profile = targets[t];
+        if (!profile.accepts(type)) continue;
+
+        fs::path destination = outputDirectory / profile.name / file.filename();
+        std::error_code ec;
+        if (fs::exists(fs::symlink_status(destination, ec))) {
+            ++existing;
+            ++filesPerTarget[t];
+            continue;
+        }
+
+        PlaceMethod method = PlaceMethod::Failed;
+        if (hardLinksWork) {
+            fs::create_hard_link(file, destination, ec);
+            if (!ec) method = PlaceMethod::HardLink;
+            else hardLinksWork = false; // 跨设备或文件系统不支持, 之后直接用符号链接
+        }
+        if (method == PlaceMethod::Failed && symlinksWork) {
+            // 相对路径的链接在整个输出目录被移动后仍然有效
+            ec.clear();
+            fs::create_symlink(fs::path("..") / file.parent_path().filename() / file.filename(), destination, ec);
+            if (!ec) method = PlaceMethod::Symlink;
+            else symlinksWork = false; // 例如 Windows 上没有创建符号链接的权限
+        }
+        if (method == PlaceMethod::Failed) {
+            ec.clear();
+            fs::copy_file(file, destination, ec);
+            if (!ec) method = PlaceMethod::Copy;
+        }
+
+        switch (method) {
+            case PlaceMethod::HardLink: ++hardLinks; break;
+            case PlaceMethod::Symlink: ++symlinks; break;
+            case PlaceMethod::Copy: ++copies; break;
+            case PlaceMethod::Failed:
+                logMessage("无法把 " + file.filename().string() + " 放入目标 " + profile.name + ": " + ec.message(),
+                           true);
+                ++failures;
+                continue;
+        }
+        ++filesPerTarget[t];
+    }
+}
+
+void ProfileOutput::logSummary() const {
+    for (size_t t = 0; t < targets.size(); ++t) {
+        logMessage("目标 " + targets[t].name + ": " + std::to_string(filesPerTarget[t]) + " 个 Mod");
+    }
+    logMessage("目标文件: 硬链接 " + std::to_string(hardLinks) + ", 符号链接 " + std::to_string(symlinks) + ", 复制 " +
+               std::to_string(copies) + ", 已存在 " + std::to_string(existing) + ", 失败 " +
+               std::to_string(failures));
+}
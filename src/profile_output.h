@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "mod_info.h"
+
+// --- 按部署目标输出 ---
+// 除了按类型分的子目录, 还可以声明若干部署目标 (专用服务器、客户端、局域网主机等),
+// 每个目标是输出目录下的一个子目录, 包含这个目标需要安装的所有 Mod。
+// 目标在 profiles.json 中声明, 按客户端 / 服务端的需求筛选, 列出的端任一满足即可:
+//   {
+//     "server":   {"server": ["required", "optional"]},
+//     "client":   {"client": ["required", "optional"]},
+//     "lan-host": {"client": ["required", "optional"], "server": ["required"]},
+//     "all":      {"client": ["required", "optional"], "server": ["required", "optional"], "unknown": true}
+//   }
+// 每个目标编译成一个 32 位的掩码集合 (见 mod_info.h 的 SideMask), 判断一个 Mod 是否属于目标只需一次位测试。
+// 文件写入类型子目录后立即链接到所有匹配的目标: 优先硬链接, 文件系统不支持时改用符号链接, 最后才复制。
+
+struct OutputProfile {
+    std::string name;        // 也是输出目录下的子目录名
+    uint32_t acceptMask = 0; // 第 m 位为 1 表示 SideMask 为 m 的 Mod 属于这个目标
+
+    bool accepts(ModType type) const { return (acceptMask >> modTypeToSideMask(type)) & 1u; }
+};
+
+// 从 JSON 文件读取目标, 格式错误时记录原因并返回 false
+bool loadOutputProfiles(const std::filesystem::path& path, std::vector<OutputProfile>& profiles);
+
+// 没有 profiles.json 时使用的默认目标: server、client、lan-host
+std::vector<OutputProfile> defaultOutputProfiles();
+
+class ProfileOutput {
+public:
+    ProfileOutput(const std::filesystem::path& outputDirectory, std::vector<OutputProfile> profiles);
+
+    ProfileOutput(const ProfileOutput&) = delete;
+    ProfileOutput& operator=(const ProfileOutput&) = delete;
+
+    // 创建所有目标子目录, 失败时返回 false
+    bool createDirectories();
+
+    // 把已经写入类型子目录的 file 放到所有接受 type 的目标中; 目标中已有同名文件时跳过
+    void add(ModType type, const std::filesystem::path& file);
+
+    const std::vector<OutputProfile>& profiles() const { return targets; }
+
+    // 记录每个目标的文件数和链接方式
+    void logSummary() const;
+
+private:
+    std::filesystem::path outputDirectory;
+    std::vector<OutputProfile> targets;
+    std::vector<size_t> filesPerTarget;
+    size_t hardLinks = 0;
+    size_t symlinks = 0;
+    size_t copies = 0;
+    size_t existing = 0;
+    size_t failures = 0;
+    bool hardLinksWork = true; // 第一次硬链接失败后不再尝试
+    bool symlinksWork = true;
+};
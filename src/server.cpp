@@ -0,0 +1,536 @@
+#include "server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include "byte_order.h"
+#include "logger.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "thread_pool.h"
+#endif
+
+bool handleServerRequest(const ModIndex& index, const char* payload, size_t length, std::string& response) {
+    if (length < 4) return false;
+    uint32_t count = readLe32(payload);
+    // 每个文件名至少占 2 字节 (长度字段), 先拒绝声明数量明显不合理的请求
+    if (count > (length - 4) / 2) return false;
+
+    response.clear();
+    response.reserve(4 + static_cast<size_t>(count) * 24);
+    appendLe32(response, count);
+
+    size_t pos = 4;
+    std::string name;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (pos + 2 > length) return false;
+        uint16_t nameLength = readLe16(payload + pos);
+        pos += 2;
+        if (pos + nameLength > length) return false;
+        name.assign(payload + pos, nameLength);
+        pos += nameLength;
+
+        ClassifyResult result = classifyFileName(index, name);
+        response.push_back(static_cast<char>(result.type ? static_cast<int8_t>(*result.type) : int8_t{-1}));
+        size_t cleanLength = std::min<size_t>(result.cleanName.size(), 0xFFFF);
+        appendLe16(response, static_cast<uint16_t>(cleanLength));
+        response.append(result.cleanName, 0, cleanLength);
+    }
+    return pos == length;
+}
+
+#ifdef __linux__
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// --- 请求延迟统计 ---
+// 保留最多 MAX_SAMPLES 个样本 (蓄水池抽样), 退出时输出分位数
+class LatencyRecorder {
+public:
+    void record(Clock::duration elapsed) {
+        auto nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        ++count;
+        if (samples.size() < MAX_SAMPLES) {
+            samples.push_back(nanos);
+        } else {
+            std::uniform_int_distribution<uint64_t> pick(0, count - 1);
+            uint64_t slot = pick(rng);
+            if (slot < MAX_SAMPLES) samples[slot] = nanos;
+        }
+    }
+
+    void logSummary(uint64_t names) {
+        if (samples.empty()) {
+            logMessage("服务期间没有处理任何请求。");
+            return;
+        }
+        auto percentile = [this](double p) {
+            size_t k = std::min(samples.size() - 1, static_cast<size_t>(p * static_cast<double>(samples.size())));
+            std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(k), samples.end());
+            return static_cast<double>(samples[k]) / 1000.0;
+        };
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(1)
+           << "服务统计: 共处理 " << count << " 个请求, " << names << " 个文件名, 延迟 p50 " << percentile(0.50)
+           << " 微秒, p99 " << percentile(0.99) << " 微秒, 最大 " << percentile(1.0) << " 微秒";
+        logMessage(ss.str());
+    }
+
+private:
+    static constexpr size_t MAX_SAMPLES = 1 << 20;
+    std::vector<uint64_t> samples;
+    uint64_t count = 0;
+    std::mt19937_64 rng{12345};
+};
+
+struct Connection {
+    int fd = -1;
+    std::string in;           // 尚未解析的输入
+    size_t inOffset = 0;
+    std::string out;          // 尚未发送的输出
+    size_t outOffset = 0;
+    uint64_t nextSequence = 0;                  // 下一个请求分配的序号
+    uint64_t nextToSend = 0;                    // 下一个应当写出的序号
+    std::map<uint64_t, std::string> completed;  // 提前完成、等待按序发送的响应
+    bool peerClosed = false;  // 对端已关闭写方向, 发送完剩余响应后关闭
+    uint32_t events = 0;      // 当前注册的 epoll 事件
+};
+
+// 工作线程完成的请求
+struct Completion {
+    uint64_t connectionId;
+    uint64_t sequence;
+    bool ok;
+    std::string response;
+    Clock::time_point received;
+};
+
+// 输出缓冲超过该值时暂停读取, 防止不读响应的客户端耗尽内存
+constexpr size_t MAX_PENDING_OUTPUT = 8 * 1024 * 1024;
+
+// epoll 中用于区分事件来源的保留 ID, 连接 ID 从 FIRST_CONNECTION_ID 开始
+constexpr uint64_t LISTEN_ID = 1;
+constexpr uint64_t WAKEUP_ID = 2;
+constexpr uint64_t SIGNAL_ID = 3;
+constexpr uint64_t FIRST_CONNECTION_ID = 16;
+
+class EpollServer {
+public:
+    EpollServer(const ServerOptions& options, ModDatabase& database) : options(options), database(database) {}
+
+    ~EpollServer() {
+        database.stopWatcher();
+        pool.reset(); // 先等待工作线程退出, 它们会访问下面的文件描述符
+        for (auto& item : connections) ::close(item.second.fd);
+        if (listenFd >= 0) {
+            ::close(listenFd);
+            ::unlink(options.socketPath.c_str());
+        }
+        if (wakeupFd >= 0) ::close(wakeupFd);
+        if (signalFd >= 0) ::close(signalFd);
+        if (epollFd >= 0) ::close(epollFd);
+    }
+
+    int run() {
+        if (!setup()) return 1;
+        logMessage("服务已启动, 监听 " + options.socketPath + ", 工作线程 " + std::to_string(pool->size()) + " 个");
+
+        std::vector<epoll_event> events(256);
+        bool running = true;
+        while (running) {
+            int ready = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), -1);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                logMessage(std::string("epoll_wait 失败: ") + std::strerror(errno), true);
+                return 1;
+            }
+            for (int i = 0; i < ready; ++i) {
+                uint64_t id = events[i].data.u64;
+                if (id == LISTEN_ID) {
+                    acceptClients();
+                } else if (id == WAKEUP_ID) {
+                    drainCompletions();
+                } else if (id == SIGNAL_ID) {
+                    running = handleSignal();
+                } else {
+                    handleConnectionEvent(id, events[i].events);
+                }
+            }
+        }
+
+        logMessage("收到退出信号, 服务正在停止...");
+        latency.logSummary(namesServed);
+        return 0;
+    }
+
+private:
+    bool setup() {
+        if (options.socketPath.size() >= sizeof(sockaddr_un::sun_path)) {
+            logMessage("套接字路径过长: " + options.socketPath, true);
+            return false;
+        }
+
+        // 在创建任何线程之前屏蔽退出和重新加载信号, 统一由 signalfd 处理
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGINT);
+        sigaddset(&mask, SIGTERM);
+        sigaddset(&mask, SIGHUP);
+        pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+        signal(SIGPIPE, SIG_IGN);
+
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        signalFd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+        if (epollFd < 0 || wakeupFd < 0 || signalFd < 0) {
+            logMessage(std::string("无法创建事件循环: ") + std::strerror(errno), true);
+            return false;
+        }
+
+        // 清理上次异常退出遗留的套接字文件, 但不会删除普通文件
+        struct stat info {};
+        if (::lstat(options.socketPath.c_str(), &info) == 0) {
+            if (!S_ISSOCK(info.st_mode)) {
+                logMessage("路径已存在且不是套接字: " + options.socketPath, true);
+                return false;
+            }
+            ::unlink(options.socketPath.c_str());
+        }
+
+        int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            logMessage(std::string("无法创建套接字: ") + std::strerror(errno), true);
+            return false;
+        }
+        sockaddr_un address {};
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, options.socketPath.c_str(), options.socketPath.size() + 1);
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 512) != 0) {
+            logMessage("无法监听 " + options.socketPath + ": " + std::strerror(errno), true);
+            ::close(fd);
+            return false;
+        }
+        listenFd = fd;
+
+        addToEpoll(listenFd, EPOLLIN, LISTEN_ID);
+        addToEpoll(wakeupFd, EPOLLIN, WAKEUP_ID);
+        addToEpoll(signalFd, EPOLLIN, SIGNAL_ID);
+
+        pool = std::make_unique<ThreadPool>(options.workerThreads);
+        database.startWatcher(options.reloadInterval);
+        return true;
+    }
+
+    // 处理 signalfd 上的信号, 需要退出时返回 false
+    bool handleSignal() {
+        signalfd_siginfo info {};
+        bool keepRunning = true;
+        while (::read(signalFd, &info, sizeof(info)) == static_cast<ssize_t>(sizeof(info))) {
+            if (info.ssi_signo == SIGHUP) {
+                database.requestReload();
+            } else {
+                keepRunning = false;
+            }
+        }
+        return keepRunning;
+    }
+
+    // 统计请求的响应: 特殊标记加 JSON 文本
+    std::string statsResponse() const {
+        std::shared_ptr<const IndexGeneration> snapshot = database.acquire();
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(3)
+           << "{\"generation\":" << snapshot->generation
+           << ",\"entries\":" << snapshot->index.size()
+           << ",\"mod_ids\":" << snapshot->index.modIdCount()
+           << ",\"generation_queries\":" << snapshot->queries.load()
+           << ",\"total_names\":" << namesServed
+           << ",\"reloads\":" << database.reloadCount()
+           << ",\"last_reload_ms\":" << database.lastReloadMillis()
+           << ",\"connections\":" << connections.size() << "}";
+        std::string response;
+        appendLe32(response, SERVER_STATS_REQUEST);
+        response += ss.str();
+        return response;
+    }
+
+    void addToEpoll(int fd, uint32_t events, uint64_t id) {
+        epoll_event event {};
+        event.events = events;
+        event.data.u64 = id;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    void acceptClients() {
+        for (;;) {
+            int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    logMessage(std::string("接受连接失败: ") + std::strerror(errno), true);
+                }
+                return;
+            }
+            uint64_t id = nextConnectionId++;
+            Connection& connection = connections[id];
+            connection.fd = fd;
+            connection.events = EPOLLIN;
+            addToEpoll(fd, EPOLLIN, id);
+        }
+    }
+
+    void handleConnectionEvent(uint64_t id, uint32_t events) {
+        auto it = connections.find(id);
+        if (it == connections.end()) return;
+        Connection& connection = it->second;
+
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            if (!(events & EPOLLIN)) {
+                closeConnection(id);
+                return;
+            }
+        }
+        if (events & EPOLLIN) {
+            if (!readFrom(id, connection)) {
+                closeConnection(id);
+                return;
+            }
+        }
+        if (!flush(connection)) {
+            closeConnection(id);
+            return;
+        }
+        finishOrUpdate(id, connection);
+    }
+
+    // 读取所有可读数据并分派完整的帧, 连接需要关闭时返回 false
+    bool readFrom(uint64_t id, Connection& connection) {
+        char buffer[64 * 1024];
+        for (;;) {
+            ssize_t n = ::read(connection.fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                connection.in.append(buffer, static_cast<size_t>(n));
+                if (!dispatchFrames(id, connection)) return false;
+                if (connection.out.size() - connection.outOffset > MAX_PENDING_OUTPUT) break;
+                continue;
+            }
+            if (n == 0) {
+                connection.peerClosed = true;
+                return true;
+            }
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        return true;
+    }
+
+    bool dispatchFrames(uint64_t id, Connection& connection) {
+        for (;;) {
+            size_t available = connection.in.size() - connection.inOffset;
+            if (available < 4) break;
+            const char* frame = connection.in.data() + connection.inOffset;
+            uint32_t length = readLe32(frame);
+            if (length > MAX_SERVER_FRAME_SIZE) {
+                logMessage("请求帧过大 (" + std::to_string(length) + " 字节), 已断开连接", true);
+                return false;
+            }
+            if (available < 4 + static_cast<size_t>(length)) break;
+
+            uint64_t sequence = connection.nextSequence++;
+            Clock::time_point received = Clock::now();
+            const char* payload = frame + 4;
+            uint32_t count = length >= 4 ? readLe32(payload) : 0;
+            if (length == 4 && count == SERVER_STATS_REQUEST) {
+                deliver(connection, sequence, statsResponse(), received);
+            } else if (count <= options.inlineThreshold) {
+                // 小请求直接处理, 延迟只有一次查找的开销
+                std::shared_ptr<const IndexGeneration> snapshot = database.acquire();
+                std::string response;
+                if (!handleServerRequest(snapshot->index, payload, length, response)) {
+                    logMessage("请求格式错误, 已断开连接", true);
+                    return false;
+                }
+                snapshot->countQuery(count);
+                namesServed += count;
+                deliver(connection, sequence, std::move(response), received);
+            } else {
+                std::string request(payload, length);
+                pool->submit([this, id, sequence, received, count, request = std::move(request)] {
+                    // 整个请求使用同一代索引, 期间发生的重新加载不会影响它
+                    std::shared_ptr<const IndexGeneration> snapshot = database.acquire();
+                    Completion completion{id, sequence, false, {}, received};
+                    completion.ok = handleServerRequest(snapshot->index, request.data(), request.size(), completion.response);
+                    if (completion.ok) snapshot->countQuery(count);
+                    {
+                        std::lock_guard<std::mutex> lock(completionMutex);
+                        completions.push_back(std::move(completion));
+                    }
+                    uint64_t one = 1;
+                    [[maybe_unused]] ssize_t written = ::write(wakeupFd, &one, sizeof(one));
+                });
+            }
+            connection.inOffset += 4 + static_cast<size_t>(length);
+        }
+        // 已消费的数据过多时压缩缓冲区
+        if (connection.inOffset > 0 && connection.inOffset * 2 >= connection.in.size()) {
+            connection.in.erase(0, connection.inOffset);
+            connection.inOffset = 0;
+        }
+        return true;
+    }
+
+    // 按请求顺序把响应放入输出缓冲
+    void deliver(Connection& connection, uint64_t sequence, std::string&& response, Clock::time_point received) {
+        latency.record(Clock::now() - received);
+        if (sequence != connection.nextToSend) {
+            connection.completed.emplace(sequence, std::move(response));
+            return;
+        }
+        appendFrame(connection, response);
+        ++connection.nextToSend;
+        for (auto it = connection.completed.begin();
+             it != connection.completed.end() && it->first == connection.nextToSend;
+             it = connection.completed.erase(it)) {
+            appendFrame(connection, it->second);
+            ++connection.nextToSend;
+        }
+    }
+
+    static void appendFrame(Connection& connection, const std::string& response) {
+        appendLe32(connection.out, static_cast<uint32_t>(response.size()));
+        connection.out += response;
+    }
+
+    void drainCompletions() {
+        uint64_t counter;
+        [[maybe_unused]] ssize_t n = ::read(wakeupFd, &counter, sizeof(counter));
+
+        std::vector<Completion> batch;
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            batch.swap(completions);
+        }
+        std::vector<uint64_t> touched;
+        for (auto& completion : batch) {
+            auto it = connections.find(completion.connectionId);
+            if (it == connections.end()) continue; // 连接已关闭, 丢弃结果
+            if (!completion.ok) {
+                logMessage("请求格式错误, 已断开连接", true);
+                closeConnection(completion.connectionId);
+                continue;
+            }
+            namesServed += readLe32(completion.response.data());
+            deliver(it->second, completion.sequence, std::move(completion.response), completion.received);
+            touched.push_back(completion.connectionId);
+        }
+        for (uint64_t id : touched) {
+            auto it = connections.find(id);
+            if (it == connections.end()) continue;
+            if (!flush(it->second)) {
+                closeConnection(id);
+                continue;
+            }
+            finishOrUpdate(id, it->second);
+        }
+    }
+
+    // 尽量写出输出缓冲, 出错时返回 false
+    static bool flush(Connection& connection) {
+        while (connection.outOffset < connection.out.size()) {
+            ssize_t n = ::send(connection.fd, connection.out.data() + connection.outOffset,
+                               connection.out.size() - connection.outOffset, MSG_NOSIGNAL);
+            if (n > 0) {
+                connection.outOffset += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            return false;
+        }
+        if (connection.outOffset == connection.out.size()) {
+            connection.out.clear();
+            connection.outOffset = 0;
+        }
+        return true;
+    }
+
+    // 对端已关闭且所有响应都已发出时关闭连接, 否则根据缓冲状态更新关注的事件
+    void finishOrUpdate(uint64_t id, Connection& connection) {
+        bool pendingOutput = connection.outOffset < connection.out.size();
+        bool pendingRequests = connection.nextToSend < connection.nextSequence;
+        if (connection.peerClosed && !pendingOutput && !pendingRequests) {
+            closeConnection(id);
+            return;
+        }
+        uint32_t wanted = 0;
+        if (!connection.peerClosed && connection.out.size() - connection.outOffset <= MAX_PENDING_OUTPUT) {
+            wanted |= EPOLLIN;
+        }
+        if (pendingOutput) wanted |= EPOLLOUT;
+        if (wanted != connection.events) {
+            epoll_event event {};
+            event.events = wanted;
+            event.data.u64 = id;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+            connection.events = wanted;
+        }
+    }
+
+    void closeConnection(uint64_t id) {
+        auto it = connections.find(id);
+        if (it == connections.end()) return;
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+        ::close(it->second.fd);
+        connections.erase(it);
+    }
+
+    const ServerOptions& options;
+    ModDatabase& database;
+    int epollFd = -1;
+    int listenFd = -1;
+    int wakeupFd = -1;
+    int signalFd = -1;
+    std::unique_ptr<ThreadPool> pool;
+    std::unordered_map<uint64_t, Connection> connections;
+    uint64_t nextConnectionId = FIRST_CONNECTION_ID;
+    std::mutex completionMutex;
+    std::vector<Completion> completions; // 由 completionMutex 保护
+    uint64_t namesServed = 0;
+    LatencyRecorder latency;
+};
+
+} // namespace
+
+int runClassifyServer(const ServerOptions& options, ModDatabase& database) {
+    EpollServer server(options, database);
+    return server.run();
+}
+
+#else
+
+int runClassifyServer(const ServerOptions& options, ModDatabase&) {
+    logMessage("服务模式目前只支持 Linux, 无法监听 " + options.socketPath, true);
+    return 1;
+}
+
+#endif
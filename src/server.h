@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include "classifier.h"
+#include "mod_database.h"
+
+// --- 常驻服务模式 (--serve) ---
+// 在 Unix 域套接字上提供分类查询, 数据库只加载一次。
+// 协议 (所有整数均为小端):
+//   帧:     u32 负载长度 | 负载
+//   请求:   u32 文件名个数 | 重复 { u16 长度 | 文件名 (UTF-8) }
+//   响应:   u32 结果个数   | 重复 { i8 类型 | u16 长度 | 干净名称 }
+//           类型为 ModType 的数值 (0-6), -1 表示数据库中没有该 Mod
+//   统计:   请求负载恰好为 u32 0xFFFFFFFF 时, 响应为 u32 0xFFFFFFFF | JSON 文本,
+//           包含当前索引代数、各代查询次数和最近一次重新加载的耗时
+// 同一连接上的响应按请求顺序返回, 请求格式错误时服务端直接关闭连接。
+// 数据库文件变化或收到 SIGHUP 时在后台重新加载, 不阻塞查询。
+// 目前只在 Linux 上可用 (基于 epoll)。
+
+struct ServerOptions {
+    std::string socketPath;
+    size_t workerThreads = 0;    // 工作线程数, 0 表示使用硬件线程数
+    size_t inlineThreshold = 64; // 文件名个数不超过该值的请求直接在事件循环线程处理, 省去线程切换
+    std::chrono::milliseconds reloadInterval{1000}; // 检查数据库文件是否变化的间隔
+};
+
+// 单帧负载的上限, 超过时视为恶意请求并断开连接
+constexpr size_t MAX_SERVER_FRAME_SIZE = 16 * 1024 * 1024;
+
+// 处理一个请求负载, 返回响应负载; 请求格式错误时返回 false
+bool handleServerRequest(const ModIndex& index, const char* payload, size_t length, std::string& response);
+
+// 统计请求使用的特殊文件名个数
+constexpr uint32_t SERVER_STATS_REQUEST = 0xFFFFFFFF;
+
+// 运行服务直到收到 SIGINT/SIGTERM, 返回进程退出码
+int runClassifyServer(const ServerOptions& options, ModDatabase& database);
@@ -0,0 +1,87 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+
+size_t defaultThreadCount() {
+    unsigned int hardware = std::thread::hardware_concurrency();
+    return hardware == 0 ? 1 : hardware;
+}
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) threadCount = defaultThreadCount();
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    allDone.wait(lock, [this] { return tasks.empty() && running == 0; });
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return; // stopping 且没有剩余任务
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            ++running;
+        }
+        task();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --running;
+            if (tasks.empty() && running == 0) allDone.notify_all();
+        }
+    }
+}
+
+void parallelFor(ThreadPool& pool, size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) return;
+    if (pool.size() <= 1 || count == 1) {
+        for (size_t i = 0; i < count; ++i) body(i);
+        return;
+    }
+
+    // 用共享计数器动态领取下标, 耗时不均的任务 (例如大小差异很大的 jar) 也能均衡
+    std::atomic<size_t> next{0};
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+    size_t remaining = std::min(pool.size(), count);
+    const size_t chunks = remaining;
+    for (size_t c = 0; c < chunks; ++c) {
+        pool.submit([&] {
+            for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                body(i);
+            }
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (--remaining == 0) doneCondition.notify_one();
+        });
+    }
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneCondition.wait(lock, [&] { return remaining == 0; });
+}
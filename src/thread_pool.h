@@ -0,0 +1,44 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --- 固定大小的线程池 ---
+// 任务按提交顺序被取出执行; wait() 阻塞到所有已提交的任务完成
+class ThreadPool {
+public:
+    // threadCount 为 0 时使用硬件线程数
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+    void wait();
+
+    size_t size() const { return workers.size(); }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable allDone;
+    size_t running = 0;
+    bool stopping = false;
+};
+
+// 默认的工作线程数: 硬件线程数, 无法获取时为 1
+size_t defaultThreadCount();
+
+// 把 [0, count) 切成若干块并行执行 body(i), 所有块完成后返回
+// 线程池只有一个线程或任务很少时直接在当前线程执行
+void parallelFor(ThreadPool& pool, size_t count, const std::function<void(size_t)>& body);
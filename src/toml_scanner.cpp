@@ -0,0 +1,283 @@
+#include "toml_scanner.h"
+
+#include <cstdint>
+
+namespace {
+
+bool isBareKeyChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-';
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void appendUtf8(std::string& out, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        out.push_back(static_cast<char>(codePoint));
+    } else if (codePoint < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+// 处理基本字符串中的转义序列
+void decodeEscapes(std::string_view raw, std::string& out) {
+    out.clear();
+    for (size_t i = 0; i < raw.size(); ++i) {
+        char c = raw[i];
+        if (c != '\\' || i + 1 >= raw.size()) {
+            out.push_back(c);
+            continue;
+        }
+        char e = raw[++i];
+        switch (e) {
+            case 'b': out.push_back('\b'); break;
+            case 't': out.push_back('\t'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'r': out.push_back('\r'); break;
+            case '"': out.push_back('"'); break;
+            case '\\': out.push_back('\\'); break;
+            case 'u':
+            case 'U': {
+                size_t digits = e == 'u' ? 4 : 8;
+                uint32_t codePoint = 0;
+                bool valid = i + digits < raw.size();
+                for (size_t k = 1; valid && k <= digits; ++k) {
+                    int h = hexValue(raw[i + k]);
+                    if (h < 0) valid = false;
+                    codePoint = (codePoint << 4) | static_cast<uint32_t>(h);
+                }
+                if (valid && codePoint <= 0x10FFFF) {
+                    appendUtf8(out, codePoint);
+                    i += digits;
+                } else {
+                    out.push_back('\\');
+                    out.push_back(e);
+                }
+                break;
+            }
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n': {
+                // 多行字符串中行尾的反斜杠: 去掉换行和下一行开头的空白
+                size_t j = i;
+                while (j < raw.size() && (raw[j] == ' ' || raw[j] == '\t')) ++j;
+                if (j < raw.size() && (raw[j] == '\n' || raw[j] == '\r')) {
+                    while (j < raw.size() && (raw[j] == ' ' || raw[j] == '\t' || raw[j] == '\n' || raw[j] == '\r')) ++j;
+                    i = j - 1;
+                } else {
+                    out.push_back('\\');
+                    out.push_back(e);
+                }
+                break;
+            }
+            default:
+                out.push_back('\\');
+                out.push_back(e);
+                break;
+        }
+    }
+}
+
+} // namespace
+
+void TomlScanner::skipSpaces() {
+    while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t')) ++pos;
+}
+
+void TomlScanner::skipToLineEnd() {
+    while (pos < text.size() && text[pos] != '\n') ++pos;
+}
+
+bool TomlScanner::next(TomlField& field) {
+    if (error) return false;
+    while (pos < text.size()) {
+        skipSpaces();
+        if (pos >= text.size()) break;
+        char c = text[pos];
+        if (c == '\n' || c == '\r') {
+            ++pos;
+            continue;
+        }
+        if (c == '#') {
+            skipToLineEnd();
+            continue;
+        }
+        if (c == '[') {
+            if (!readHeader()) break;
+            continue;
+        }
+
+        if (!readKey(keyBuffer)) break;
+        skipSpaces();
+        if (pos >= text.size() || text[pos] != '=') break;
+        ++pos;
+        skipSpaces();
+        if (!readValue(field)) break;
+
+        field.table = tableName;
+        field.key = keyBuffer;
+        field.tableSerial = tableSerial;
+        // 值后面只允许注释, 多余的内容宽松地忽略
+        skipToLineEnd();
+        return true;
+    }
+    if (pos < text.size()) error = true;
+    return false;
+}
+
+bool TomlScanner::readHeader() {
+    bool isArray = pos + 1 < text.size() && text[pos + 1] == '[';
+    pos += isArray ? 2 : 1;
+    if (!readKey(tableName)) return false;
+    skipSpaces();
+    if (pos >= text.size() || text[pos] != ']') return false;
+    ++pos;
+    if (isArray) {
+        if (pos >= text.size() || text[pos] != ']') return false;
+        ++pos;
+    }
+    ++tableSerial;
+    skipToLineEnd();
+    return true;
+}
+
+bool TomlScanner::readKey(std::string& out) {
+    out.clear();
+    for (;;) {
+        skipSpaces();
+        if (pos >= text.size()) return false;
+        char c = text[pos];
+        if (c == '"') {
+            if (!readBasicString(false)) return false;
+            out.append(stringValue);
+        } else if (c == '\'') {
+            if (!readLiteralString(false)) return false;
+            out.append(stringValue);
+        } else {
+            size_t start = pos;
+            while (pos < text.size() && isBareKeyChar(text[pos])) ++pos;
+            if (pos == start) return false;
+            out.append(text.substr(start, pos - start));
+        }
+        skipSpaces();
+        if (pos < text.size() && text[pos] == '.') {
+            out.push_back('.');
+            ++pos;
+            continue;
+        }
+        return true;
+    }
+}
+
+bool TomlScanner::readValue(TomlField& field) {
+    if (pos >= text.size()) return false;
+    char c = text[pos];
+    field.isString = false;
+    if (c == '"' || c == '\'') {
+        bool multiline = text.compare(pos, 3, c == '"' ? "\"\"\"" : "'''") == 0;
+        if (!(c == '"' ? readBasicString(multiline) : readLiteralString(multiline))) return false;
+        field.value = stringValue;
+        field.isString = true;
+        return true;
+    }
+
+    size_t start = pos;
+    if (c == '[' || c == '{') {
+        if (!skipComposite()) return false;
+    } else {
+        while (pos < text.size() && text[pos] != '\n' && text[pos] != '\r' && text[pos] != '#') ++pos;
+    }
+    size_t end = pos;
+    while (end > start && (text[end - 1] == ' ' || text[end - 1] == '\t')) --end;
+    if (end == start) return false;
+    field.value = text.substr(start, end - start);
+    return true;
+}
+
+bool TomlScanner::readBasicString(bool multiline) {
+    pos += multiline ? 3 : 1;
+    // 多行字符串紧跟在开头引号后的换行不属于内容
+    if (multiline && pos < text.size() && text[pos] == '\r') ++pos;
+    if (multiline && pos < text.size() && text[pos] == '\n') ++pos;
+
+    size_t start = pos;
+    bool escaped = false;
+    for (; pos < text.size(); ++pos) {
+        char c = text[pos];
+        if (c == '\\') {
+            escaped = true;
+            ++pos;
+            continue;
+        }
+        if (!multiline && c == '\n') return false;
+        if (c == '"' && (!multiline || text.compare(pos, 3, "\"\"\"") == 0)) break;
+    }
+    if (pos >= text.size()) return false;
+
+    // 多行字符串的结尾最多可以再多出两个引号, 它们属于内容
+    if (multiline) {
+        while (pos + 3 < text.size() && text[pos + 3] == '"') ++pos;
+    }
+    std::string_view raw = text.substr(start, pos - start);
+    pos += multiline ? 3 : 1;
+    if (escaped) {
+        decodeEscapes(raw, valueBuffer);
+        stringValue = valueBuffer;
+    } else {
+        stringValue = raw;
+    }
+    return true;
+}
+
+bool TomlScanner::readLiteralString(bool multiline) {
+    pos += multiline ? 3 : 1;
+    if (multiline && pos < text.size() && text[pos] == '\r') ++pos;
+    if (multiline && pos < text.size() && text[pos] == '\n') ++pos;
+
+    size_t end = multiline ? text.find("'''", pos) : text.find_first_of("'\n", pos);
+    if (end == std::string_view::npos || text[end] != '\'') return false;
+    if (multiline) {
+        while (end + 3 < text.size() && text[end + 3] == '\'') ++end;
+    }
+    stringValue = text.substr(pos, end - pos);
+    pos = end + (multiline ? 3 : 1);
+    return true;
+}
+
+bool TomlScanner::skipComposite() {
+    size_t depth = 0;
+    while (pos < text.size()) {
+        char c = text[pos];
+        if (c == '[' || c == '{') {
+            ++depth;
+            ++pos;
+        } else if (c == ']' || c == '}') {
+            ++pos;
+            if (--depth == 0) return true;
+        } else if (c == '"' || c == '\'') {
+            bool multiline = text.compare(pos, 3, c == '"' ? "\"\"\"" : "'''") == 0;
+            if (!(c == '"' ? readBasicString(multiline) : readLiteralString(multiline))) return false;
+        } else if (c == '#') {
+            skipToLineEnd();
+        } else {
+            ++pos;
+        }
+    }
+    return false;
+}
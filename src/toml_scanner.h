@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// --- 最小化的流式 TOML 扫描器 ---
+// 只为读取 mods.toml 这类简单配置而写: 逐个返回 "当前表 + 键 + 值", 不构建文档树。
+// 支持的语法: 注释, [表] 和 [[表数组]] 表头, 裸键/引号键/点分键, 基本字符串与字面量字符串
+// (含多行形式), 以及其它值 (数字、布尔、数组、内联表) 的原始文本。
+// 返回的 string_view 指向输入文本或扫描器内部缓冲区, 只在下一次调用 next() 之前有效。
+
+struct TomlField {
+    std::string_view table;  // 所在的表名, 各段之间用 '.' 连接, 顶层为空
+    std::string_view key;
+    std::string_view value;  // 字符串值已去掉引号并处理转义, 其它值为去掉首尾空白的原始文本
+    bool isString = false;
+    size_t tableSerial = 0;  // 表头的序号, 同名表数组中的不同元素序号不同
+};
+
+class TomlScanner {
+public:
+    explicit TomlScanner(std::string_view text) : text(text) {}
+
+    // 取下一个键值对, 文本结束或遇到无法识别的语法时返回 false
+    bool next(TomlField& field);
+
+    // 是否因为语法错误而提前结束
+    bool failed() const { return error; }
+
+private:
+    void skipSpaces();
+    void skipToLineEnd();
+    bool readHeader();
+    bool readKey(std::string& out);
+    bool readValue(TomlField& field);
+    bool readBasicString(bool multiline);
+    bool readLiteralString(bool multiline);
+    bool skipComposite(); // 跳过数组或内联表
+
+    std::string_view text;
+    size_t pos = 0;
+    bool error = false;
+    std::string tableName;
+    size_t tableSerial = 0;
+    std::string keyBuffer;
+    std::string valueBuffer; // 只在字符串含有转义时使用
+    std::string_view stringValue;
+};
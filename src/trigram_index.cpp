@@ -0,0 +1,351 @@
+#include "trigram_index.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include "cpu_features.h"
+#include "normalizer.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MODCLASSIFIER_SSE2 1
+#endif
+
+namespace {
+
+// 超过这个长度的部分不参与比较, 保证每个名称的三元组数 (长度 + 2 个空格 - 2) 放得进 uint8_t
+constexpr size_t MAX_NAME_LENGTH = 250;
+constexpr size_t MAX_TRIGRAMS = MAX_NAME_LENGTH;
+
+// 远低于最高分的建议没有参考价值, 只给出不低于最高分这个比例的建议
+constexpr float RELATIVE_SCORE = 0.8f;
+
+// 候选数远少于倒排表长度时改用二分查找跳过, 比顺序比较更快
+constexpr size_t SPARSE_RATIO = 32;
+
+// --- 辅助函数：名称的三元组 ---
+// 扩展名 (最后一个 '.' 之后不超过 5 个字母数字) 不参与比较; 字母转小写, 分隔符统一为一个空格
+void collectTrigrams(std::string_view name, std::string& scratch, std::vector<uint32_t>& trigrams) {
+    name = stripNameExtension(name);
+    if (name.size() > MAX_NAME_LENGTH) name = name.substr(0, MAX_NAME_LENGTH);
+
+    scratch.assign(1, ' ');
+    for (char c : name) {
+        bool separator = c == '-' || c == '_' || c == '.' || c == '+' || c == ' ' || c == '\t';
+        if (separator) {
+            if (scratch.back() != ' ') scratch.push_back(' ');
+        } else {
+            scratch.push_back(c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c);
+        }
+    }
+    if (scratch.back() != ' ') scratch.push_back(' ');
+
+    trigrams.clear();
+    for (size_t i = 0; i + 3 <= scratch.size(); ++i) {
+        trigrams.push_back(static_cast<uint32_t>(static_cast<unsigned char>(scratch[i])) << 16 |
+                           static_cast<uint32_t>(static_cast<unsigned char>(scratch[i + 1])) << 8 |
+                           static_cast<uint32_t>(static_cast<unsigned char>(scratch[i + 2])));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+// --- 辅助函数：有序倒排表与有序候选集求交集 ---
+// 两者都升序, 在 list 中找到的候选计数加一。编号小于 2^31, 可以直接用有符号比较
+using CountMatchesFunction = void (*)(const uint32_t* list, size_t n, const uint32_t* candidates, size_t m,
+                                      uint16_t* counts);
+
+#ifndef MODCLASSIFIER_SSE2
+void countMatchesScalar(const uint32_t* list, size_t n, const uint32_t* candidates, size_t m, uint16_t* counts) {
+    size_t j = 0;
+    for (size_t k = 0; k < m && j < n; ++k) {
+        uint32_t value = candidates[k];
+        while (j < n && list[j] < value) ++j;
+        if (j < n && list[j] == value) {
+            ++counts[k];
+            ++j;
+        }
+    }
+}
+#endif
+
+#ifdef MODCLASSIFIER_SSE2
+// 每次比较 4 个编号: 全部小于候选时整块跳过, 否则小于的个数就是需要前进的距离
+void countMatchesSse2(const uint32_t* list, size_t n, const uint32_t* candidates, size_t m, uint16_t* counts) {
+    size_t j = 0;
+    for (size_t k = 0; k < m && j < n; ++k) {
+        uint32_t value = candidates[k];
+        const __m128i key = _mm_set1_epi32(static_cast<int>(value));
+        while (j + 4 <= n) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(list + j));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(block, key))));
+            j += static_cast<size_t>(std::popcount(mask));
+            if (mask != 0xF) break;
+        }
+        while (j < n && list[j] < value) ++j;
+        if (j < n && list[j] == value) {
+            ++counts[k];
+            ++j;
+        }
+    }
+}
+#endif
+
+#ifdef MODCLASSIFIER_X86_AVX2
+MODCLASSIFIER_TARGET_AVX2 void countMatchesAvx2(const uint32_t* list, size_t n, const uint32_t* candidates, size_t m,
+                                                uint16_t* counts) {
+    size_t j = 0;
+    for (size_t k = 0; k < m && j < n; ++k) {
+        uint32_t value = candidates[k];
+        const __m256i key = _mm256_set1_epi32(static_cast<int>(value));
+        while (j + 8 <= n) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(list + j));
+            unsigned mask =
+                static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(key, block))));
+            j += static_cast<size_t>(std::popcount(mask));
+            if (mask != 0xFF) break;
+        }
+        while (j < n && list[j] < value) ++j;
+        if (j < n && list[j] == value) {
+            ++counts[k];
+            ++j;
+        }
+    }
+}
+#endif
+
+// 启动时选定求交集的实现
+CountMatchesFunction selectCountMatches() {
+#ifdef MODCLASSIFIER_X86_AVX2
+    if (cpuHasAvx2()) return countMatchesAvx2;
+#endif
+#ifdef MODCLASSIFIER_SSE2
+    return countMatchesSse2;
+#else
+    return countMatchesScalar;
+#endif
+}
+
+const CountMatchesFunction COUNT_MATCHES = selectCountMatches();
+
+// 候选很少时逐个倍增查找 (galloping), 每次从上一个位置之后开始
+void countMatchesSparse(const uint32_t* list, size_t n, const uint32_t* candidates, size_t m, uint16_t* counts) {
+    size_t j = 0;
+    for (size_t k = 0; k < m && j < n; ++k) {
+        uint32_t value = candidates[k];
+        size_t step = 1;
+        while (j + step < n && list[j + step] < value) step <<= 1;
+        const uint32_t* begin = list + j + (step >> 1);
+        const uint32_t* end = list + std::min(n, j + step + 1);
+        j = static_cast<size_t>(std::lower_bound(begin, end, value) - list);
+        if (j < n && list[j] == value) {
+            ++counts[k];
+            ++j;
+        }
+    }
+}
+
+} // namespace
+
+void TrigramIndex::build(const std::vector<std::string_view>& entries) {
+    names.clear();
+    nameOffsets.assign(1, 0);
+    entryTrigrams.clear();
+    trigramSlot.clear();
+    postingStart.clear();
+    postings.clear();
+
+    size_t totalLength = 0;
+    for (std::string_view entry : entries) totalLength += entry.size();
+    names.reserve(totalLength);
+    nameOffsets.reserve(entries.size() + 1);
+    entryTrigrams.reserve(entries.size());
+
+    // 第一遍为每个条目的三元组分配倒排表编号并计数; 名称平均十几个三元组, 按此预留
+    std::vector<uint32_t> entrySlots;
+    entrySlots.reserve(entries.size() * 16);
+    std::vector<uint32_t> slotSizes;
+    trigramSlot.reserve(entries.size() * 2);
+    std::string scratch;
+    std::vector<uint32_t> trigrams;
+    for (std::string_view entry : entries) {
+        names.append(entry);
+        nameOffsets.push_back(static_cast<uint32_t>(names.size()));
+        collectTrigrams(entry, scratch, trigrams);
+        entryTrigrams.push_back(static_cast<uint8_t>(trigrams.size()));
+        for (uint32_t trigram : trigrams) {
+            auto [it, inserted] = trigramSlot.try_emplace(trigram, static_cast<uint32_t>(slotSizes.size()));
+            if (inserted) slotSizes.push_back(0);
+            ++slotSizes[it->second];
+            entrySlots.push_back(it->second);
+        }
+    }
+
+    // 第二遍按 (三元组数, 条目编号) 的顺序填入, 每个倒排表按三元组数分段, 段内升序
+    std::vector<uint32_t> entrySlotStart(entryTrigrams.size() + 1, 0);
+    for (size_t i = 0; i < entryTrigrams.size(); ++i) entrySlotStart[i + 1] = entrySlotStart[i] + entryTrigrams[i];
+    std::vector<uint32_t> bySize(MAX_TRIGRAMS + 2, 0);
+    for (uint8_t count : entryTrigrams) ++bySize[count + 1];
+    for (size_t e = 0; e <= MAX_TRIGRAMS; ++e) bySize[e + 1] += bySize[e];
+    std::vector<uint32_t> order(entryTrigrams.size());
+    for (uint32_t entry = 0; entry < entryTrigrams.size(); ++entry) order[bySize[entryTrigrams[entry]]++] = entry;
+
+    postingStart.resize(slotSizes.size() + 1);
+    postingStart[0] = 0;
+    for (size_t i = 0; i < slotSizes.size(); ++i) postingStart[i + 1] = postingStart[i] + slotSizes[i];
+    postings.resize(entrySlots.size());
+    std::vector<uint32_t> fill(postingStart.begin(), postingStart.end() - 1);
+    for (uint32_t entry : order) {
+        for (uint32_t k = entrySlotStart[entry]; k < entrySlotStart[entry + 1]; ++k) postings[fill[entrySlots[k]]++] = entry;
+    }
+
+    // 每段的起点和三元组数
+    runStart.assign(1, 0);
+    runStart.reserve(slotSizes.size() + 1);
+    runBegin.clear();
+    runTrigrams.clear();
+    for (size_t slot = 0; slot < slotSizes.size(); ++slot) {
+        for (uint32_t k = postingStart[slot]; k < postingStart[slot + 1]; ++k) {
+            uint8_t count = entryTrigrams[postings[k]];
+            if (k == postingStart[slot] || count != runTrigrams.back()) {
+                runBegin.push_back(k);
+                runTrigrams.push_back(count);
+            }
+        }
+        runStart.push_back(static_cast<uint32_t>(runBegin.size()));
+    }
+}
+
+std::vector<TrigramMatch> TrigramIndex::search(std::string_view query, size_t limit, float minScore) const {
+    std::vector<TrigramMatch> matches;
+    if (limit == 0 || postings.empty()) return matches;
+
+    std::string scratch;
+    std::vector<uint32_t> trigrams;
+    collectTrigrams(query, scratch, trigrams);
+    const size_t queryCount = trigrams.size();
+    if (queryCount == 0) return matches;
+    const double n = static_cast<double>(queryCount);
+
+    // 查询的每个三元组在各个分段中的倒排表, 按条目的三元组数分组 (计数排序)
+    struct PostingList {
+        const uint32_t* data;
+        size_t size;
+    };
+    std::array<uint32_t, MAX_TRIGRAMS + 2> bucketStart{};
+    std::vector<std::pair<uint8_t, PostingList>> found;
+    for (uint32_t trigram : trigrams) {
+        auto it = trigramSlot.find(trigram);
+        if (it == trigramSlot.end()) continue;
+        uint32_t slot = it->second;
+        for (uint32_t r = runStart[slot]; r < runStart[slot + 1]; ++r) {
+            uint32_t end = r + 1 < runStart[slot + 1] ? runBegin[r + 1] : postingStart[slot + 1];
+            found.push_back({runTrigrams[r], {postings.data() + runBegin[r], end - runBegin[r]}});
+            ++bucketStart[runTrigrams[r] + 1];
+        }
+    }
+    for (size_t e = 0; e <= MAX_TRIGRAMS; ++e) bucketStart[e + 1] += bucketStart[e];
+    std::vector<PostingList> lists(found.size());
+    {
+        std::array<uint32_t, MAX_TRIGRAMS + 1> fill;
+        std::copy(bucketStart.begin(), bucketStart.end() - 1, fill.begin());
+        for (const auto& [e, list] : found) lists[fill[e]++] = list;
+    }
+
+    // 三元组数为 e 的条目最高只能得到 2 * min(n, e) / (n + e) 分, 从最有希望的分组开始
+    std::vector<std::pair<float, uint8_t>> buckets;
+    for (size_t e = 1; e <= MAX_TRIGRAMS; ++e) {
+        if (bucketStart[e] == bucketStart[e + 1]) continue;
+        float best = static_cast<float>(2.0 * static_cast<double>(std::min(queryCount, e)) / (n + static_cast<double>(e)));
+        if (best >= minScore) buckets.push_back({best, static_cast<uint8_t>(e)});
+    }
+    std::sort(buckets.begin(), buckets.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    auto better = [](const TrigramMatch& a, const TrigramMatch& b) {
+        return a.score != b.score ? a.score > b.score : a.entry < b.entry;
+    };
+    // 计数数组每个线程一份, 用完清零以便下次复用
+    thread_local std::vector<uint8_t> threadHits;
+    thread_local std::vector<uint32_t> threadTouched;
+    std::vector<uint8_t>& hitVector = threadHits;
+    std::vector<uint32_t>& touched = threadTouched;
+    if (hitVector.size() < size()) hitVector.resize(size());
+    uint8_t* hits = hitVector.data();
+    std::vector<uint32_t> candidates;
+    std::vector<uint16_t> counts;
+
+    for (const auto& [best, e] : buckets) {
+        // 分数下限随已找到的建议提高: 不低于最高分的 RELATIVE_SCORE 倍, 已有 limit 个时不低于其中最低的分数;
+        // 剩下的分组都达不到时结束
+        float threshold = minScore;
+        if (!matches.empty()) threshold = std::max(threshold, matches.front().score * RELATIVE_SCORE);
+        if (matches.size() >= limit) threshold = std::max(threshold, matches[limit - 1].score);
+        if (best < threshold) break;
+        // 至少要共享的三元组数 t: 2t / (n + e) >= threshold
+        double needed = std::ceil(static_cast<double>(threshold) * (n + e) / 2.0 - 1e-6);
+        size_t required = std::max<size_t>(1, static_cast<size_t>(std::max(0.0, needed)));
+        PostingList* group = lists.data() + bucketStart[e];
+        size_t groupSize = bucketStart[e + 1] - bucketStart[e];
+        if (groupSize < required) continue;
+        std::sort(group, group + groupSize, [](const PostingList& a, const PostingList& b) { return a.size < b.size; });
+
+        // 达到 t 的条目必然出现在最短的 (组内倒排表数 - t + 1) 个倒排表中 (前缀过滤), 在计数数组中累加
+        size_t prefix = groupSize - required + 1;
+        touched.clear();
+        for (size_t i = 0; i < prefix; ++i) {
+            for (size_t k = 0; k < group[i].size; ++k) {
+                uint32_t id = group[i].data[k];
+                if (hits[id]++ == 0) touched.push_back(id);
+            }
+        }
+        // 出现过的条目排序后与其余倒排表求交集
+        candidates.assign(touched.begin(), touched.end());
+        std::sort(candidates.begin(), candidates.end());
+        counts.resize(candidates.size());
+        for (size_t k = 0; k < candidates.size(); ++k) counts[k] = hits[candidates[k]];
+        for (uint32_t id : touched) hits[id] = 0;
+
+        // 其余倒排表只为已有的候选计数, 每处理一个就剔除剩下的倒排表全部命中也不够的候选
+        for (size_t i = prefix; i < groupSize && !candidates.empty(); ++i) {
+            if (candidates.size() * SPARSE_RATIO < group[i].size) {
+                countMatchesSparse(group[i].data, group[i].size, candidates.data(), candidates.size(), counts.data());
+            } else {
+                COUNT_MATCHES(group[i].data, group[i].size, candidates.data(), candidates.size(), counts.data());
+            }
+            size_t left = groupSize - i - 1;
+            size_t kept = 0;
+            for (size_t k = 0; k < candidates.size(); ++k) {
+                if (counts[k] + left < required) continue;
+                candidates[kept] = candidates[k];
+                counts[kept] = counts[k];
+                ++kept;
+            }
+            candidates.resize(kept);
+            counts.resize(kept);
+        }
+
+        for (size_t k = 0; k < candidates.size(); ++k) {
+            float score = static_cast<float>(2.0 * counts[k] / (n + e));
+            if (score >= threshold) matches.push_back({candidates[k], score});
+        }
+        // 最高分提高后, 之前找到的分数过低的建议一并去掉
+        if (!matches.empty()) {
+            float floor = std::max_element(matches.begin(), matches.end(), [](const auto& a, const auto& b) {
+                return a.score < b.score;
+            })->score * RELATIVE_SCORE;
+            matches.erase(std::remove_if(matches.begin(), matches.end(),
+                                         [&](const TrigramMatch& match) { return match.score < floor; }),
+                          matches.end());
+        }
+        if (matches.size() > limit) {
+            std::partial_sort(matches.begin(), matches.begin() + static_cast<std::ptrdiff_t>(limit), matches.end(),
+                              better);
+            matches.resize(limit);
+        } else {
+            std::sort(matches.begin(), matches.end(), better);
+        }
+    }
+    return matches;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// --- 名称的三元组倒排索引 ---
+// 为数据库中找不到的文件名给出最相近的几个条目。名称去掉扩展名, 分隔符 (- _ . + 空白) 统一为空格,
+// 首尾各补一个空格后取所有三字节子串, 相似度为 Dice 系数 2 * 共享数 / (查询三元组数 n + 条目三元组数 e)。
+// 每个三元组的倒排表是一段 uint32 条目编号, 所有倒排表连续存放在一个数组中 (CSR), 内存与数据库的三元组总数成正比;
+// 倒排表内按条目的三元组数分段, 段内升序。查询时按 e 分组处理, 从最高可能分数 2 * min(n, e) / (n + e) 最大的组开始:
+//   1. 分数下限决定组内至少要共享的三元组数 t, 达标的条目必然出现在组内最短的 (倒排表数 - t + 1) 个倒排表中,
+//      只需在计数数组中合并这几个 (前缀过滤)
+//   2. 其余较长的倒排表与有序的候选求交集计数, 用 SIMD 一次比较 4 / 8 个编号来跳过不相交的部分,
+//      候选很少时改用倍增查找; 每处理一个倒排表就剔除已经不可能达标的候选
+//   3. 分数下限随找到的结果提高 (不低于最高分的 0.8 倍, 凑满 k 个后不低于第 k 个), 剩下的组都达不到时提前结束
+// 建好后只读, 可以在多个线程中同时查询。
+
+struct TrigramMatch {
+    uint32_t entry; // 条目编号, 即构建时名称的下标
+    float score;    // Dice 系数, 0 到 1
+};
+
+class TrigramIndex {
+public:
+    TrigramIndex() = default;
+
+    // 按给定顺序为名称编号并建立索引
+    void build(const std::vector<std::string_view>& names);
+
+    size_t size() const { return nameOffsets.empty() ? 0 : nameOffsets.size() - 1; }
+    size_t trigramCount() const { return postingStart.empty() ? 0 : postingStart.size() - 1; }
+    size_t postingCount() const { return postings.size(); }
+    std::string_view name(uint32_t entry) const {
+        return std::string_view(names).substr(nameOffsets[entry], nameOffsets[entry + 1] - nameOffsets[entry]);
+    }
+
+    // 与 query 最相近的至多 limit 个条目, 按分数从高到低 (相同时按编号); 分数低于 minScore
+    // 或低于最高分 0.8 倍的不返回
+    std::vector<TrigramMatch> search(std::string_view query, size_t limit, float minScore = 0.5f) const;
+
+private:
+    std::string names; // 所有名称连续存放
+    std::vector<uint32_t> nameOffsets;
+    std::vector<uint8_t> entryTrigrams;            // 每个条目的不同三元组数
+    std::unordered_map<uint32_t, uint32_t> trigramSlot; // 三元组 -> 倒排表编号
+    std::vector<uint32_t> postingStart;            // 倒排表 i 为 postings[postingStart[i] .. postingStart[i + 1])
+    std::vector<uint32_t> postings;
+    std::vector<uint32_t> runStart;   // 倒排表 i 的分段为 [runStart[i], runStart[i + 1])
+    std::vector<uint32_t> runBegin;   // 分段在 postings 中的起点, 终点为下一段的起点或倒排表的终点
+    std::vector<uint8_t> runTrigrams; // 分段中条目的三元组数
+};
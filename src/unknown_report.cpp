@@ -0,0 +1,339 @@
+#include "unknown_report.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+#include "edit_distance.h"
+#include "include/nlohmann/json.hpp"
+#include "logger.h"
+#include "modpack_diff.h"
+#include "normalizer.h"
+#include "thread_pool.h"
+
+namespace fs = std::filesystem;
+using ordered_json = nlohmann::ordered_json;
+
+namespace {
+
+// 去掉分隔符后达到这个长度才允许 1 处编辑, 达到第二个长度才允许 2 处; 短名称之间差一个字母往往就是另一个 Mod,
+// 允许的编辑太多时, 单链接合并会把互不相关的名称串成一大组
+constexpr size_t ONE_EDIT_LENGTH = 10;
+constexpr size_t TWO_EDIT_LENGTH = 20;
+
+int allowedEdits(size_t length) {
+    return length >= TWO_EDIT_LENGTH ? 2 : length >= ONE_EDIT_LENGTH ? 1 : 0;
+}
+
+// --- 辅助函数：比较用的名称骨架 ---
+// 转小写、去掉扩展名和分隔符, xaeros_minimap.jar 与 xaeros-minimap.jar 的骨架相同
+std::string nameSkeleton(std::string_view name) {
+    std::string skeleton;
+    for (char c : FuzzyNameIndex::comparisonKey(name)) {
+        if (c != '-' && c != '_' && c != '.' && c != '+' && c != ' ') skeleton.push_back(c);
+    }
+    return skeleton;
+}
+
+// --- 辅助函数：按片段找出候选名称对 ---
+// 鸽巢原理: 长度为 L 的骨架允许 k 处编辑时均分成 k + 1 段, 与它的编辑距离不超过 k 的骨架中至少原样出现其中一段,
+// 且起点的偏移不超过 k。每个骨架只登记 k + 1 个片段; 查询时对每个可能的 (长度, 段号, 起点) 查一次哈希表,
+// 工作量取决于片段相同的名称数, 而不是同一长度的名称总数
+class SegmentIndex {
+public:
+    // skeletons[entries[...]] 中允许编辑的骨架; entries 中的骨架互不相同
+    void build(const std::vector<std::string>& skeletons, const std::vector<uint32_t>& entries) {
+        std::vector<std::pair<uint64_t, uint32_t>> keyed;
+        for (uint32_t entry : entries) {
+            std::string_view skeleton = skeletons[entry];
+            int edits = allowedEdits(skeleton.size());
+            for (int piece = 0; piece < edits + 1 && edits > 0; ++piece) {
+                auto [start, length] = segment(skeleton.size(), edits, piece);
+                keyed.emplace_back(segmentKey(skeleton.size(), piece, skeleton.substr(start, length)), entry);
+            }
+        }
+        std::sort(keyed.begin(), keyed.end());
+        entryOf.resize(keyed.size());
+        ranges.reserve(keyed.size());
+        for (size_t i = 0; i < keyed.size(); ++i) {
+            entryOf[i] = keyed[i].second;
+            auto [it, inserted] = ranges.try_emplace(keyed[i].first, static_cast<uint32_t>(i), static_cast<uint32_t>(i));
+            it->second.second = static_cast<uint32_t>(i + 1);
+        }
+    }
+
+    // 可能与 skeletons[query] 近似的骨架及允许的编辑数: 只给出不长于它的 (长度相同时编号较小的), 每对只出现一次
+    std::vector<std::pair<uint32_t, int>> candidates(const std::vector<std::string>& skeletons, uint32_t query) const {
+        std::vector<std::pair<uint32_t, int>> found;
+        std::string_view text = skeletons[query];
+        const size_t length = text.size();
+        for (size_t shorter = length >= MAX_EDITS ? length - MAX_EDITS : 0; shorter <= length; ++shorter) {
+            // 两个名称允许的编辑数取决于较短的一个
+            int edits = allowedEdits(shorter);
+            if (edits == 0 || length - shorter > static_cast<size_t>(edits)) continue;
+            for (int piece = 0; piece < edits + 1; ++piece) {
+                auto [start, pieceLength] = segment(shorter, edits, piece);
+                size_t first = start >= static_cast<size_t>(edits) ? start - edits : 0;
+                size_t last = std::min(start + edits, length - pieceLength);
+                for (size_t at = first; at <= last; ++at) {
+                    auto it = ranges.find(segmentKey(shorter, piece, text.substr(at, pieceLength)));
+                    if (it == ranges.end()) continue;
+                    for (uint32_t k = it->second.first; k < it->second.second; ++k) {
+                        uint32_t entry = entryOf[k];
+                        if (shorter == length && entry >= query) continue;
+                        if (skeletons[entry].size() == shorter) found.emplace_back(entry, edits);
+                    }
+                }
+            }
+        }
+        // 同一对可能由多个片段找到
+        std::sort(found.begin(), found.end());
+        found.erase(std::unique(found.begin(), found.end()), found.end());
+        return found;
+    }
+
+private:
+    static constexpr size_t MAX_EDITS = 2;
+
+    // 长度为 length 的骨架分成 edits + 1 段后第 piece 段的 (起点, 长度), 靠后的段长一个字符
+    static std::pair<size_t, size_t> segment(size_t length, int edits, int piece) {
+        size_t pieces = static_cast<size_t>(edits) + 1;
+        size_t shortPieces = pieces - length % pieces;
+        size_t base = length / pieces;
+        size_t index = static_cast<size_t>(piece);
+        size_t start = index * base + (index > shortPieces ? index - shortPieces : 0);
+        return {start, base + (index >= shortPieces ? 1 : 0)};
+    }
+
+    // 片段的哈希值与 (骨架长度, 段号) 一起作为键; 哈希冲突只会多出候选, 之后都会计算编辑距离
+    static uint64_t segmentKey(size_t length, int piece, std::string_view text) {
+        uint64_t hash = std::hash<std::string_view>{}(text);
+        return (hash * 0x9E3779B97F4A7C15ULL) ^ (static_cast<uint64_t>(length) << 3 | static_cast<uint64_t>(piece));
+    }
+
+    std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> ranges; // 键 -> entryOf 中的区间
+    std::vector<uint32_t> entryOf;
+};
+
+// 日志中找不到的 Mod 记录干净名称的位置
+constexpr std::string_view CLEAN_NAME_MARKER = "干净名称: ";
+
+// --- 辅助函数：并查集 ---
+// 按大小合并, 查找时折半路径压缩
+class DisjointSets {
+public:
+    explicit DisjointSets(size_t count) : parent(count), size(count, 1) {
+        std::iota(parent.begin(), parent.end(), uint32_t{0});
+    }
+
+    uint32_t find(uint32_t x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    void unite(uint32_t a, uint32_t b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return;
+        if (size[a] < size[b]) std::swap(a, b);
+        parent[b] = a;
+        size[a] += size[b];
+    }
+
+private:
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> size;
+};
+
+// --- 辅助函数：从日志或名称列表中取出名称 ---
+// 日志只取找不到的 Mod 记录的干净名称; 名称列表的每个非空行按文件名清理
+bool readNameList(const fs::path& path, bool isLog, NormalizeCache* nameCache, std::vector<std::string>& names) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        logMessage("无法打开文件: " + path.string(), true);
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t marker = line.find(CLEAN_NAME_MARKER);
+        if (marker != std::string::npos) {
+            size_t begin = marker + CLEAN_NAME_MARKER.size();
+            size_t end = line.find_first_of(",)", begin);
+            if (end == std::string::npos) end = line.size();
+            if (end > begin) names.push_back(line.substr(begin, end - begin));
+            continue;
+        }
+        if (isLog) continue;
+        size_t begin = line.find_first_not_of(" \t");
+        if (begin == std::string::npos) continue;
+        size_t end = line.find_last_not_of(" \t") + 1;
+        std::string fileName = line.substr(begin, end - begin);
+        names.push_back(nameCache ? nameCache->getCleanName(fileName) : getCleanModName(fileName));
+    }
+    return true;
+}
+
+} // namespace
+
+std::vector<NameCluster> clusterNames(const std::vector<std::string>& names) {
+    // 去重, 同时记下每个名称出现的次数
+    std::vector<std::string_view> sorted(names.begin(), names.end());
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<std::string_view> unique;
+    std::vector<size_t> fileCounts;
+    for (size_t i = 0; i < sorted.size();) {
+        size_t end = i + 1;
+        while (end < sorted.size() && sorted[end] == sorted[i]) ++end;
+        unique.push_back(sorted[i]);
+        fileCounts.push_back(end - i);
+        i = end;
+    }
+    const size_t count = unique.size();
+    if (count == 0) return {};
+
+    DisjointSets sets(count);
+
+    // 1. 骨架完全相同的名称直接合并 (不允许编辑的短名称只有这一种情况), 之后每种骨架只保留一个代表
+    std::vector<std::string> skeletons(count);
+    for (size_t i = 0; i < count; ++i) skeletons[i] = nameSkeleton(unique[i]);
+    std::vector<uint32_t> distinct;
+    {
+        std::unordered_map<std::string_view, uint32_t> firstWithSkeleton;
+        firstWithSkeleton.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            auto [it, inserted] = firstWithSkeleton.emplace(skeletons[i], i);
+            if (inserted) {
+                distinct.push_back(i);
+            } else {
+                sets.unite(it->second, i);
+            }
+        }
+    }
+
+    // 2. 允许编辑的骨架按片段建立索引, 每个骨架只查询片段可能出现的位置, 候选对只来自片段相同的骨架
+    SegmentIndex segments;
+    segments.build(skeletons, distinct);
+    std::vector<std::vector<uint32_t>> neighbors(distinct.size());
+    ThreadPool pool(std::min(defaultThreadCount(), distinct.size()));
+    parallelFor(pool, distinct.size(), [&](size_t d) {
+        uint32_t i = distinct[d];
+        const std::string& skeleton = skeletons[i];
+        for (const auto& [entry, edits] : segments.candidates(skeletons, i)) {
+            if (editDistance(skeleton, skeletons[entry], edits) <= edits) neighbors[d].push_back(entry);
+        }
+    });
+
+    for (size_t d = 0; d < distinct.size(); ++d) {
+        for (uint32_t j : neighbors[d]) sets.unite(distinct[d], j);
+    }
+
+    // 按根分组; unique 已排序, 组内名称自然按字典序
+    std::vector<uint32_t> clusterOf(count, UINT32_MAX);
+    std::vector<std::vector<uint32_t>> members;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t root = sets.find(static_cast<uint32_t>(i));
+        if (clusterOf[root] == UINT32_MAX) {
+            clusterOf[root] = static_cast<uint32_t>(members.size());
+            members.emplace_back();
+        }
+        members[clusterOf[root]].push_back(static_cast<uint32_t>(i));
+    }
+
+    std::vector<NameCluster> clusters;
+    clusters.reserve(members.size());
+    for (const std::vector<uint32_t>& group : members) {
+        uint32_t best = group[0];
+        for (uint32_t i : group) {
+            if (fileCounts[i] != fileCounts[best] ? fileCounts[i] > fileCounts[best]
+                                                  : unique[i].size() < unique[best].size()) {
+                best = i;
+            }
+        }
+        NameCluster cluster;
+        cluster.representative = std::string(unique[best]);
+        for (uint32_t i : group) {
+            cluster.files += fileCounts[i];
+            if (i != best) cluster.variants.emplace_back(unique[i]);
+        }
+        clusters.push_back(std::move(cluster));
+    }
+    std::sort(clusters.begin(), clusters.end(), [](const NameCluster& a, const NameCluster& b) {
+        if (a.variants.size() != b.variants.size()) return a.variants.size() > b.variants.size();
+        if (a.files != b.files) return a.files > b.files;
+        return a.representative < b.representative;
+    });
+    return clusters;
+}
+
+bool writeUnknownReport(const std::string& path, const std::vector<NameCluster>& clusters) {
+    // 与 mods_data.json 的条目格式相同, 类型由贡献者确认后填写
+    ordered_json report = ordered_json::array();
+    for (const NameCluster& cluster : clusters) {
+        ordered_json item;
+        item["name"] = cluster.representative;
+        item["type"] = ModInfo::modTypeToString(ModType::Unknown);
+        if (!cluster.variants.empty()) item["aliases"] = cluster.variants;
+        report.push_back(std::move(item));
+    }
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        logMessage("无法写入报告: " + path, true);
+        return false;
+    }
+    out << report.dump(2) << '\n';
+    if (!out) {
+        logMessage("写入报告失败: " + path, true);
+        return false;
+    }
+    return true;
+}
+
+bool runUnknownReport(const std::string& inputPath, const std::string& outputPath, const ModIndex& index,
+                      NormalizeCache* nameCache) {
+    std::vector<std::string> names;
+    std::string fileName = fs::path(inputPath).filename().string();
+    bool isLog = hasExtension(fileName, ".log");
+    if (fs::is_regular_file(inputPath) && (isLog || hasExtension(fileName, ".txt"))) {
+        if (!readNameList(inputPath, isLog, nameCache, names)) return false;
+        // 日志中的名称在写日志时没有找到, 数据库或覆盖规则之后可能已经补上
+        names.erase(std::remove_if(names.begin(), names.end(),
+                                   [&](const std::string& name) {
+                                       return index.matchOverride(name) != nullptr || index.find(name).has_value();
+                                   }),
+                    names.end());
+    } else {
+        std::vector<DiffMod> mods;
+        if (!listDiffMods(inputPath, index, nameCache, mods)) return false;
+        for (DiffMod& mod : mods) {
+            if (!mod.type) names.push_back(std::move(mod.cleanName));
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<NameCluster> clusters = clusterNames(names);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    size_t grouped = 0;
+    size_t distinct = 0;
+    for (const NameCluster& cluster : clusters) {
+        distinct += cluster.variants.size() + 1;
+        if (!cluster.variants.empty()) ++grouped;
+    }
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2) << "已把 " << distinct << " 个未找到的名称 (" << names.size()
+       << " 个文件) 聚成 " << clusters.size() << " 组, 其中 " << grouped << " 组有多个名称, 耗时 " << elapsed
+       << " 毫秒";
+    logMessage(ss.str());
+
+    if (!writeUnknownReport(outputPath, clusters)) return false;
+    logMessage("已写出未找到的 Mod 报告: " + outputPath);
+    return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "classifier.h"
+#include "normalize_cache.h"
+
+// --- 未找到的 Mod 聚类报告 ---
+// 给数据库贡献者用: 把数据库中找不到的干净名称按近似程度聚成若干组, 每组给出一个代表名称和其余变体,
+// 写成可以直接编辑后并入 mods_data.json 的条目 ({name, type: unknown, aliases})。
+// 所有名称去重后去掉分隔符得到骨架: 骨架相同的直接用哈希表合并; 允许编辑的骨架按鸽巢原理均分成若干段建立片段索引,
+// 只对片段相同的名称对计算编辑距离 (见 edit_distance.h), 近似的名称对用并查集合并。
+// 不做两两比较, 也不扫描同一长度的所有名称, 工作量随名称数和近似的名称对数增长。
+
+struct NameCluster {
+    std::string representative;        // 文件最多的名称, 相同时取较短的, 再按字典序
+    std::vector<std::string> variants; // 其余名称, 按字典序
+    size_t files = 0;                  // 组内所有名称对应的文件数
+};
+
+// names 可以重复, 重复次数计入 files。
+// 转小写、去掉扩展名和分隔符后相同, 或编辑距离在允许范围内 (较短的一方不少于 10 个字符时 1 处, 不少于 20 个字符时 2 处)
+// 的两个名称视为同一个 Mod。
+// 结果按组的名称数从多到少排列, 相同时按文件数和代表名称
+std::vector<NameCluster> clusterNames(const std::vector<std::string>& names);
+
+// 把聚类结果写成 JSON 数组, 失败时记录日志并返回 false
+bool writeUnknownReport(const std::string& path, const std::vector<NameCluster>& clusters);
+
+// 完整流程: 从 inputPath 收集数据库中找不到的干净名称, 聚类后写到 outputPath。
+// inputPath 为目录或整合包时按文件名查找数据库 (不读取 jar); 为 .log 文件 (本程序的日志) 时取出找不到的 Mod
+// 记录的 "干净名称: ..."; 为 .txt 文件时每个非空行是一个文件名。日志和列表中的名称会重新查一遍数据库
+bool runUnknownReport(const std::string& inputPath, const std::string& outputPath, const ModIndex& index,
+                      NormalizeCache* nameCache);
@@ -0,0 +1,224 @@
+#include "zip_reader.h"
+
+#include <algorithm>
+#include <array>
+#include "byte_order.h"
+
+namespace {
+
+constexpr uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+constexpr uint32_t CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+constexpr uint32_t END_OF_CENTRAL_SIGNATURE = 0x06054b50;
+constexpr uint32_t ZIP64_END_SIGNATURE = 0x06064b50;
+constexpr uint32_t ZIP64_LOCATOR_SIGNATURE = 0x07064b50;
+
+constexpr size_t LOCAL_HEADER_SIZE = 30;
+constexpr size_t CENTRAL_HEADER_SIZE = 46;
+constexpr size_t END_OF_CENTRAL_SIZE = 22;
+constexpr size_t ZIP64_LOCATOR_SIZE = 20;
+constexpr size_t ZIP64_END_SIZE = 56;
+constexpr size_t MAX_COMMENT_SIZE = 0xFFFF;
+
+// 按 8 字节切片的 CRC 表: tables[k][b] 为字节 b 之后再跟 k 个零字节的 CRC 贡献
+using CrcTables = std::array<std::array<uint32_t, 256>, 8>;
+
+const CrcTables& crcTables() {
+    static const CrcTables tables = [] {
+        CrcTables t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (size_t k = 1; k < 8; ++k) t[k][i] = t[0][t[k - 1][i] & 0xFF] ^ (t[k - 1][i] >> 8);
+        }
+        return t;
+    }();
+    return tables;
+}
+
+// 从 ZIP64 扩展字段中取出被 0xFFFFFFFF 占位的字段, 顺序固定为 原始大小, 压缩大小, 本地头偏移
+void applyZip64Extra(ZipEntry& entry, const unsigned char* extra, size_t extraSize,
+                     bool needUncompressed, bool needCompressed, bool needOffset) {
+    size_t pos = 0;
+    while (pos + 4 <= extraSize) {
+        uint16_t id = readLe16(extra + pos);
+        uint16_t length = readLe16(extra + pos + 2);
+        pos += 4;
+        if (pos + length > extraSize) return;
+        if (id == 0x0001) {
+            const unsigned char* field = extra + pos;
+            const unsigned char* end = field + length;
+            if (needUncompressed && field + 8 <= end) { entry.uncompressedSize = readLe64(field); field += 8; }
+            if (needCompressed && field + 8 <= end) { entry.compressedSize = readLe64(field); field += 8; }
+            if (needOffset && field + 8 <= end) { entry.localHeaderOffset = readLe64(field); }
+            return;
+        }
+        pos += length;
+    }
+}
+
+} // namespace
+
+uint32_t zipCrc32(uint32_t crc, const unsigned char* data, size_t size) {
+    // 每次处理 8 字节 (slicing-by-8), 写出存储条目时 CRC 是主要开销
+    const CrcTables& t = crcTables();
+    crc = ~crc;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint32_t low = crc ^ readLe32(data + i);
+        uint32_t high = readLe32(data + i + 4);
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+              t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+    }
+    for (; i < size; ++i) crc = t[0][(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+bool ZipReader::open(const std::filesystem::path& path) {
+    data = nullptr;
+    if (!mapping.open(path)) return false;
+    return openMemory(mapping.data(), mapping.size());
+}
+
+bool ZipReader::openMemory(const unsigned char* bytes, size_t length) {
+    data = bytes;
+    size = length;
+    if (data == nullptr || !locateCentralDirectory()) {
+        data = nullptr;
+        size = 0;
+        return false;
+    }
+    return true;
+}
+
+bool ZipReader::locateCentralDirectory() {
+    if (size < END_OF_CENTRAL_SIZE) return false;
+
+    // 结束记录后面可能跟着最长 64 KB 的注释, 从后向前查找签名
+    size_t lowest = size - END_OF_CENTRAL_SIZE > MAX_COMMENT_SIZE ? size - END_OF_CENTRAL_SIZE - MAX_COMMENT_SIZE : 0;
+    size_t eocd = size - END_OF_CENTRAL_SIZE;
+    for (;;) {
+        if (readLe32(data + eocd) == END_OF_CENTRAL_SIGNATURE &&
+            eocd + END_OF_CENTRAL_SIZE + readLe16(data + eocd + 20) <= size) {
+            break;
+        }
+        if (eocd == lowest) return false;
+        --eocd;
+    }
+
+    totalEntries = readLe16(data + eocd + 10);
+    centralSize = readLe32(data + eocd + 12);
+    centralOffset = readLe32(data + eocd + 16);
+
+    // 字段被占满时改用 ZIP64 结束记录
+    if (eocd >= ZIP64_LOCATOR_SIZE && readLe32(data + eocd - ZIP64_LOCATOR_SIZE) == ZIP64_LOCATOR_SIGNATURE) {
+        uint64_t zip64End = readLe64(data + eocd - ZIP64_LOCATOR_SIZE + 8);
+        if (size >= ZIP64_END_SIZE && zip64End <= size - ZIP64_END_SIZE &&
+            readLe32(data + zip64End) == ZIP64_END_SIGNATURE) {
+            totalEntries = readLe64(data + zip64End + 32);
+            centralSize = readLe64(data + zip64End + 40);
+            centralOffset = readLe64(data + zip64End + 48);
+        }
+    }
+
+    return centralOffset <= size && centralSize <= size - centralOffset;
+}
+
+bool ZipReader::forEachEntry(const std::function<bool(const ZipEntry&)>& visitor) const {
+    if (data == nullptr) return false;
+    const unsigned char* p = data + centralOffset;
+    const unsigned char* end = p + centralSize;
+    for (uint64_t i = 0; i < totalEntries; ++i) {
+        if (p + CENTRAL_HEADER_SIZE > end || readLe32(p) != CENTRAL_HEADER_SIGNATURE) return false;
+        uint16_t nameLength = readLe16(p + 28);
+        uint16_t extraLength = readLe16(p + 30);
+        uint16_t commentLength = readLe16(p + 32);
+        size_t recordSize = CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength;
+        if (p + recordSize > end) return false;
+
+        ZipEntry entry;
+        entry.flags = readLe16(p + 8);
+        entry.method = readLe16(p + 10);
+        entry.crc32 = readLe32(p + 16);
+        entry.compressedSize = readLe32(p + 20);
+        entry.uncompressedSize = readLe32(p + 24);
+        entry.localHeaderOffset = readLe32(p + 42);
+        entry.name = std::string_view(reinterpret_cast<const char*>(p + CENTRAL_HEADER_SIZE), nameLength);
+        bool needUncompressed = entry.uncompressedSize == 0xFFFFFFFF;
+        bool needCompressed = entry.compressedSize == 0xFFFFFFFF;
+        bool needOffset = entry.localHeaderOffset == 0xFFFFFFFF;
+        if (needUncompressed || needCompressed || needOffset) {
+            applyZip64Extra(entry, p + CENTRAL_HEADER_SIZE + nameLength, extraLength,
+                            needUncompressed, needCompressed, needOffset);
+        }
+
+        if (!visitor(entry)) return true;
+        p += recordSize;
+    }
+    return true;
+}
+
+std::optional<ZipEntry> ZipReader::find(std::string_view name) const {
+    std::optional<ZipEntry> found;
+    forEachEntry([&](const ZipEntry& entry) {
+        if (entry.name != name) return true;
+        found = entry;
+        return false;
+    });
+    return found;
+}
+
+const unsigned char* ZipReader::rawData(const ZipEntry& entry) const {
+    if (data == nullptr || size < LOCAL_HEADER_SIZE || entry.localHeaderOffset > size - LOCAL_HEADER_SIZE) return nullptr;
+    const unsigned char* local = data + entry.localHeaderOffset;
+    if (readLe32(local) != LOCAL_HEADER_SIGNATURE) return nullptr;
+    // 本地头中的扩展字段长度可能与中央目录不同, 必须以本地头为准
+    uint64_t offset = entry.localHeaderOffset + LOCAL_HEADER_SIZE + readLe16(local + 26) + readLe16(local + 28);
+    if (offset > size || entry.compressedSize > size - offset) return nullptr;
+    return data + offset;
+}
+
+bool ZipReader::extract(const ZipEntry& entry, std::string& out, size_t maxSize) const {
+    out.clear();
+    if (entry.isEncrypted() || entry.uncompressedSize > maxSize) return false;
+    const unsigned char* raw = rawData(entry);
+    if (raw == nullptr) return false;
+
+    if (entry.method == 0) {
+        if (entry.compressedSize != entry.uncompressedSize) return false;
+        out.assign(reinterpret_cast<const char*>(raw), static_cast<size_t>(entry.compressedSize));
+    } else if (entry.method == 8) {
+        out.reserve(static_cast<size_t>(entry.uncompressedSize));
+        size_t limit = static_cast<size_t>(entry.uncompressedSize);
+        if (inflateRaw(raw, static_cast<size_t>(entry.compressedSize), out, limit) != InflateStatus::Ok) return false;
+    } else {
+        return false;
+    }
+    if (out.size() != entry.uncompressedSize) return false;
+    return zipCrc32(0, reinterpret_cast<const unsigned char*>(out.data()), out.size()) == entry.crc32;
+}
+
+bool ZipReader::extractToWindow(const ZipEntry& entry, size_t maxSize, std::string_view& out,
+                                const InflateStopCheck& shouldStop) const {
+    out = {};
+    if (entry.isEncrypted() || entry.uncompressedSize > maxSize) return false;
+    const unsigned char* raw = rawData(entry);
+    if (raw == nullptr) return false;
+
+    auto size = static_cast<size_t>(entry.uncompressedSize);
+    if (entry.method == 0) {
+        if (entry.compressedSize != entry.uncompressedSize) return false;
+        out = std::string_view(reinterpret_cast<const char*>(raw), size);
+    } else if (entry.method == 8) {
+        InflateResult result = inflateToWindow(raw, static_cast<size_t>(entry.compressedSize), size, shouldStop);
+        out = result.data;
+        if (result.status == InflateStatus::Stopped) return true;
+        if (result.status != InflateStatus::Ok) return false;
+    } else {
+        return false;
+    }
+    if (out.size() != size) return false;
+    return zipCrc32(0, reinterpret_cast<const unsigned char*>(out.data()), out.size()) == entry.crc32;
+}
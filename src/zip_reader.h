@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "inflate.h"
+#include "mapped_file.h"
+
+// --- zip 条目 ---
+// name 指向中央目录中的原始字节, 只在所属 ZipReader 存活期间有效
+struct ZipEntry {
+    std::string_view name;
+    uint16_t method = 0;          // 0 = 存储, 8 = DEFLATE
+    uint16_t flags = 0;
+    uint32_t crc32 = 0;
+    uint64_t compressedSize = 0;
+    uint64_t uncompressedSize = 0;
+    uint64_t localHeaderOffset = 0;
+
+    bool isDirectory() const { return !name.empty() && name.back() == '/'; }
+    bool isEncrypted() const { return (flags & 0x0001) != 0; }
+};
+
+// --- 只读 zip 读取器 ---
+// 只解析末尾的中央目录, 不扫描整个文件; 支持 ZIP64。
+// 数据可以来自内存映射的文件, 也可以来自调用方持有的内存 (例如 jar 中嵌套的 jar)。
+// 打开后只读, 可以在多个线程中同时读取条目。
+class ZipReader {
+public:
+    ZipReader() = default;
+
+    ZipReader(const ZipReader&) = delete;
+    ZipReader& operator=(const ZipReader&) = delete;
+
+    // 映射并打开文件, 不是有效的 zip 时返回 false
+    bool open(const std::filesystem::path& path);
+    // 打开一段内存中的 zip 数据, 调用方保证 data 在读取器使用期间有效
+    bool openMemory(const unsigned char* data, size_t size);
+
+    bool isOpen() const { return data != nullptr; }
+    uint64_t entryCount() const { return totalEntries; }
+    const unsigned char* archiveData() const { return data; }
+    size_t archiveSize() const { return size; }
+
+    // 在中央目录中按完整路径查找条目 (区分大小写)
+    std::optional<ZipEntry> find(std::string_view name) const;
+
+    // 按中央目录顺序遍历条目, visitor 返回 false 时停止; 中央目录损坏时返回 false
+    bool forEachEntry(const std::function<bool(const ZipEntry&)>& visitor) const;
+
+    // 取得条目压缩数据在归档中的位置, 条目越界时返回 nullptr
+    const unsigned char* rawData(const ZipEntry& entry) const;
+
+    // 解压条目到 out (覆盖原内容), 解压后超过 maxSize 字节、加密、方法不支持或校验失败时返回 false
+    bool extract(const ZipEntry& entry, std::string& out, size_t maxSize) const;
+
+    // 解压条目到当前线程复用的窗口缓冲区 (存储的条目直接指向归档数据), 用于读取大量小条目。
+    // shouldStop 返回 true 时提前结束, 此时 out 只是前缀且不校验 CRC; out 在本线程下一次解压前有效
+    bool extractToWindow(const ZipEntry& entry, size_t maxSize, std::string_view& out,
+                         const InflateStopCheck& shouldStop = nullptr) const;
+
+private:
+    bool locateCentralDirectory();
+
+    MappedFile mapping;
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    uint64_t centralOffset = 0;
+    uint64_t centralSize = 0;
+    uint64_t totalEntries = 0;
+};
+
+// 标准 CRC-32 (zip/gzip 使用的多项式), 可以分段累加: crc = zipCrc32(crc, ...)
+uint32_t zipCrc32(uint32_t crc, const unsigned char* data, size_t size);
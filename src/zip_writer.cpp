@@ -0,0 +1,212 @@
+#include "zip_writer.h"
+
+#include <ctime>
+#include <system_error>
+#include "byte_order.h"
+#include "deflate.h"
+#include "logger.h"
+#include "zip_reader.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+constexpr uint32_t CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+constexpr uint32_t END_OF_CENTRAL_SIGNATURE = 0x06054b50;
+constexpr uint32_t ZIP64_END_SIGNATURE = 0x06064b50;
+constexpr uint32_t ZIP64_LOCATOR_SIGNATURE = 0x07064b50;
+
+constexpr uint16_t VERSION_DEFAULT = 20; // 2.0: DEFLATE
+constexpr uint16_t VERSION_ZIP64 = 45;   // 4.5: ZIP64
+constexpr uint16_t FLAG_UTF8 = 0x0800;   // 文件名为 UTF-8
+constexpr uint64_t MAX_32 = 0xFFFFFFFF;
+constexpr uint64_t MAX_16 = 0xFFFF;
+
+// --- 辅助函数：取 32 位字段的值, 超出时写占位符并由 ZIP64 扩展字段给出 ---
+uint64_t field32(uint64_t value) {
+    return value >= MAX_32 ? MAX_32 : value;
+}
+
+} // namespace
+
+ZipWriter::~ZipWriter() {
+    if (finished || tempPath.empty()) return;
+    out.close();
+    std::error_code ec;
+    fs::remove(tempPath, ec);
+}
+
+bool ZipWriter::open(const fs::path& path) {
+    targetPath = path;
+    tempPath = fs::path(path) += ".tmp";
+    out.open(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        logMessage("无法创建归档: " + tempPath.string(), true);
+        failed = true;
+        return false;
+    }
+
+    // 所有条目使用打开归档时的本地时间
+    std::time_t now = std::time(nullptr);
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    int year = local.tm_year + 1900 < 1980 ? 0 : local.tm_year + 1900 - 1980;
+    dosTime = static_cast<uint16_t>((local.tm_hour << 11) | (local.tm_min << 5) | (local.tm_sec / 2));
+    dosDate = static_cast<uint16_t>((year << 9) | ((local.tm_mon + 1) << 5) | local.tm_mday);
+    return true;
+}
+
+bool ZipWriter::write(const void* data, size_t size) {
+    if (failed) return false;
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    if (!out) {
+        logMessage("写入归档失败: " + tempPath.string(), true);
+        failed = true;
+        return false;
+    }
+    position += size;
+    return true;
+}
+
+bool ZipWriter::addStored(std::string_view name, const unsigned char* data, size_t size) {
+    return addRaw(name, 0, zipCrc32(0, data, size), data, size, size);
+}
+
+bool ZipWriter::addDeflated(std::string_view name, const unsigned char* data, size_t size, ThreadPool& pool) {
+    std::string compressed;
+    deflateParallel(data, size, compressed, pool);
+    if (compressed.size() >= size) return addStored(name, data, size);
+    return addRaw(name, 8, zipCrc32(0, data, size), reinterpret_cast<const unsigned char*>(compressed.data()),
+                  compressed.size(), size);
+}
+
+bool ZipWriter::addRaw(std::string_view name, uint16_t method, uint32_t crc32, const unsigned char* data,
+                       uint64_t compressedSize, uint64_t uncompressedSize) {
+    if (failed || finished || name.size() > MAX_16) return false;
+    if (!names.emplace(name).second) return false;
+
+    Record record{std::string(name), method, crc32, compressedSize, uncompressedSize, position};
+    bool zip64 = compressedSize >= MAX_32 || uncompressedSize >= MAX_32;
+
+    std::string header;
+    header.reserve(30 + name.size() + 20);
+    appendLe32(header, LOCAL_HEADER_SIGNATURE);
+    appendLe16(header, zip64 ? VERSION_ZIP64 : VERSION_DEFAULT);
+    appendLe16(header, FLAG_UTF8);
+    appendLe16(header, method);
+    appendLe16(header, dosTime);
+    appendLe16(header, dosDate);
+    appendLe32(header, crc32);
+    appendLe32(header, zip64 ? MAX_32 : compressedSize);
+    appendLe32(header, zip64 ? MAX_32 : uncompressedSize);
+    appendLe16(header, name.size());
+    appendLe16(header, zip64 ? 20 : 0);
+    header.append(name);
+    if (zip64) {
+        // 本地头的 ZIP64 扩展字段必须同时包含两个大小
+        appendLe16(header, 0x0001);
+        appendLe16(header, 16);
+        appendLe64(header, uncompressedSize);
+        appendLe64(header, compressedSize);
+    }
+    if (!write(header.data(), header.size())) return false;
+    if (compressedSize > 0 && !write(data, static_cast<size_t>(compressedSize))) return false;
+    records.push_back(std::move(record));
+    return true;
+}
+
+bool ZipWriter::finish() {
+    if (failed || finished) return false;
+
+    uint64_t centralOffset = position;
+    std::string central;
+    for (const Record& record : records) {
+        std::string extra;
+        if (record.uncompressedSize >= MAX_32) appendLe64(extra, record.uncompressedSize);
+        if (record.compressedSize >= MAX_32) appendLe64(extra, record.compressedSize);
+        if (record.offset >= MAX_32) appendLe64(extra, record.offset);
+        uint16_t version = extra.empty() ? VERSION_DEFAULT : VERSION_ZIP64;
+
+        appendLe32(central, CENTRAL_HEADER_SIGNATURE);
+        appendLe16(central, version); // 创建系统 0 (MS-DOS), 没有 Unix 权限位
+        appendLe16(central, version);
+        appendLe16(central, FLAG_UTF8);
+        appendLe16(central, record.method);
+        appendLe16(central, dosTime);
+        appendLe16(central, dosDate);
+        appendLe32(central, record.crc32);
+        appendLe32(central, field32(record.compressedSize));
+        appendLe32(central, field32(record.uncompressedSize));
+        appendLe16(central, record.name.size());
+        appendLe16(central, extra.empty() ? 0 : extra.size() + 4);
+        appendLe16(central, 0); // 注释
+        appendLe16(central, 0); // 磁盘号
+        appendLe16(central, 0); // 内部属性
+        appendLe32(central, 0); // 外部属性
+        appendLe32(central, field32(record.offset));
+        central += record.name;
+        if (!extra.empty()) {
+            appendLe16(central, 0x0001);
+            appendLe16(central, extra.size());
+            central += extra;
+        }
+        // 中央目录可能很大, 分段写出
+        if (central.size() >= 1024 * 1024) {
+            if (!write(central.data(), central.size())) return false;
+            central.clear();
+        }
+    }
+    if (!write(central.data(), central.size())) return false;
+    uint64_t centralSize = position - centralOffset;
+
+    std::string end;
+    bool zip64 = records.size() >= MAX_16 || centralOffset >= MAX_32 || centralSize >= MAX_32;
+    if (zip64) {
+        uint64_t zip64EndOffset = position;
+        appendLe32(end, ZIP64_END_SIGNATURE);
+        appendLe64(end, 44); // 记录中此字段之后的长度
+        appendLe16(end, VERSION_ZIP64);
+        appendLe16(end, VERSION_ZIP64);
+        appendLe32(end, 0);
+        appendLe32(end, 0);
+        appendLe64(end, records.size());
+        appendLe64(end, records.size());
+        appendLe64(end, centralSize);
+        appendLe64(end, centralOffset);
+
+        appendLe32(end, ZIP64_LOCATOR_SIGNATURE);
+        appendLe32(end, 0);
+        appendLe64(end, zip64EndOffset);
+        appendLe32(end, 1);
+    }
+    appendLe32(end, END_OF_CENTRAL_SIGNATURE);
+    appendLe16(end, 0);
+    appendLe16(end, 0);
+    appendLe16(end, records.size() >= MAX_16 ? MAX_16 : records.size());
+    appendLe16(end, records.size() >= MAX_16 ? MAX_16 : records.size());
+    appendLe32(end, field32(centralSize));
+    appendLe32(end, field32(centralOffset));
+    appendLe16(end, 0);
+    if (!write(end.data(), end.size())) return false;
+
+    out.close();
+    if (!out) {
+        logMessage("写入归档失败: " + tempPath.string(), true);
+        failed = true;
+        return false;
+    }
+    std::error_code ec;
+    fs::rename(tempPath, targetPath, ec);
+    if (ec) {
+        logMessage("无法替换归档 " + targetPath.string() + ": " + ec.message(), true);
+        failed = true;
+        return false;
+    }
+    finished = true;
+    return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#include "thread_pool.h"
+
+// --- 顺序写入的 zip 写入器 ---
+// 每个条目的数据在写入前已经全部就绪 (内存映射的文件或解压/压缩后的缓冲区), 本地头中直接写入 CRC 和大小,
+// 不使用数据描述符; 中央目录在 finish() 时统一写在末尾。条目数或偏移超出 32 位时自动使用 ZIP64。
+// 先写入 "<目标>.tmp", finish() 成功后替换目标文件, 中途失败或未调用 finish() 时删除临时文件。
+class ZipWriter {
+public:
+    ZipWriter() = default;
+    ~ZipWriter();
+
+    ZipWriter(const ZipWriter&) = delete;
+    ZipWriter& operator=(const ZipWriter&) = delete;
+
+    bool open(const std::filesystem::path& path);
+
+    bool contains(std::string_view name) const { return names.count(std::string(name)) != 0; }
+    size_t entryCount() const { return records.size(); }
+    uint64_t bytesWritten() const { return position; }
+    const std::filesystem::path& path() const { return targetPath; }
+
+    // 原样存储 (method 0)
+    bool addStored(std::string_view name, const unsigned char* data, size_t size);
+    // 在线程池中并行压缩 (method 8); 压缩后不比原数据小时改为存储
+    bool addDeflated(std::string_view name, const unsigned char* data, size_t size, ThreadPool& pool);
+    // 直接写入已经编码好的数据, 例如从另一个 zip 原样复制的条目 (不重新压缩, 也不重新计算 CRC)
+    bool addRaw(std::string_view name, uint16_t method, uint32_t crc32, const unsigned char* data,
+                uint64_t compressedSize, uint64_t uncompressedSize);
+
+    // 写出中央目录并替换目标文件
+    bool finish();
+
+private:
+    struct Record {
+        std::string name;
+        uint16_t method;
+        uint32_t crc32;
+        uint64_t compressedSize;
+        uint64_t uncompressedSize;
+        uint64_t offset;
+    };
+
+    bool write(const void* data, size_t size);
+
+    std::filesystem::path targetPath;
+    std::filesystem::path tempPath;
+    std::ofstream out;
+    uint64_t position = 0;
+    uint16_t dosTime = 0;
+    uint16_t dosDate = 0;
+    std::vector<Record> records;
+    std::unordered_set<std::string> names;
+    bool failed = false;
+    bool finished = false;
+};